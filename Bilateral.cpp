@@ -0,0 +1,232 @@
+#include "Bilateral.h"
+
+//
+// fvXf[^̃oCetB^
+//
+
+// WCu
+#include <cmath>
+#include <immintrin.h>
+
+// fvX̃eNX`̒l~[gɊZW (GL_R16)
+const GLfloat depthRange(65535.0f);
+
+// fvXl̍̏d݂̕\ 1mm ̗vf
+const GLfloat rangeResolution(4.0f);
+
+// RXgN^
+Bilateral::Bilateral(int width, int height)
+  : radius(0)
+  , sigmaSpace(1.0f)
+  , sigmaRange(1.0f)
+  , separable(false)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    // tB^ɎgvZ
+    pass[i] = new Calculate(width, height, "bilateral.frag", 1, 1, GL_R32F);
+
+    // uniform ϐ̏ꏊ
+    radiusLoc[i] = glGetUniformLocation(pass[i]->get(), "radius");
+    sigmaSpaceLoc[i] = glGetUniformLocation(pass[i]->get(), "sigmaSpace");
+    sigmaRangeLoc[i] = glGetUniformLocation(pass[i]->get(), "sigmaRange");
+    directionLoc[i] = glGetUniformLocation(pass[i]->get(), "direction");
+  }
+}
+
+// fXgN^
+Bilateral::~Bilateral()
+{
+  for (int i = 0; i < 2; ++i) delete pass[i];
+}
+
+// fvXf[^̃eNX`ɃtB^, ʂ̃eNX`Ԃ
+GLuint Bilateral::filter(GLuint depth) const
+{
+  // 񎟌Ȃ, ƏcɕȂ
+  const int passes(separable ? 2 : 1);
+
+  for (int i = 0; i < passes; ++i)
+  {
+    // p[^ݒ肷
+    pass[i]->use();
+    glUniform1i(radiusLoc[i], radius);
+    glUniform1f(sigmaSpaceLoc[i], sigmaSpace);
+    glUniform1f(sigmaRangeLoc[i], sigmaRange / depthRange);
+    glUniform2i(directionLoc[i], separable ? 1 - i : 0, separable ? i : 0);
+
+    // ÕpX̌ʂ͂
+    glUniform1i(0, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depth);
+
+    // tB^
+    depth = pass[i]->calculate()[0];
+  }
+
+  return depth;
+}
+
+// CPU ɂtB^̃RXgN^
+CpuBilateral::CpuBilateral(int width, int height)
+  : CpuCalculate(width, height, 1, 1, 1)
+  , rangeScale(rangeResolution)
+  , radius(-1)
+  , separable(false)
+  , stride(0)
+  , stage(0)
+  , depth(width * height)
+  , avx2(hasAvx2())
+{
+  setParameter(0, 1.0f, 1.0f);
+}
+
+// tB^̃p[^ݒ肷
+void CpuBilateral::setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaRange, bool separable)
+{
+  // aς͂𖄂߂obt@蒼
+  if (radius != this->radius)
+  {
+    this->radius = radius;
+    stride = width + radius * 2;
+    for (int i = 0; i < 2; ++i) padded[i].assign(stride * (height + radius * 2), 0.0f);
+  }
+  this->separable = separable;
+
+  // ߖT̉f̈ʒuƋ̏d
+  const GLfloat ks(-0.5f / (sigmaSpace * sigmaSpace));
+  for (int i = 0; i < 3; ++i) taps[i].clear();
+  for (int j = -radius; j <= radius; ++j)
+  {
+    for (int i = -radius; i <= radius; ++i)
+    {
+      const Tap tap = { j * stride + i, GLfloat(exp(GLfloat(i * i + j * j) * ks)) };
+      taps[0].push_back(tap);
+      if (j == 0) taps[1].push_back(tap);
+      if (i == 0) taps[2].push_back(tap);
+    }
+  }
+
+  // fvXl̍̏d݂̕\ (W΍ 3 {ȏ̍ 0 ɂ)
+  const GLfloat kr(-0.5f / (sigmaRange * sigmaRange));
+  const int entries(int(ceil(sigmaRange * 3.0f * rangeScale)));
+  range.resize(entries + 1);
+  for (int k = 0; k < entries; ++k)
+  {
+    const GLfloat e(GLfloat(k) / rangeScale);
+    range[k] = GLfloat(exp(e * e * kr));
+  }
+  range[entries] = 0.0f;
+}
+
+// s count ̉fɃtB^
+void CpuBilateral::filterRow(const GLfloat *src, GLfloat *dst, int count, const std::vector<Tap> &taps) const
+{
+  const int last(int(range.size()) - 1);
+
+  for (int u = 0; u < count; ++u)
+  {
+    // vłȂf͂̂܂܂ɂ
+    const GLfloat d(src[u]);
+    if (d == 0.0f)
+    {
+      dst[u] = 0.0f;
+      continue;
+    }
+
+    // ߖT̉f̃fvXldݕtĕς
+    GLfloat sw(0.0f), sd(0.0f);
+    for (std::vector<Tap>::const_iterator t = taps.begin(); t != taps.end(); ++t)
+    {
+      const GLfloat n(src[u + t->offset]);
+      if (n == 0.0f) continue;
+      const GLfloat e(fabs(n - d) * rangeScale);
+      const GLfloat w(t->weight * range[e < GLfloat(last) ? int(e) : last]);
+      sw += w;
+      sd += w * n;
+    }
+    dst[u] = sd / sw;
+  }
+}
+
+// s count ̉f 8 ftB^, fԂ
+AVX2_FUNCTION int CpuBilateral::filterRowAvx2(const GLfloat *src, GLfloat *dst, int count, const std::vector<Tap> &taps) const
+{
+  const __m256 zero(_mm256_setzero_ps());
+  const __m256 sign(_mm256_set1_ps(-0.0f));
+  const __m256 scale(_mm256_set1_ps(rangeScale));
+  const __m256 last(_mm256_set1_ps(GLfloat(range.size() - 1)));
+
+  int u(0);
+  for (; u + 8 <= count; u += 8)
+  {
+    const __m256 d(_mm256_loadu_ps(src + u));
+    __m256 sw(zero), sd(zero);
+
+    for (std::vector<Tap>::const_iterator t = taps.begin(); t != taps.end(); ++t)
+    {
+      // fvXl̍̏d݂\
+      const __m256 n(_mm256_loadu_ps(src + u + t->offset));
+      const __m256 e(_mm256_min_ps(_mm256_mul_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(n, d)), scale), last));
+      const __m256 r(_mm256_i32gather_ps(range.data(), _mm256_cvttps_epi32(e), 4));
+
+      // vłȂf̏d݂ 0 ɂ
+      const __m256 w(_mm256_and_ps(_mm256_cmp_ps(n, zero, _CMP_NEQ_OQ), _mm256_mul_ps(r, _mm256_set1_ps(t->weight))));
+      sw = _mm256_add_ps(sw, w);
+      sd = _mm256_fmadd_ps(w, n, sd);
+    }
+
+    // vłȂf 0 ̂܂܂ɂ (S̏d݂ 1 Ȃ̂ sw  0 ɂȂȂ)
+    const __m256 valid(_mm256_cmp_ps(d, zero, _CMP_NEQ_OQ));
+    _mm256_storeu_ps(dst + u, _mm256_and_ps(valid, _mm256_div_ps(sd, _mm256_or_ps(sw, _mm256_andnot_ps(valid, _mm256_set1_ps(1.0f))))));
+  }
+
+  return u;
+}
+
+// s [begin, end) ̌vZs
+void CpuBilateral::kernel(int begin, int end)
+{
+  for (int v = begin; v < end; ++v)
+  {
+    // ͂𖄂߂obt@̂̍s̐擪
+    const int row((v + radius) * stride + radius);
+
+    if (stage == 0)
+    {
+      // ͂fvXl͂𖄂߂obt@Ɉڂ
+      const GLushort *const d(static_cast<const GLushort *>(input[0]) + v * width);
+      GLfloat *const p(padded[0].data() + row);
+      for (int u = 0; u < width; ++u) p[u] = GLfloat(d[u]);
+      continue;
+    }
+
+    // 񎟌̃tB^܂͉̃tB^, c̃tB^
+    const std::vector<Tap> &t(separable ? taps[stage] : taps[0]);
+    const GLfloat *const src(padded[stage - 1].data() + row);
+    const bool lastStage(!separable || stage == 2);
+    GLfloat *const dst(lastStage ? buffer[0].data() + v * width : padded[1].data() + row);
+
+    const int done(avx2 ? filterRowAvx2(src, dst, width, t) : 0);
+    filterRow(src + done, dst + done, width - done, t);
+
+    // Ō̒iKȂfvXlۂ߂
+    if (lastStage)
+    {
+      GLushort *const o(depth.data() + v * width);
+      for (int u = 0; u < width; ++u) o[u] = GLushort(dst[u] + 0.5f);
+    }
+  }
+}
+
+// fvXf[^ɃtB^, ۂ߂fvXlԂ
+const GLushort *CpuBilateral::filter(const GLushort *data)
+{
+  setInput(0, data);
+
+  // ͂̕ϊ, 񎟌܂͉̃tB^, c̃tB^
+  const int stages(separable ? 3 : 2);
+  for (stage = 0; stage < stages; ++stage) calculate();
+
+  return depth.data();
+}
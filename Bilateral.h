@@ -0,0 +1,140 @@
+#pragma once
+
+//
+// fvXf[^̃oCetB^
+//
+//   ߖT̉f̃fvXl̏d݂ƃfvXl̍̏d݂̐ςŕς
+//   fvXl傫قȂ镨̂̋E͂ڂȂ
+//   vłȂf (0) Ɖ摜̊O͕ςɊ܂߂, vłȂf 0 ̂܂܂ɂ
+//   separable  true ɂƉƏc̓ɕċߎ (a r  (2r + 1)^2 ̎QƂ 2(2r + 1) ɂȂ)
+//
+
+// 摜
+#include "Calculate.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂtB^ (bilateral.frag)
+//
+//   vZʂ̃eNX` R32F , ͂fvX̃eNX` R ƓPʂ̒l
+//
+class Bilateral
+{
+  // 񎟌̃tB^܂͉̃tB^ [0] Əc̃tB^ [1]
+  const Calculate *pass[2];
+
+  // aƋ̕W΍ƃfvXl̍̕W΍ƕ uniform ϐ̏ꏊ
+  GLint radiusLoc[2], sigmaSpaceLoc[2], sigmaRangeLoc[2], directionLoc[2];
+
+  // tB^̔a (f)
+  int radius;
+
+  // ̏d݂̕W΍ (f)
+  GLfloat sigmaSpace;
+
+  // fvXl̍̏d݂̕W΍ (mm)
+  GLfloat sigmaRange;
+
+  // Əcɕċߎ
+  bool separable;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Bilateral(const Bilateral &o);
+
+  //  (֎~)
+  Bilateral &operator=(const Bilateral &o);
+
+public:
+
+  // RXgN^
+  Bilateral(int width, int height);
+
+  // fXgN^
+  virtual ~Bilateral();
+
+  // tB^̃p[^ݒ肷
+  //   radius: tB^̔a (f)
+  //   sigmaSpace: ̏d݂̕W΍ (f)
+  //   sigmaRange: fvXl̍̏d݂̕W΍ (mm,  3 {ȏ̍̉f͕ςɊ܂߂Ȃ)
+  //   separable: Əc̓ɕċߎȂ true
+  void setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaRange, bool separable = false)
+  {
+    this->radius = radius;
+    this->sigmaSpace = sigmaSpace;
+    this->sigmaRange = sigmaRange;
+    this->separable = separable;
+  }
+
+  // fvXf[^̃eNX`ɃtB^, ʂ̃eNX`Ԃ
+  GLuint filter(GLuint depth) const;
+};
+
+//
+// CPU ɂtB^ (bilateral.frag ƓvZ)
+//
+//   fvXl̍̏d݂͕\ɂ, AVX2 g 8 f߂
+//
+//    0: fvXf[^ (GLushort, mm)
+//   o 0: tB^fvXl (mm)
+//
+class CpuBilateral : public CpuCalculate
+{
+  // ߖT̉f̈ʒuƋ̏d
+  struct Tap
+  {
+    int offset;
+    GLfloat weight;
+  };
+
+  // 񎟌̃tB^ [0], ̃tB^ [1], c̃tB^ [2] ̋ߖT̉f
+  std::vector<Tap> taps[3];
+
+  // fvXl̍̏d݂̕\
+  std::vector<GLfloat> range;
+
+  // fvXl̍\̔ԍւ̊ZW
+  GLfloat rangeScale;
+
+  // tB^̔a
+  int radius;
+
+  // Əcɕċߎ
+  bool separable;
+
+  // ͂𔼌a 0 Ŗ߂fvXl [0] Ɖ̃tB^̌ [1]
+  std::vector<GLfloat> padded[2];
+
+  // ͂𖄂߂f[^̈s̗vf
+  int stride;
+
+  // ̒iK (0: ͂̕ϊ, 1: 񎟌܂͉̃tB^, 2: c̃tB^)
+  int stage;
+
+  // tB^fvXlۂ߂
+  std::vector<GLushort> depth;
+
+  // AVX2 g
+  const bool avx2;
+
+  // s count ̉fɃtB^
+  void filterRow(const GLfloat *src, GLfloat *dst, int count, const std::vector<Tap> &taps) const;
+
+  // s count ̉f 8 ftB^, fԂ (AVX2)
+  int filterRowAvx2(const GLfloat *src, GLfloat *dst, int count, const std::vector<Tap> &taps) const;
+
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuBilateral(int width, int height);
+
+  // tB^̃p[^ݒ肷 (Bilateral::setParameter() Ɠ)
+  void setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaRange, bool separable = false);
+
+  // fvXf[^ɃtB^, ۂ߂fvXlԂ
+  const GLushort *filter(const GLushort *data);
+};
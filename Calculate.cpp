@@ -5,7 +5,7 @@
 //
 
 // RXgN^
-Calculate::Calculate(int width, int height, const char *source, int uniforms, int targets)
+Calculate::Calculate(int width, int height, const char *source, int uniforms, int targets, GLenum internal)
   : width(width)
   , height(height)
   , program(ggLoadShader("rectangle.vert", source))
@@ -21,7 +21,7 @@ Calculate::Calculate(int width, int height, const char *source, int uniforms, in
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
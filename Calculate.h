@@ -42,7 +42,9 @@ class Calculate
 public:
 
   // RXgN^
-  Calculate(int width, int height, const char *source, int uniforms = 1, int targets = 1);
+  //   internal: vZʂۑeNX`̓tH[}bg
+  Calculate(int width, int height, const char *source, int uniforms = 1, int targets = 1,
+    GLenum internal = GL_RGB32F);
 
   // fXgN^
   virtual ~Calculate();
@@ -0,0 +1,172 @@
+#include "CaptureCamera.h"
+
+//
+// p̃XbhŃfvXf[^擾[xZT̊NX
+//
+
+// 
+#include "HoleFill.h"
+
+// WCu
+#include <cstring>
+
+// RXgN^
+CaptureCamera::CaptureCamera()
+  : produced(0)
+  , consumed(0)
+  , position(NULL)
+  , running(false)
+{
+}
+
+// fXgN^
+CaptureCamera::~CaptureCamera()
+{
+  // hNXIĂȂ΂ŏI
+  stop();
+  delete position;
+}
+
+// eNX`ƃobt@쐬Ď擾XbhJn
+void CaptureCamera::start(int width, int height, GLenum pointFormat)
+{
+  if (running) return;
+
+  // J[f[^͎Ȃ̂ŃJ[̃eNX` 1 fɂ
+  depthWidth = width;
+  depthHeight = height;
+  colorWidth = colorHeight = 1;
+
+  // depthCount  colorCount vZăeNX`ƃobt@IuWFNg쐬
+  makeTexture(pointFormat);
+
+  // eNX`Wׂ͂ 0 ɂ
+  glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+  const std::vector<GLfloat> texcoord(depthCount * 2, 0.0f);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, texcoord.size() * sizeof (GLfloat), texcoord.data());
+
+  // J[̃eNX`𔒂ɂ
+  setColor(1.0f, 1.0f, 1.0f);
+
+  // 擾XbhƎ󂯓nɎgobt@mۂ
+  backDepth.assign(depthCount, 0);
+  backPoint.assign(depthCount * 3, 0.0f);
+  backMask.assign(depthCount, 0);
+  readyDepth = frontDepth = backDepth;
+  readyPoint = frontPoint = backPoint;
+  readyMask = frontMask = backMask;
+  position = new CpuPosition(width, height);
+
+  // 擾XbhJn
+  running = true;
+  thread = std::thread(&CaptureCamera::run, this);
+}
+
+// 擾XbhI
+void CaptureCamera::stop()
+{
+  running = false;
+  if (thread.joinable()) thread.join();
+}
+
+// 擾Xbh̏
+void CaptureCamera::run()
+{
+  // 擾fvXf[^
+  std::vector<GLushort> raw(depthCount);
+
+  while (running)
+  {
+    // ̃t[擾
+    if (!capture(raw.data())) continue;
+
+    {
+      // ݒςĂrłȂΕ
+      std::lock_guard<std::mutex> lock(filterMutex);
+      const GLushort *const depth(filterDepth(raw.data()));
+      memcpy(backDepth.data(), depth, depthCount * sizeof (GLushort));
+      if (holeFill) memcpy(backMask.data(), holeFill->getMask(), depthCount);
+    }
+
+    // JW߂
+    position->setInput(0, backDepth.data());
+    const std::vector<GLfloat> &point(position->calculate()[0]);
+    memcpy(backPoint.data(), point.data(), point.size() * sizeof (GLfloat));
+
+    // It[ŐṼt[Ɠւ
+    std::lock_guard<std::mutex> lock(readyMutex);
+    readyDepth.swap(backDepth);
+    readyPoint.swap(backPoint);
+    readyMask.swap(backMask);
+    ++produced;
+  }
+}
+
+// ŐṼt[Γւĕω^CeNX`ɓ]
+void CaptureCamera::update() const
+{
+  {
+    // Vt[ȂΉȂ
+    std::lock_guard<std::mutex> lock(readyMutex);
+    if (consumed == produced) return;
+    consumed = produced;
+
+    // ŐṼt[󂯎
+    frontDepth.swap(readyDepth);
+    frontPoint.swap(readyPoint);
+    frontMask.swap(readyMask);
+  }
+
+  // fvXf[^ω^C𒲂ׂ
+  if (detectChange(frontDepth.data()) > 0)
+  {
+    // ω^C̃fvXf[^ƃJWeNX`ɓ]
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    uploadDirtyTiles(frontDepth.data(), GL_RED, GL_UNSIGNED_SHORT, sizeof (GLushort));
+    glBindTexture(GL_TEXTURE_2D, pointTexture);
+    uploadDirtyTiles(frontPoint.data(), GL_RGB, GL_FLOAT, 3 * sizeof (GLfloat));
+  }
+
+  // Mx߂
+  updateConfidence();
+
+  // Vt[擾
+  ++frame;
+}
+
+// fvXf[^擾
+GLuint CaptureCamera::getDepth() const
+{
+  update();
+  glBindTexture(GL_TEXTURE_2D, depthTexture);
+  return depthTexture;
+}
+
+// JW擾
+GLuint CaptureCamera::getPoint() const
+{
+  update();
+  glBindTexture(GL_TEXTURE_2D, pointTexture);
+  return pointTexture;
+}
+
+// J[f[^擾
+GLuint CaptureCamera::getColor() const
+{
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  return colorTexture;
+}
+
+// J[̃eNX`̐Fݒ肷
+void CaptureCamera::setColor(GLfloat r, GLfloat g, GLfloat b)
+{
+  const GLubyte color[] =
+  {
+    static_cast<GLubyte>(b * 255.0f + 0.5f),
+    static_cast<GLubyte>(g * 255.0f + 0.5f),
+    static_cast<GLubyte>(r * 255.0f + 0.5f),
+    255
+  };
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_BGRA, GL_UNSIGNED_BYTE, color);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+//
+// p̃XbhŃfvXf[^擾[xZT̊NX
+//
+//   擾XbhŃfvXf[^擾ĕ, JW (CpuPosition, position.frag ƓvZ) ܂ŋ߂
+//   擾Xbȟʂ͎O̃obt@ւĎ󂯓n, getDepth()  getPoint() Ă񂾃Xbhł
+//   ŐṼt[ɓւĕω^CeNX`ɓ]邾ɂ
+//   ZTƂɎ擾Xbh, ̒̌vZ̓Xbhv[ŕɍŝ, 䐔𑝂₵Ă`~߂Ȃ
+//   J[f[^͎, J[̃eNX`͈lȐFɂ
+//
+
+// [xZT֘ÅNX
+#include "DepthCamera.h"
+
+// CPU ɂ摜
+#include "CpuCalculate.h"
+
+// WCu
+#include <thread>
+#include <atomic>
+
+class CaptureCamera : public DepthCamera
+{
+  // 擾XbhރfvXf[^ƃJWƃ}XN
+  std::vector<GLushort> backDepth;
+  std::vector<GLfloat> backPoint;
+  std::vector<GLubyte> backMask;
+
+  // 擾XbhIŐṼfvXf[^ƃJWƃ}XN
+  mutable std::vector<GLushort> readyDepth;
+  mutable std::vector<GLfloat> readyPoint;
+  mutable std::vector<GLubyte> readyMask;
+
+  // eNX`ɓ]fvXf[^ƃJWƃ}XN
+  mutable std::vector<GLushort> frontDepth;
+  mutable std::vector<GLfloat> frontPoint;
+  mutable std::vector<GLubyte> frontMask;
+
+  // ready ̎󂯓n̔r
+  mutable std::mutex readyMutex;
+
+  // 擾XbhIt[Ɠ]t[
+  unsigned int produced;
+  mutable unsigned int consumed;
+
+  // fvXf[^JW߂
+  CpuPosition *position;
+
+  // 擾Xbh
+  std::thread thread;
+
+  // 擾Xbh𑱂邩ǂ
+  std::atomic<bool> running;
+
+  // 擾Xbh̏
+  void run();
+
+  // ŐṼt[Γւĕω^CeNX`ɓ]
+  void update() const;
+
+  // Rs[RXgN^ (Rs[֎~)
+  CaptureCamera(const CaptureCamera &o);
+
+  //  (֎~)
+  CaptureCamera &operator=(const CaptureCamera &o);
+
+protected:
+
+  // ̃t[̃fvXf[^ (mm, vłȂf 0)  depth Ɋi[ (擾XbhĂяo)
+  //   t[͂܂ő҂Ă悢, ҂̂ 1 t[̊Ԋuxɂ
+  //   ߂l: i[łȂ false
+  virtual bool capture(GLushort *depth) = 0;
+
+  // eNX`ƃobt@쐬Ď擾XbhJn (hNX̃RXgN^̍ŌɌĂяo)
+  //   width, height: fvXf[^̃TCY
+  //   pointFormat: JWi[eNX`̓tH[}bg
+  void start(int width, int height, GLenum pointFormat);
+
+  // 擾XbhI (hNX̃fXgN^̍ŏɌĂяo)
+  void stop();
+
+public:
+
+  // RXgN^
+  CaptureCamera();
+
+  // fXgN^
+  virtual ~CaptureCamera();
+
+  // fvXf[^擾
+  virtual GLuint getDepth() const;
+
+  // JW擾
+  virtual GLuint getPoint() const;
+
+  // Ō getDepth()  getPoint() œ]JW𓾂 (vłȂ_ z  depthMaximum)
+  virtual const GLfloat (*getPointBuffer() const)[3]
+  {
+    return reinterpret_cast<const GLfloat (*)[3]>(frontPoint.data());
+  }
+
+  // J[f[^擾 (lȐF)
+  virtual GLuint getColor() const;
+
+  // Õt[Ō𖄂߂f}XN𓾂 (߂f 1, ߂ĂȂ NULL)
+  virtual const GLubyte *getFillMask() const
+  {
+    return holeFill ? frontMask.data() : NULL;
+  }
+
+  // J[̃eNX`̐Fݒ肷
+  void setColor(GLfloat r, GLfloat g, GLfloat b);
+};
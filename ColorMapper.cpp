@@ -0,0 +1,525 @@
+#include "ColorMapper.h"
+
+//
+// fvX̉f̃J[̃eNX`Wւ̕ϊ
+//
+
+// L^fvXf[^̓ǂݍ
+#include "DepthReader.h"
+
+// WCu
+#include <cmath>
+#include <limits>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <emmintrin.h>
+
+// fvXl̒Pʂ[gɊZW
+const GLfloat depthScale(0.001f);
+
+// c݂菜̉
+const int undistortIterations(20);
+
+// Lu[V߂锽̉
+const int fitIterations(100);
+
+namespace
+{
+  // ϊłȂf̃eNX`W
+  const GLfloat invalid(-std::numeric_limits<GLfloat>::infinity());
+
+  // Lu[V߂ƂɎg_
+  struct Sample
+  {
+    // fvXJ̍W (m)
+    double x, y, z;
+
+    // ̃eNX`W (f)
+    double u, v;
+  };
+
+  // ]xNg]s߂
+  void rodrigues(const double *r, double *m)
+  {
+    const double t(sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]));
+    const double c(cos(t)), s(t > 1.0e-12 ? sin(t) / t : 1.0), k(t > 1.0e-12 ? (1.0 - c) / (t * t) : 0.5);
+    m[0] = c + k * r[0] * r[0];
+    m[1] = k * r[0] * r[1] - s * r[2];
+    m[2] = k * r[0] * r[2] + s * r[1];
+    m[3] = k * r[1] * r[0] + s * r[2];
+    m[4] = c + k * r[1] * r[1];
+    m[5] = k * r[1] * r[2] - s * r[0];
+    m[6] = k * r[2] * r[0] - s * r[1];
+    m[7] = k * r[2] * r[1] + s * r[0];
+    m[8] = c + k * r[2] * r[2];
+  }
+
+  // ]s񂩂]xNg߂
+  void rodrigues(const GLfloat *m, double *r)
+  {
+    const double c((m[0] + m[4] + m[8] - 1.0) * 0.5);
+    const double t(acos(c < -1.0 ? -1.0 : c > 1.0 ? 1.0 : c));
+    const double k(t > 1.0e-6 ? t / (2.0 * sin(t)) : 0.5);
+    r[0] = (m[7] - m[5]) * k;
+    r[1] = (m[2] - m[6]) * k;
+    r[2] = (m[3] - m[1]) * k;
+  }
+
+  // p[^ q (fx, fy, cx, cy, k1, k2, ]xNg, sړ) œ_J[̉fɓe
+  void project(const double *q, const double *m, const Sample &p, double *u, double *v)
+  {
+    const double x(m[0] * p.x + m[1] * p.y + m[2] * p.z + q[9]);
+    const double y(m[3] * p.x + m[4] * p.y + m[5] * p.z + q[10]);
+    const double z(m[6] * p.x + m[7] * p.y + m[8] * p.z + q[11]);
+    const double xn(x / z), yn(y / z), r2(xn * xn + yn * yn);
+    const double f(1.0 + r2 * (q[4] + r2 * q[5]));
+    *u = q[0] * xn * f + q[2];
+    *v = q[1] * yn * f + q[3];
+  }
+
+  // p[^ q ł̌덷߂ (e  NULL łȂΊe_̌덷i[)
+  double residual(const double *q, const std::vector<Sample> &samples, double *e)
+  {
+    double m[9];
+    rodrigues(q + 6, m);
+
+    double cost(0.0);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+      double u, v;
+      project(q, m, samples[i], &u, &v);
+      const double du(u - samples[i].u), dv(v - samples[i].v);
+      if (e)
+      {
+        e[i * 2 + 0] = du;
+        e[i * 2 + 1] = dv;
+      }
+      cost += du * du + dv * dv;
+    }
+
+    return cost;
+  }
+
+  // n Aꎟ a x = b  (a  b ͉)
+  bool solve(double *a, double *b, int n)
+  {
+    for (int k = 0; k < n; ++k)
+    {
+      // s{bgI
+      int p(k);
+      for (int i = k + 1; i < n; ++i) if (fabs(a[i * n + k]) > fabs(a[p * n + k])) p = i;
+      if (fabs(a[p * n + k]) < 1.0e-300) return false;
+      if (p != k)
+      {
+        for (int j = 0; j < n; ++j) std::swap(a[k * n + j], a[p * n + j]);
+        std::swap(b[k], b[p]);
+      }
+
+      // Oi
+      for (int i = k + 1; i < n; ++i)
+      {
+        const double f(a[i * n + k] / a[k * n + k]);
+        for (int j = k; j < n; ++j) a[i * n + j] -= f * a[k * n + j];
+        b[i] -= f * b[k];
+      }
+    }
+
+    // ޑ
+    for (int k = n - 1; k >= 0; --k)
+    {
+      for (int j = k + 1; j < n; ++j) b[k] -= a[k * n + j] * b[j];
+      b[k] /= a[k * n + k];
+    }
+
+    return true;
+  }
+}
+
+// RXgN^
+ColorMapper::ColorMapper(int depthWidth, int depthHeight, int colorWidth, int colorHeight)
+  : CpuCalculate(depthWidth, depthHeight, 1, 0)
+  , colorWidth(colorWidth)
+  , colorHeight(colorHeight)
+  , rayX(depthWidth * depthHeight)
+  , rayY(depthWidth * depthHeight)
+  , texcoord(NULL)
+{
+  for (int i = 0; i < 3; ++i) colorRay[i].resize(depthWidth * depthHeight);
+
+  // ĉ݂ȂfvXJ (p 70 xx) ƃJ[J𓯂ʒuɒûlɂ
+  const Intrinsics depth = { GLfloat(depthWidth) * 0.71f, GLfloat(depthWidth) * 0.71f,
+    GLfloat(depthWidth) * 0.5f, GLfloat(depthHeight) * 0.5f, 0.0f, 0.0f, 0.0f };
+  const Intrinsics color = { GLfloat(colorWidth) * 0.55f, GLfloat(colorWidth) * 0.55f,
+    GLfloat(colorWidth) * 0.5f, GLfloat(colorHeight) * 0.5f, 0.0f, 0.0f, 0.0f };
+  static const GLfloat identity[] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+  static const GLfloat zero[] = { 0.0f, 0.0f, 0.0f };
+  colorIntrinsics = color;
+  setExtrinsics(identity, zero);
+  setDepthIntrinsics(depth);
+}
+
+// fvXJ̓p[^ݒ肷
+void ColorMapper::setDepthIntrinsics(const Intrinsics &intrinsics)
+{
+  depthIntrinsics = intrinsics;
+  updateRay();
+}
+
+// J[J̓p[^ݒ肷
+void ColorMapper::setColorIntrinsics(const Intrinsics &intrinsics)
+{
+  colorIntrinsics = intrinsics;
+}
+
+// fvXJJ[Jւ̊Op[^ݒ肷
+void ColorMapper::setExtrinsics(const GLfloat *rotation, const GLfloat *translation)
+{
+  for (int i = 0; i < 9; ++i) this->rotation[i] = rotation[i];
+  for (int i = 0; i < 3; ++i) this->translation[i] = translation[i];
+  rotateRay();
+}
+
+// fvXJ̓p[^ςƂɎ̕ߒ
+void ColorMapper::updateRay()
+{
+  const Intrinsics &d(depthIntrinsics);
+
+  for (int v = 0; v < height; ++v)
+  {
+    for (int u = 0; u < width; ++u)
+    {
+      // c񂾉摜̈ʒu
+      const GLfloat xd((GLfloat(u) - d.cx) / d.fx), yd((GLfloat(v) - d.cy) / d.fy);
+
+      // c݂菜
+      GLfloat x(xd), y(yd);
+      for (int k = 0; k < undistortIterations; ++k)
+      {
+        const GLfloat r2(x * x + y * y);
+        const GLfloat f(1.0f + r2 * (d.k1 + r2 * (d.k2 + r2 * d.k3)));
+        x = xd / f;
+        y = yd / f;
+      }
+
+      rayX[v * width + u] = x;
+      rayY[v * width + u] = y;
+    }
+  }
+
+  rotateRay();
+}
+
+// Op[^ςƂɎ̕]
+void ColorMapper::rotateRay()
+{
+  const GLfloat *const r(rotation);
+
+  for (int i = 0; i < width * height; ++i)
+  {
+    const GLfloat x(rayX[i]), y(rayY[i]);
+    colorRay[0][i] = r[0] * x + r[1] * y + r[2];
+    colorRay[1][i] = r[3] * x + r[4] * y + r[5];
+    colorRay[2][i] = r[6] * x + r[7] * y + r[8];
+  }
+}
+
+// Lu[Vt@Cǂݍ
+bool ColorMapper::load(const char *file)
+{
+  std::ifstream in(file);
+  if (!in) return false;
+
+  Intrinsics depth, color;
+  GLfloat r[9], t[3];
+  std::string key;
+  int found(0);
+
+  while (in >> key)
+  {
+    if (key == "depth" && in >> depth.fx >> depth.fy >> depth.cx >> depth.cy >> depth.k1 >> depth.k2 >> depth.k3)
+      found |= 1;
+    else if (key == "color" && in >> color.fx >> color.fy >> color.cx >> color.cy >> color.k1 >> color.k2 >> color.k3)
+      found |= 2;
+    else if (key == "rotation" && in >> r[0] >> r[1] >> r[2] >> r[3] >> r[4] >> r[5] >> r[6] >> r[7] >> r[8])
+      found |= 4;
+    else if (key == "translation" && in >> t[0] >> t[1] >> t[2])
+      found |= 8;
+    else
+      return false;
+  }
+
+  // ׂĂ̍ڂĂȂΎgȂ
+  if (found != 15) return false;
+
+  colorIntrinsics = color;
+  for (int i = 0; i < 9; ++i) rotation[i] = r[i];
+  for (int i = 0; i < 3; ++i) translation[i] = t[i];
+  setDepthIntrinsics(depth);
+
+  return true;
+}
+
+// Lu[Vt@Cɕۑ
+bool ColorMapper::save(const char *file) const
+{
+  std::ofstream out(file);
+  if (!out) return false;
+
+  const Intrinsics &d(depthIntrinsics), &c(colorIntrinsics);
+  const GLfloat *const r(rotation), *const t(translation);
+  out.precision(9);
+  out << "depth " << d.fx << ' ' << d.fy << ' ' << d.cx << ' ' << d.cy << ' ' << d.k1 << ' ' << d.k2 << ' ' << d.k3 << '\n';
+  out << "color " << c.fx << ' ' << c.fy << ' ' << c.cx << ' ' << c.cy << ' ' << c.k1 << ' ' << c.k2 << ' ' << c.k3 << '\n';
+  out << "rotation " << r[0] << ' ' << r[1] << ' ' << r[2] << ' ' << r[3] << ' ' << r[4] << ' ' << r[5]
+    << ' ' << r[6] << ' ' << r[7] << ' ' << r[8] << '\n';
+  out << "translation " << t[0] << ' ' << t[1] << ' ' << t[2] << '\n';
+
+  return bool(out);
+}
+
+// s v ̉f [u0, u1) ϊ
+void ColorMapper::mapRow(const GLushort *depth, GLfloat (*texcoord)[2], int v, int u0, int u1) const
+{
+  const Intrinsics &c(colorIntrinsics);
+  const int row(v * width);
+  const GLfloat *const rx(colorRay[0].data() + row);
+  const GLfloat *const ry(colorRay[1].data() + row);
+  const GLfloat *const rz(colorRay[2].data() + row);
+  const GLushort *const d(depth + row);
+  GLfloat *const o(texcoord[row]);
+
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 scale(_mm_set1_ps(depthScale));
+  const __m128 tx(_mm_set1_ps(translation[0])), ty(_mm_set1_ps(translation[1])), tz(_mm_set1_ps(translation[2]));
+  const __m128 fx(_mm_set1_ps(c.fx)), fy(_mm_set1_ps(c.fy)), cx(_mm_set1_ps(c.cx)), cy(_mm_set1_ps(c.cy));
+  const __m128 k1(_mm_set1_ps(c.k1)), k2(_mm_set1_ps(c.k2)), k3(_mm_set1_ps(c.k3));
+  const __m128 bad(_mm_set1_ps(invalid));
+
+  // 4 fϊ
+  int u(u0);
+  for (; u + 4 <= u1; u += 4)
+  {
+    // fvXl (m)
+    const __m128 z(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(d + u)), _mm_setzero_si128())), scale));
+
+    // J[J̍W
+    const __m128 x(_mm_add_ps(_mm_mul_ps(z, _mm_loadu_ps(rx + u)), tx));
+    const __m128 y(_mm_add_ps(_mm_mul_ps(z, _mm_loadu_ps(ry + u)), ty));
+    const __m128 w(_mm_add_ps(_mm_mul_ps(z, _mm_loadu_ps(rz + u)), tz));
+
+    // J[J̑Oɂvł_ϊ
+    const __m128 valid(_mm_and_ps(_mm_cmpgt_ps(z, zero), _mm_cmpgt_ps(w, zero)));
+
+    // 摜̈ʒuɘc݂
+    const __m128 iw(_mm_div_ps(one, _mm_or_ps(_mm_and_ps(valid, w), _mm_andnot_ps(valid, one))));
+    const __m128 xn(_mm_mul_ps(x, iw)), yn(_mm_mul_ps(y, iw));
+    const __m128 r2(_mm_add_ps(_mm_mul_ps(xn, xn), _mm_mul_ps(yn, yn)));
+    const __m128 f(_mm_add_ps(one, _mm_mul_ps(r2, _mm_add_ps(k1, _mm_mul_ps(r2, _mm_add_ps(k2, _mm_mul_ps(r2, k3)))))));
+
+    // J[̉f
+    const __m128 px(_mm_or_ps(_mm_and_ps(valid, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(fx, xn), f), cx)), _mm_andnot_ps(valid, bad)));
+    const __m128 py(_mm_or_ps(_mm_and_ps(valid, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(fy, yn), f), cy)), _mm_andnot_ps(valid, bad)));
+
+    // (x, y) ̑gɂĊi[
+    _mm_storeu_ps(o + u * 2, _mm_unpacklo_ps(px, py));
+    _mm_storeu_ps(o + u * 2 + 4, _mm_unpackhi_ps(px, py));
+  }
+
+  // c̉f
+  for (; u < u1; ++u)
+  {
+    const GLfloat z(GLfloat(d[u]) * depthScale);
+    const GLfloat x(z * rx[u] + translation[0]), y(z * ry[u] + translation[1]), w(z * rz[u] + translation[2]);
+    if (z > 0.0f && w > 0.0f)
+    {
+      const GLfloat xn(x / w), yn(y / w), r2(xn * xn + yn * yn);
+      const GLfloat f(1.0f + r2 * (c.k1 + r2 * (c.k2 + r2 * c.k3)));
+      o[u * 2 + 0] = c.fx * xn * f + c.cx;
+      o[u * 2 + 1] = c.fy * yn * f + c.cy;
+    }
+    else
+    {
+      o[u * 2 + 0] = o[u * 2 + 1] = invalid;
+    }
+  }
+}
+
+// s [begin, end) ̌vZs
+void ColorMapper::kernel(int begin, int end)
+{
+  const GLushort *const depth(static_cast<const GLushort *>(input[0]));
+  for (int v = begin; v < end; ++v) mapRow(depth, texcoord, v, 0, width);
+}
+
+// fvXf[^ׂ̂Ẳf̃eNX`W߂
+void ColorMapper::map(const GLushort *depth, GLfloat (*texcoord)[2])
+{
+  setInput(0, depth);
+  this->texcoord = texcoord;
+  calculate();
+}
+
+// fvXf[^̋` [x0, x1) x [y0, y1) ̉f̃eNX`W߂
+void ColorMapper::map(const GLushort *depth, GLfloat (*texcoord)[2], int x0, int y0, int x1, int y1) const
+{
+  for (int v = y0; v < y1; ++v) mapRow(depth, texcoord, v, x0, x1);
+}
+
+// ߂eNX`WƊ̃eNX`W̍߂
+ColorMapper::Error ColorMapper::difference(const GLfloat (*t)[2], const GLfloat (*reference)[2]) const
+{
+  double sum(0.0);
+  Error error = { 0.0f, 0.0f, 0, 0 };
+  for (int i = 0; i < width * height; ++i)
+  {
+    // ŕϊłfׂ
+    const bool mapped(t[i][0] > invalid), expected(reference[i][0] > invalid && reference[i][1] > invalid);
+    if (mapped != expected) ++error.mismatch;
+    if (!(mapped && expected)) continue;
+    const GLfloat du(t[i][0] - reference[i][0]), dv(t[i][1] - reference[i][1]);
+    const GLfloat e(sqrt(du * du + dv * dv));
+    sum += e;
+    if (e > error.max) error.max = e;
+    ++error.count;
+  }
+
+  if (error.count > 0) error.mean = GLfloat(sum / error.count);
+  return error;
+}
+
+// ߂eNX`WƊ̃eNX`Wrč̕ς߂
+GLfloat ColorMapper::compare(const GLushort *depth, const GLfloat (*reference)[2], GLfloat *maxError, int *count) const
+{
+  std::vector<GLfloat> mapped(width * height * 2);
+  GLfloat (*const t)[2](reinterpret_cast<GLfloat (*)[2]>(mapped.data()));
+  map(depth, t, 0, 0, width, height);
+
+  const Error error(difference(t, reference));
+  if (maxError) *maxError = error.max;
+  if (count) *count = error.count;
+  return error.mean;
+}
+
+// L^fvXf[^̃t[ɕϊ, ꏏɋL^ SDK ̃eNX`WƔr
+std::vector<ColorMapper::Error> ColorMapper::verify(DepthReader &reader)
+{
+  std::vector<Error> result;
+  if (!reader.hasTexcoord() || reader.getDepthWidth() != width || reader.getDepthHeight() != height) return result;
+
+  // fvXf[^ SDK ̃eNX`W, coordBuffer Ɠт̕ϊ
+  std::vector<GLushort> depth(width * height);
+  std::vector<GLfloat> reference(width * height * 2), mapped(width * height * 2);
+  GLfloat (*const r)[2](reinterpret_cast<GLfloat (*)[2]>(reference.data()));
+  GLfloat (*const t)[2](reinterpret_cast<GLfloat (*)[2]>(mapped.data()));
+
+  // `̂ƂƓɕϊ@ŕϊĔׂ
+  while (reader.read(depth.data(), r))
+  {
+    map(depth.data(), t);
+    result.push_back(difference(t, r));
+  }
+
+  return result;
+}
+
+GLfloat ColorMapper::fit(const GLushort *depth, const GLfloat (*reference)[2], int step)
+{
+  // c step fɌvłĂĊ̃eNX`WJ[̉摜̒ɂfg
+  std::vector<Sample> samples;
+  for (int v = 0; v < height; v += step)
+  {
+    for (int u = 0; u < width; u += step)
+    {
+      const int i(v * width + u);
+      const GLfloat (&r)[2](reference[i]);
+      if (depth[i] == 0 || !(r[0] >= 0.0f && r[0] < GLfloat(colorWidth) && r[1] >= 0.0f && r[1] < GLfloat(colorHeight))) continue;
+      const double z(double(depth[i]) * depthScale);
+      const Sample s = { rayX[i] * z, rayY[i] * z, z, r[0], r[1] };
+      samples.push_back(s);
+    }
+  }
+  if (samples.size() < 12) return -1.0f;
+
+  // ݂̃p[^lɂ
+  const Intrinsics &c(colorIntrinsics);
+  double q[12] = { c.fx, c.fy, c.cx, c.cy, c.k1, c.k2, 0.0, 0.0, 0.0, translation[0], translation[1], translation[2] };
+  rodrigues(rotation, q + 6);
+
+  // l̍
+  static const double delta[12] = { 1.0e-2, 1.0e-2, 1.0e-2, 1.0e-2, 1.0e-6, 1.0e-6, 1.0e-7, 1.0e-7, 1.0e-7, 1.0e-6, 1.0e-6, 1.0e-6 };
+
+  // Levenberg-Marquardt @Ō덷̓aŏɂ
+  const size_t n(samples.size() * 2);
+  std::vector<double> e(n), j(n * 12);
+  double cost(residual(q, samples, e.data())), lambda(1.0e-3);
+  for (int iteration = 0; iteration < fitIterations; ++iteration)
+  {
+    // Rrs𐔒lŋ߂
+    std::vector<double> ek(n);
+    for (int k = 0; k < 12; ++k)
+    {
+      double qk[12];
+      for (int l = 0; l < 12; ++l) qk[l] = q[l];
+      qk[k] += delta[k];
+      residual(qk, samples, ek.data());
+      for (size_t i = 0; i < n; ++i) j[i * 12 + k] = (ek[i] - e[i]) / delta[k];
+    }
+
+    // ǨW
+    double a[144] = { 0.0 }, g[12] = { 0.0 };
+    for (size_t i = 0; i < n; ++i)
+    {
+      const double *const ji(j.data() + i * 12);
+      for (int k = 0; k < 12; ++k)
+      {
+        g[k] -= ji[k] * e[i];
+        for (int l = k; l < 12; ++l) a[k * 12 + l] += ji[k] * ji[l];
+      }
+    }
+    for (int k = 0; k < 12; ++k) for (int l = 0; l < k; ++l) a[k * 12 + l] = a[l * 12 + k];
+
+    // 덷܂ŌW傫
+    bool improved(false);
+    while (lambda < 1.0e10)
+    {
+      double b[144], x[12], qn[12];
+      for (int k = 0; k < 144; ++k) b[k] = a[k];
+      for (int k = 0; k < 12; ++k)
+      {
+        b[k * 12 + k] *= 1.0 + lambda;
+        x[k] = g[k];
+      }
+      if (solve(b, x, 12))
+      {
+        for (int k = 0; k < 12; ++k) qn[k] = q[k] + x[k];
+        const double cn(residual(qn, samples, ek.data()));
+        if (cn < cost)
+        {
+          improved = cost - cn > cost * 1.0e-12;
+          for (int k = 0; k < 12; ++k) q[k] = qn[k];
+          e.swap(ek);
+          cost = cn;
+          lambda *= 0.1;
+          break;
+        }
+      }
+      lambda *= 10.0;
+    }
+    if (!improved) break;
+  }
+
+  // ߂p[^ݒ肷
+  double m[9];
+  rodrigues(q + 6, m);
+  GLfloat r[9], t[3];
+  for (int k = 0; k < 9; ++k) r[k] = GLfloat(m[k]);
+  for (int k = 0; k < 3; ++k) t[k] = GLfloat(q[9 + k]);
+  const Intrinsics color = { GLfloat(q[0]), GLfloat(q[1]), GLfloat(q[2]), GLfloat(q[3]), GLfloat(q[4]), GLfloat(q[5]), 0.0f };
+  colorIntrinsics = color;
+  setExtrinsics(r, t);
+
+  return GLfloat(sqrt(cost / double(samples.size())));
+}
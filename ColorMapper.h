@@ -0,0 +1,130 @@
+#pragma once
+
+//
+// fvX̉f̃J[̃eNX`Wւ̕ϊ
+//
+//   SDK ̍Wϊ (MapDepthFrameToColorSpace) ̑, ۑLu[Vg
+//   fvX̉fJ[̉fɓe
+//   fvXJ̓p[^ŉfĉ݂Ȃɒ, fvXl|ăfvXJ̍Wɂ
+//   Op[^ (]ƕsړ) ŃJ[J̍WɈڂ, J[J̓p[^ŉfɓe
+//   Wn͂ǂ̃J x 摜̉E, y 摜̉, z O, ̒Pʂ̓[g
+//   OpenGL gȂ̂ŋL^f[^g GPU  SDK ̂Ȃłg
+//
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+// L^fvXf[^̓ǂݍ
+class DepthReader;
+
+class ColorMapper : public CpuCalculate
+{
+public:
+
+  // J̓p[^ (œ_Ɖ摜S͉f, a̘č݂W)
+  struct Intrinsics
+  {
+    GLfloat fx, fy, cx, cy, k1, k2, k3;
+  };
+
+  // ̃eNX`WƂ̍
+  struct Error
+  {
+    // ̕ςƍől (f)
+    GLfloat mean, max;
+
+    // rf, ŕϊłf
+    int count, mismatch;
+  };
+
+private:
+
+  // J[J̃TCY
+  const int colorWidth, colorHeight;
+
+  // fvXJƃJ[J̓p[^
+  Intrinsics depthIntrinsics, colorIntrinsics;
+
+  // fvXJ̍WJ[J̍Wւ̉] (sD 3x3 s) ƕsړ (m)
+  GLfloat rotation[9], translation[3];
+
+  // fvX̉fƂ̘ĉ݂Ȃ̕ (z = 1)
+  std::vector<GLfloat> rayX, rayY;
+
+  // J[J̍Wnɉ]
+  std::vector<GLfloat> colorRay[3];
+
+  // ϊeNX`W̊i[
+  GLfloat (*texcoord)[2];
+
+  // p[^Op[^ςƂɎ̕ߒ
+  void updateRay();
+  void rotateRay();
+
+  // s v ̉f [u0, u1) ϊ
+  void mapRow(const GLushort *depth, GLfloat (*texcoord)[2], int v, int u0, int u1) const;
+
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+  // ߂eNX`WƊ̃eNX`W̍߂
+  Error difference(const GLfloat (*texcoord)[2], const GLfloat (*reference)[2]) const;
+
+public:
+
+  // RXgN^
+  ColorMapper(int depthWidth, int depthHeight, int colorWidth, int colorHeight);
+
+  // fvXJ̓p[^ݒ肷
+  void setDepthIntrinsics(const Intrinsics &intrinsics);
+
+  // J[J̓p[^ݒ肷
+  void setColorIntrinsics(const Intrinsics &intrinsics);
+
+  // fvXJJ[Jւ̊Op[^ݒ肷
+  //   rotation: ] (sD 3x3 s)
+  //   translation: sړ (m)
+  void setExtrinsics(const GLfloat *rotation, const GLfloat *translation);
+
+  // fvXJ̓p[^𓾂
+  const Intrinsics &getDepthIntrinsics() const
+  {
+    return depthIntrinsics;
+  }
+
+  // J[J̓p[^𓾂
+  const Intrinsics &getColorIntrinsics() const
+  {
+    return colorIntrinsics;
+  }
+
+  // Lu[Vt@Cǂݍ
+  bool load(const char *file);
+
+  // Lu[Vt@Cɕۑ
+  bool save(const char *file) const;
+
+  // fvXf[^ׂ̂Ẳf̃eNX`W߂
+  //   texcoord: eNX`W (f) ̊i[ (coordBuffer Ɠ, ϊłȂf -)
+  void map(const GLushort *depth, GLfloat (*texcoord)[2]);
+
+  // fvXf[^̋` [x0, x1) x [y0, y1) ̉f̃eNX`W߂ (ʂ̃Xbh瓯ɌĂяo)
+  void map(const GLushort *depth, GLfloat (*texcoord)[2], int x0, int y0, int x1, int y1) const;
+
+  // ߂eNX`WƊ̃eNX`W (SDK ̏o͂Ȃ) rč̕ (f) ߂
+  //   maxError: ̍ől̊i[ (NULL Ȃi[Ȃ)
+  //   count: rf̊i[ (NULL Ȃi[Ȃ)
+  GLfloat compare(const GLushort *depth, const GLfloat (*reference)[2],
+    GLfloat *maxError = NULL, int *count = NULL) const;
+
+  // L^fvXf[^̃t[I܂ŏ map() ŕϊ, ꏏɋL^ SDK ̃eNX`WƔr
+  //   OpenGL ZT SDK gȂ̂, L^t@C GPU ZT̂Ȃł؂ł
+  //   reader: SDK ̃eNX`WL^t@CJ (fvXf[^̃TCY͂Ɠɂ)
+  //   ߂l: t[Ƃ̍ (SDK ̃eNX`WL^ĂȂ΋)
+  std::vector<Error> verify(DepthReader &reader);
+
+  // fvXJ̓p[^Œ肵, ̃eNX`Wɍ悤ɃJ[J̓p[^
+  // (k3 ) ƊOp[^, 덷̓敽ϕ (f) Ԃ
+  //   step: c step f̉fg
+  GLfloat fit(const GLushort *depth, const GLfloat (*reference)[2], int step = 4);
+};
@@ -0,0 +1,53 @@
+#include "Compute.h"
+
+//
+// 摜 (Rs[gVF[_)
+//
+
+// RXgN^
+Compute::Compute(int width, int height, const char *source, int targets, GLenum internal)
+  : width(width)
+  , height(height)
+  , internal(internal)
+  , program(ggLoadComputeShader(source))
+{
+  for (int i = 0; i < targets; ++i)
+  {
+    // vZʂۑeNX`쐬
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internal, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    texture.push_back(tex);
+  }
+}
+
+// fXgN^
+Compute::~Compute()
+{
+  // VF[_vO폜
+  glDeleteProgram(program);
+
+  // vZʂۑeNX`폜
+  glDeleteTextures(GLsizei(texture.size()), texture.data());
+}
+
+// vZs
+const std::vector<GLuint> &Compute::calculate() const
+{
+  // vZʂۑeNX` binding = i ̃C[WɌ
+  for (size_t i = 0; i < texture.size(); ++i)
+    glBindImageTexture(GLuint(i), texture[i], 0, GL_FALSE, 0, GL_WRITE_ONLY, internal);
+
+  // eNX`Ŝ𕢂[NO[vN
+  glDispatchCompute((width + localSize - 1) / localSize, (height + localSize - 1) / localSize, 1);
+
+  // vZʂeNX`ƂĎQƂOɏ݂̊҂
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+  return texture;
+}
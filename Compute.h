@@ -0,0 +1,67 @@
+#pragma once
+
+//
+// 摜 (Rs[gVF[_)
+//
+//   OpenGL 4.3 ȍ~Kv
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+class Compute
+{
+  // vZʂۑeNX`
+  std::vector<GLuint> texture;
+
+  // vZʂۑeNX`̃TCY
+  const GLsizei width, height;
+
+  // vZʂۑeNX`̓tH[}bg
+  const GLenum internal;
+
+  // vZp̃VF[_vO
+  const GLuint program;
+
+  // [NO[v̈ӂ̃Xbh (VF[_ local_size ƍ킹)
+  static const GLsizei localSize = 16;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Compute(const Compute &o);
+
+  //  (֎~)
+  Compute &operator=(const Compute &o);
+
+public:
+
+  // RXgN^
+  //   internal: vZʂۑeNX`̓tH[}bg (C[WƂĎg)
+  Compute(int width, int height, const char *source, int targets = 1, GLenum internal = GL_RGBA32F);
+
+  // fXgN^
+  virtual ~Compute();
+
+  // VF[_vO𓾂
+  GLuint get() const
+  {
+    return program;
+  }
+
+  // vZʂoeNX`𓾂
+  const std::vector<GLuint> &getTexture() const
+  {
+    return texture;
+  }
+
+  // vZp̃VF[_vO̎gpJn
+  void use() const
+  {
+    glUseProgram(program);
+  }
+
+  // vZs
+  const std::vector<GLuint> &calculate() const;
+};
@@ -0,0 +1,313 @@
+#include "Confidence.h"
+
+//
+// fvXf[^̉fƂ̐Mx
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <emmintrin.h>
+
+// xɏs
+const int rowGrain(8);
+
+// ΂̏d݂̕\̕\ (c̕Uƌv̕U̔ 1 ̗vf) Ɨvf
+const int spreadResolution(32);
+const int spreadEntries(spreadResolution * 16);
+
+namespace
+{
+  // c̕Uƌv̕U̔䂲Ƃ̂΂̏d exp(-x / 2) ̕\
+  struct SpreadTable
+  {
+    GLfloat weight[spreadEntries + 1];
+
+    SpreadTable()
+    {
+      for (int k = 0; k < spreadEntries; ++k)
+        weight[k] = GLfloat(exp(-0.5 * (double(k) + 0.5) / double(spreadResolution)));
+      weight[spreadEntries] = 0.0f;
+    }
+  };
+  const SpreadTable spreadTable;
+
+  // Ȃ 16bit ̒l 4 ǂݍŎɂ
+  inline __m128 load4(const GLushort *p)
+  {
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128()));
+  }
+
+  // 8bit ̒l 4 ǂݍŐɂ
+  inline __m128i load4(const GLubyte *p)
+  {
+    const __m128i zero(_mm_setzero_si128());
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*reinterpret_cast<const int *>(p)), zero), zero);
+  }
+
+  // 32bit ̐ 4  8bit ɋl߂ď
+  inline void store4(GLubyte *p, __m128i a)
+  {
+    const __m128i zero(_mm_setzero_si128());
+    *reinterpret_cast<int *>(p) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(a, zero), zero));
+  }
+
+  // vłׂ̉f n Ƃ̃fvXl d ̍ limit 𒴂邩ǂ
+  inline __m128 jumped(__m128 d, __m128 n, __m128 limit)
+  {
+    const __m128 sign(_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+    return _mm_and_ps(_mm_cmpneq_ps(n, _mm_setzero_ps()), _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(d, n), sign), limit));
+  }
+}
+
+// RXgN^
+CpuConfidence::CpuConfidence(int width, int height)
+  : CpuCalculate(width, height, 2, 0)
+  , confidence(width * height)
+  , spread(width * height)
+  , rowDistance(width * height)
+  , stable(width * height, 0)
+  , previous(width * height, 0)
+{
+  setParameter(1.5f, 0.03f, 4, 8);
+}
+
+// Mx̃p[^ݒ肷
+void CpuConfidence::setParameter(GLfloat sigma, GLfloat jump, int distance, int frames)
+{
+  this->sigma = sigma;
+  this->jump = jump;
+  this->distance = (std::max)(1, (std::min)(distance, 254));
+  this->frames = (std::max)(1, (std::min)(frames, 254));
+}
+
+// 肵t[𐔂
+void CpuConfidence::restart()
+{
+  std::fill(stable.begin(), stable.end(), 0);
+}
+
+// s v ̉f u ̂΂ƈ萫, ֊sǂׂ
+void CpuConfidence::measure(int v, int u)
+{
+  const GLushort *const c(static_cast<const GLushort *>(input[0]) + v * width);
+  const GLubyte *const mask(static_cast<const GLubyte *>(input[1]));
+  const int i(v * width + u);
+  const int d(c[u]);
+  GLubyte *const h(rowDistance.data() + v * width);
+
+  // vłȂf
+  if (d == 0)
+  {
+    spread[i] = 0.0f;
+    stable[i] = 0;
+    previous[i] = 0;
+    h[u] = 0;
+    return;
+  }
+
+  // ̉f̌v̕W΍ (fvXlɔႳ)
+  const GLfloat e(sigma * 0.001f * GLfloat(d));
+
+  // fvXl̕ωW΍ 3 {ȓȂ肵t[𐔂
+  if (previous[i] != 0 && GLfloat(abs(d - int(previous[i]))) <= e * 3.0f)
+  {
+    if (stable[i] < frames) ++stable[i];
+  }
+  else
+  {
+    stable[i] = 0;
+  }
+  previous[i] = GLushort(d);
+
+  // 𖄂߂fƏ㉺Eׂ̗Ƃ̃fvXl̍傫f͗֊sƂ݂Ȃ
+  const GLfloat limit(jump * GLfloat(d));
+  bool edge(mask && mask[i]);
+  if (u > 0 && c[u - 1] && GLfloat(abs(d - int(c[u - 1]))) > limit) edge = true;
+  if (u < width - 1 && c[u + 1] && GLfloat(abs(d - int(c[u + 1]))) > limit) edge = true;
+  if (v > 0 && c[u - width] && GLfloat(abs(d - int(c[u - width]))) > limit) edge = true;
+  if (v < height - 1 && c[u + width] && GLfloat(abs(d - int(c[u + width]))) > limit) edge = true;
+  h[u] = edge ? 0 : 255;
+
+  // 3x3 fׂČvłĂȂ΂΂͋ɔC
+  spread[i] = 1.0f;
+  if (u == 0 || u == width - 1 || v == 0 || v == height - 1) return;
+  const GLushort *const t(c + u - width), *const b(c + u + width);
+  if (!(t[-1] && t[0] && t[1] && c[u - 1] && c[u + 1] && b[-1] && b[0] && b[1])) return;
+
+  // S̃fvXlƂ̍ɕ a + gx * x + gy * y 𓖂Ă͂߂ (x, y  -1, 0, 1)
+  const GLfloat r0(GLfloat(t[-1] - d)), r1(GLfloat(t[0] - d)), r2(GLfloat(t[1] - d));
+  const GLfloat r3(GLfloat(c[u - 1] - d)), r5(GLfloat(c[u + 1] - d));
+  const GLfloat r6(GLfloat(b[-1] - d)), r7(GLfloat(b[0] - d)), r8(GLfloat(b[1] - d));
+  const GLfloat sum(r0 + r1 + r2 + r3 + r5 + r6 + r7 + r8);
+  const GLfloat sum2(r0 * r0 + r1 * r1 + r2 * r2 + r3 * r3 + r5 * r5 + r6 * r6 + r7 * r7 + r8 * r8);
+  const GLfloat sx(r2 + r5 + r8 - r0 - r3 - r6), sy(r6 + r7 + r8 - r0 - r1 - r2);
+
+  // c̕U (Rx 9 - 3) ƌv̕U̔䂩d݂\ň
+  const GLfloat residual((sum2 - sum * sum / 9.0f - (sx * sx + sy * sy) / 6.0f) / 6.0f);
+  const GLfloat k((std::max)(residual, 0.0f) / (e * e) * GLfloat(spreadResolution));
+  spread[i] = spreadTable.weight[k < GLfloat(spreadEntries) ? int(k) : spreadEntries];
+}
+
+// s v ̉f [u0, u1)  4 f measure() Ɠ悤ɋ, fԂ (㉺̒[̍s͏)
+int CpuConfidence::measureRow(int v, int u0, int u1)
+{
+  const GLushort *const c(static_cast<const GLushort *>(input[0]) + v * width);
+  const GLushort *const t(c - width), *const b(c + width);
+  const GLubyte *const mask(static_cast<const GLubyte *>(input[1]));
+
+  const __m128i zeroi(_mm_setzero_si128());
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 three(_mm_set1_ps(3.0f));
+  const __m128 sign(_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+  const __m128 s(_mm_set1_ps(sigma * 0.001f));
+  const __m128 j(_mm_set1_ps(jump));
+  const __m128 scale(_mm_set1_ps(GLfloat(spreadResolution)));
+  const __m128 last(_mm_set1_ps(GLfloat(spreadEntries)));
+  const __m128i maximum(_mm_set1_epi32(frames));
+  const __m128i inc(_mm_set1_epi32(1));
+
+  int u(u0);
+  for (; u + 4 <= u1; u += 4)
+  {
+    const int i(v * width + u);
+
+    // 3x3 f̃fvXlƑÕt[̃fvXl
+    const __m128i raw(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(c + u)));
+    const __m128 d(_mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, zeroi)));
+    const __m128 n0(load4(t + u - 1)), n1(load4(t + u)), n2(load4(t + u + 1));
+    const __m128 n3(load4(c + u - 1)), n5(load4(c + u + 1));
+    const __m128 n6(load4(b + u - 1)), n7(load4(b + u)), n8(load4(b + u + 1));
+    const __m128 p(load4(previous.data() + i));
+
+    // vłf 3x3 fׂČvłf
+    const __m128 valid(_mm_cmpneq_ps(d, zero));
+    const __m128 all(_mm_and_ps(_mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(n0, zero), _mm_cmpneq_ps(n1, zero)),
+      _mm_and_ps(_mm_cmpneq_ps(n2, zero), _mm_cmpneq_ps(n3, zero))), _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(n5, zero),
+      _mm_cmpneq_ps(n6, zero)), _mm_and_ps(_mm_cmpneq_ps(n7, zero), _mm_cmpneq_ps(n8, zero)))));
+
+    // ̉f̌v̕W΍
+    const __m128 e(_mm_mul_ps(s, d));
+
+    // fvXl̕ωW΍ 3 {ȓȂ肵t[𐔂
+    const __m128 keep(_mm_and_ps(_mm_and_ps(valid, _mm_cmpneq_ps(p, zero)),
+      _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(d, p), sign), _mm_mul_ps(e, three))));
+    const __m128i count(load4(stable.data() + i));
+    const __m128i next(_mm_add_epi32(count, _mm_andnot_si128(_mm_cmpgt_epi32(inc, _mm_sub_epi32(maximum, count)), inc)));
+    store4(stable.data() + i, _mm_and_si128(_mm_castps_si128(keep), next));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(previous.data() + i), raw);
+
+    // 𖄂߂fƏ㉺Eׂ̗Ƃ̃fvXl̍傫f͗֊sƂ݂Ȃ
+    const __m128 limit(_mm_mul_ps(j, d));
+    __m128 edge(_mm_or_ps(_mm_or_ps(jumped(d, n1, limit), jumped(d, n3, limit)),
+      _mm_or_ps(jumped(d, n5, limit), jumped(d, n7, limit))));
+    if (mask) edge = _mm_or_ps(edge, _mm_castsi128_ps(_mm_cmpgt_epi32(load4(mask + i), zeroi)));
+    store4(rowDistance.data() + i, _mm_and_si128(_mm_castps_si128(_mm_andnot_ps(edge, valid)), _mm_set1_epi32(255)));
+
+    // S̃fvXlƂ̍ɕʂ𓖂Ă͂߂c̕U
+    const __m128 r0(_mm_sub_ps(n0, d)), r1(_mm_sub_ps(n1, d)), r2(_mm_sub_ps(n2, d));
+    const __m128 r3(_mm_sub_ps(n3, d)), r5(_mm_sub_ps(n5, d));
+    const __m128 r6(_mm_sub_ps(n6, d)), r7(_mm_sub_ps(n7, d)), r8(_mm_sub_ps(n8, d));
+    const __m128 sum(_mm_add_ps(_mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)),
+      _mm_add_ps(_mm_add_ps(r5, r6), _mm_add_ps(r7, r8))));
+    const __m128 sum2(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, r0), _mm_mul_ps(r1, r1)),
+      _mm_add_ps(_mm_mul_ps(r2, r2), _mm_mul_ps(r3, r3))), _mm_add_ps(_mm_add_ps(_mm_mul_ps(r5, r5),
+      _mm_mul_ps(r6, r6)), _mm_add_ps(_mm_mul_ps(r7, r7), _mm_mul_ps(r8, r8)))));
+    const __m128 sx(_mm_sub_ps(_mm_add_ps(_mm_add_ps(r2, r5), r8), _mm_add_ps(_mm_add_ps(r0, r3), r6)));
+    const __m128 sy(_mm_sub_ps(_mm_add_ps(_mm_add_ps(r6, r7), r8), _mm_add_ps(_mm_add_ps(r0, r1), r2)));
+    const __m128 residual(_mm_mul_ps(_mm_sub_ps(_mm_sub_ps(sum2, _mm_mul_ps(_mm_mul_ps(sum, sum), _mm_set1_ps(1.0f / 9.0f))),
+      _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)), _mm_set1_ps(1.0f / 6.0f))), _mm_set1_ps(1.0f / 6.0f)));
+
+    // v̕UƂ̔䂩d݂\ň (vłȂf 0, 3x3 fȂ 1)
+    const __m128 ee(_mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(e, e)), _mm_andnot_ps(valid, one)));
+    const __m128i k(_mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_div_ps(_mm_max_ps(residual, zero), ee), scale), last)));
+    GLint index[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(index), k);
+    const __m128 w(_mm_setr_ps(spreadTable.weight[index[0]], spreadTable.weight[index[1]],
+      spreadTable.weight[index[2]], spreadTable.weight[index[3]]));
+    _mm_storeu_ps(spread.data() + i, _mm_and_ps(valid, _mm_or_ps(_mm_and_ps(all, w), _mm_andnot_ps(all, one))));
+  }
+
+  return u - u0;
+}
+
+// s [begin, end) ̂΂ƈ萫Ɠs̒ł̋߂
+void CpuConfidence::kernel(int begin, int end)
+{
+  for (int v = begin; v < end; ++v)
+  {
+    // ㉺̒[̍sƍE̒[̉f 4 fɖȂc͈߂
+    const int done(v > 0 && v < height - 1 ? measureRow(v, 1, width - 1) : 0);
+    measure(v, 0);
+    for (int u = 1 + done; u < width; ++u) measure(v, u);
+
+    // s̒ōł߂֊s܂ł̋E狁߂ (distance + 1 őł؂)
+    GLubyte *const h(rowDistance.data() + v * width);
+    const int cap(distance + 1);
+    int run(cap);
+    for (int u = 0; u < width; ++u)
+    {
+      run = h[u] == 0 ? 0 : (std::min)(run + 1, cap);
+      h[u] = GLubyte(run);
+    }
+    run = cap;
+    for (int u = width - 1; u >= 0; --u)
+    {
+      run = h[u] == 0 ? 0 : (std::min)(run + 1, int(h[u]));
+      h[u] = GLubyte(run);
+    }
+  }
+}
+
+// s [begin, end) ̋߂ĐMxɂ܂Ƃ߂
+void CpuConfidence::combine(int begin, int end)
+{
+  const GLushort *const data(static_cast<const GLushort *>(input[0]));
+  const GLfloat se(1.0f / GLfloat(distance + 1)), st(1.0f / GLfloat(frames + 1));
+
+  for (int v = begin; v < end; ++v)
+  {
+    for (int u = 0; u < width; ++u)
+    {
+      const int i(v * width + u);
+
+      // vłȂf 0
+      if (data[i] == 0)
+      {
+        confidence[i] = 0;
+        continue;
+      }
+
+      // ㉺̍s̓s̒ł̋猊֊s܂ł̃`FrVFt߂
+      int r(rowDistance[i]);
+      for (int y = 1; y < r; ++y)
+      {
+        if (v - y >= 0) r = (std::min)(r, (std::max)(y, int(rowDistance[i - y * width])));
+        if (v + y < height) r = (std::min)(r, (std::max)(y, int(rowDistance[i + y * width])));
+      }
+      r = (std::min)(r, distance);
+
+      // Mxɂ܂Ƃ߂ (vłf 1 ȏɂ)
+      const GLfloat c(255.0f * spread[i] * GLfloat(r + 1) * se * GLfloat(stable[i] + 1) * st);
+      confidence[i] = GLubyte((std::max)(1.0f, c + 0.5f));
+    }
+  }
+}
+
+// fvXf[^ƌ߂̃}XNMx, ̐MxԂ
+const GLubyte *CpuConfidence::filter(const GLushort *data, const GLubyte *mask)
+{
+  setInput(0, data);
+  setInput(1, mask);
+
+  // sƂ̂΂ƈ萫Ƌ߂Ă, ㉺̍s̋ƍ킹ĐMxɂ܂Ƃ߂
+  calculate();
+  Parallel::run(0, height, [this](int begin, int end) { combine(begin, end); }, rowGrain);
+
+  return confidence.data();
+}
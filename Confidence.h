@@ -0,0 +1,92 @@
+#pragma once
+
+//
+// fvXf[^̉fƂ̐Mx
+//
+//   vłǂ, ͂̂΂, ╨̗̂֊s̋, ԕ̈萫܂Ƃ߂
+//   fƂ 0`255 ̐Mxɂ (vłȂf 0, vłf 1 ȏ)
+//   ȉ͐Mx臒lƔׂ邾Ŏ̈f
+//
+//   ΂: 3x3 fɕʂ𓖂Ă͂߂c̕Uv̕U (fvXlɔႷW΍̓) Ɣׂ
+//             ΂߂̖ʂłȂ, ̗̂֊s܂Α傫Ȃ
+//   : vłȂf, 𖄂߂f, ׂ̉fƂ̃fvXl̍ jump * d 𒴂f
+//         `FrVFt (distance főł؂)
+//   萫: fvXl̕ωv̕W΍ 3 {ȓɎ܂Ăt[ (frames őł؂)
+//
+//   Mx = 255 * exp(-c̕U / (2 * v̕U)) * ( + 1) / (distance + 1) * (萫 + 1) / (frames + 1)
+//
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// CPU ɂMx̌vZ
+//
+//    0: fvXf[^ (GLushort, mm)
+//    1: 𖄂߂f}XN (GLubyte, ߂f 1, NULL Ȃ疄߂ĂȂ)
+//
+class CpuConfidence : public CpuCalculate
+{
+  // fƂ̐Mx
+  std::vector<GLubyte> confidence;
+
+  // fƂ̂΂̏d
+  std::vector<GLfloat> spread;
+
+  // fƂ̓s̒ł̌֊s̋ (f)
+  std::vector<GLubyte> rowDistance;
+
+  // fƂ̃fvXl肵Ăt[
+  std::vector<GLubyte> stable;
+
+  // Õt[̃fvXl
+  std::vector<GLushort> previous;
+
+  // 1 m ̂Ƃ̌v̕W΍ (mm)
+  GLfloat sigma;
+
+  // ֊sƂ݂Ȃׂ̉fƂ̃fvXl̍̃fvXlɑ΂䗦
+  GLfloat jump;
+
+  // ł؂鋗 (f)
+  int distance;
+
+  // ł؂肵t[
+  int frames;
+
+  // s v ̉f u ̂΂ƈ萫, ֊sǂׂ
+  void measure(int v, int u);
+
+  // s v ̉f [u0, u1)  4 f measure() Ɠ悤ɋ, fԂ (SSE2)
+  int measureRow(int v, int u0, int u1);
+
+  // s [begin, end) ̂΂ƈ萫Ɠs̒ł̋߂
+  virtual void kernel(int begin, int end);
+
+  // s [begin, end) ̋߂ĐMxɂ܂Ƃ߂
+  void combine(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuConfidence(int width, int height);
+
+  // Mx̃p[^ݒ肷
+  //   sigma: 1 m ̂Ƃ̌v̕W΍ (mm, fvXlɔႷƂ݂Ȃ)
+  //   jump: ֊sƂ݂Ȃׂ̉fƂ̃fvXl̍̃fvXlɑ΂䗦
+  //   distance: ł؂錊֊s̋ (f, 1`254)
+  //   frames: ł؂肵t[ (1`254)
+  void setParameter(GLfloat sigma, GLfloat jump, int distance, int frames);
+
+  // 肵t[𐔂
+  void restart();
+
+  // fvXf[^ƌ߂̃}XNMx, ̐MxԂ
+  const GLubyte *filter(const GLushort *data, const GLubyte *mask = NULL);
+
+  // Oɋ߂Mx𓾂
+  const GLubyte *get() const
+  {
+    return confidence.data();
+  }
+};
@@ -0,0 +1,299 @@
+#include "CpuCalculate.h"
+
+//
+// 摜 (CPU)
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+// _ʒǔvZɗp萔 (position.frag ƍ킹, depthInvalid  positionScale  CpuCalculate.h)
+const GLfloat depthScale(-0.001f);                      // fvXl̒Pʂ[gɊZW
+const GLfloat depthMaximum(-10.0f);                     // vs\_̃fvXl
+
+// xɏs
+const int rowGrain(8);
+
+namespace
+{
+  // A 4 f (x, y, z)  x, y, z Ƃ̃xNgɓǂݍ
+  inline void load4(const GLfloat *p, __m128 &x, __m128 &y, __m128 &z)
+  {
+    const __m128 a(_mm_loadu_ps(p));                    // x0 y0 z0 x1
+    const __m128 b(_mm_loadu_ps(p + 4));                // y1 z1 x2 y2
+    const __m128 c(_mm_loadu_ps(p + 8));                // z2 x3 y3 z3
+    x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 0)),
+      _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+      _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+      _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+  }
+
+  // x, y, z Ƃ̃xNgA 4 f (x, y, z) ɏ
+  inline void store4(GLfloat *p, __m128 x, __m128 y, __m128 z)
+  {
+    const __m128 t0(_mm_unpacklo_ps(x, y));             // x0 y0 x1 y1
+    const __m128 t1(_mm_unpackhi_ps(x, y));             // x2 y2 x3 y3
+    _mm_storeu_ps(p, _mm_shuffle_ps(t0,
+      _mm_shuffle_ps(z, t0, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(t0, z, _MM_SHUFFLE(1, 1, 3, 3)),
+      t1, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, t1, _MM_SHUFFLE(2, 2, 2, 2)),
+      _mm_shuffle_ps(t1, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+
+  // vs\_ x, y, z 𒆐S̓_ x, y, z ɒu
+  inline void replace(__m128 &x, __m128 &y, __m128 &z, __m128 cx, __m128 cy, __m128 cz, __m128 invalid)
+  {
+    const __m128 m(_mm_cmplt_ps(z, invalid));
+    x = _mm_or_ps(_mm_and_ps(m, cx), _mm_andnot_ps(m, x));
+    y = _mm_or_ps(_mm_and_ps(m, cy), _mm_andnot_ps(m, y));
+    z = _mm_or_ps(_mm_and_ps(m, cz), _mm_andnot_ps(m, z));
+  }
+
+  // ߖT̒_ʒu̍@xNg߂ (normal.frag ƓvZ)
+  //   vs\_͒S̓_ c ɒuĕБ̍ɂ
+  inline void cross(GLfloat *n, const GLfloat *c, const GLfloat *l, const GLfloat *r, const GLfloat *b, const GLfloat *t)
+  {
+    if (l[2] < depthInvalid) l = c;
+    if (r[2] < depthInvalid) r = c;
+    if (b[2] < depthInvalid) b = c;
+    if (t[2] < depthInvalid) t = c;
+    const GLfloat vx[] = { r[0] - l[0], r[1] - l[1], r[2] - l[2] };
+    const GLfloat vy[] = { t[0] - b[0], t[1] - b[1], t[2] - b[2] };
+    ggCross(n, vx, vy);
+    const GLfloat a(ggDot3(n, n));
+    const GLfloat s(a > 0.0f ? 1.0f / sqrt(a) : 0.0f);
+    n[0] *= s;
+    n[1] *= s;
+    n[2] *= s;
+  }
+
+  // ʑ̎ʑ [0, 1]  2 ɕϊꂽPʃxNg𕜌 (simple.vert ƓvZ)
+  inline void decode(GLfloat *n, const GLfloat *e)
+  {
+    n[0] = e[0] * 2.0f - 1.0f;
+    n[1] = e[1] * 2.0f - 1.0f;
+    n[2] = 1.0f - fabs(n[0]) - fabs(n[1]);
+    const GLfloat t(n[2] < 0.0f ? -n[2] : 0.0f);
+    n[0] += n[0] >= 0.0f ? -t : t;
+    n[1] += n[1] >= 0.0f ? -t : t;
+    const GLfloat s(1.0f / sqrt(ggDot3(n, n)));
+    n[0] *= s;
+    n[1] *= s;
+    n[2] *= s;
+  }
+}
+
+// RXgN^
+CpuCalculate::CpuCalculate(int width, int height, int uniforms, int targets, int components)
+  : width(width)
+  , height(height)
+  , components(components)
+  , input(uniforms, static_cast<const GLvoid *>(NULL))
+  , buffer(targets, std::vector<GLfloat>(width * height * components))
+{
+}
+
+// vZs
+const std::vector< std::vector<GLfloat> > &CpuCalculate::calculate()
+{
+  // sƂɕɌvZ
+  Parallel::run(0, height, [this](int begin, int end) { kernel(begin, end); }, rowGrain);
+
+  return buffer;
+}
+
+// vZʂeNX`ɓ]
+void CpuCalculate::upload(GLuint texture, int target) const
+{
+  static const GLenum format[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format[components - 1], GL_FLOAT, buffer[target].data());
+}
+
+// eNX`̓eƌvZʂrč̐Βl̍ől߂
+GLfloat CpuCalculate::compare(GLuint texture, int target, bool packed, int *count) const
+{
+  static const GLenum format[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+
+  // eNX`̓eo
+  const int c(packed ? 2 : components);
+  std::vector<GLfloat> gpu(width * height * c);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, 0, format[c - 1], GL_FLOAT, gpu.data());
+
+  // fƂɔr
+  GLfloat error(0.0f);
+  int compared(0);
+  for (int i = 0; i < width * height; ++i)
+  {
+    const GLfloat *const p(buffer[target].data() + i * components);
+
+    // @xNg߂Ȃf͔rȂ
+    GLfloat q[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (packed)
+    {
+      if (p[0] == 0.0f && p[1] == 0.0f && p[2] == 0.0f) continue;
+      decode(q, gpu.data() + i * 2);
+    }
+    else
+    {
+      for (int k = 0; k < c; ++k) q[k] = gpu[i * c + k];
+    }
+
+    for (int k = 0; k < components; ++k)
+    {
+      const GLfloat e(fabs(p[k] - q[k]));
+      if (e > error) error = e;
+    }
+    ++compared;
+  }
+
+  if (count) *count = compared;
+  return error;
+}
+
+//  CPU  OS  AVX2  FMA g邩ǂׂ
+bool CpuCalculate::hasAvx2()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+
+  // FMA  AVX g OS  AVX ̃WX^ۑ邩
+  const int features((1 << 12) | (1 << 27) | (1 << 28));
+  __cpuid(info, 1);
+  if ((info[2] & features) != features || (_xgetbv(0) & 6) != 6) return false;
+
+  // AVX2 g邩
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+// fvXf[^璸_ʒu߂RXgN^
+CpuPosition::CpuPosition(int width, int height)
+  : CpuCalculate(width, height)
+  , xScale(width)
+  , yScale(height)
+{
+  // eNX`W狁߂W
+  for (int u = 0; u < width; ++u)
+    xScale[u] = ((GLfloat(u) + 0.5f) / GLfloat(width) - 0.5f) * positionScale[0];
+  for (int v = 0; v < height; ++v)
+    yScale[v] = ((GLfloat(v) + 0.5f) / GLfloat(height) - 0.5f) * positionScale[1];
+}
+
+// fvXf[^璸_ʒu߂
+void CpuPosition::kernel(int begin, int end)
+{
+  const GLushort *const depth(static_cast<const GLushort *>(input[0]));
+  const __m128 zScale(_mm_set1_ps(depthScale));
+  const __m128 zMaximum(_mm_set1_ps(depthMaximum));
+  const __m128i zero(_mm_setzero_si128());
+
+  for (int v = begin; v < end; ++v)
+  {
+    const GLushort *const d(depth + v * width);
+    GLfloat *const p(buffer[0].data() + v * width * 3);
+    const __m128 ys(_mm_set1_ps(yScale[v]));
+
+    // 4 f߂
+    int u(0);
+    for (; u + 4 <= width; u += 4)
+    {
+      // fvXl[gɊZ (vs\_ depthMaximum ɂ)
+      const __m128 df(_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(d + u)), zero)));
+      const __m128 invalid(_mm_cmpeq_ps(df, _mm_setzero_ps()));
+      const __m128 z(_mm_or_ps(_mm_and_ps(invalid, zMaximum), _mm_andnot_ps(invalid, _mm_mul_ps(df, zScale))));
+
+      // JW߂
+      store4(p + u * 3, _mm_mul_ps(_mm_loadu_ps(xScale.data() + u), z), _mm_mul_ps(ys, z), z);
+    }
+
+    // c̉f
+    for (; u < width; ++u)
+    {
+      const GLfloat z(d[u] == 0 ? depthMaximum : GLfloat(d[u]) * depthScale);
+      p[u * 3 + 0] = xScale[u] * z;
+      p[u * 3 + 1] = yScale[v] * z;
+      p[u * 3 + 2] = z;
+    }
+  }
+}
+
+// _ʒu@xNg߂
+void CpuNormal::kernel(int begin, int end)
+{
+  const GLfloat *const position(static_cast<const GLfloat *>(input[0]));
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 invalid(_mm_set1_ps(depthInvalid));
+
+  for (int v = begin; v < end; ++v)
+  {
+    // ㉺̍s (摜̒[ł͒[̉fg)
+    const GLfloat *const c(position + v * width * 3);
+    const GLfloat *const b(position + (v > 0 ? v - 1 : v) * width * 3);
+    const GLfloat *const t(position + (v < height - 1 ? v + 1 : v) * width * 3);
+    GLfloat *const n(buffer[0].data() + v * width * 3);
+
+    // [̉f
+    cross(n, c, c, c + (width > 1 ? 3 : 0), b, t);
+
+    // 4 f߂
+    int u(1);
+    for (; u + 5 <= width; u += 4)
+    {
+      __m128 lx, ly, lz, rx, ry, rz, bx, by, bz, tx, ty, tz;
+      load4(c + (u - 1) * 3, lx, ly, lz);
+      load4(c + (u + 1) * 3, rx, ry, rz);
+      load4(b + u * 3, bx, by, bz);
+      load4(t + u * 3, tx, ty, tz);
+
+      // vs\_ΒS̓_ɒu
+      if (_mm_movemask_ps(_mm_cmplt_ps(_mm_min_ps(_mm_min_ps(lz, rz), _mm_min_ps(bz, tz)), invalid)) != 0)
+      {
+        __m128 ox, oy, oz;
+        load4(c + u * 3, ox, oy, oz);
+        replace(lx, ly, lz, ox, oy, oz, invalid);
+        replace(rx, ry, rz, ox, oy, oz, invalid);
+        replace(bx, by, bz, ox, oy, oz, invalid);
+        replace(tx, ty, tz, ox, oy, oz, invalid);
+      }
+
+      // ߖŤz߂
+      const __m128 ax(_mm_sub_ps(rx, lx)), ay(_mm_sub_ps(ry, ly)), az(_mm_sub_ps(rz, lz));
+      const __m128 cx(_mm_sub_ps(tx, bx)), cy(_mm_sub_ps(ty, by)), cz(_mm_sub_ps(tz, bz));
+
+      // z@xNg߂
+      const __m128 nx(_mm_sub_ps(_mm_mul_ps(ay, cz), _mm_mul_ps(az, cy)));
+      const __m128 ny(_mm_sub_ps(_mm_mul_ps(az, cx), _mm_mul_ps(ax, cz)));
+      const __m128 nz(_mm_sub_ps(_mm_mul_ps(ax, cy), _mm_mul_ps(ay, cx)));
+      const __m128 a(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+      const __m128 s(_mm_and_ps(_mm_cmpgt_ps(a, zero), _mm_div_ps(one, _mm_sqrt_ps(a))));
+      store4(n + u * 3, _mm_mul_ps(nx, s), _mm_mul_ps(ny, s), _mm_mul_ps(nz, s));
+    }
+
+    // c̉f
+    for (; u < width; ++u)
+    {
+      const int r(u < width - 1 ? u + 1 : u);
+      cross(n + u * 3, c + u * 3, c + (u - 1) * 3, c + r * 3, b + u * 3, t + u * 3);
+    }
+  }
+}
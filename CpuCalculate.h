@@ -0,0 +1,128 @@
+#pragma once
+
+//
+// 摜 (CPU)
+//
+//   Calculate Ɠ菇 CPU ŌvZ
+//   calculate()  OpenGL gȂ̂ GPU ̂Ȃłg
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+// AVX2  FMA ̑gݍ݊֐g֐ɕt
+//   GCC  Clang ł͂̊֐ AVX2  FMA ̖߂g悤ɂ, ق̊֐ AVX2 ̂Ȃ CPU ł悤ɂ
+//   (MSVC ͎w肵ȂĂgݍ݊֐g)
+#if defined(_MSC_VER)
+#  define AVX2_FUNCTION
+#else
+#  define AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#endif
+
+// _ʒǔvZɗp萔 (position.frag ƍ킹)
+//   CpuPosition ߂_ʒugNX͂̒lg
+const GLfloat depthInvalid(-9.0f);                      // 艓_͌vs\_Ƃ݂Ȃ (normal.frag ƍ킹)
+const GLfloat positionScale[] = { 1.546592f, 1.222434f };
+
+class CpuCalculate
+{
+protected:
+
+  // 摜̃TCY
+  const int width, height;
+
+  // vZʂ 1 f̗vf
+  const int components;
+
+  // ͂f[^
+  std::vector<const GLvoid *> input;
+
+  // vZʂۑobt@
+  std::vector< std::vector<GLfloat> > buffer;
+
+  // s [begin, end) ̌vZs (ʂ̃Xbh瓯ɌĂяo)
+  virtual void kernel(int begin, int end) = 0;
+
+public:
+
+  // RXgN^
+  //   uniforms: ͂f[^̐
+  //   targets: vZʂۑobt@̐
+  //   components: vZʂ 1 f̗vf
+  CpuCalculate(int width, int height, int uniforms = 1, int targets = 1, int components = 3);
+
+  // fXgN^
+  virtual ~CpuCalculate() {}
+
+  // ͂f[^ݒ肷 (Calculate ŃeNX`jbgɃeNX`̂ɑ)
+  void setInput(int unit, const GLvoid *data)
+  {
+    input[unit] = data;
+  }
+
+  // vZʂۑobt@𓾂
+  const std::vector< std::vector<GLfloat> > &getBuffer() const
+  {
+    return buffer;
+  }
+
+  // vZs
+  const std::vector< std::vector<GLfloat> > &calculate();
+
+  // vZʂeNX`ɓ]
+  void upload(GLuint texture, int target = 0) const;
+
+  // eNX`̓eƌvZʂrč̐Βl̍ől߂
+  //   packed: eNX`ʑ̎ʑŋlߍ񂾖@xNgȂ true
+  //   count: rf̊i[ (NULL Ȃi[Ȃ)
+  GLfloat compare(GLuint texture, int target = 0, bool packed = false, int *count = NULL) const;
+
+  //  CPU  OS  AVX2  FMA g邩ǂׂ (AVX2_FUNCTION t֐ĂяoOɊm߂)
+  static bool hasAvx2();
+};
+
+//
+// fvXf[^璸_ʒu߂ (position.frag ƓvZ)
+//
+//    0: fvXf[^ (GLushort, mm)
+//   o 0: _ʒu (x, y, z)
+//
+class CpuPosition : public CpuCalculate
+{
+  // 񂲂Ƃ x ̌W
+  std::vector<GLfloat> xScale;
+
+  // sƂ y ̌W
+  std::vector<GLfloat> yScale;
+
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuPosition(int width, int height);
+};
+
+//
+// _ʒu@xNg߂ (normal.frag ƓvZ)
+//
+//    0: _ʒu (GLfloat[3])
+//   o 0: @xNg (x, y, z)
+//
+class CpuNormal : public CpuCalculate
+{
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuNormal(int width, int height)
+    : CpuCalculate(width, height)
+  {
+  }
+};
@@ -1,11 +1,36 @@
 #include "DepthCamera.h"
 
+// ԕ̕
+#include "Temporal.h"
+
+// tCOsNZ̏
+#include "FlyingPixel.h"
+
+// 
+#include "HoleFill.h"
+
+// oCetB^
+#include "Bilateral.h"
+
+// Lu[VɂJ[̃eNX`Wւ̕ϊ
+#include "ColorMapper.h"
+
+// Mx
+#include "Confidence.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cstdlib>
+#include <cstring>
+
 //
 // [xZT֘ÅNX
 //
 
 // depthCount  colorCount vZăeNX`ƃobt@IuWFNg쐬
-void DepthCamera::makeTexture()
+void DepthCamera::makeTexture(GLenum pointFormat)
 {
   // fvXf[^ƃJ[f[^̉f߂
   depthCount = depthWidth * depthHeight;
@@ -14,7 +39,7 @@ void DepthCamera::makeTexture()
   // fvXf[^i[eNX`
   glGenTextures(1, &depthTexture);
   glBindTexture(GL_TEXTURE_2D, depthTexture);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, depthWidth, depthHeight, 0, GL_RED, GL_UNSIGNED_SHORT, NULL);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, depthWidth, depthHeight, 0, GL_RED, GL_UNSIGNED_SHORT, NULL);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -23,7 +48,7 @@ void DepthCamera::makeTexture()
   // fvXf[^狁߂JWi[eNX`
   glGenTextures(1, &pointTexture);
   glBindTexture(GL_TEXTURE_2D, pointTexture);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, depthWidth, depthHeight, 0, GL_RGB, GL_FLOAT, NULL);
+  glTexImage2D(GL_TEXTURE_2D, 0, pointFormat, depthWidth, depthHeight, 0, GL_RGB, GL_FLOAT, NULL);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -43,15 +68,358 @@ void DepthCamera::makeTexture()
   glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
   glBufferData(GL_ARRAY_BUFFER, depthCount * 2 * sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
 
-  // gpĂZT̐𐔂
-  ++activated;
+  // ωoɗp^C̐߂
+  tileCols = (depthWidth + tileSize - 1) / tileSize;
+  tileRows = (depthHeight + tileSize - 1) / tileSize;
+  tileCount = tileCols * tileRows;
+
+  // ωoɗp郁mۂ
+  reference.assign(depthCount, 0);
+  dirty.assign(tileCount, 1);
+  dirtyCount = tileCount;
+
+  // ŏ̃t[ׂ͂Ẵ^C]
+  changeReset = true;
+
+  // ̃ZTLɂ
+  activated = true;
+}
+
+// fvXf[^̕ω^CƂɌo
+int DepthCamera::detectChange(const GLushort *depth) const
+{
+  // ω^C̐
+  dirtyCount = 0;
+
+  // ׂẴ^Cɂ
+  for (int tile = 0; tile < tileCount; ++tile)
+  {
+    // ̃^Cf͈̔
+    int x0, y0, x1, y1;
+    getTileRect(tile, &x0, &y0, &x1, &y1);
+
+    // O񔽉ffvXlƂ̍̍ől߂ (臒l𒴂ł؂)
+    bool changed(changeReset);
+    for (int y = y0; y < y1 && !changed; ++y)
+    {
+      const GLushort *const d(depth + y * depthWidth);
+      const GLushort *const r(reference.data() + y * depthWidth);
+      int diff(0);
+      for (int x = x0; x < x1; ++x)
+      {
+        const int e(abs(int(d[x]) - int(r[x])));
+        if (e > diff) diff = e;
+      }
+      changed = diff > changeThreshold;
+    }
+
+    // ω^C̓fvXlL^
+    if (changed)
+    {
+      for (int y = y0; y < y1; ++y)
+      {
+        memcpy(reference.data() + y * depthWidth + x0, depth + y * depthWidth + x0, (x1 - x0) * sizeof (GLushort));
+      }
+      ++dirtyCount;
+    }
+    dirty[tile] = changed;
+  }
+
+  // ̃t[͕ω^C
+  changeReset = false;
+
+  return dirtyCount;
+}
+
+// fvXf[^𕽊
+const GLushort *DepthCamera::filterDepth(const GLushort *depth) const
+{
+  // ԕɕ, tCOsNZČ𖄂߂Ăԕɕ
+  if (temporal) depth = temporal->filter(depth);
+  if (flyingPixel) depth = flyingPixel->filter(depth);
+  if (holeFill) depth = holeFill->filter(depth);
+  if (bilateral) depth = bilateral->filter(depth);
+  return depth;
+}
+
+// fvXf[^̎ԕ̕ݒ肷
+void DepthCamera::setTemporalFilter(GLfloat alpha, GLfloat threshold, int hold)
+{
+  // ʂ̃XbhŕĂrȂÎ҂
+  std::lock_guard<std::mutex> lock(filterMutex);
+
+  // Ȃ
+  if (alpha >= 1.0f)
+  {
+    delete temporal;
+    temporal = NULL;
+  }
+  else
+  {
+    // Ɏgobt@pӂăp[^ݒ肷
+    if (!temporal) temporal = new CpuTemporal(depthWidth, depthHeight);
+    temporal->setParameter(alpha, threshold, hold);
+    temporal->restart();
+  }
+
+  // ̃t[ׂ͂Ẵ^CXV
+  changeReset = true;
+}
+
+// fvXf[^̃tCOsNZ̏ݒ肷
+void DepthCamera::setFlyingPixelFilter(GLfloat ratio)
+{
+  // ʂ̃XbhŕĂrȂÎ҂
+  std::lock_guard<std::mutex> lock(filterMutex);
+
+  // Ȃ
+  if (ratio <= 0.0f)
+  {
+    delete flyingPixel;
+    flyingPixel = NULL;
+  }
+  else
+  {
+    // Ɏgobt@pӂăp[^ݒ肷
+    if (!flyingPixel) flyingPixel = new CpuFlyingPixel(depthWidth, depthHeight);
+    flyingPixel->setParameter(ratio);
+  }
+
+  // ̃t[ׂ͂Ẵ^CXV
+  changeReset = true;
+}
+
+// fvXf[^̌߂ݒ肷
+void DepthCamera::setHoleFill(int maxGap, int jump)
+{
+  // ʂ̃XbhŕĂrȂÎ҂
+  std::lock_guard<std::mutex> lock(filterMutex);
+
+  // 𖄂߂Ȃ
+  if (maxGap <= 0)
+  {
+    delete holeFill;
+    holeFill = NULL;
+  }
+  else
+  {
+    // ߂Ɏgobt@pӂăp[^ݒ肷
+    if (!holeFill) holeFill = new CpuHoleFill(depthWidth, depthHeight);
+    holeFill->setParameter(maxGap, jump);
+  }
+
+  // ̃t[ׂ͂Ẵ^CXV
+  changeReset = true;
+}
+
+// Õt[Ō𖄂߂f}XN𓾂
+const GLubyte *DepthCamera::getFillMask() const
+{
+  return holeFill ? holeFill->getMask() : NULL;
+}
+
+// fvXf[^̃oCetB^ݒ肷
+void DepthCamera::setBilateralFilter(int radius, GLfloat sigmaSpace, GLfloat sigmaRange, bool separable)
+{
+  // ʂ̃XbhŕĂrȂÎ҂
+  std::lock_guard<std::mutex> lock(filterMutex);
+
+  // tB^Ȃ
+  if (radius <= 0)
+  {
+    delete bilateral;
+    bilateral = NULL;
+  }
+  else
+  {
+    // tB^Ɏgobt@pӂăp[^ݒ肷
+    if (!bilateral) bilateral = new CpuBilateral(depthWidth, depthHeight);
+    bilateral->setParameter(radius, sigmaSpace, sigmaRange, separable);
+  }
+
+  // ̃t[ׂ͂Ẵ^CXV
+  changeReset = true;
+}
+
+// fvXf[^̉fƂ̐Mx߂悤ɂ
+void DepthCamera::setConfidence(GLfloat sigma, GLfloat jump, int distance, int frames)
+{
+  // ߂Ȃ
+  if (sigma <= 0.0f)
+  {
+    delete confidence;
+    confidence = NULL;
+    glDeleteTextures(1, &confidenceTexture);
+    confidenceTexture = 0;
+    return;
+  }
+
+  // MxɎgobt@ƃeNX`pӂăp[^ݒ肷
+  if (!confidence)
+  {
+    confidence = new CpuConfidence(depthWidth, depthHeight);
+
+    glGenTextures(1, &confidenceTexture);
+    glBindTexture(GL_TEXTURE_2D, confidenceTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, depthWidth, depthHeight, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  }
+  confidence->setParameter(sigma, jump, distance, frames);
+  confidence->restart();
+}
+
+// Ōɋ߂Mx𓾂
+const GLubyte *DepthCamera::getConfidenceBuffer() const
+{
+  return confidence ? confidence->get() : NULL;
+}
+
+// eNX`ɓ]fvXf[^̐Mx߂ăeNX`ɓ]
+void DepthCamera::updateConfidence() const
+{
+  if (!confidence) return;
+
+  // ωȂ^C萫ς̂őŜ]
+  confidence->filter(reference.data(), getFillMask());
+  GLint bound;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+  glBindTexture(GL_TEXTURE_2D, confidenceTexture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, depthWidth, depthHeight, GL_RED, GL_UNSIGNED_BYTE, confidence->get());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  // Ăяow肵ĂeNX`ɖ߂
+  glBindTexture(GL_TEXTURE_2D, bound);
+}
+
+// J[̃eNX`WۑLu[Vŋ߂悤ɂ
+bool DepthCamera::setColorMapping(const char *file)
+{
+  // ǂݍ߂Ȃ΃ZT SDK g
+  ColorMapper *mapper(NULL);
+  if (file)
+  {
+    mapper = new ColorMapper(depthWidth, depthHeight, colorWidth, colorHeight);
+    if (!mapper->load(file))
+    {
+      delete mapper;
+      mapper = NULL;
+    }
+  }
+
+  delete colorMapper;
+  colorMapper = mapper;
+
+  // ̃t[ׂ͂Ẵ^CXV
+  changeReset = true;
+
+  return mapper != NULL;
+}
+
+// Lu[Vgĕω^C̃J[̃eNX`W߂ăobt@IuWFNgɓ]
+bool DepthCamera::mapColorCalibrated(const GLushort *depth) const
+{
+  if (!colorMapper) return false;
+
+  // eNX`Wi[obt@IuWFNg}bv
+  glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+  GLfloat (*const texcoord)[2](static_cast<GLfloat (*)[2]>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)));
+
+  if (dirtyCount == tileCount)
+  {
+    // ׂẴ^CωĂŜsƂɕɋ߂
+    colorMapper->map(depth, texcoord);
+  }
+  else
+  {
+    // ω^Cɋ߂
+    Parallel::run(0, tileCount, [&](int begin, int end)
+    {
+      for (int tile = begin; tile < end; ++tile)
+      {
+        if (!dirty[tile]) continue;
+
+        int x0, y0, x1, y1;
+        getTileRect(tile, &x0, &y0, &x1, &y1);
+        colorMapper->map(depth, texcoord, x0, y0, x1, y1);
+      }
+    }, 8);
+  }
+
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+
+  return true;
+}
+
+// ω^C̕eNX`ɓ]
+void DepthCamera::uploadDirtyTiles(const GLvoid *data, GLenum format, GLenum type, GLsizei pixelSize) const
+{
+  // ω^CȂΉȂ
+  if (dirtyCount == 0) return;
+
+  // ׂẴ^CωĂŜxɓ]
+  if (dirtyCount == tileCount)
+  {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, depthWidth, depthHeight, format, type, data);
+    return;
+  }
+
+  // f[^̈s̉fw肵ĕ̈]
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, depthWidth);
+
+  // ^C̍sƂ
+  for (int j = 0; j < tileRows; ++j)
+  {
+    // ɘAĕω^C܂Ƃ߂ē]
+    for (int i = 0; i < tileCols;)
+    {
+      const int first(j * tileCols + i);
+      if (!dirty[first])
+      {
+        ++i;
+        continue;
+      }
+      while (i < tileCols && dirty[j * tileCols + i]) ++i;
+      const int last(j * tileCols + i - 1);
+
+      // ]͈
+      int x0, y0, x1, y1, x2, y2;
+      getTileRect(first, &x0, &y0, &x1, &y1);
+      getTileRect(last, &x2, &y2, &x1, &y1);
+
+      // ]̐擪ʒu
+      const GLubyte *const src(static_cast<const GLubyte *>(data) + (y0 * depthWidth + x0) * pixelSize);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, x1 - x0, y1 - y0, format, type, src);
+    }
+  }
+
+  // f̊i[@ɖ߂
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 // fXgN^
 DepthCamera::~DepthCamera()
 {
+  // Ɏgobt@폜
+  delete temporal;
+  delete flyingPixel;
+  delete holeFill;
+  delete bilateral;
+
+  // Lu[V폜
+  delete colorMapper;
+
+  // MxɎgobt@ƃeNX`폜
+  delete confidence;
+  if (confidenceTexture) glDeleteTextures(1, &confidenceTexture);
+
   // ZTLɂȂĂ
-  if (activated > 0)
+  if (activated)
   {
     // eNX`폜
     glDeleteTextures(1, &depthTexture);
@@ -60,11 +428,5 @@ DepthCamera::~DepthCamera()
 
     // obt@IuWFNg폜
     glDeleteBuffers(1, &coordBuffer);
-
-    // gpĂZT̐炷
-    --activated;
   }
 }
-
-// gpĂZT̐
-int DepthCamera::activated(0);
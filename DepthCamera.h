@@ -7,10 +7,35 @@
 // EBhE֘Ȁ
 #include "Window.h"
 
+// WCu
+#include <vector>
+#include <mutex>
+
+// CPU ɂ鎞ԕ̕
+class CpuTemporal;
+
+// CPU ɂoCetB^
+class CpuBilateral;
+
+// CPU ɂtCOsNZ̏
+class CpuFlyingPixel;
+
+// CPU ɂ錊
+class CpuHoleFill;
+
+// Lu[VɂJ[̃eNX`Wւ̕ϊ
+class ColorMapper;
+
+// CPU ɂMx̌vZ
+class CpuConfidence;
+
 class DepthCamera
 {
-  // LꂽfvXJ̑䐔
-  static int activated;
+  // ̃fvXJLꂽǂ
+  bool activated;
+
+  // JW畡̃ZTŋLWnւ̕ϊs (Op[^)
+  GgMatrix extrinsic;
 
 protected:
 
@@ -33,19 +58,115 @@ protected:
   GLuint coordBuffer;
 
   // depthCount  colorCount vZăeNX`ƃobt@IuWFNg쐬
-  void makeTexture();
+  //   pointFormat: JWi[eNX`̓tH[}bg
+  void makeTexture(GLenum pointFormat = GL_RGB32F);
+
+  // ωoɗp^C̈ӂ̉f
+  static const int tileSize = 16;
+
+  // ^C̉Əc̐Ƒ
+  int tileCols, tileRows, tileCount;
+
+  // ^CƂɍŌɔffvXf[^
+  mutable std::vector<GLushort> reference;
+
+  // ^CƂ̕ω̗L
+  mutable std::vector<GLubyte> dirty;
+
+  // ω^C̐
+  mutable int dirtyCount;
+
+  // ωƂ݂ȂfvXl̍臒l (mm)
+  GLushort changeThreshold;
+
+  // ̃t[ׂ͂Ẵ^Cω̂Ƃ
+  mutable bool changeReset;
+
+  // ωoOɃfvXf[^ԕɕ (NULL Ȃ畽Ȃ)
+  CpuTemporal *temporal;
+
+  // ωoOɃfvXf[^tCOsNZ (NULL Ȃ珜Ȃ)
+  CpuFlyingPixel *flyingPixel;
+
+  // ωoOɃfvXf[^̌𖄂߂ (NULL Ȃ疄߂Ȃ)
+  CpuHoleFill *holeFill;
+
+  // ωoOɃfvXf[^ɃoCetB^ (NULL Ȃ炩Ȃ)
+  CpuBilateral *bilateral;
+
+  // J[̃eNX`W߂̂ɎgLu[V (NULL ȂZT SDK g)
+  ColorMapper *colorMapper;
+
+  // eNX`ɓ]fvXf[^̉fƂ̐Mx߂ (NULL Ȃ狁߂Ȃ)
+  CpuConfidence *confidence;
+
+  // Mxi[eNX` (R8)
+  GLuint confidenceTexture;
+
+  // 擾fvX̃t[̔ԍ (Vt[擾邽тɑ₷)
+  mutable unsigned int frame;
+
+  // fvXf[^̐̕ݒ̔r (ʂ̃Xbh filterDepth() ĂԂƂ͂bN)
+  std::mutex filterMutex;
+
+  // eNX`ɓ]fvXf[^̐Mx߂ăeNX`ɓ] (Vt[ƂɌĂяo)
+  void updateConfidence() const;
+
+  // Lu[Vgĕω^C̃J[̃eNX`W߂ăobt@IuWFNgɓ]
+  //   Lu[Vݒ肵ĂȂΉ false Ԃ
+  bool mapColorCalibrated(const GLushort *depth) const;
+
+  // fvXf[^𕽊 (ȂƂ͂̂܂ܕԂ)
+  const GLushort *filterDepth(const GLushort *depth) const;
+
+  // fvXf[^̕ω^CƂɌo
+  int detectChange(const GLushort *depth) const;
+
+  // ^Cf͈̔͂߂
+  void getTileRect(int tile, int *x0, int *y0, int *x1, int *y1) const
+  {
+    *x0 = (tile % tileCols) * tileSize;
+    *y0 = (tile / tileCols) * tileSize;
+    *x1 = *x0 + tileSize < depthWidth ? *x0 + tileSize : depthWidth;
+    *y1 = *y0 + tileSize < depthHeight ? *y0 + tileSize : depthHeight;
+  }
+
+  // ω^C̕eNX`ɓ]
+  void uploadDirtyTiles(const GLvoid *data, GLenum format, GLenum type, GLsizei pixelSize) const;
 
 public:
 
   // RXgN^
   DepthCamera()
+    : activated(false)
+    , extrinsic(ggIdentity())
+    , changeThreshold(0)
+    , temporal(NULL)
+    , flyingPixel(NULL)
+    , holeFill(NULL)
+    , bilateral(NULL)
+    , colorMapper(NULL)
+    , confidence(NULL)
+    , confidenceTexture(0)
+    , frame(0)
   {
   }
   DepthCamera(int depthWidth, int depthHeight, int colorWidth, int colorHeight)
-    : depthWidth(depthWidth)
+    : activated(false)
+    , extrinsic(ggIdentity())
+    , depthWidth(depthWidth)
     , depthHeight(depthHeight)
     , colorWidth(colorWidth)
     , colorHeight(colorHeight)
+    , changeThreshold(0)
+    , temporal(NULL)
+    , flyingPixel(NULL)
+    , holeFill(NULL)
+    , bilateral(NULL)
+    , colorMapper(NULL)
+    , confidence(NULL)
+    , confidenceTexture(0)
+    , frame(0)
   {
   }
 
@@ -53,21 +174,33 @@ public:
   virtual ~DepthCamera();
 
   // fvXf[^擾
-  GLuint getDepth() const
+  virtual GLuint getDepth() const
   {
     glBindTexture(GL_TEXTURE_2D, depthTexture);
     return depthTexture;
   }
 
+  // ŌɃeNX`ɓ]fvXf[^𓾂
+  const GLushort *getDepthBuffer() const
+  {
+    return reference.data();
+  }
+
   // JW擾
-  GLuint getPoint() const
+  virtual GLuint getPoint() const
   {
     glBindTexture(GL_TEXTURE_2D, pointTexture);
     return pointTexture;
   }
 
+  // Ō getPoint() ŋ߂JW𓾂 (CPU ŋ߂ĂȂ NULL)
+  virtual const GLfloat (*getPointBuffer() const)[3]
+  {
+    return NULL;
+  }
+
   // J[f[^擾
-  GLuint getColor() const
+  virtual GLuint getColor() const
   {
     glBindTexture(GL_TEXTURE_2D, colorTexture);
     return colorTexture;
@@ -93,9 +226,73 @@ public:
     return coordBuffer;
   }
 
-  // gpĂZT[̐𒲂ׂ
-  int getActivated()
+  // ωƂ݂ȂfvXl̍臒lݒ肷 (0 Ȃ킸ȕωłXV)
+  void setChangeThreshold(GLushort threshold)
+  {
+    changeThreshold = threshold;
+    changeReset = true;
+  }
+
+  // fvXf[^̎ԕ̕ݒ肷 (Temporal::setParameter() Ɠ, alpha  1 ȏȂ畽Ȃ)
+  void setTemporalFilter(GLfloat alpha, GLfloat threshold, int hold);
+
+  // fvXf[^̃tCOsNZ̏ݒ肷 (FlyingPixel::setParameter() Ɠ, ratio  0 ȉȂ珜Ȃ)
+  void setFlyingPixelFilter(GLfloat ratio);
+
+  // fvXf[^̌߂ݒ肷 (CpuHoleFill::setParameter() Ɠ, maxGap  0 ȉȂ疄߂Ȃ)
+  void setHoleFill(int maxGap, int jump);
+
+  // Õt[Ō𖄂߂f}XN𓾂 (߂f 1, ߂ĂȂ NULL)
+  virtual const GLubyte *getFillMask() const;
+
+  // fvXf[^̃oCetB^ݒ肷 (Bilateral::setParameter() Ɠ, radius  0 ȉȂ炩Ȃ)
+  void setBilateralFilter(int radius, GLfloat sigmaSpace, GLfloat sigmaRange, bool separable = false);
+
+  // J[̃eNX`WۑLu[Vŋ߂悤ɂ
+  //   file: Lu[Ṽt@C (NULL ȂZT SDK ɖ߂)
+  //   ߂l: ǂݍ߂Ȃ false (ZT SDK g)
+  bool setColorMapping(const char *file);
+
+  // fvXf[^̉fƂ̐Mx߂悤ɂ (CpuConfidence::setParameter() Ɠ, sigma  0 ȉȂ狁߂Ȃ)
+  void setConfidence(GLfloat sigma, GLfloat jump, int distance, int frames);
+
+  // Mx̃eNX`擾 (R8, vłȂf 0, Mx߂ĂȂ 0 Ԃ)
+  GLuint getConfidence() const
+  {
+    glBindTexture(GL_TEXTURE_2D, confidenceTexture);
+    return confidenceTexture;
+  }
+
+  // Ōɋ߂Mx𓾂 (Mx߂ĂȂ NULL)
+  const GLubyte *getConfidenceBuffer() const;
+
+  // ŌɎ擾fvX̃t[̔ԍ𓾂 (getDepth()  getPoint() Vt[擾邽тɑ)
+  unsigned int getFrame() const
+  {
+    return frame;
+  }
+
+  // Õt[ŕω^C̊𓾂
+  GLfloat getDirtyRatio() const
+  {
+    return tileCount > 0 ? GLfloat(dirtyCount) / GLfloat(tileCount) : 0.0f;
+  }
+
+  // JW狤LWnւ̕ϊs (Op[^) ݒ肷
+  void setExtrinsic(const GgMatrix &extrinsic)
+  {
+    this->extrinsic = extrinsic;
+  }
+
+  // JW狤LWnւ̕ϊs (Op[^) 𓾂
+  const GgMatrix &getExtrinsic() const
+  {
+    return extrinsic;
+  }
+
+  // ̃ZTg邩ǂׂ (g 1)
+  int getActivated() const
   {
-    return activated;
+    return activated ? 1 : 0;
   }
 };
@@ -0,0 +1,114 @@
+#include "DepthReader.h"
+
+//
+// L^fvXf[^̓ǂݍ݂ƋL^
+//
+
+// WCu
+#include <limits>
+#include <vector>
+
+// RXgN^
+DepthReader::DepthReader(const char *name, const char *texcoordName)
+  : first(0)
+  , texcoordFirst(0)
+{
+  depthSize[0] = depthSize[1] = colorSize[0] = colorSize[1] = 0;
+
+  // fvXf[^̃TCYǂݍ
+  file.open(name, std::ios::binary);
+  if (!open(file, depthSize, first)) return;
+
+  // SDK ̃eNX`W̃t@C΃J[̃TCYǂݍ
+  if (texcoordName)
+  {
+    texcoordFile.open(texcoordName, std::ios::binary);
+    open(texcoordFile, colorSize, texcoordFirst);
+  }
+}
+
+// t@C̃TCYǂݍōŏ̃t[̈ʒu߂
+bool DepthReader::open(std::ifstream &file, GLint *size, std::streamoff &first)
+{
+  if (!file.read(reinterpret_cast<char *>(size), 2 * sizeof (GLint)) || size[0] <= 0 || size[1] <= 0)
+  {
+    size[0] = size[1] = 0;
+    return false;
+  }
+  first = file.tellg();
+  return true;
+}
+
+// ̃t[ǂݍ
+bool DepthReader::read(GLushort *depth, GLfloat (*texcoord)[2], bool loop)
+{
+  if (!isOpen() || (texcoord && !hasTexcoord())) return false;
+
+  // I܂ŗ擪ɖ߂ (eNX`W̃t@Cꏏɖ߂)
+  const std::streamsize count(depthSize[0] * depthSize[1]);
+  if (file.peek() == EOF && loop)
+  {
+    file.clear();
+    file.seekg(first);
+    if (hasTexcoord())
+    {
+      texcoordFile.clear();
+      texcoordFile.seekg(texcoordFirst);
+    }
+  }
+
+  if (!file.read(reinterpret_cast<char *>(depth), count * sizeof (GLushort))) return false;
+
+  // eNX`WgȂĂfvXf[^Ɠt[ɐi߂Ă
+  if (hasTexcoord())
+  {
+    if (texcoord)
+      return !!texcoordFile.read(reinterpret_cast<char *>(texcoord), count * 2 * sizeof (GLfloat));
+    texcoordFile.seekg(count * 2 * sizeof (GLfloat), std::ios::cur);
+  }
+
+  return true;
+}
+
+//
+// fvXf[^̋L^
+//
+
+// RXgN^
+DepthRecorder::DepthRecorder(const char *name, int width, int height,
+  const char *texcoordName, int colorWidth, int colorHeight)
+  : file(name, std::ios::binary)
+  , count(width * height)
+{
+  // fvXf[^̃TCY
+  const GLint size[] = { width, height };
+  file.write(reinterpret_cast<const char *>(size), sizeof size);
+
+  // SDK ̃eNX`WL^ȂJ[̃TCY
+  if (texcoordName)
+  {
+    texcoordFile.open(texcoordName, std::ios::binary);
+    const GLint colorSize[] = { colorWidth, colorHeight };
+    texcoordFile.write(reinterpret_cast<const char *>(colorSize), sizeof colorSize);
+  }
+}
+
+// t[̃fvXf[^ǉ
+void DepthRecorder::write(const GLushort *depth, const GLfloat (*texcoord)[2])
+{
+  file.write(reinterpret_cast<const char *>(depth), count * sizeof (GLushort));
+
+  // eNX`W̃t@C̓fvXf[^Ɠt[ɂ
+  if (texcoordFile.is_open())
+  {
+    if (texcoord)
+    {
+      texcoordFile.write(reinterpret_cast<const char *>(texcoord), count * 2 * sizeof (GLfloat));
+    }
+    else
+    {
+      const std::vector<GLfloat> invalid(count * 2, -std::numeric_limits<GLfloat>::infinity());
+      texcoordFile.write(reinterpret_cast<const char *>(invalid.data()), count * 2 * sizeof (GLfloat));
+    }
+  }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+//
+// L^fvXf[^̓ǂݍ݂ƋL^
+//
+//   t@C͕ƍ (int32) ̂ƂɃt[̃fvXf[^ (GLushort, mm) ׂ
+//   SDK ̃eNX`WL^Ă, ʂ̃t@CɃJ[̕ƍ (int32) ̂Ƃ
+//   t[̃eNX`W (GLfloat  x, y  coordBuffer Ɠтɂ) ׂ
+//   OpenGL gȂ̂, ZT GPU ̂ȂłL^t[ǂݍ߂
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <fstream>
+
+//
+// L^fvXf[^̓ǂݍ
+//
+class DepthReader
+{
+  // fvXf[^ SDK ̃eNX`W̃t@C
+  std::ifstream file, texcoordFile;
+
+  // ꂼ̍ŏ̃t[̈ʒu
+  std::streamoff first, texcoordFirst;
+
+  // fvXf[^ƃJ[̃TCY
+  GLint depthSize[2], colorSize[2];
+
+  // t@C̃TCYǂݍōŏ̃t[̈ʒu߂
+  static bool open(std::ifstream &file, GLint *size, std::streamoff &first);
+
+public:
+
+  // RXgN^
+  //   name: fvXf[^̃t@C
+  //   texcoordName: SDK ̃eNX`W̃t@C (NULL Ȃǂݍ܂Ȃ)
+  DepthReader(const char *name, const char *texcoordName = NULL);
+
+  // fvXf[^̃t@CJǂ
+  bool isOpen() const
+  {
+    return depthSize[0] > 0;
+  }
+
+  // SDK ̃eNX`W̃t@CJǂ
+  bool hasTexcoord() const
+  {
+    return colorSize[0] > 0;
+  }
+
+  // fvXf[^̃TCY𓾂
+  int getDepthWidth() const
+  {
+    return depthSize[0];
+  }
+  int getDepthHeight() const
+  {
+    return depthSize[1];
+  }
+
+  // J[̃TCY𓾂 (SDK ̃eNX`W̃t@CȂ 0)
+  int getColorWidth() const
+  {
+    return colorSize[0];
+  }
+  int getColorHeight() const
+  {
+    return colorSize[1];
+  }
+
+  // ̃t[ǂݍ
+  //   depth: fvXf[^̊i[
+  //   texcoord: SDK ̃eNX`W̊i[ (NULL Ȃǂݍ܂Ȃ)
+  //   loop: I܂ŗ擪ɖ߂Ȃ true
+  //   ߂l: ǂݍ߂Ȃ false
+  bool read(GLushort *depth, GLfloat (*texcoord)[2] = NULL, bool loop = false);
+};
+
+//
+// fvXf[^̋L^
+//
+//   [xZT getDepthBuffer() Ȃǂ ReplayCamera ōĐłt@CɒǉĂ
+//   SDK ̃eNX`WꏏɋL^Ă, ColorMapper::verify() ŋL^t[gČ؂ł
+//
+class DepthRecorder
+{
+  // L^fvXf[^ SDK ̃eNX`W̃t@C
+  std::ofstream file, texcoordFile;
+
+  // fvXf[^̉f
+  int count;
+
+public:
+
+  // RXgN^
+  //   name: L^t@C
+  //   width, height: fvXf[^̃TCY
+  //   texcoordName: SDK ̃eNX`WL^t@C (NULL ȂL^Ȃ)
+  //   colorWidth, colorHeight: J[̃TCY
+  DepthRecorder(const char *name, int width, int height,
+    const char *texcoordName = NULL, int colorWidth = 0, int colorHeight = 0);
+
+  // t@CJǂ
+  bool isOpen() const
+  {
+    return file.is_open() && file.good();
+  }
+
+  // t[̃fvXf[^ǉ
+  //   texcoord: ̃fvXf[^ɑ΂ SDK ̃eNX`W (NULL Ȃ炷ׂẲfϊłȂ̂ƂċL^)
+  void write(const GLushort *depth, const GLfloat (*texcoord)[2] = NULL);
+};
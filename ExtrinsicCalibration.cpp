@@ -0,0 +1,561 @@
+#include "ExtrinsicCalibration.h"
+
+//
+// dȂ_QɂZTԂ̊Op[^̐
+//
+
+// WCu
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+// ʂ̒o
+const int planeStride(4);                               // ʂTƂɊԈf̊Ԋu
+const int planeSpan(3);                                 // @xNg߂ƂɍƂԈf̊Ԋu
+const GLfloat planeJump(0.1f);                          // @xNg߂Ȃׂ̉fƂ̉s̍̉sɑ΂䗦
+const GLfloat planeCosine(0.95f);                       // ʂƂ݂Ȃ@xNĝȂp̗]̉
+const GLfloat planeDistance(0.015f);                    // ʂƂ݂Ȃʂ̋̉s 1 m ̂Ƃ̏ (m)
+const int planeMinimum(150);                            // ʂƂ݂ȂԈf̐̉
+const int planeMaximum(8);                              // Ή镽ʂ̐̏
+
+// ʂ̑Ή
+const GLfloat pairCosine(0.87f);                        // ]߂̕ʂ̖@xNĝȂp̗]̏
+const GLfloat matchAngle(0.09f);                        // Ή̕ʂ̂Ȃp̍̏ (rad)
+const GLfloat matchCosine(0.996f);                      // Ή镽ʂ̖@xNĝȂp̗]̉
+const GLfloat matchDistance(0.05f);                     // Ή镽ʂ̋̍̏ (m)
+const GLfloat matchTie(0.9f);                           // Ή̗ǂ̔䗦ȏ̌͏lɋ߂̂I
+const GLfloat matchRotation(0.8f);                      // l̉]p̏ (rad, 藣ꂽ͎ႦƂ݂Ȃ)
+
+// ICP ɂ鍇킹
+const GLfloat calibrationDistance[] = { 0.5f, 0.1f };  // 񂲂Ƃ̑Ή_Ƃ݂Ȃ (m, e킹Ăi)
+const int calibrationPasses(2);                         // 킹މ
+const GLfloat calibrationAngle(0.35f);                  // Ή_Ƃ݂Ȃ@xNĝȂp̏ (rad)
+const int calibrationIterations[] = { 20, 20, 30 };     // iƂ̌JԂ̉񐔂̏ (ׂi)
+const int calibrationInliers(2000);                     // łƂ݂ȂΉ_̐̉
+const GLfloat calibrationError(0.03f);                  // łƂ݂Ȃ_Ɩʂ̋̓敽ϕ̏ (m)
+
+namespace
+{
+  // 3 vf̃xNg̓
+  inline GLfloat dot(const GLfloat *a, const GLfloat *b)
+  {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+  // 3 vf̃xNg̊O
+  inline void cross(const GLfloat *a, const GLfloat *b, GLfloat *c)
+  {
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  // 3 vf̃xNg𐳋K ( 0 Ȃ false)
+  inline bool normalize(GLfloat *a)
+  {
+    const GLfloat l(std::sqrt(dot(a, a)));
+    if (l <= 0.0f) return false;
+    a[0] /= l;
+    a[1] /= l;
+    a[2] /= l;
+    return true;
+  }
+
+  // Ώ̍s a (3x3) ̍ŏ̌ŗLľŗLxNg v  Jacobi @ŋ߂
+  void smallestEigenvector(const double *a, GLfloat *v)
+  {
+    double m[9], e[9] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    std::copy(a, a + 9, m);
+
+    for (int sweep = 0; sweep < 16; ++sweep)
+    {
+      // Ίp\ΏI
+      const double off(m[1] * m[1] + m[2] * m[2] + m[5] * m[5]);
+      if (off < 1.0e-24) break;
+
+      // Ίp (p, q) ɏ
+      static const int pq[][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+      for (int k = 0; k < 3; ++k)
+      {
+        const int p(pq[k][0]), q(pq[k][1]);
+        const double apq(m[p * 3 + q]);
+        if (std::fabs(apq) < 1.0e-300) continue;
+
+        // ]p
+        const double theta((m[q * 3 + q] - m[p * 3 + p]) / (2.0 * apq));
+        const double t((theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0)));
+        const double c(1.0 / std::sqrt(t * t + 1.0)), s(t * c);
+
+        // m  J^T m J, e  e J
+        for (int i = 0; i < 3; ++i)
+        {
+          const double mip(m[i * 3 + p]), miq(m[i * 3 + q]);
+          m[i * 3 + p] = c * mip - s * miq;
+          m[i * 3 + q] = s * mip + c * miq;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+          const double mpi(m[p * 3 + i]), mqi(m[q * 3 + i]);
+          m[p * 3 + i] = c * mpi - s * mqi;
+          m[q * 3 + i] = s * mpi + c * mqi;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+          const double eip(e[i * 3 + p]), eiq(e[i * 3 + q]);
+          e[i * 3 + p] = c * eip - s * eiq;
+          e[i * 3 + q] = s * eip + c * eiq;
+        }
+      }
+    }
+
+    // ŏ̌ŗLl̗
+    int k(0);
+    if (m[4] < m[k * 4]) k = 1;
+    if (m[8] < m[k * 4]) k = 2;
+    for (int i = 0; i < 3; ++i) v[i] = GLfloat(e[i * 3 + k]);
+  }
+
+  // ̒PʃxNg a, b 琳K (񂲂Ƃɕׂ 3x3 s, b  a ƕsłȂ)
+  void makeFrame(const GLfloat *a, const GLfloat *b, GLfloat *f)
+  {
+    GLfloat e1[3] = { a[0], a[1], a[2] };
+    const GLfloat ab(dot(a, b));
+    GLfloat e2[3] = { b[0] - ab * a[0], b[1] - ab * a[1], b[2] - ab * a[2] };
+    normalize(e2);
+    GLfloat e3[3];
+    cross(e1, e2, e3);
+    for (int r = 0; r < 3; ++r)
+    {
+      f[r * 3 + 0] = e1[r];
+      f[r * 3 + 1] = e2[r];
+      f[r * 3 + 2] = e3[r];
+    }
+  }
+
+  // 3 Aꎟ a x = b  (a  b ͉)
+  bool solve3(double *a, double *b)
+  {
+    const int n(3);
+    for (int k = 0; k < n; ++k)
+    {
+      // s{bgI
+      int p(k);
+      for (int i = k + 1; i < n; ++i) if (std::fabs(a[i * n + k]) > std::fabs(a[p * n + k])) p = i;
+      if (std::fabs(a[p * n + k]) < 1.0e-300) return false;
+      if (p != k)
+      {
+        for (int j = 0; j < n; ++j) std::swap(a[k * n + j], a[p * n + j]);
+        std::swap(b[k], b[p]);
+      }
+
+      // Oi
+      for (int i = k + 1; i < n; ++i)
+      {
+        const double f(a[i * n + k] / a[k * n + k]);
+        for (int j = k; j < n; ++j) a[i * n + j] -= f * a[k * n + j];
+        b[i] -= f * b[k];
+      }
+    }
+
+    // ޑ
+    for (int k = n - 1; k >= 0; --k)
+    {
+      for (int j = k + 1; j < n; ++j) b[k] -= a[k * n + j] * b[j];
+      b[k] /= a[k * n + k];
+    }
+
+    return true;
+  }
+}
+
+// RXgN^
+ExtrinsicCalibration::ExtrinsicCalibration(int width, int height)
+  : width(width)
+  , height(height)
+  , reference(width * height * 3)
+  , target(width * height * 3)
+  , referenceNormal(width * height * 3)
+  , referenceNormalCalculate(width, height)
+  , targetNormalCalculate(width, height)
+  , icp(width, height, 3)
+  , initial(ggIdentity())
+  , relative(ggIdentity())
+  , busy(false)
+  , ready(false)
+{
+  // ̌o߂ɂ
+  const Result empty = { 0, 0, 0, { 0, 0, 0.0f, false, 0.0f }, false, 0.0f };
+  result = empty;
+
+  // Op[^͑傫Ă邱Ƃ̂, ICP ̌JԂ̉񐔂𑽂
+  for (int i = 0; i < icp.getLevels(); ++i) icp.setIterations(i, calibrationIterations[i]);
+
+  // _ʒu͂
+  referenceNormalCalculate.setInput(0, reference.data());
+  targetNormalCalculate.setInput(0, target.data());
+}
+
+// fXgN^
+ExtrinsicCalibration::~ExtrinsicCalibration()
+{
+  // 蒆ȂÎ҂
+  if (thread.joinable()) thread.join();
+}
+
+// [JXbhŐn߂
+bool ExtrinsicCalibration::start(const GLfloat (*reference)[3], const GLfloat (*target)[3], const GgMatrix &initial)
+{
+  if (busy) return false;
+
+  // O̐̃[JXbhЕt
+  if (thread.joinable()) thread.join();
+
+  // 蒆Ɏ擾ił悤ɒ_ʒu𕡐
+  std::copy(reference[0], reference[0] + width * height * 3, this->reference.begin());
+  std::copy(target[0], target[0] + width * height * 3, this->target.begin());
+  this->initial = initial;
+
+  // [JXbhN
+  busy = true;
+  ready = false;
+  thread = std::thread(&ExtrinsicCalibration::run, this);
+
+  return true;
+}
+
+// V茋ʂ𓾂
+bool ExtrinsicCalibration::getResult(GgMatrix &relative)
+{
+  if (busy || !ready.exchange(false) || !result.valid) return false;
+  relative = this->relative;
+  return true;
+}
+
+// 肷
+void ExtrinsicCalibration::run()
+{
+  // ɂ鎞Ԃ̌vJn
+  const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+  // ʂ𔲂ođΉ, l߂
+  std::vector<Plane> referencePlane, targetPlane;
+  extractPlanes(reference.data(), referencePlane);
+  extractPlanes(target.data(), targetPlane);
+  GgMatrix pose(initial);
+  result.referencePlanes = int(referencePlane.size());
+  result.targetPlanes = int(targetPlane.size());
+  result.matchedPlanes = matchPlanes(referencePlane, targetPlane, pose);
+
+  // @xNg, ̃ZŤvłȂ_̓fɊ܂߂Ȃ
+  const std::vector<GLfloat> &normal(referenceNormalCalculate.calculate()[0]);
+  for (int i = 0; i < width * height; ++i)
+  {
+    const bool valid(reference[i * 3 + 2] >= depthInvalid);
+    for (int c = 0; c < 3; ++c) referenceNormal[i * 3 + c] = valid ? normal[i * 3 + c] : 0.0f;
+  }
+  targetNormalCalculate.calculate();
+
+  // ̃JW[hWƂ, Ώۂ̓_Q̓_Qɍ킹
+  icp.setModel(reinterpret_cast<const GLfloat (*)[3]>(reference.data()),
+    reinterpret_cast<const GLfloat (*)[3]>(referenceNormal.data()), ggIdentity());
+  //   ʂŌ܂Ȃ̕sړ͏l̂܂܂Ȃ̂, Ή_Ƃ݂ȂLƂđe킹Ăi
+  GgMatrix view(pose.invert());
+  bool tracked(false);
+  for (int pass = 0; pass < calibrationPasses; ++pass)
+  {
+    icp.setParameter(calibrationDistance[pass], calibrationAngle);
+    tracked = icp.track(reinterpret_cast<const GLfloat (*)[3]>(target.data()),
+      reinterpret_cast<const GLfloat (*)[3]>(targetNormalCalculate.getBuffer()[0].data()), view);
+  }
+
+  // đΉ_\덷ΐłƂ (ʂŌ܂ȂɊĂΎȂ)
+  result.icp = icp.getResult(0);
+  result.valid = tracked && result.icp.converged
+    && result.icp.inliers >= calibrationInliers && result.icp.error <= calibrationError;
+  if (result.valid) relative = view.invert();
+
+  // ɂ
+  result.time = GLfloat(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+  // 茋ʂo悤ɂ
+  ready = true;
+  busy = false;
+}
+
+// _ʒủ摜畽ʂ𔲂ođ傫ɕׂ
+void ExtrinsicCalibration::extractPlanes(const GLfloat *point, std::vector<Plane> &plane) const
+{
+  plane.clear();
+
+  // Ԉf̉摜̃TCY
+  const int w(width / planeStride), h(height / planeStride), count(w * h);
+
+  // Ԉf̒_ʒu
+  std::vector<GLfloat> p(count * 3);
+  std::vector<GLubyte> valid(count);
+  for (int j = 0; j < h; ++j)
+  {
+    for (int i = 0; i < w; ++i)
+    {
+      const GLfloat *const q(point + ((j * planeStride + planeStride / 2) * width + i * planeStride + planeStride / 2) * 3);
+      std::copy(q, q + 3, &p[(j * w + i) * 3]);
+      valid[j * w + i] = q[2] >= depthInvalid;
+    }
+  }
+
+  // ㉺E planeSpan ꂽf̍̊OςŖ@xNg߂ (s傫ςƂ͋߂ 0 ɂ)
+  std::vector<GLfloat> n(count * 3, 0.0f);
+  for (int j = planeSpan; j < h - planeSpan; ++j)
+  {
+    for (int i = planeSpan; i < w - planeSpan; ++i)
+    {
+      const int k(j * w + i), dk(planeSpan), dw(planeSpan * w);
+      if (!valid[k] || !valid[k - dk] || !valid[k + dk] || !valid[k - dw] || !valid[k + dw]) continue;
+
+      const GLfloat *const c(&p[k * 3]);
+      const GLfloat *const l(&p[(k - dk) * 3]), *const r(&p[(k + dk) * 3]);
+      const GLfloat *const b(&p[(k - dw) * 3]), *const t(&p[(k + dw) * 3]);
+      const GLfloat jump(planeJump * std::fabs(c[2]));
+      if (std::fabs(r[2] - c[2]) > jump || std::fabs(l[2] - c[2]) > jump
+        || std::fabs(t[2] - c[2]) > jump || std::fabs(b[2] - c[2]) > jump) continue;
+
+      const GLfloat dx[] = { r[0] - l[0], r[1] - l[1], r[2] - l[2] };
+      const GLfloat dy[] = { t[0] - b[0], t[1] - b[1], t[2] - b[2] };
+      GLfloat *const m(&n[k * 3]);
+      cross(dx, dy, m);
+      if (!normalize(m)) continue;
+
+      // ZTɌ
+      if (dot(m, c) > 0.0f)
+      {
+        m[0] = -m[0];
+        m[1] = -m[1];
+        m[2] = -m[2];
+      }
+    }
+  }
+
+  // @xNgĂĕʂ痣ĂȂׂ̉fɗ̈L
+  std::vector<GLubyte> labeled(count, 0);
+  std::vector<int> stack;
+  for (int seed = 0; seed < count; ++seed)
+  {
+    if (labeled[seed] || dot(&n[seed * 3], &n[seed * 3]) == 0.0f) continue;
+
+    // ̖̈@xNg̘aƒ_ʒu̘aƓ񎟂̃[g
+    double normalSum[3] = { 0.0, 0.0, 0.0 }, pointSum[3] = { 0.0, 0.0, 0.0 }, moment[9] = { 0.0 };
+    int size(0);
+
+    stack.assign(1, seed);
+    labeled[seed] = 1;
+    while (!stack.empty())
+    {
+      const int k(stack.back());
+      stack.pop_back();
+
+      // ̈ɉ
+      const GLfloat *const q(&p[k * 3]);
+      for (int a = 0; a < 3; ++a)
+      {
+        normalSum[a] += n[k * 3 + a];
+        pointSum[a] += q[a];
+        for (int b = 0; b < 3; ++b) moment[a * 3 + b] += double(q[a]) * double(q[b]);
+      }
+      ++size;
+
+      // ̗̈̕
+      GLfloat rn[3] = { GLfloat(normalSum[0]), GLfloat(normalSum[1]), GLfloat(normalSum[2]) };
+      normalize(rn);
+      const GLfloat rc[3] = { GLfloat(pointSum[0] / size), GLfloat(pointSum[1] / size), GLfloat(pointSum[2] / size) };
+
+      // ㉺Ẻf
+      const int i(k % w), j(k / w);
+      const int neighbor[] = { i > 0 ? k - 1 : -1, i < w - 1 ? k + 1 : -1, j > 0 ? k - w : -1, j < h - 1 ? k + w : -1 };
+      for (int e = 0; e < 4; ++e)
+      {
+        const int m(neighbor[e]);
+        if (m < 0 || labeled[m]) continue;
+
+        const GLfloat *const nm(&n[m * 3]), *const pm(&p[m * 3]);
+        if (dot(nm, rn) < planeCosine) continue;
+        const GLfloat d[] = { pm[0] - rc[0], pm[1] - rc[1], pm[2] - rc[2] };
+        if (std::fabs(dot(d, rn)) > planeDistance * std::fabs(pm[2])) continue;
+
+        labeled[m] = 1;
+        stack.push_back(m);
+      }
+    }
+
+    // ͎̈gȂ
+    if (size < planeMinimum) continue;
+
+    // _ʒűUs̍ŏ̌ŗLľŗLxNg@xNgɂ
+    double covariance[9];
+    for (int a = 0; a < 3; ++a)
+      for (int b = 0; b < 3; ++b)
+        covariance[a * 3 + b] = moment[a * 3 + b] / size - pointSum[a] * pointSum[b] / (double(size) * double(size));
+    Plane f;
+    smallestEigenvector(covariance, f.normal);
+    if (f.normal[0] * normalSum[0] + f.normal[1] * normalSum[1] + f.normal[2] * normalSum[2] < 0.0)
+    {
+      f.normal[0] = -f.normal[0];
+      f.normal[1] = -f.normal[1];
+      f.normal[2] = -f.normal[2];
+    }
+    f.offset = -GLfloat((f.normal[0] * pointSum[0] + f.normal[1] * pointSum[1] + f.normal[2] * pointSum[2]) / size);
+    f.count = size;
+    plane.push_back(f);
+  }
+
+  // 傫ɕׂď̐c
+  std::sort(plane.begin(), plane.end(), [](const Plane &a, const Plane &b) { return a.count > b.count; });
+  if (int(plane.size()) > planeMaximum) plane.resize(planeMaximum);
+}
+
+// ʂΉđΏۂ̃JW̃JWւ̕ϊ̏l߂
+int ExtrinsicCalibration::matchPlanes(const std::vector<Plane> &referencePlane, const std::vector<Plane> &targetPlane,
+  GgMatrix &pose) const
+{
+  // ^l̉]ƕsړ
+  const GLfloat *const m0(pose.get());
+  const GLfloat t0[] = { m0[12], m0[13], m0[14] };
+
+  // ̕ϊ (]͍s) ƑΉ̗ǂƏl̊u
+  struct Candidate
+  {
+    GLfloat rotation[9], translation[3];
+    double score, distance;
+    int matched;
+  };
+  std::vector<Candidate> candidate;
+
+  const int nr(int(referencePlane.size())), nt(int(targetPlane.size()));
+  for (int i = 0; i < nt; ++i)
+  {
+    for (int j = i + 1; j < nt; ++j)
+    {
+      // ]߂̈قȂΏۂ̓̕
+      const GLfloat *const ti(targetPlane[i].normal), *const tj(targetPlane[j].normal);
+      const GLfloat ct(dot(ti, tj));
+      if (std::fabs(ct) > pairCosine) continue;
+      GLfloat ft[9];
+      makeFrame(ti, tj, ft);
+
+      for (int k = 0; k < nr; ++k)
+      {
+        for (int l = 0; l < nr; ++l)
+        {
+          // Ȃp炢̊̓̕
+          if (k == l) continue;
+          const GLfloat *const rk(referencePlane[k].normal), *const rl(referencePlane[l].normal);
+          const GLfloat cr(dot(rk, rl));
+          if (std::fabs(std::acos((std::max)(-1.0f, (std::min)(1.0f, cr))) - std::acos((std::max)(-1.0f, (std::min)(1.0f, ct)))) > matchAngle)
+            continue;
+
+          // Ώۂ̓̕ʂ̖@xNg̓̕ʂ̖@xNgɏd˂]
+          GLfloat fr[9];
+          makeFrame(rk, rl, fr);
+          Candidate c;
+          for (int r = 0; r < 3; ++r)
+            for (int s = 0; s < 3; ++s)
+              c.rotation[r * 3 + s] = fr[r * 3 + 0] * ft[s * 3 + 0] + fr[r * 3 + 1] * ft[s * 3 + 1] + fr[r * 3 + 2] * ft[s * 3 + 2];
+
+          // ]Ώۂ̕ʂ̖@xNgɍł߂̕ʂΉ
+          std::vector<int> match(nt, -1);
+          for (int a = 0; a < nt; ++a)
+          {
+            const GLfloat *const na(targetPlane[a].normal);
+            const GLfloat rn[] =
+            {
+              dot(c.rotation + 0, na),
+              dot(c.rotation + 3, na),
+              dot(c.rotation + 6, na)
+            };
+            GLfloat best(matchCosine);
+            for (int b = 0; b < nr; ++b)
+            {
+              const GLfloat cb(dot(rn, referencePlane[b].normal));
+              if (cb >= best)
+              {
+                best = cb;
+                match[a] = b;
+              }
+            }
+          }
+
+          // Ήʂ̋̍ (nrEt = offset_t - offset_r) 畽sړŏ@ŋ߂
+          //   ʂ肸Ɍ܂Ȃ͏lɋ߂Â
+          double a[9] = { 0.0 }, b[3] = { 0.0 }, weight(0.0);
+          for (int e = 0; e < nt; ++e)
+          {
+            if (match[e] < 0) continue;
+            const Plane &pr(referencePlane[match[e]]), &pt(targetPlane[e]);
+            const double w((std::min)(pr.count, pt.count));
+            const double d(pt.offset - pr.offset);
+            for (int r = 0; r < 3; ++r)
+            {
+              for (int s = 0; s < 3; ++s) a[r * 3 + s] += w * pr.normal[r] * pr.normal[s];
+              b[r] += w * pr.normal[r] * d;
+            }
+            weight += w;
+          }
+          const double lambda(weight * 1.0e-3);
+          for (int r = 0; r < 3; ++r)
+          {
+            a[r * 4] += lambda;
+            b[r] += lambda * t0[r];
+          }
+          if (!solve3(a, b)) continue;
+          for (int r = 0; r < 3; ++r) c.translation[r] = GLfloat(b[r]);
+
+          // ̍Ή𐔂
+          c.score = 0.0;
+          c.matched = 0;
+          for (int e = 0; e < nt; ++e)
+          {
+            if (match[e] < 0) continue;
+            const Plane &pr(referencePlane[match[e]]), &pt(targetPlane[e]);
+            if (std::fabs(dot(pr.normal, c.translation) - (pt.offset - pr.offset)) > matchDistance) continue;
+            c.score += (std::min)(pr.count, pt.count);
+            ++c.matched;
+          }
+          if (c.matched < 2) continue;
+
+          // l̊u (]pƕsړ̘̋a), ]ꂷĂΎgȂ
+          GLfloat trace(0.0f);
+          for (int r = 0; r < 3; ++r) trace += c.rotation[r * 3 + 0] * m0[r] + c.rotation[r * 3 + 1] * m0[4 + r] + c.rotation[r * 3 + 2] * m0[8 + r];
+          const GLfloat angle(std::acos((std::max)(-1.0f, (std::min)(1.0f, (trace - 1.0f) * 0.5f))));
+          if (angle > matchRotation) continue;
+          const GLfloat dt[] = { c.translation[0] - t0[0], c.translation[1] - t0[1], c.translation[2] - t0[2] };
+          c.distance = angle + std::sqrt(dot(dt, dt));
+
+          candidate.push_back(c);
+        }
+      }
+    }
+  }
+  if (candidate.empty()) return 0;
+
+  // Ή̗ǂłǂ̂ɋ߂̂lɍł߂̂I (Ώ̂ȏʂ̎Ⴆ)
+  double best(0.0);
+  for (size_t i = 0; i < candidate.size(); ++i) best = (std::max)(best, candidate[i].score);
+  const Candidate *chosen(NULL);
+  for (size_t i = 0; i < candidate.size(); ++i)
+  {
+    if (candidate[i].score < best * matchTie) continue;
+    if (!chosen || candidate[i].distance < chosen->distance) chosen = &candidate[i];
+  }
+
+  // 񂲂Ƃɕׂϊsɂ
+  GLfloat m[16];
+  for (int r = 0; r < 3; ++r)
+  {
+    for (int s = 0; s < 3; ++s) m[s * 4 + r] = chosen->rotation[r * 3 + s];
+    m[12 + r] = chosen->translation[r];
+    m[r * 4 + 3] = 0.0f;
+  }
+  m[15] = 1.0f;
+  pose = GgMatrix(m);
+
+  return chosen->matched;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+//
+// dȂ_QɂZTԂ̊Op[^̐
+//
+//   ̃ZT̂قړ̓_Q炻ꂼꕽʂ𔲂ođΉ, ΓIȈʒuƌ̏l߂Ă
+//   CpuIcp œ_Ɩʂ̋ō킹 (_gȂ)
+//   ʂ͊Ԉf̖@xNg̈Lċ, ̈قȂg̕ʂ̑Ή],
+//   ΉׂĂ̕ʂ̋畽sړ߂ (ʂ肸Ɍ܂Ȃ̕sړ͗^lɋ߂Â)
+//   ICP ͑Ή_Ƃ݂ȂLƂđe킹Ăi, ȂΐłȂƂ
+//   ̓[JXbhōŝ, 肵ĂԂZT̎擾ƕ`𑱂
+//
+
+// ICP ɂfvXZT̈ʒuƌ̐
+#include "Icp.h"
+
+// CPU ɂ摜
+#include "CpuCalculate.h"
+
+// WCu
+#include <thread>
+#include <atomic>
+
+class ExtrinsicCalibration
+{
+public:
+
+  // ̌o
+  struct Result
+  {
+    // ƑΏۂ̃ZT̓_Q甲oʂ̐
+    int referencePlanes, targetPlanes;
+
+    // l߂̂ɑΉʂ̐ (0 Ȃ^l獇킹)
+    int matchedPlanes;
+
+    // łׂi ICP ̌
+    CpuIcp::Result icp;
+
+    // łǂ
+    bool valid;
+
+    // ɂ (ʂ̒o獇킹݂܂, ms)
+    GLfloat time;
+  };
+
+private:
+
+  //  (normalEx + offset = 0, @xNg̓ZTɌ)
+  struct Plane
+  {
+    // @xNgƌ_̕t
+    GLfloat normal[3], offset;
+
+    // ʂɊ܂܂Ԉf̐
+    int count;
+  };
+
+  // _Q̉摜̃TCY
+  const int width, height;
+
+  // ƑΏۂ̃ZT̒_ʒu (蒆Ɏ擾ił悤ɕ)
+  std::vector<GLfloat> reference, target;
+
+  // ̃ZŤvłȂ_̖@xNg 0 ɂ
+  std::vector<GLfloat> referenceNormal;
+
+  // ƑΏۂ̃ZT̒_ʒu@xNg߂
+  CpuNormal referenceNormalCalculate, targetNormalCalculate;
+
+  // _Ɩʂ̋ō킹
+  CpuIcp icp;
+
+  // Ώۂ̃JW̃JWւ̕ϊ̏lƐl
+  GgMatrix initial, relative;
+
+  // O̐̌o
+  Result result;
+
+  // [JXbh
+  std::thread thread;
+
+  // 蒆ǂƎoĂȂ茋ʂ邩ǂ
+  std::atomic<bool> busy, ready;
+
+  // 肷 ([JXbh)
+  void run();
+
+  // _ʒủ摜畽ʂ𔲂ođ傫ɕׂ
+  void extractPlanes(const GLfloat *point, std::vector<Plane> &plane) const;
+
+  // ʂΉđΏۂ̃JW̃JWւ̕ϊ̏l߂
+  //   pose: ^l, ΉƂ΂Œu
+  //   ߂l: Ήʂ̐ (ΉƂȂ 0)
+  int matchPlanes(const std::vector<Plane> &referencePlane, const std::vector<Plane> &targetPlane, GgMatrix &pose) const;
+
+  // Rs[RXgN^ (Rs[֎~)
+  ExtrinsicCalibration(const ExtrinsicCalibration &o);
+
+  //  (֎~)
+  ExtrinsicCalibration &operator=(const ExtrinsicCalibration &o);
+
+public:
+
+  // RXgN^
+  //   width, height: _Q̉摜̃TCY (̃ZTœɂ)
+  ExtrinsicCalibration(int width, int height);
+
+  // fXgN^
+  virtual ~ExtrinsicCalibration();
+
+  // [JXbhŐn߂
+  //   reference, target: ƑΏۂ̃ZT̂قړ̒_ʒu (JW, getPointBuffer())
+  //   initial: Ώۂ̃JW̃JWւ̕ϊ̏l (̊Op[^狁߂)
+  //   ߂l: 蒆Ȃn߂ false
+  bool start(const GLfloat (*reference)[3], const GLfloat (*target)[3], const GgMatrix &initial);
+
+  // 蒆ǂׂ
+  bool isBusy() const
+  {
+    return busy;
+  }
+
+  // V茋ʂ𓾂
+  //   relative: łĂΑΏۂ̃JW̃JWւ̕ϊsi[
+  //   ߂l: oĂȂ茋ʂ, łĂ true (o玟̐肪I܂ false)
+  bool getResult(GgMatrix &relative);
+
+  // O̐̌o߂𓾂 (蒆͎gȂ)
+  const Result &getLastResult() const
+  {
+    return result;
+  }
+};
@@ -0,0 +1,149 @@
+#include "FlyingPixel.h"
+
+//
+// tCOsNZ̏
+//
+
+// WCu
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <emmintrin.h>
+
+namespace
+{
+  // ׂ̃fvXl n1, n2 Ƃ t ȏ㗣, d ̊Ԃɂf߂
+  inline __m128 between(__m128 n1, __m128 n2, __m128 d, __m128 t)
+  {
+    const __m128 zero(_mm_setzero_ps());
+    const __m128 sign(_mm_set1_ps(-0.0f));
+    const __m128 a(_mm_sub_ps(n1, d));
+    const __m128 b(_mm_sub_ps(n2, d));
+    const __m128 valid(_mm_and_ps(_mm_cmpgt_ps(n1, zero), _mm_cmpgt_ps(n2, zero)));
+    const __m128 opposite(_mm_cmplt_ps(_mm_mul_ps(a, b), zero));
+    const __m128 far(_mm_cmpgt_ps(_mm_min_ps(_mm_andnot_ps(sign, a), _mm_andnot_ps(sign, b)), t));
+    return _mm_and_ps(_mm_and_ps(valid, opposite), far);
+  }
+
+  // A 4 f̃fvXlǂݍ
+  inline __m128 load4(const GLushort *p)
+  {
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128()));
+  }
+
+  // fɂėׂ̊Ԃɂ邩ׂ
+  inline bool between(int n1, int n2, int d, GLfloat t)
+  {
+    const int a(n1 - d), b(n2 - d);
+    return n1 > 0 && n2 > 0 && ((a < 0 && b > 0) || (a > 0 && b < 0))
+      && GLfloat(abs(a)) > t && GLfloat(abs(b)) > t;
+  }
+}
+
+// RXgN^
+FlyingPixel::FlyingPixel(int width, int height)
+  : pass(width, height, "flying.frag", 1, 1, GL_R32F)
+  , ratio(0.0f)
+{
+  // 臒l̔䗦 uniform ϐ̏ꏊ
+  ratioLoc = glGetUniformLocation(pass.get(), "ratio");
+}
+
+// fvXf[^̃eNX`tCOsNZ, ʂ̃eNX`Ԃ
+GLuint FlyingPixel::filter(GLuint depth) const
+{
+  // p[^ݒ肷
+  pass.use();
+  glUniform1f(ratioLoc, ratio);
+
+  // fvXf[^͂
+  glUniform1i(0, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, depth);
+
+  // tCOsNZ
+  return pass.calculate()[0];
+}
+
+// CPU ɂ鏜̃RXgN^
+CpuFlyingPixel::CpuFlyingPixel(int width, int height)
+  : CpuCalculate(width, height, 1, 0)
+  , depth(width * height)
+  , removed(height)
+  , ratio(0.0f)
+{
+}
+
+// s [begin, end) ̌vZs
+void CpuFlyingPixel::kernel(int begin, int end)
+{
+  const GLushort *const data(static_cast<const GLushort *>(input[0]));
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 r(_mm_set1_ps(ratio));
+
+  for (int v = begin; v < end; ++v)
+  {
+    // ̍sƏ㉺̍s
+    const GLushort *const c(data + v * width);
+    GLushort *const o(depth.data() + v * width);
+    memcpy(o, c, width * sizeof (GLushort));
+    removed[v] = 0;
+
+    // 摜̏㉺̒[̍s͂̂܂܂ɂ
+    if (v == 0 || v == height - 1) continue;
+    const GLushort *const b(c - width);
+    const GLushort *const t(c + width);
+
+    // 4 fׂ (E̒[̉f͏)
+    int u(1);
+    for (; u + 5 <= width; u += 4)
+    {
+      const __m128 d(load4(c + u));
+      const __m128 th(_mm_mul_ps(r, d));
+
+      // , c, ̎΂߂̂ꂩŗׂ̊Ԃɂf
+      const __m128 flying(_mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_or_ps(
+        _mm_or_ps(between(load4(c + u - 1), load4(c + u + 1), d, th), between(load4(b + u), load4(t + u), d, th)),
+        _mm_or_ps(between(load4(b + u - 1), load4(t + u + 1), d, th), between(load4(b + u + 1), load4(t + u - 1), d, th)))));
+
+      // tCOsNZ͌vłȂfɂ
+      const int m(_mm_movemask_ps(flying));
+      if (m == 0) continue;
+      for (int k = 0; k < 4; ++k)
+      {
+        if (m & (1 << k))
+        {
+          o[u + k] = 0;
+          ++removed[v];
+        }
+      }
+    }
+
+    // c̉f
+    for (; u < width - 1; ++u)
+    {
+      const int d(c[u]);
+      const GLfloat th(ratio * GLfloat(d));
+      if (d > 0 && (between(c[u - 1], c[u + 1], d, th) || between(b[u], t[u], d, th)
+        || between(b[u - 1], t[u + 1], d, th) || between(b[u + 1], t[u - 1], d, th)))
+      {
+        o[u] = 0;
+        ++removed[v];
+      }
+    }
+  }
+}
+
+// fvXf[^tCOsNZ, fvXlԂ
+const GLushort *CpuFlyingPixel::filter(const GLushort *data)
+{
+  setInput(0, data);
+  calculate();
+  return depth.data();
+}
+
+// Oɏf𓾂
+int CpuFlyingPixel::getRemoved() const
+{
+  return std::accumulate(removed.begin(), removed.end(), 0);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+//
+// tCOsNZ̏
+//
+//   TOF ̃ZTł͉s̕sAȕɎOƉ̒Ԃ̃fvXl̉f (tCOsNZ) 
+//   , c, ̎΂߂̂ꂩ̕, ׂ̉f̃fvXlƂ臒lȏ㗣,
+//   ̉f̃fvXlׂ̊Ԃɂ, tCOsNZƂ݂ȂČvłȂf (0) ɂ
+//   臒l̓fvXlɔႳ (ratio * d)
+//   ̑Ă镨̗̂֊s̉f, ׂOɂׂ̂̉f͎c
+//   摜̒[̉f͂̂܂܂ɂ
+//
+
+// 摜
+#include "Calculate.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂ鏜 (flying.frag)
+//
+//   vZʂ̃eNX` R32F , ͂fvX̃eNX` R ƓPʂ̒l
+//
+class FlyingPixel
+{
+  // ɎgvZ
+  const Calculate pass;
+
+  // 臒l̔䗦 uniform ϐ̏ꏊ
+  GLint ratioLoc;
+
+  // 臒l̃fvXlɑ΂䗦
+  GLfloat ratio;
+
+  // Rs[RXgN^ (Rs[֎~)
+  FlyingPixel(const FlyingPixel &o);
+
+  //  (֎~)
+  FlyingPixel &operator=(const FlyingPixel &o);
+
+public:
+
+  // RXgN^
+  FlyingPixel(int width, int height);
+
+  // fXgN^
+  virtual ~FlyingPixel() {}
+
+  // 臒l̃fvXlɑ΂䗦ݒ肷
+  void setParameter(GLfloat ratio)
+  {
+    this->ratio = ratio;
+  }
+
+  // fvXf[^̃eNX`tCOsNZ, ʂ̃eNX`Ԃ
+  GLuint filter(GLuint depth) const;
+};
+
+//
+// CPU ɂ鏜 (flying.frag ƓvZ)
+//
+//    0: fvXf[^ (GLushort, mm)
+//
+class CpuFlyingPixel : public CpuCalculate
+{
+  // tCOsNZfvXl
+  std::vector<GLushort> depth;
+
+  // sƂ̏f
+  std::vector<int> removed;
+
+  // 臒l̃fvXlɑ΂䗦
+  GLfloat ratio;
+
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuFlyingPixel(int width, int height);
+
+  // 臒l̃fvXlɑ΂䗦ݒ肷
+  void setParameter(GLfloat ratio)
+  {
+    this->ratio = ratio;
+  }
+
+  // fvXf[^tCOsNZ, fvXlԂ
+  const GLushort *filter(const GLushort *data);
+
+  // Oɏf𓾂
+  int getRemoved() const;
+};
@@ -0,0 +1,351 @@
+#include "HashedTsdf.h"
+
+//
+// {NZnbVɂa TSDF
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+// xɏs
+const int rowGrain(8);
+
+// xɏubN
+const int brickGrain(16);
+
+// L[ɋlߍރubN̈ʒü̎̃rbgƕ̈ʒu𐳂ɂ邽߂̉
+const int keyBits(21);
+const int keyBias(1 << (keyBits - 1));
+const GLuint64 keyMask((GLuint64(1) << keyBits) - 1);
+
+// OɏW߂L[oĂ (2 ׂ̂)
+const int recentSize(64);
+
+// ubN̃ ({NZ, L[, t[ԍ, XV, Xg, 󂫃Xg, nbV\̍ő 4 vf)
+const size_t brickBytes(sizeof(CpuTsdfBase::Voxel) * CpuTsdfBase::brickVoxels
+  + sizeof(GLuint64) + sizeof(GLuint) * 2 + sizeof(int) * 3 + (sizeof(GLuint64) + sizeof(int)) * 4);
+
+namespace
+{
+  // vf 2 {ȏɂȂ 2 ׂ̂̎w߂
+  int getTableBits(int count)
+  {
+    int bits(1);
+    while ((size_t(1) << bits) < size_t(count) * 2) ++bits;
+    return bits;
+  }
+}
+
+// RXgN^
+CpuHashedTsdf::CpuHashedTsdf(int depthWidth, int depthHeight, GLfloat voxelSize, size_t memoryBudget)
+  : CpuTsdfBase(depthWidth, depthHeight, voxelSize)
+  , capacity(int((std::max)(memoryBudget / brickBytes, size_t(1))))
+  , pool(size_t(capacity) * brickVoxels)
+  , brickKey(capacity)
+  , lastUsed(capacity)
+  , prev(capacity)
+  , next(capacity)
+  , tableBits(getTableBits(capacity))
+  , tableKey(size_t(1) << tableBits)
+  , tableBrick(size_t(1) << tableBits)
+  , request((depthHeight + rowGrain - 1) / rowGrain)
+{
+  brickVersion.resize(capacity);
+  freeList.reserve(capacity);
+  reset();
+}
+
+// {[ɂ
+void CpuHashedTsdf::reset()
+{
+  // ׂẴubNgĂȂƂɂ ({NZ͊mۂƂɋɂ)
+  std::fill(brickKey.begin(), brickKey.end(), GLuint64(emptyKey));
+  std::fill(lastUsed.begin(), lastUsed.end(), 0);
+  std::fill(brickVersion.begin(), brickVersion.end(), ++version);
+  std::fill(prev.begin(), prev.end(), -1);
+  std::fill(next.begin(), next.end(), -1);
+  head = tail = -1;
+  freeList.clear();
+  for (int brick = capacity - 1; brick >= 0; --brick) freeList.push_back(brick);
+
+  // nbV\ɂ
+  std::fill(tableKey.begin(), tableKey.end(), GLuint64(emptyKey));
+
+  frame = 0;
+  visible.clear();
+  evicted = dropped = 0;
+}
+
+// ubN̈ʒulߍ񂾃L[
+GLuint64 CpuHashedTsdf::makeKey(int x, int y, int z)
+{
+  return ((GLuint64(x + keyBias) & keyMask) << (keyBits * 2))
+    | ((GLuint64(y + keyBias) & keyMask) << keyBits)
+    | (GLuint64(z + keyBias) & keyMask);
+}
+
+// ubÑubNPʂ̈ʒu𓾂
+bool CpuHashedTsdf::getBrickPosition(int brick, int *x, int *y, int *z) const
+{
+  const GLuint64 key(brickKey[brick]);
+  if (key == emptyKey) return false;
+  *x = int((key >> (keyBits * 2)) & keyMask) - keyBias;
+  *y = int((key >> keyBits) & keyMask) - keyBias;
+  *z = int(key & keyMask) - keyBias;
+  return true;
+}
+
+// L[̃nbV\̍ŏ̒Tʒu߂
+int CpuHashedTsdf::hash(GLuint64 key) const
+{
+  // tB{ib`nbV ( 2^64 {|ďʂ̃rbgo)
+  return int((key * 0x9e3779b97f4a7c15ULL) >> (64 - tableBits));
+}
+
+// L[̃nbV\̈ʒuT (Ȃ΋󂫂̈ʒu)
+int CpuHashedTsdf::lookup(GLuint64 key) const
+{
+  const int mask((1 << tableBits) - 1);
+  int i(hash(key));
+  while (tableKey[i] != key && tableKey[i] != emptyKey) i = (i + 1) & mask;
+  return i;
+}
+
+// L[nbV\菜
+void CpuHashedTsdf::erase(GLuint64 key)
+{
+  const int mask((1 << tableBits) - 1);
+  int i(lookup(key));
+  if (tableKey[i] == emptyKey) return;
+
+  // ɑvf̂{̈ʒu󂢂ʒuÔ̂l߂, Tr؂Ȃ悤ɂ
+  for (int j = i;;)
+  {
+    j = (j + 1) & mask;
+    if (tableKey[j] == emptyKey) break;
+    const int k(hash(tableKey[j]));
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+    tableKey[i] = tableKey[j];
+    tableBrick[i] = tableBrick[j];
+    i = j;
+  }
+  tableKey[i] = emptyKey;
+}
+
+// ubNϑ̃Xg̐擪Ɉڂ
+void CpuHashedTsdf::touch(int brick)
+{
+  if (head == brick) return;
+
+  // XgO
+  if (prev[brick] >= 0) next[prev[brick]] = next[brick];
+  if (next[brick] >= 0) prev[next[brick]] = prev[brick];
+  if (tail == brick) tail = prev[brick];
+
+  // 擪ɓ
+  prev[brick] = -1;
+  next[brick] = head;
+  if (head >= 0) prev[head] = brick;
+  head = brick;
+  if (tail < 0) tail = brick;
+}
+
+// L[̃ubNT, ȂΊmۂ, ̃t[œubNɂ
+void CpuHashedTsdf::require(GLuint64 key)
+{
+  int slot(lookup(key));
+
+  // łɊmۂĂubN
+  if (tableKey[slot] == key)
+  {
+    const int brick(tableBrick[slot]);
+    if (lastUsed[brick] != frame)
+    {
+      lastUsed[brick] = frame;
+      touch(brick);
+      visible.push_back(brick);
+    }
+    return;
+  }
+
+  // v[sĂ΍łϑĂȂubN̂Ă
+  if (freeList.empty())
+  {
+    // ̃t[ŊϑubNcĂȂΊmۂȂ
+    if (tail < 0 || lastUsed[tail] == frame)
+    {
+      ++dropped;
+      return;
+    }
+
+    // nbV\菜Ɨvfl߂̂ňʒuT
+    const int brick(tail);
+    erase(brickKey[brick]);
+    brickKey[brick] = emptyKey;
+    freeList.push_back(brick);
+    slot = lookup(key);
+    ++evicted;
+  }
+
+  // ̃ubNoănbV\ɓo^
+  const int brick(freeList.back());
+  freeList.pop_back();
+  clear(pool.data() + size_t(brick) * brickVoxels);
+  brickKey[brick] = key;
+  lastUsed[brick] = frame;
+  brickVersion[brick] = version;
+  tableKey[slot] = key;
+  tableBrick[slot] = brick;
+  touch(brick);
+  visible.push_back(brick);
+}
+
+// ubNPʂ̈ʒu (x, y, z) ̃ubNT (Ȃ -1)
+int CpuHashedTsdf::findBrick(int x, int y, int z) const
+{
+  const GLuint64 key(makeKey(x, y, z));
+  const int slot(lookup(key));
+  return tableKey[slot] == key ? tableBrick[slot] : -1;
+}
+
+// mۂ̑傫𓾂 (byte)
+size_t CpuHashedTsdf::getMemory() const
+{
+  size_t bytes(pool.size() * sizeof(Voxel) + brickKey.size() * sizeof(GLuint64) + (lastUsed.size() + brickVersion.size()) * sizeof(GLuint)
+    + (prev.size() + next.size() + freeList.capacity()) * sizeof(int)
+    + tableKey.size() * sizeof(GLuint64) + tableBrick.size() * sizeof(int));
+  for (size_t i = 0; i < request.size(); ++i) bytes += request[i].capacity() * sizeof(GLuint64);
+  return bytes;
+}
+
+// JW{[ɓ
+void CpuHashedTsdf::integrate(const GLfloat (*point)[3], const GgMatrix &view)
+{
+  // JWƕϊsݒ肷
+  prepare(point, view);
+  const GgMatrix inverse(view.invert());
+  std::copy(inverse.get(), inverse.get() + 16, pose);
+
+  // Vt[ɂ
+  ++frame;
+  ++version;
+  visible.clear();
+  evicted = dropped = 0;
+
+  // _̎̃ubÑL[s̃ubNƂɕɏW߂
+  Parallel::run(0, depthHeight, [this](int begin, int end) { collect(begin, end); }, rowGrain);
+
+  // W߂L[̃ubNmۂẴt[œubNɂ
+  for (size_t i = 0; i < request.size(); ++i)
+    for (size_t j = 0; j < request[i].size(); ++j)
+      require(request[i][j]);
+
+  // ubNƂɕɓ
+  Parallel::run(0, int(visible.size()), [this](int begin, int end) { kernel(begin, end); }, brickGrain);
+}
+
+// fvX̍s [begin, end) ̓_̎̃ubÑL[W߂
+void CpuHashedTsdf::collect(int begin, int end)
+{
+  // ubN̈ӂ̒̋t
+  const GLfloat scale(1.0f / (voxelSize * GLfloat(brickSize)));
+
+  // J̈ʒu ([hW)
+  const GLfloat cx(pose[12]), cy(pose[13]), cz(pose[14]);
+
+  for (int block = begin; block < end; block += rowGrain)
+  {
+    std::vector<GLuint64> &keys(request[block / rowGrain]);
+    keys.clear();
+
+    // ߂̓_͓ubNʂ邱Ƃ̂ŒOɏW߂L[oĂďd炷
+    GLuint64 recent[recentSize];
+    std::fill(recent, recent + recentSize, GLuint64(emptyKey));
+
+    for (int v = block; v < (std::min)(block + rowGrain, end); ++v)
+    {
+      for (int u = 0; u < depthWidth; ++u)
+      {
+        // vł_̃[hW
+        const GLfloat *const p(point[v * depthWidth + u]);
+        if (p[2] < depthInvalid || p[2] >= 0.0f) continue;
+        const GLfloat px(pose[0] * p[0] + pose[4] * p[1] + pose[8] * p[2] + pose[12]);
+        const GLfloat py(pose[1] * p[0] + pose[5] * p[1] + pose[9] * p[2] + pose[13]);
+        const GLfloat pz(pose[2] * p[0] + pose[6] * p[1] + pose[10] * p[2] + pose[14]);
+
+        // ɉē_̑O truncation ̗̐[ (ubNP)
+        const GLfloat dx(px - cx), dy(py - cy), dz(pz - cz);
+        const GLfloat t(truncation / sqrt(dx * dx + dy * dy + dz * dz));
+        const GLfloat ax((px - dx * t) * scale), ay((py - dy * t) * scale), az((pz - dz * t) * scale);
+        const GLfloat bx((px + dx * t) * scale), by((py + dy * t) * scale), bz((pz + dz * t) * scale);
+
+        // ʂubNɂǂ (3D DDA)
+        int x(int(floor(ax))), y(int(floor(ay))), z(int(floor(az)));
+        const int ex(int(floor(bx))), ey(int(floor(by))), ez(int(floor(bz)));
+        const int sx(bx > ax ? 1 : -1), sy(by > ay ? 1 : -1), sz(bz > az ? 1 : -1);
+        const GLfloat lx(fabs(bx - ax)), ly(fabs(by - ay)), lz(fabs(bz - az));
+        const GLfloat ix(lx > 0.0f ? 1.0f / lx : 1.0e30f), iy(ly > 0.0f ? 1.0f / ly : 1.0e30f), iz(lz > 0.0f ? 1.0f / lz : 1.0e30f);
+        GLfloat tx((sx > 0 ? GLfloat(x + 1) - ax : ax - GLfloat(x)) * ix);
+        GLfloat ty((sy > 0 ? GLfloat(y + 1) - ay : ay - GLfloat(y)) * iy);
+        GLfloat tz((sz > 0 ? GLfloat(z + 1) - az : az - GLfloat(z)) * iz);
+        for (int n = std::abs(ex - x) + std::abs(ey - y) + std::abs(ez - z);; --n)
+        {
+          // OɏW߂L[łȂΓ
+          const GLuint64 key(makeKey(x, y, z));
+          GLuint64 &r(recent[(x * 7 + y * 13 + z * 31) & (recentSize - 1)]);
+          if (r != key)
+          {
+            r = key;
+            keys.push_back(key);
+          }
+          if (n <= 0) break;
+
+          if (tx < ty && tx < tz)
+          {
+            x += sx;
+            tx += ix;
+          }
+          else if (ty < tz)
+          {
+            y += sy;
+            ty += iy;
+          }
+          else
+          {
+            z += sz;
+            tz += iz;
+          }
+        }
+      }
+    }
+
+    // ubN̒̏d
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  }
+}
+
+// ̃t[œubN [begin, end) ɃJW𓝍
+void CpuHashedTsdf::kernel(int begin, int end)
+{
+  for (int i = begin; i < end; ++i)
+  {
+    // ubN̍ŏ̃{NZ̒S̃[hW
+    const int brick(visible[i]);
+    int bx, by, bz;
+    if (!getBrickPosition(brick, &bx, &by, &bz)) continue;
+    GLfloat c[3];
+    getBrickCenter(bx, by, bz, c);
+
+    // \ʂς肤ȂXVƂɂ
+    if (integrateBrick(pool.data() + size_t(brick) * brickVoxels, c[0], c[1], c[2])) brickVersion[brick] = version;
+  }
+}
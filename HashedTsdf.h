@@ -0,0 +1,149 @@
+#pragma once
+
+//
+// {NZnbVɂa TSDF
+//
+//   v_̎ (truncation ȓ) ̃ubNmۂ, ubN̈ʒunbV\ň
+//   ubN͍ŏ memoryBudget ̑傫ł܂Ƃ߂Ċmۂv[o,
+//   v[słϑĂȂubN̂ĂĎg (LRU)
+//   {[͈̔͂ɐȂ̂, Ŝ𑖍Ăg memoryBudget Ɏ܂
+//
+
+// TSDF ɂfvXf[^̓
+#include "Tsdf.h"
+
+//
+// CPU ɂ{NZnbV TSDF ̓
+//
+//   ͓_ƂɎɉ truncation ȓ̃ubNs̃ubNƂɕɏW,
+//   nbV\ւ̓o^ LRU ̍XV܂Ƃ߂čsĂ, o^ubNƂɕɓ
+//
+class CpuHashedTsdf : public CpuTsdfBase
+{
+  // ubN̐̏
+  const int capacity;
+
+  // ubNƂɕׂ{NZ̃v[
+  std::vector<Voxel> pool;
+
+  // ubN̈ʒulߍ񂾃L[ (gĂȂubN emptyKey)
+  std::vector<GLuint64> brickKey;
+
+  // ubNŌɊϑt[̔ԍ
+  std::vector<GLuint> lastUsed;
+
+  // ϑɕׂubN̑oXg (head łV tail łÂ)
+  std::vector<int> prev, next;
+  int head, tail;
+
+  // gĂȂubN
+  std::vector<int> freeList;
+
+  // nbV\̑傫 2 ̎w
+  const int tableBits;
+
+  // nbV\̃L[ƃubN (JԒn@, 傫 2 ׂ̂)
+  std::vector<GLuint64> tableKey;
+  std::vector<int> tableBrick;
+
+  // t[̔ԍ
+  GLuint frame;
+
+  // ̃t[œubN
+  std::vector<int> visible;
+
+  // fvX̍s̃ubNƂɏW߂ubÑL[
+  std::vector< std::vector<GLuint64> > request;
+
+  // JW烏[hWւ̕ϊs
+  GLfloat pose[16];
+
+  // ̂ĂubN̐ƃv[sĊmۂłȂubN̐ (̃t[)
+  int evicted, dropped;
+
+  // ubN̈ʒulߍ񂾃L[
+  static GLuint64 makeKey(int x, int y, int z);
+
+  // L[̃nbV\̍ŏ̒Tʒu߂
+  int hash(GLuint64 key) const;
+
+  // L[̃nbV\̈ʒuT (Ȃ΋󂫂̈ʒu)
+  int lookup(GLuint64 key) const;
+
+  // L[nbV\菜
+  void erase(GLuint64 key);
+
+  // ubNϑ̃Xg̐擪Ɉڂ
+  void touch(int brick);
+
+  // L[̃ubNT, ȂΊmۂ, ̃t[œubNɂ
+  void require(GLuint64 key);
+
+  // fvX̍s [begin, end) ̓_̎̃ubÑL[W߂
+  void collect(int begin, int end);
+
+  // ̃t[œubN [begin, end) ɃJW𓝍
+  void kernel(int begin, int end);
+
+public:
+
+  // gĂȂubÑL[
+  static const GLuint64 emptyKey = ~GLuint64(0);
+
+  // RXgN^
+  //   depthWidth, depthHeight: fvX̃TCY
+  //   voxelSize: {NZ̈ӂ̒ (m)
+  //   memoryBudget: ubNƃnbV\Ɏg̏ (byte)
+  CpuHashedTsdf(int depthWidth, int depthHeight, GLfloat voxelSize, size_t memoryBudget);
+
+  // {[ɂ
+  void reset();
+
+  // JW{[ɓ (CpuTsdf::integrate() Ɠ)
+  void integrate(const GLfloat (*point)[3], const GgMatrix &view);
+
+  // ubN̐̏𓾂
+  int getCapacity() const
+  {
+    return capacity;
+  }
+
+  // gĂubN̐𓾂
+  int getBrickCount() const
+  {
+    return capacity - int(freeList.size());
+  }
+
+  // Õt[œubN𓾂
+  const std::vector<int> &getVisible() const
+  {
+    return visible;
+  }
+
+  // Õt[Ŏ̂ĂubN̐𓾂
+  int getEvicted() const
+  {
+    return evicted;
+  }
+
+  // Õt[Ńv[sĊmۂłȂubN̐𓾂
+  int getDropped() const
+  {
+    return dropped;
+  }
+
+  // mۂ̑傫𓾂 (byte)
+  size_t getMemory() const;
+
+  // ubÑubNPʂ̈ʒu𓾂 (gĂȂubNȂ false)
+  virtual bool getBrickPosition(int brick, int *x, int *y, int *z) const;
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubNT (Ȃ -1)
+  virtual int findBrick(int x, int y, int z) const;
+
+  // ubÑ{NZ𓾂
+  virtual const Voxel *getBrickVoxel(int brick) const
+  {
+    return pool.data() + size_t(brick) * brickVoxels;
+  }
+};
@@ -0,0 +1,153 @@
+#include "HoleFill.h"
+
+//
+// fvXf[^̌
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+// ̕т𖄂߂ƂɈxɏ
+const int columnGrain(64);
+
+// RXgN^
+CpuHoleFill::CpuHoleFill(int width, int height)
+  : CpuCalculate(width, height, 1, 0)
+  , depth(width * height)
+  , mask(width * height)
+  , maxGap(8)
+  , jump(50)
+{
+}
+
+// p[0]  p[(count + 1) * step] ̊Ԃ count ̉f𖄂߂
+void CpuHoleFill::fill(GLushort *p, GLubyte *m, int count, int step) const
+{
+  const int a(p[0]), b(p[(count + 1) * step]);
+
+  if (abs(b - a) <= jump)
+  {
+    // [̍ΐ`Ԃ
+    const int n(count + 1);
+    for (int i = 1; i <= count; ++i)
+    {
+      p[i * step] = GLushort((a * (n - i) + b * i + n / 2) / n);
+      m[i * step] = 1;
+    }
+  }
+  else
+  {
+    // ̂̋EȂ牓̒lŖ߂
+    const GLushort f(GLushort(a > b ? a : b));
+    for (int i = 1; i <= count; ++i)
+    {
+      p[i * step] = f;
+      m[i * step] = 1;
+    }
+  }
+}
+
+// s [begin, end) ̉̕т𖄂߂
+void CpuHoleFill::kernel(int begin, int end)
+{
+  const __m128i zero(_mm_setzero_si128());
+
+  for (int v = begin; v < end; ++v)
+  {
+    // ͂fvXlڂă}XN
+    const int row(v * width);
+    GLushort *const d(depth.data() + row);
+    GLubyte *const m(mask.data() + row);
+    memcpy(d, static_cast<const GLushort *>(input[0]) + row, width * sizeof (GLushort));
+    memset(m, 0, width);
+
+    // OɌvłf
+    int last(-1);
+
+    for (int u = 0; u < width;)
+    {
+      // ߂т̓rłȂ 8 fƂvłĂΓǂݔ΂
+      if (last == u - 1 && u + 8 <= width)
+      {
+        const __m128i z(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(d + u)), zero));
+        if (_mm_movemask_epi8(z) == 0)
+        {
+          u += 8;
+          last = u - 1;
+          continue;
+        }
+      }
+
+      if (d[u] != 0)
+      {
+        // vłȂf̕т̌̒[Ȃ疄߂
+        const int gap(u - last - 1);
+        if (last >= 0 && gap > 0 && gap <= maxGap) fill(d + last, m + last, gap, 1);
+        last = u;
+      }
+      ++u;
+    }
+  }
+}
+
+//  [begin, end) ̏c̕т𖄂߂
+void CpuHoleFill::fillColumns(int begin, int end)
+{
+  // 񂲂Ƃ̒OɌvłf̍s (LbVɉčsƂɂǂ)
+  std::vector<GLshort> last(end - begin, -1);
+  const __m128i zero(_mm_setzero_si128());
+
+  for (int v = 0; v < height; ++v)
+  {
+    GLushort *const d(depth.data() + v * width);
+    const __m128i current(_mm_set1_epi16(GLshort(v)));
+    const __m128i previous(_mm_set1_epi16(GLshort(v - 1)));
+
+    for (int u = begin; u < end;)
+    {
+      GLshort *const l(last.data() + u - begin);
+
+      // 8 Ƃvłf̏オvłĂ΍sXV邾ɂ
+      if (u + 8 <= end)
+      {
+        const __m128i lv(_mm_loadu_si128(reinterpret_cast<const __m128i *>(l)));
+        const __m128i invalid(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(d + u)), zero));
+        if (_mm_movemask_epi8(_mm_andnot_si128(_mm_or_si128(invalid, _mm_cmpeq_epi16(lv, previous)), _mm_set1_epi16(-1))) == 0)
+        {
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(l), _mm_or_si128(_mm_and_si128(invalid, lv), _mm_andnot_si128(invalid, current)));
+          u += 8;
+          continue;
+        }
+      }
+
+      if (d[u] != 0)
+      {
+        // vłȂf̕т̉̒[Ȃ疄߂
+        const int gap(v - *l - 1);
+        if (*l >= 0 && gap > 0 && gap <= maxGap)
+          fill(depth.data() + *l * width + u, mask.data() + *l * width + u, gap, width);
+        *l = GLshort(v);
+      }
+      ++u;
+    }
+  }
+}
+
+// fvXf[^̌𖄂, ߂fvXlԂ
+const GLushort *CpuHoleFill::filter(const GLushort *data)
+{
+  setInput(0, data);
+
+  // sƂɉ̕т𖄂߂
+  calculate();
+
+  // 񂲂Ƃɏc̕т𖄂߂
+  Parallel::run(0, width, [this](int begin, int end) { fillColumns(begin, end); }, columnGrain);
+
+  return depth.data();
+}
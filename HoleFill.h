@@ -0,0 +1,60 @@
+#pragma once
+
+//
+// fvXf[^̌
+//
+//   vłȂf (0) ̉Əc̕т̗[ƂɌvłĂ, ̊Ԃ𖄂߂
+//   [̃fvXl̍ΐ`Ԃ, 傫Ε̂̋EƂ݂Ȃĉ̒lŖ߂
+//   ܂sƂɉ̕т𖄂, cf񂲂Ƃɏc̕тŖ߂
+//   摜̒[ɐڂтƒт͖߂ 0 ̂܂܂ɂ
+//
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+class CpuHoleFill : public CpuCalculate
+{
+  // 𖄂߂fvXl
+  std::vector<GLushort> depth;
+
+  // 𖄂߂f 1, vłfƖ߂Ȃf 0
+  std::vector<GLubyte> mask;
+
+  // ߂т̍ő̉f
+  int maxGap;
+
+  // `Ԃ闼[̃fvXl̍̍ől (mm)
+  int jump;
+
+  // s [begin, end) ̉̕т𖄂߂
+  virtual void kernel(int begin, int end);
+
+  //  [begin, end) ̏c̕т𖄂߂
+  void fillColumns(int begin, int end);
+
+  // p[0]  p[(count + 1) * step] ̊Ԃ count ̉f𖄂߂
+  void fill(GLushort *p, GLubyte *m, int count, int step) const;
+
+public:
+
+  // RXgN^
+  CpuHoleFill(int width, int height);
+
+  // ߂̃p[^ݒ肷
+  //   maxGap: ߂т̍ő̉f
+  //   jump: `Ԃ闼[̃fvXl̍̍ől (mm, 荷傫Ή̒lŖ߂)
+  void setParameter(int maxGap, int jump)
+  {
+    this->maxGap = maxGap;
+    this->jump = jump;
+  }
+
+  // fvXf[^̌𖄂, ߂fvXlԂ
+  const GLushort *filter(const GLushort *data);
+
+  // Oɖ߂f}XN𓾂 (߂f 1)
+  const GLubyte *getMask() const
+  {
+    return mask.data();
+  }
+};
@@ -0,0 +1,504 @@
+#include "Icp.h"
+
+//
+// ICP ɂfvXZT̈ʒuƌ̐
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <emmintrin.h>
+
+// xɏs (`̌W͂̍sƂɑ킹)
+const int rowGrain(8);
+
+// iƂ 2x2 f̍ŏ̓_Ƃ܂Ƃ߂_̋̏ (m)
+const GLfloat reduceDistance(0.03f);
+
+// ɕKvȑΉ_̐
+const int minimumInliers(100);
+
+namespace
+{
+  //  start ̌oߎ (ms)
+  GLfloat elapsed(const std::chrono::steady_clock::time_point &start)
+  {
+    return GLfloat(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  // ỉ摜̍s [begin, end) ̒ỉ摜 2x2 f
+  //   ŏ̓_ reduceDistance ȓ̓_̒_ʒu𕽋ς, @xNg𑫂ĐK
+  void reduceRows(const std::vector<GLfloat> *srcPoint, const std::vector<GLfloat> *srcNormal, int srcWidth,
+    std::vector<GLfloat> *dstPoint, std::vector<GLfloat> *dstNormal, int dstWidth, int begin, int end)
+  {
+    for (int v = begin; v < end; ++v)
+    {
+      for (int u = 0; u < dstWidth; ++u)
+      {
+        GLfloat p[3] = { 0.0f, 0.0f, 0.0f }, n[3] = { 0.0f, 0.0f, 0.0f }, first[3] = { 0.0f, 0.0f, 0.0f };
+        int count(0);
+
+        for (int k = 0; k < 4; ++k)
+        {
+          const int i((v * 2 + (k >> 1)) * srcWidth + u * 2 + (k & 1));
+          const GLfloat nx(srcNormal[0][i]), ny(srcNormal[1][i]), nz(srcNormal[2][i]);
+          if (nx == 0.0f && ny == 0.0f && nz == 0.0f) continue;
+
+          const GLfloat x(srcPoint[0][i]), y(srcPoint[1][i]), z(srcPoint[2][i]);
+          if (count == 0)
+          {
+            first[0] = x;
+            first[1] = y;
+            first[2] = z;
+          }
+          else
+          {
+            const GLfloat dx(x - first[0]), dy(y - first[1]), dz(z - first[2]);
+            if (dx * dx + dy * dy + dz * dz > reduceDistance * reduceDistance) continue;
+          }
+
+          p[0] += x;
+          p[1] += y;
+          p[2] += z;
+          n[0] += nx;
+          n[1] += ny;
+          n[2] += nz;
+          ++count;
+        }
+
+        // @xNgł_ȂƂɂ
+        const GLfloat a(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        const GLfloat s(count > 0 ? 1.0f / GLfloat(count) : 0.0f), r(a > 0.0f ? 1.0f / sqrt(a) : 0.0f);
+        const int j(v * dstWidth + u);
+        for (int c = 0; c < 3; ++c)
+        {
+          dstPoint[c][j] = p[c] * s;
+          dstNormal[c][j] = n[c] * r;
+        }
+      }
+    }
+  }
+
+  // Op̌W a ƉE b  6 ̐` A x = b RXL[ŉ (lłȂ false)
+  bool solve(const double *a, const double *b, double *x)
+  {
+    // Op̌WOps L ɓWJȂ番
+    double l[6][6];
+    for (int i = 0, k = 0; i < 6; ++i)
+      for (int j = i; j < 6; ++j) l[j][i] = a[k++];
+
+    for (int i = 0; i < 6; ++i)
+    {
+      for (int j = 0; j < i; ++j) l[i][i] -= l[i][j] * l[i][j];
+      if (!(l[i][i] > 1.0e-12)) return false;
+      l[i][i] = sqrt(l[i][i]);
+      for (int j = i + 1; j < 6; ++j)
+      {
+        for (int k = 0; k < i; ++k) l[j][i] -= l[j][k] * l[i][k];
+        l[j][i] /= l[i][i];
+      }
+    }
+
+    // L y = b, L^T x = y 
+    double y[6];
+    for (int i = 0; i < 6; ++i)
+    {
+      y[i] = b[i];
+      for (int k = 0; k < i; ++k) y[i] -= l[i][k] * y[k];
+      y[i] /= l[i][i];
+    }
+    for (int i = 5; i >= 0; --i)
+    {
+      x[i] = y[i];
+      for (int k = i + 1; k < 6; ++k) x[i] -= l[k][i] * x[k];
+      x[i] /= l[i][i];
+    }
+
+    return true;
+  }
+}
+
+// RXgN^
+CpuIcp::CpuIcp(int width, int height, int levels)
+  : level(levels)
+  , iterations(levels, 10)
+  , distance(0.1f)
+  , cosine(0.9f)
+  , angleEpsilon(1.0e-4f)
+  , translationEpsilon(1.0e-4f)
+  , hasModel(false)
+  , result(levels)
+  , time(0.0f)
+  , current(0)
+  , partial((height + rowGrain - 1) / rowGrain * terms)
+{
+  // ׂiقǌJԂ̉񐔂炷
+  if (levels > 0) iterations[0] = 4;
+  if (levels > 1) iterations[1] = 5;
+
+  // iƂ̉摜mۂ (̕⍂̍Ō̗ŝ͎Ă)
+  for (int i = 0; i < levels; ++i)
+  {
+    Level &l(level[i]);
+    l.width = i == 0 ? width : level[i - 1].width / 2;
+    l.height = i == 0 ? height : level[i - 1].height / 2;
+    for (int c = 0; c < 3; ++c)
+    {
+      l.point[c].resize(l.width * l.height);
+      l.normal[c].resize(l.width * l.height);
+      l.modelPoint[c].resize(l.width * l.height);
+      l.modelNormal[c].resize(l.width * l.height);
+    }
+
+    const Result empty = { 0, 0, 0.0f, false, 0.0f };
+    result[i] = empty;
+  }
+
+  std::fill(modelView, modelView + 16, 0.0f);
+  std::fill(rotation, rotation + 9, 0.0);
+  std::fill(translation, translation + 3, 0.0);
+  std::fill(project, project + 12, 0.0f);
+}
+
+// ̃p[^ݒ肷
+void CpuIcp::setParameter(GLfloat distance, GLfloat angle, GLfloat angleEpsilon, GLfloat translationEpsilon)
+{
+  this->distance = distance;
+  cosine = cos(angle);
+  this->angleEpsilon = angleEpsilon;
+  this->translationEpsilon = translationEpsilon;
+}
+
+// fݒ肷
+void CpuIcp::setModel(const GLfloat (*point)[3], const GLfloat (*normal)[3], const GgMatrix &view)
+{
+  std::copy(view.get(), view.get() + 16, modelView);
+
+  // fƂ̃ZT̃[hW
+  const GLfloat *const m(modelView);
+  const GLfloat center[3] =
+  {
+    -(m[0] * m[12] + m[1] * m[13] + m[2] * m[14]),
+    -(m[4] * m[12] + m[5] * m[13] + m[6] * m[14]),
+    -(m[8] * m[12] + m[9] * m[13] + m[10] * m[14])
+  };
+
+  // i 0  x, y, z Ƃɕ, @xNgZTɌ
+  Level &l0(level[0]);
+  Parallel::run(0, l0.height, [&](int begin, int end)
+  {
+    for (int i = begin * l0.width; i < end * l0.width; ++i)
+    {
+      const GLfloat *const p(point[i]), *const n(normal[i]);
+      const GLfloat s((p[0] - center[0]) * n[0] + (p[1] - center[1]) * n[1] + (p[2] - center[2]) * n[2] > 0.0f ? -1.0f : 1.0f);
+      for (int c = 0; c < 3; ++c)
+      {
+        l0.modelPoint[c][i] = p[c];
+        l0.modelNormal[c][i] = n[c] * s;
+      }
+    }
+  }, rowGrain);
+
+  // ei
+  for (int i = 1; i < getLevels(); ++i)
+  {
+    const Level &s(level[i - 1]);
+    Level &d(level[i]);
+    Parallel::run(0, d.height, [&](int begin, int end)
+    {
+      reduceRows(s.modelPoint, s.modelNormal, s.width, d.modelPoint, d.modelNormal, d.width, begin, end);
+    }, rowGrain);
+  }
+
+  hasModel = true;
+}
+
+// t[fɍ킹ăZT̈ʒuƌ𐄒肷
+bool CpuIcp::track(const GLfloat (*point)[3], const GLfloat (*normal)[3], GgMatrix &view)
+{
+  const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+  for (int i = 0; i < getLevels(); ++i)
+  {
+    const Result empty = { 0, 0, 0.0f, false, 0.0f };
+    result[i] = empty;
+  }
+  const bool tracked(hasModel && align(point, normal, view));
+  time = elapsed(start);
+  return tracked;
+}
+
+// iđei珇ɍ킹
+bool CpuIcp::align(const GLfloat (*point)[3], const GLfloat (*normal)[3], GgMatrix &view)
+{
+  // i 0  x, y, z Ƃɕ, vłȂ_͖@xNg 0 ɂ, @xNgZTɌ
+  Level &l0(level[0]);
+  Parallel::run(0, l0.height, [&](int begin, int end)
+  {
+    for (int i = begin * l0.width; i < end * l0.width; ++i)
+    {
+      const GLfloat *const p(point[i]), *const n(normal[i]);
+      const GLfloat s(p[2] < depthInvalid ? 0.0f : p[0] * n[0] + p[1] * n[1] + p[2] * n[2] > 0.0f ? -1.0f : 1.0f);
+      for (int c = 0; c < 3; ++c)
+      {
+        l0.point[c][i] = p[c];
+        l0.normal[c][i] = n[c] * s;
+      }
+    }
+  }, rowGrain);
+
+  // ei
+  for (int i = 1; i < getLevels(); ++i)
+  {
+    const Level &s(level[i - 1]);
+    Level &d(level[i]);
+    Parallel::run(0, d.height, [&](int begin, int end)
+    {
+      reduceRows(s.point, s.normal, s.width, d.point, d.normal, d.width, begin, end);
+    }, rowGrain);
+  }
+
+  // l̃JW烏[hWւ̕ϊ (view ̋tϊ)
+  const GLfloat *const v(view.get());
+  for (int r = 0; r < 3; ++r)
+  {
+    for (int c = 0; c < 3; ++c) rotation[r * 3 + c] = v[r * 4 + c];
+    translation[r] = -(double(v[r * 4 + 0]) * v[12] + double(v[r * 4 + 1]) * v[13] + double(v[r * 4 + 2]) * v[14]);
+  }
+
+  // ei珇ɍ킹
+  for (current = getLevels() - 1; current >= 0; --current)
+  {
+    Result &res(result[current]);
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    const int blocks((level[current].height + rowGrain - 1) / rowGrain);
+
+    while (res.iterations < iterations[current])
+    {
+      // t[̓_f̉摜̃JWɈڂϊ (modelView ƃJW烏[hWւ̕ϊ̐)
+      for (int r = 0; r < 3; ++r)
+      {
+        for (int c = 0; c < 3; ++c)
+          project[r * 4 + c] = GLfloat(modelView[r] * rotation[c] + modelView[r + 4] * rotation[3 + c] + modelView[r + 8] * rotation[6 + c]);
+        project[r * 4 + 3] = GLfloat(modelView[r] * translation[0] + modelView[r + 4] * translation[1] + modelView[r + 8] * translation[2]
+          + modelView[r + 12]);
+      }
+
+      // s̃ubNƂɕɐ`̌W߂
+      Parallel::run(0, level[current].height, [this](int begin, int end) { kernel(begin, end); }, rowGrain);
+
+      // ubN̏ɑ킹
+      double sum[terms] = { 0.0 };
+      for (int b = 0; b < blocks; ++b)
+        for (int k = 0; k < terms; ++k) sum[k] += partial[b * terms + k];
+
+      res.inliers = int(sum[28]);
+      res.error = res.inliers > 0 ? GLfloat(sqrt(sum[27] / sum[28])) : 0.0f;
+
+      // _Ɩʂ̋ŏɂ]ƕsړ߂
+      double x[6];
+      const double b[6] = { -sum[21], -sum[22], -sum[23], -sum[24], -sum[25], -sum[26] };
+      if (res.inliers < minimumInliers || !solve(sum, b, x))
+      {
+        res.time = elapsed(start);
+        return false;
+      }
+      ++res.iterations;
+
+      // ]hQX̎ŉ]sɂĐ蒆̕ϊɍ|
+      const double angle(sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]));
+      double d[9] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+      if (angle > 0.0)
+      {
+        const double ax(x[0] / angle), ay(x[1] / angle), az(x[2] / angle);
+        const double s(sin(angle)), c(cos(angle)), t(1.0 - c);
+        d[0] = c + ax * ax * t;      d[1] = ax * ay * t - az * s; d[2] = ax * az * t + ay * s;
+        d[3] = ay * ax * t + az * s; d[4] = c + ay * ay * t;      d[5] = ay * az * t - ax * s;
+        d[6] = az * ax * t - ay * s; d[7] = az * ay * t + ax * s; d[8] = c + az * az * t;
+      }
+      double r[9], t[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j) r[i * 3 + j] = d[i * 3] * rotation[j] + d[i * 3 + 1] * rotation[3 + j] + d[i * 3 + 2] * rotation[6 + j];
+        t[i] = d[i * 3] * translation[0] + d[i * 3 + 1] * translation[1] + d[i * 3 + 2] * translation[2] + x[3 + i];
+      }
+      std::copy(r, r + 9, rotation);
+      std::copy(t, t + 3, translation);
+
+      // XVʂ臒l玟̒iɐi
+      if (angle < angleEpsilon && sqrt(x[3] * x[3] + x[4] * x[4] + x[5] * x[5]) < translationEpsilon)
+      {
+        res.converged = true;
+        break;
+      }
+    }
+    res.time = elapsed(start);
+  }
+
+  // 肵JW烏[hWւ̕ϊ̋tϊ view ɂ
+  GLfloat m[16];
+  for (int r = 0; r < 3; ++r)
+  {
+    for (int c = 0; c < 3; ++c) m[c * 4 + r] = GLfloat(rotation[c * 3 + r]);
+    m[12 + r] = GLfloat(-(rotation[r] * translation[0] + rotation[3 + r] * translation[1] + rotation[6 + r] * translation[2]));
+    m[r * 4 + 3] = 0.0f;
+  }
+  m[15] = 1.0f;
+  view.load(m);
+
+  return true;
+}
+
+// i current ̍s [begin, end) ̑Ή_`̌W߂
+void CpuIcp::kernel(int begin, int end)
+{
+  const Level &l(level[current]);
+  const int width(l.width), height(l.height);
+
+  // JW烏[hWւ̕ϊƃf̉摜̃JWւ̕ϊ
+  const __m128 r0(_mm_set1_ps(GLfloat(rotation[0]))), r1(_mm_set1_ps(GLfloat(rotation[1]))), r2(_mm_set1_ps(GLfloat(rotation[2])));
+  const __m128 r3(_mm_set1_ps(GLfloat(rotation[3]))), r4(_mm_set1_ps(GLfloat(rotation[4]))), r5(_mm_set1_ps(GLfloat(rotation[5])));
+  const __m128 r6(_mm_set1_ps(GLfloat(rotation[6]))), r7(_mm_set1_ps(GLfloat(rotation[7]))), r8(_mm_set1_ps(GLfloat(rotation[8])));
+  const __m128 t0(_mm_set1_ps(GLfloat(translation[0]))), t1(_mm_set1_ps(GLfloat(translation[1]))), t2(_mm_set1_ps(GLfloat(translation[2])));
+  const __m128 p0(_mm_set1_ps(project[0])), p1(_mm_set1_ps(project[1])), p2(_mm_set1_ps(project[2])), p3(_mm_set1_ps(project[3]));
+  const __m128 p4(_mm_set1_ps(project[4])), p5(_mm_set1_ps(project[5])), p6(_mm_set1_ps(project[6])), p7(_mm_set1_ps(project[7]));
+  const __m128 p8(_mm_set1_ps(project[8])), p9(_mm_set1_ps(project[9])), p10(_mm_set1_ps(project[10])), p11(_mm_set1_ps(project[11]));
+
+  // ěW
+  const __m128 su(_mm_set1_ps(GLfloat(width) / positionScale[0])), sv(_mm_set1_ps(GLfloat(height) / positionScale[1]));
+  const __m128 hu(_mm_set1_ps(GLfloat(width) * 0.5f)), hv(_mm_set1_ps(GLfloat(height) * 0.5f));
+  const __m128 wu(_mm_set1_ps(GLfloat(width))), wv(_mm_set1_ps(GLfloat(height)));
+
+  // Ή_̔臒l
+  const __m128 zero(_mm_setzero_ps()), half(_mm_set1_ps(0.5f));
+  const __m128 limit(_mm_set1_ps(distance * distance)), cosLimit(_mm_set1_ps(cosine));
+
+  // s̃ubNƂɌW𑫂킹
+  for (int b = begin; b < end; b += rowGrain)
+  {
+    __m128 acc[terms];
+    for (int k = 0; k < terms; ++k) acc[k] = zero;
+
+    const int e((std::min)(b + rowGrain, end));
+    for (int v = b; v < e; ++v)
+    {
+      const int row(v * width);
+
+      // 4 f߂ ( 4 ̔{łȂ΍Ō̉fd˂ēǂ, dȂf͎̂Ă)
+      for (int u = 0; u < width; u += 4)
+      {
+        const int base((std::min)(u, width - 4) + row);
+        const __m128 fresh(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_add_epi32(_mm_set1_epi32(base - row), _mm_setr_epi32(0, 1, 2, 3)),
+          _mm_set1_epi32(u - 1))));
+
+        // t[̓_Ɩ@xNg
+        const __m128 x(_mm_loadu_ps(&l.point[0][base])), y(_mm_loadu_ps(&l.point[1][base])), z(_mm_loadu_ps(&l.point[2][base]));
+        const __m128 nx(_mm_loadu_ps(&l.normal[0][base])), ny(_mm_loadu_ps(&l.normal[1][base])), nz(_mm_loadu_ps(&l.normal[2][base]));
+        __m128 valid(_mm_and_ps(fresh, _mm_cmpgt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)), half)));
+        if (_mm_movemask_ps(valid) == 0) continue;
+
+        // f̉摜̃JWɈڂēe
+        const __m128 qx(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, x), _mm_mul_ps(p1, y)), _mm_mul_ps(p2, z)), p3));
+        const __m128 qy(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p4, x), _mm_mul_ps(p5, y)), _mm_mul_ps(p6, z)), p7));
+        const __m128 qz(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p8, x), _mm_mul_ps(p9, y)), _mm_mul_ps(p10, z)), p11));
+        const __m128 rz(_mm_div_ps(_mm_set1_ps(1.0f), qz));
+        const __m128 fu(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(qx, rz), su), hu));
+        const __m128 fv(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(qy, rz), sv), hv));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(qz, zero),
+          _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(fu, zero), _mm_cmplt_ps(fu, wu)), _mm_and_ps(_mm_cmpge_ps(fv, zero), _mm_cmplt_ps(fv, wv)))));
+        const int mask(_mm_movemask_ps(valid));
+        if (mask == 0) continue;
+
+        // ef̃f̓_Ɩ@xNgW߂
+        int iu[4], iv[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(iu), _mm_cvttps_epi32(fu));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(iv), _mm_cvttps_epi32(fv));
+        GLfloat m[6][4];
+        for (int k = 0; k < 4; ++k)
+        {
+          const int i(mask >> k & 1 ? iv[k] * width + iu[k] : 0);
+          for (int c = 0; c < 3; ++c)
+          {
+            m[c][k] = l.modelPoint[c][i];
+            m[3 + c][k] = l.modelNormal[c][i];
+          }
+        }
+        const __m128 mx(_mm_loadu_ps(m[0])), my(_mm_loadu_ps(m[1])), mz(_mm_loadu_ps(m[2]));
+        const __m128 mnx(_mm_loadu_ps(m[3])), mny(_mm_loadu_ps(m[4])), mnz(_mm_loadu_ps(m[5]));
+
+        // t[̓_Ɩ@xNg[hWɈڂ
+        const __m128 wx(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, x), _mm_mul_ps(r1, y)), _mm_mul_ps(r2, z)), t0));
+        const __m128 wy(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r3, x), _mm_mul_ps(r4, y)), _mm_mul_ps(r5, z)), t1));
+        const __m128 wz(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r6, x), _mm_mul_ps(r7, y)), _mm_mul_ps(r8, z)), t2));
+        const __m128 wnx(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, nx), _mm_mul_ps(r1, ny)), _mm_mul_ps(r2, nz)));
+        const __m128 wny(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r3, nx), _mm_mul_ps(r4, ny)), _mm_mul_ps(r5, nz)));
+        const __m128 wnz(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r6, nx), _mm_mul_ps(r7, ny)), _mm_mul_ps(r8, nz)));
+
+        // ߂@xNǧĂ_Ή_ɂ
+        const __m128 dx(_mm_sub_ps(wx, mx)), dy(_mm_sub_ps(wy, my)), dz(_mm_sub_ps(wz, mz));
+        const __m128 dd(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        const __m128 dn(_mm_add_ps(_mm_add_ps(_mm_mul_ps(wnx, mnx), _mm_mul_ps(wny, mny)), _mm_mul_ps(wnz, mnz)));
+        const __m128 inlier(_mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(dd, limit), _mm_cmpge_ps(dn, cosLimit))));
+        if (_mm_movemask_ps(inlier) == 0) continue;
+
+        // _Ɩʂ̋Ƃ̔]ƕsړɑ΂z (Ή_łȂ 0)
+        const __m128 r(_mm_and_ps(inlier, _mm_add_ps(_mm_add_ps(_mm_mul_ps(mnx, dx), _mm_mul_ps(mny, dy)), _mm_mul_ps(mnz, dz))));
+        const __m128 j[6] =
+        {
+          _mm_and_ps(inlier, _mm_sub_ps(_mm_mul_ps(wy, mnz), _mm_mul_ps(wz, mny))),
+          _mm_and_ps(inlier, _mm_sub_ps(_mm_mul_ps(wz, mnx), _mm_mul_ps(wx, mnz))),
+          _mm_and_ps(inlier, _mm_sub_ps(_mm_mul_ps(wx, mny), _mm_mul_ps(wy, mnx))),
+          _mm_and_ps(inlier, mnx),
+          _mm_and_ps(inlier, mny),
+          _mm_and_ps(inlier, mnz)
+        };
+
+        // W𑫂
+        for (int i = 0, k = 0; i < 6; ++i)
+          for (int c = i; c < 6; ++c, ++k) acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(j[i], j[c]));
+        for (int i = 0; i < 6; ++i) acc[21 + i] = _mm_add_ps(acc[21 + i], _mm_mul_ps(j[i], r));
+        acc[27] = _mm_add_ps(acc[27], _mm_mul_ps(r, r));
+        acc[28] = _mm_add_ps(acc[28], _mm_and_ps(inlier, _mm_set1_ps(1.0f)));
+      }
+    }
+
+    // ubŇWۑ
+    double *const p(&partial[b / rowGrain * terms]);
+    for (int k = 0; k < terms; ++k)
+    {
+      GLfloat a[4];
+      _mm_storeu_ps(a, acc[k]);
+      p[k] = double(a[0]) + double(a[1]) + double(a[2]) + double(a[3]);
+    }
+  }
+}
+
+// O̐ŌJԂ񐔂̍v𓾂
+int CpuIcp::getIterations() const
+{
+  int count(0);
+  for (size_t i = 0; i < result.size(); ++i) count += result[i].iterations;
+  return count;
+}
+
+// fvXZTƓpƉf̕т̓eϊs𓾂
+//   position.frag ̒_ʒu𓊉eƉf (u, v) ̒SKfoCXW ((u + 0.5) / width * 2 - 1, (v + 0.5) / height * 2 - 1) ɂȂ
+GgMatrix CpuIcp::getProjection(GLfloat zNear, GLfloat zFar)
+{
+  const GLfloat depth(zFar - zNear);
+  const GLfloat m[] =
+  {
+    -2.0f / positionScale[0], 0.0f, 0.0f, 0.0f,
+    0.0f, -2.0f / positionScale[1], 0.0f, 0.0f,
+    0.0f, 0.0f, -(zFar + zNear) / depth, -1.0f,
+    0.0f, 0.0f, -2.0f * zFar * zNear / depth, 0.0f
+  };
+
+  return GgMatrix(m);
+}
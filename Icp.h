@@ -0,0 +1,162 @@
+#pragma once
+
+//
+// ICP ɂfvXZT̈ʒuƌ̐
+//
+//   t[̒_ʒuƖ@xNgf ({[CLXg\ʂȂ) ɓ_Ɩʂ̋ō킹,
+//   [hWJWւ̕ϊs߂
+//   Ή_̓t[̓_fƂ̃ZT̉摜ɓeēf̓_ɂ (projective data association)
+//   c̒ie珇ɍ킹, iƂɍXVʂ臒l邩񐔂̏ɒB玟̒iɐi
+//   `̌W 4 f SSE ŋ߂čs̃ubNƂɕɑ킹
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+class CpuIcp
+{
+public:
+
+  // iƂ̐̌
+  struct Result
+  {
+    // JԂ
+    int iterations;
+
+    // Ō̌JԂőΉ_̐
+    int inliers;
+
+    // Ō̌JԂ̓_Ɩʂ̋̓敽ϕ (m)
+    GLfloat error;
+
+    // 񐔂̏܂łɍXVʂ臒lǂ
+    bool converged;
+
+    // ̒i킹̂ɂ (ms)
+    GLfloat time;
+  };
+
+private:
+
+  // iƂ̉摜 (x, y, z Ƃɕׂ_ʒuƖ@xNg, @xNg 0 Ȃ_Ȃ)
+  struct Level
+  {
+    // 摜̃TCY
+    int width, height;
+
+    // t[̒_ʒuƖ@xNg (JW)
+    std::vector<GLfloat> point[3], normal[3];
+
+    // f̒_ʒuƖ@xNg ([hW)
+    std::vector<GLfloat> modelPoint[3], modelNormal[3];
+  };
+
+  // iƂ̉摜
+  std::vector<Level> level;
+
+  // iƂ̌JԂ̉񐔂̏
+  std::vector<int> iterations;
+
+  // Ή_Ƃ݂Ȃ (m) Ɩ@xNĝȂp̗]̉
+  GLfloat distance, cosine;
+
+  // Ƃ݂Ȃ] (rad) ƕsړ (m) ̍XV
+  GLfloat angleEpsilon, translationEpsilon;
+
+  // f邩ǂ
+  bool hasModel;
+
+  // fƂ̃[hWJWւ̕ϊs
+  GLfloat modelView[16];
+
+  // iƂ̐̌
+  std::vector<Result> result;
+
+  // O̐ɂ (i鎞Ԃ܂, ms)
+  GLfloat time;
+
+  // 킹Ăi
+  int current;
+
+  // 蒆̃JW烏[hWւ̕ϊ (]ƕsړ)
+  double rotation[9], translation[3];
+
+  // t[̓_f̉摜ɓeϊ (]ƕsړ)
+  GLfloat project[12];
+
+  // s̃ubNƂ̐`̌W (Op 21 , Eӂ 6 , ̓a, Ή_̐)
+  static const int terms = 29;
+  std::vector<double> partial;
+
+  // i current ̍s [begin, end) ̑Ή_`̌W߂
+  void kernel(int begin, int end);
+
+  // iđei珇ɍ킹 (track() ̒g)
+  bool align(const GLfloat (*point)[3], const GLfloat (*normal)[3], GgMatrix &view);
+
+  // Rs[RXgN^ (Rs[֎~)
+  CpuIcp(const CpuIcp &o);
+
+  //  (֎~)
+  CpuIcp &operator=(const CpuIcp &o);
+
+public:
+
+  // RXgN^
+  //   levels: i (͂摜܂)
+  CpuIcp(int width, int height, int levels = 3);
+
+  // fXgN^
+  virtual ~CpuIcp() {}
+
+  // ̃p[^ݒ肷
+  //   distance: Ή_Ƃ݂Ȃ (m)
+  //   angle: Ή_Ƃ݂Ȃ@xNĝȂp̏ (rad)
+  //   angleEpsilon, translationEpsilon: Ƃ݂Ȃ] (rad) ƕsړ (m) ̍XV
+  void setParameter(GLfloat distance, GLfloat angle, GLfloat angleEpsilon = 1.0e-4f, GLfloat translationEpsilon = 1.0e-4f);
+
+  // i level ̌JԂ̉񐔂̏ݒ肷 (i 0 łׂ)
+  void setIterations(int level, int iterations)
+  {
+    this->iterations[level] = iterations;
+  }
+
+  // fݒ肷
+  //   point, normal: f̒_ʒuƖ@xNg ([hW, @xNg 0 Ȃ_Ȃ)
+  //   view: fƂ̃[hWJWւ̕ϊs
+  //   f̕т̓fvXZT̉摜Ɠɂ (CpuRaycast Ȃ getProjection() ̓eϊsŃCLXg)
+  void setModel(const GLfloat (*point)[3], const GLfloat (*normal)[3], const GgMatrix &view);
+
+  // t[fɍ킹ăZT̈ʒuƌ𐄒肷
+  //   point, normal: t[̒_ʒuƖ@xNg (JW, CpuPosition  CpuNormal ̌vZ)
+  //   view: l̃[hWJWւ̕ϊs, łΐ肵ϊsŒu
+  //   fȂΉ_Ȃ false Ԃ view ςȂ
+  bool track(const GLfloat (*point)[3], const GLfloat (*normal)[3], GgMatrix &view);
+
+  // i𓾂
+  int getLevels() const
+  {
+    return int(level.size());
+  }
+
+  // i level ̒O̐̌ʂ𓾂
+  const Result &getResult(int level) const
+  {
+    return result[level];
+  }
+
+  // O̐ŌJԂ񐔂̍v𓾂
+  int getIterations() const;
+
+  // O̐ɂ (ms) 𓾂 (iƂ̎Ԃ getResult()  time)
+  GLfloat getTime() const
+  {
+    return time;
+  }
+
+  // fvXZTƓpƉf̕т̓eϊs𓾂
+  static GgMatrix getProjection(GLfloat zNear, GLfloat zFar);
+};
@@ -0,0 +1,246 @@
+#include "KdTree.h"
+
+//
+// t[̓_Q k-d 
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <algorithm>
+
+// _l߂ƂɈxɏ_̐
+const int pointGrain(4096);
+
+// ؂ォ番ĕɍ镔؂̃Xbh̐
+const int subtreesPerThread(4);
+
+// ɍ镔؂̓_̐̉
+const int subtreeMinimum(4096);
+
+// xɒTʒu̐
+const int queryGrain(256);
+
+// TƂɐςޔ͈͂̐̏ (؂̍̓{傫)
+const int stackSize(128);
+
+// RXgN^
+KdTree::KdTree(int leafSize)
+  : leafSize((std::max)(leafSize, 1))
+{
+}
+
+// t[̓_Q؂蒼
+int KdTree::build(const GLfloat (*p)[3], int count)
+{
+  // ubNƂɌvł_̐𐔂
+  const int chunks((count + pointGrain - 1) / pointGrain);
+  chunkCount.assign(chunks + 1, 0);
+  Parallel::run(0, chunks, [&](int begin, int end)
+  {
+    for (int c = begin; c < end; ++c)
+    {
+      const int e((std::min)((c + 1) * pointGrain, count));
+      int n(0);
+      for (int i = c * pointGrain; i < e; ++i) if (p[i][2] >= depthInvalid) ++n;
+      chunkCount[c + 1] = n;
+    }
+  });
+  for (int c = 0; c < chunks; ++c) chunkCount[c + 1] += chunkCount[c];
+
+  // vł_l߂ĕׂ
+  const int n(chunkCount[chunks]);
+  item.resize(n);
+  axis.resize(n);
+  Parallel::run(0, chunks, [&](int begin, int end)
+  {
+    for (int c = begin; c < end; ++c)
+    {
+      const int e((std::min)((c + 1) * pointGrain, count));
+      Item *q(item.data() + chunkCount[c]);
+      for (int i = c * pointGrain; i < e; ++i)
+      {
+        if (p[i][2] < depthInvalid) continue;
+        std::copy(p[i], p[i] + 3, q->position);
+        q->index = i;
+        ++q;
+      }
+    }
+  });
+
+  // ؂Xbh̐\Ȃ܂ŏ̒i𕪂
+  std::vector< std::pair<int, int> > subtree(1, std::make_pair(0, n));
+  const int target(Parallel::getThreads() * subtreesPerThread);
+  for (bool divided(true); divided && int(subtree.size()) < target;)
+  {
+    divided = false;
+    std::vector< std::pair<int, int> > lower;
+    for (size_t i = 0; i < subtree.size(); ++i)
+    {
+      const int b(subtree[i].first), e(subtree[i].second);
+      if (e - b < subtreeMinimum || e - b <= leafSize)
+      {
+        lower.push_back(subtree[i]);
+        continue;
+      }
+      const int m(split(b, e));
+      lower.push_back(std::make_pair(b, m));
+      lower.push_back(std::make_pair(m + 1, e));
+      divided = true;
+    }
+    subtree.swap(lower);
+  }
+
+  // ؂ɍ
+  Parallel::run(0, int(subtree.size()), [&](int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) build(subtree[i].first, subtree[i].second);
+  });
+
+  return n;
+}
+
+// ͈ [begin, end) L肪ł傫Œ̓_̑Oɕ
+int KdTree::split(int begin, int end)
+{
+  // ͈͂̓_̍L߂
+  GLfloat lower[3], upper[3];
+  std::copy(item[begin].position, item[begin].position + 3, lower);
+  std::copy(item[begin].position, item[begin].position + 3, upper);
+  for (int i = begin + 1; i < end; ++i)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      lower[c] = (std::min)(lower[c], item[i].position[c]);
+      upper[c] = (std::max)(upper[c], item[i].position[c]);
+    }
+  }
+  int a(0);
+  for (int c = 1; c < 3; ++c) if (upper[c] - lower[c] > upper[a] - lower[a]) a = c;
+
+  // ̓_I, Oɏ_, ɑ傫_W߂
+  const int m(begin + (end - begin) / 2);
+  std::nth_element(item.begin() + begin, item.begin() + m, item.begin() + end, [a](const Item &x, const Item &y)
+  {
+    return x.position[a] < y.position[a];
+  });
+  axis[m] = GLubyte(a);
+
+  return m;
+}
+
+// ͈ [begin, end) ̕؂
+void KdTree::build(int begin, int end)
+{
+  if (end - begin <= leafSize) return;
+  const int m(split(begin, end));
+  build(begin, m);
+  build(m + 1, end);
+}
+
+// ̓_̋ߖT̓_߂ɒT
+int KdTree::findNearest(const GLfloat *query, int k, int *neighbour, GLfloat *distance) const
+{
+  k = (std::max)((std::min)(k, int(maximumNeighbours)), 0);
+
+  // _̋߂ɕׂĂ
+  int found(0);
+  int best[maximumNeighbours];
+  GLfloat bestDistance[maximumNeighbours];
+
+  // ߂_, k 𒴂ł_̂Ă
+  const Item *const base(item.data());
+  auto consider = [&](int i)
+  {
+    const GLfloat *const q(base[i].position);
+    const GLfloat d[] = { q[0] - query[0], q[1] - query[1], q[2] - query[2] };
+    const GLfloat d2(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (found == k && d2 >= bestDistance[k - 1]) return;
+    int j(found < k ? found++ : k - 1);
+    for (; j > 0 && bestDistance[j - 1] > d2; --j)
+    {
+      best[j] = best[j - 1];
+      bestDistance[j] = bestDistance[j - 1];
+    }
+    best[j] = i;
+    bestDistance[j] = d2;
+  };
+
+  // ͈͂Ƃ͈̔͂܂ł̋̓̉ς, ߂T
+  struct Range
+  {
+    int begin, end;
+    GLfloat bound;
+  };
+  Range stack[stackSize];
+  int top(0);
+  if (k > 0 && !item.empty())
+  {
+    const Range root = { 0, int(item.size()), 0.0f };
+    stack[top++] = root;
+  }
+  while (top > 0)
+  {
+    const Range r(stack[--top]);
+    if (found == k && r.bound >= bestDistance[k - 1]) continue;
+
+    // tȂ񂾓_ɒׂ
+    if (r.end - r.begin <= leafSize)
+    {
+      for (int i = r.begin; i < r.end; ++i) consider(i);
+      continue;
+    }
+
+    // ̓_𒲂, ̎qɐςł߂̎qς
+    const int m(r.begin + (r.end - r.begin) / 2), a(axis[m]);
+    consider(m);
+    const GLfloat diff(query[a] - base[m].position[a]);
+    const Range left = { r.begin, m, diff < 0.0f ? r.bound : (std::max)(r.bound, diff * diff) };
+    const Range right = { m + 1, r.end, diff < 0.0f ? (std::max)(r.bound, diff * diff) : r.bound };
+    if (diff < 0.0f)
+    {
+      if (right.begin < right.end) stack[top++] = right;
+      if (left.begin < left.end) stack[top++] = left;
+    }
+    else
+    {
+      if (left.begin < left.end) stack[top++] = left;
+      if (right.begin < right.end) stack[top++] = right;
+    }
+  }
+
+  // ̓_Qł̓YɂĊi[
+  for (int j = 0; j < k; ++j)
+  {
+    neighbour[j] = j < found ? base[best[j]].index : -1;
+    if (distance) distance[j] = j < found ? bestDistance[j] : 0.0f;
+  }
+
+  return found;
+}
+
+// ̓_̋ߖT̓_܂Ƃ߂ĕɒT
+void KdTree::findNearest(const GLfloat (*query)[3], int count, int k, int *neighbour, GLfloat *distance) const
+{
+  Parallel::run(0, count, [&](int begin, int end)
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      int *const n(neighbour + size_t(i) * k);
+      GLfloat *const d(distance ? distance + size_t(i) * k : NULL);
+      if (query[i][2] < depthInvalid)
+      {
+        std::fill(n, n + k, -1);
+        if (d) std::fill(d, d + k, 0.0f);
+      }
+      else
+      {
+        findNearest(query[i], k, n, d);
+      }
+    }
+  }, queryGrain);
+}
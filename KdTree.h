@@ -0,0 +1,89 @@
+#pragma once
+
+//
+// t[̓_Q k-d 
+//
+//   t[̌vł_l߂ĕ, ͈͂̒̓_ߓ_ɂčE͈̔͂qɂÖق̔zuŖ؂
+//   (qւ̎QƂ, ͈͂ leafSize ȉɂȂtƂĕ񂾓_ɒׂ)
+//   鎲͔͈͂̓_̍L肪ł傫ɂ, ̓_ std::nth_element őI
+//   ̒iXbh̐葽؂ɕĂ, ؂ɍ
+//   ߖT̒T const Ȃ̂, findNearest() ő̓_܂Ƃ߂ĕɒT
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+class KdTree
+{
+  // ׂ_
+  struct Item
+  {
+    // ʒu
+    GLfloat position[3];
+
+    // ̓_Qł̓Y
+    int index;
+  };
+
+  // tɂ͈͂̓_̐̏
+  const int leafSize;
+
+  // ߓ_̏ɕׂ_
+  std::vector<Item> item;
+
+  // ߓ_̕鎲 (͈͂̒̓_̈ʒuɒu)
+  std::vector<GLubyte> axis;
+
+  // _l߂Ƃ̃ubNƂ̌vł_̐
+  std::vector<int> chunkCount;
+
+  // ͈ [begin, end) L肪ł傫Œ̓_̑Oɕ (߂l͒̓_̈ʒu)
+  int split(int begin, int end);
+
+  // ͈ [begin, end) ̕؂
+  void build(int begin, int end);
+
+  // Rs[RXgN^ (Rs[֎~)
+  KdTree(const KdTree &o);
+
+  //  (֎~)
+  KdTree &operator=(const KdTree &o);
+
+public:
+
+  // xɒTߖT̓_̐̏
+  static const int maximumNeighbours = 64;
+
+  // RXgN^
+  //   leafSize: tɂ͈͂̓_̐̏
+  KdTree(int leafSize = 16);
+
+  // t[̓_Q؂蒼
+  //   point: _ʒu (CpuPosition Ɠ z  depthInvalid 艓_͌vs\_Ƃď)
+  //   count: _̐
+  //   ߂l: ؂ɓꂽ_̐
+  int build(const GLfloat (*point)[3], int count);
+
+  // ؂ɓꂽ_̐𓾂
+  int getPointCount() const
+  {
+    return int(item.size());
+  }
+
+  // ̓_̋ߖT̓_߂ɒT
+  //   query: Tʒu
+  //   k: T_̐ (maximumNeighbours ȉ)
+  //   neighbour: _ build() ɗ^_Qł̓Y̊i[ (k , Ȃ -1)
+  //   distance: _܂ł̋̓̊i[ (k , NULL Ȃi[Ȃ)
+  //   ߂l: _̐ (Tʒuɓ_΂̓_܂)
+  int findNearest(const GLfloat *query, int k, int *neighbour, GLfloat *distance = NULL) const;
+
+  // ̓_̋ߖT̓_܂Ƃ߂ĕɒT
+  //   query: Tʒu (z  depthInvalid 艓ʒu͒Tɂׂ -1 ɂ)
+  //   count: Tʒu̐
+  //   k, neighbour, distance: ̓_ findNearest() Ɠ, TʒuƂ k ׂ
+  void findNearest(const GLfloat (*query)[3], int count, int k, int *neighbour, GLfloat *distance = NULL) const;
+};
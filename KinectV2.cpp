@@ -4,6 +4,9 @@
 // [xZT֘Ȁ
 //
 
+// Lu[VɂJ[̃eNX`Wւ̕ϊ
+#include "ColorMapper.h"
+
 // WCu
 #include <cassert>
 
@@ -14,10 +17,21 @@
 const GLfloat maxDepth(10.0f);
 
 // RXgN^
-KinectV2::KinectV2()
+KinectV2::KinectV2(GLenum pointFormat)
+  : sensor(NULL)
 {
   // ZT擾
-  if (sensor == NULL && GetDefaultKinectSensor(&sensor) == S_OK)
+  if (GetDefaultKinectSensor(&sensor) != S_OK) sensor = NULL;
+
+  // ق̃IuWFNgɊJĂΎgȂ
+  BOOLEAN open;
+  if (sensor && (sensor->get_IsOpen(&open) != S_OK || open))
+  {
+    sensor->Release();
+    sensor = NULL;
+  }
+
+  if (sensor)
   {
     // ZT̎gpJn
     assert(sensor->Open() == S_OK);
@@ -44,13 +58,18 @@ KinectV2::KinectV2()
     colorDescription->get_Height(&colorHeight);
 
     // depthCount  colorCount vZăeNX`ƃobt@IuWFNg쐬
-    makeTexture();
+    makeTexture(pointFormat);
 
     // fvXf[^JW߂Ƃɗpꎞmۂ
     position = new GLfloat[depthCount][3];
 
     // J[f[^ϊpꎞmۂ
     color = new GLubyte[colorCount * 4];
+
+    // ω^C̃J[̃eNX`W߂Ƃɗpꎞmۂ
+    depthPoint = new DepthSpacePoint[depthCount];
+    depthValue = new UINT16[depthCount];
+    colorPoint = new ColorSpacePoint[depthCount];
   }
 }
 
@@ -62,6 +81,9 @@ KinectV2::~KinectV2()
     // f[^ϊp̃폜
     delete[] position;
     delete[] color;
+    delete[] depthPoint;
+    delete[] depthValue;
+    delete[] colorPoint;
 
     // ZTJ
     colorDescription->Release();
@@ -73,10 +95,91 @@ KinectV2::~KinectV2()
     coordinateMapper->Release();
     sensor->Close();
     sensor->Release();
+  }
+}
 
-    // ZTJƂL^
-    sensor = NULL;
+// J[̃eNX`W߂ăobt@IuWFNgɓ]
+void KinectV2::mapColor(const UINT16 *depthBuffer) const
+{
+  // Lu[Vݒ肵Ă΂g
+  if (mapColorCalibrated(depthBuffer)) return;
+
+  // eNX`Wi[obt@IuWFNg}bv
+  glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+  ColorSpacePoint *const texcoord(static_cast<ColorSpacePoint *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)));
+
+  if (dirtyCount * 2 > tileCount)
+  {
+    // ω^CΑŜ̃eNX`W߂
+    coordinateMapper->MapDepthFrameToColorSpace(depthCount, depthBuffer, depthCount, texcoord);
+  }
+  else
+  {
+    // ω^C̉fW߂
+    UINT count(0);
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+      if (!dirty[tile]) continue;
+
+      int x0, y0, x1, y1;
+      getTileRect(tile, &x0, &y0, &x1, &y1);
+
+      for (int v = y0; v < y1; ++v)
+      {
+        for (int u = x0; u < x1; ++u)
+        {
+          depthPoint[count].X = float(u);
+          depthPoint[count].Y = float(v);
+          depthValue[count] = depthBuffer[v * depthWidth + u];
+          ++count;
+        }
+      }
+    }
+
+    // W߂f̃eNX`W߂
+    coordinateMapper->MapDepthPointsToColorSpace(count, depthPoint, count, depthValue, count, colorPoint);
+
+    // ߂eNX`W̉f̈ʒuɊi[
+    for (UINT k = 0; k < count; ++k)
+    {
+      texcoord[int(depthPoint[k].Y) * depthWidth + int(depthPoint[k].X)] = colorPoint[k];
+    }
   }
+
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+// ÕfvXf[^ɑ΂ SDK ̃eNX`W߂
+bool KinectV2::getSdkTexcoord(GLfloat (*texcoord)[2]) const
+{
+  return coordinateMapper->MapDepthFrameToColorSpace(depthCount, reference.data(), depthCount,
+    reinterpret_cast<ColorSpacePoint *>(texcoord)) == S_OK;
+}
+
+// ÕfvXf[^ɑ΂ SDK ̃eNX`Wɍ悤ɃLu[V߂ăt@Cɕۑ
+GLfloat KinectV2::fitColorMapping(const char *file) const
+{
+  // fvXJ̓p[^𓾂
+  CameraIntrinsics camera;
+  if (coordinateMapper->GetDepthCameraIntrinsics(&camera) != S_OK || camera.FocalLengthX == 0.0f) return -1.0f;
+
+  // ÕfvXf[^ׂ̂Ẳf SDK ɂeNX`W߂
+  std::vector<GLfloat> point(depthCount * 2);
+  GLfloat (*const texcoord)[2](reinterpret_cast<GLfloat (*)[2]>(point.data()));
+  if (!getSdkTexcoord(texcoord)) return -1.0f;
+
+  // fvXJ̓p[^Œ肵ĂȊO߂
+  ColorMapper mapper(depthWidth, depthHeight, colorWidth, colorHeight);
+  const ColorMapper::Intrinsics intrinsics =
+  {
+    camera.FocalLengthX, camera.FocalLengthY, camera.PrincipalPointX, camera.PrincipalPointY,
+    camera.RadialDistortionSecondOrder, camera.RadialDistortionFourthOrder, camera.RadialDistortionSixthOrder
+  };
+  mapper.setDepthIntrinsics(intrinsics);
+  const GLfloat error(mapper.fit(reference.data(), texcoord));
+
+  // ߂Lu[Vۑ
+  return error >= 0.0f && mapper.save(file) ? error : -1.0f;
 }
 
 // fvXf[^擾
@@ -94,14 +197,24 @@ GLuint KinectV2::getDepth() const
     UINT16 *depthBuffer;
     depthFrame->AccessUnderlyingBuffer(&depthSize, &depthBuffer);
 
-    // J[̃eNX`W߂ē]
-    glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
-    ColorSpacePoint *const texcoord(static_cast<ColorSpacePoint *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)));
-    coordinateMapper->MapDepthFrameToColorSpace(depthCount, depthBuffer, depthCount, texcoord);
-    glUnmapBuffer(GL_ARRAY_BUFFER);
+    // fvXf[^𕽊
+    const UINT16 *const depthData(filterDepth(depthBuffer));
 
-    // fvXf[^eNX`ɓ]
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, depthWidth, depthHeight, GL_RED, GL_UNSIGNED_SHORT, depthBuffer);
+    // fvXf[^ω^C𒲂ׂ
+    if (detectChange(depthData) > 0)
+    {
+      // J[̃eNX`W߂ē]
+      mapColor(depthData);
+
+      // ω^C̃fvXf[^eNX`ɓ]
+      uploadDirtyTiles(depthData, GL_RED, GL_UNSIGNED_SHORT, sizeof (UINT16));
+    }
+
+    // Mx߂
+    updateConfidence();
+
+    // Vt[擾
+    ++frame;
 
     // fvXt[J
     depthFrame->Release();
@@ -125,44 +238,69 @@ GLuint KinectV2::getPoint() const
     UINT16 *depthBuffer;
     depthFrame->AccessUnderlyingBuffer(&depthSize, &depthBuffer);
 
-    // JWւ̕ϊe[u𓾂
-    UINT32 entry;
-    PointF *table;
-    coordinateMapper->GetDepthFrameToCameraSpaceTable(&entry, &table);
+    // fvXf[^𕽊
+    const UINT16 *const depthData(filterDepth(depthBuffer));
 
-    // ׂĂ̓_ɂ
-    for (unsigned int i = 0; i < entry; ++i)
+    // fvXf[^ω^C𒲂ׂ
+    if (detectChange(depthData) > 0)
     {
-      // fvXl̒Pʂ[gɊZW
-      static const GLfloat zScale(-0.001f);
-
-      // ̓_̃fvXl𓾂
-      const unsigned short d(depthBuffer[i]);
-
-      // fvXl̒Pʂ[gɊZ (vs\_ maxDepth ɂ)
-      const GLfloat z(d == 0 ? -maxDepth : GLfloat(d) * zScale);
-
-      // ̓_̃XN[̈ʒu߂
-      const GLfloat x(table[i].X);
-      const GLfloat y(-table[i].Y);
-
-      // ̓_̃JW߂
-      position[i][0] = x * z;
-      position[i][1] = y * z;
-      position[i][2] = z;
+      // JWւ̕ϊe[u𓾂
+      UINT32 entry;
+      PointF *table;
+      coordinateMapper->GetDepthFrameToCameraSpaceTable(&entry, &table);
+
+      // ω^C̓_ɂ
+      for (int tile = 0; tile < tileCount; ++tile)
+      {
+        if (!dirty[tile]) continue;
+
+        // ̃^Cf͈̔
+        int x0, y0, x1, y1;
+        getTileRect(tile, &x0, &y0, &x1, &y1);
+
+        for (int v = y0; v < y1; ++v)
+        {
+          for (int u = x0; u < x1; ++u)
+          {
+            // fvXl̒Pʂ[gɊZW
+            static const GLfloat zScale(-0.001f);
+
+            // ̓_̔ԍ
+            const int i(v * depthWidth + u);
+
+            // ̓_̃fvXl𓾂
+            const unsigned short d(depthData[i]);
+
+            // fvXl̒Pʂ[gɊZ (vs\_ maxDepth ɂ)
+            const GLfloat z(d == 0 ? -maxDepth : GLfloat(d) * zScale);
+
+            // ̓_̃XN[̈ʒu߂
+            const GLfloat x(table[i].X);
+            const GLfloat y(-table[i].Y);
+
+            // ̓_̃JW߂
+            position[i][0] = x * z;
+            position[i][1] = y * z;
+            position[i][2] = z;
+          }
+        }
+      }
+
+      // J[̃eNX`W߂ăobt@IuWFNgɓ]
+      mapColor(depthData);
+
+      // ω^C̃JW]
+      uploadDirtyTiles(position, GL_RGB, GL_FLOAT, sizeof position[0]);
     }
 
-    // J[̃eNX`W߂ăobt@IuWFNgɓ]
-    glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
-    ColorSpacePoint *const texcoord(static_cast<ColorSpacePoint *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)));
-    coordinateMapper->MapDepthFrameToColorSpace(depthCount, depthBuffer, depthCount, texcoord);
-    glUnmapBuffer(GL_ARRAY_BUFFER);
+    // Mx߂
+    updateConfidence();
+
+    // Vt[擾
+    ++frame;
 
     // fvXt[J
     depthFrame->Release();
-
-    // JW]
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, depthWidth, depthHeight, GL_RGB, GL_FLOAT, position);
   }
 
   return pointTexture;
@@ -191,7 +329,3 @@ GLuint KinectV2::getColor() const
 
   return colorTexture;
 }
-
-
-// ZT̎ʎq
-IKinectSensor *KinectV2::sensor(NULL);
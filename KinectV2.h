@@ -13,8 +13,8 @@
 
 class KinectV2 : public DepthCamera
 {
-  // ZT̎ʎq
-  static IKinectSensor *sensor;
+  // ZT̎ʎq (SDK ͊̃ZTȂ̂, ɊJĂ NULL)
+  IKinectSensor *sensor;
 
   // W̃}bsO
   ICoordinateMapper *coordinateMapper;
@@ -35,6 +35,14 @@ class KinectV2 : public DepthCamera
   // J[f[^̕ϊɗpꎞ
   GLubyte *color;
 
+  // ω^C̃J[̃eNX`W߂Ƃɗpꎞ
+  DepthSpacePoint *depthPoint;
+  UINT16 *depthValue;
+  ColorSpacePoint *colorPoint;
+
+  // J[̃eNX`W߂ăobt@IuWFNgɓ]
+  void mapColor(const UINT16 *depthBuffer) const;
+
   // Rs[RXgN^ (Rs[֎~)
   KinectV2(const KinectV2 &w);
 
@@ -44,17 +52,33 @@ class KinectV2 : public DepthCamera
 public:
 
   // RXgN^
-  KinectV2();
+  //   pointFormat: JWi[eNX`̓tH[}bg
+  KinectV2(GLenum pointFormat = GL_RGB32F);
 
   // fXgN^
   virtual ~KinectV2();
 
   // fvXf[^擾
-  GLuint getDepth() const;
+  virtual GLuint getDepth() const;
 
   // JW擾
-  GLuint getPoint() const;
+  virtual GLuint getPoint() const;
+
+  // Ō getPoint() ŋ߂JW𓾂 (vłȂ_ z  -maxDepth)
+  virtual const GLfloat (*getPointBuffer() const)[3]
+  {
+    return position;
+  }
 
   // J[f[^擾
-  GLuint getColor() const;
+  virtual GLuint getColor() const;
+
+  // ÕfvXf[^ɑ΂ SDK ̃eNX`W߂
+  //   texcoord: eNX`W (f) ̊i[ (coordBuffer Ɠ, ϊłȂf -)
+  //   ߂l: ߂Ȃ false
+  bool getSdkTexcoord(GLfloat (*texcoord)[2]) const;
+
+  // ÕfvXf[^ɑ΂ SDK ̃eNX`Wɍ悤ɃLu[V߂ăt@Cɕۑ
+  //   ߂l: eNX`W̌덷̓敽ϕ (f), ߂ȂΕ̒l
+  GLfloat fitColorMapping(const char *file) const;
 };
@@ -0,0 +1,549 @@
+#include "MarchingCubes.h"
+
+//
+// }[`OL[u@ɂ TSDF ̕\ʂ̒o
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+
+// xɏubN
+const int brickGrain(4);
+
+// ubN̈ӂ̃{NZƎ̃{NZ܂߂W{̈ӂ̐
+const int brickSize(CpuTsdfBase::brickSize);
+const int sampleSize(brickSize + 3);
+
+// Z̒_̈ӂ̐
+const int edgeSize(brickSize + 1);
+
+// d݂ 0 ̃{NZ̕W{̒l (Ktɂ͂Ȃl)
+const GLfloat noSample(2.0f);
+
+// t̐K߂W
+const GLfloat distanceScale(1.0f / 32767.0f);
+
+// ӂ̃L[ɋlߍރ{NZ̈ʒü̎̃rbgƕ̈ʒu𐳂ɂ邽߂̉
+const int edgeKeyBits(20);
+const int edgeKeyBias(1 << (edgeKeyBits - 1));
+const GLuint64 edgeKeyMask((GLuint64(1) << edgeKeyBits) - 1);
+
+namespace
+{
+  //
+  // Z̒_ k ̈ʒu (k & 1, k >> 1 & 1, k >> 2 & 1)
+  // Z̕ e ̗[̒_ (ӂ̌ e / 4 ̎)
+  //
+  const int edgeCorner[12][2] =
+  {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+  };
+
+  //
+  // ̒_̑gݍ킹Ƃ̎Op`̕\
+  //
+  //   Z 6 ̖ʂO猩čɂǂ, 琳ɕςӂ̌_玟̌_܂Ő
+  //   (̐̒_؂藎Ƃ)
+  //   ׂ̖͗ʂ̐ƂȂĕւɂȂ̂, ւ`ɎOp`ɕ
+  //
+  struct CubeTable
+  {
+    // Op`̐
+    int count[256];
+
+    // Op`̒_
+    signed char edge[256][12][3];
+
+    // RXgN^
+    CubeTable()
+    {
+      // [̒_ӂ\
+      int edgeIndex[8][8];
+      for (int e = 0; e < 12; ++e)
+      {
+        edgeIndex[edgeCorner[e][0]][edgeCorner[e][1]] = e;
+        edgeIndex[edgeCorner[e][1]][edgeCorner[e][0]] = e;
+      }
+
+      for (int cube = 0; cube < 256; ++cube)
+      {
+        // _̂ӂƂ̐łȂ鎟̕
+        int next[12];
+        std::fill(next, next + 12, -1);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          for (int side = 0; side < 2; ++side)
+          {
+            // ʂ̒_O猩čɕׂ
+            const int u(1 << (axis + 1) % 3), v(1 << (axis + 2) % 3), w(side << axis);
+            int q[4] = { w, w | u, w | u | v, w | v };
+            if (side == 0) std::swap(q[1], q[3]);
+
+            // 琳ɕςӂ玟ɕςӂ܂Ő
+            for (int k = 0; k < 4; ++k)
+            {
+              const int a(q[k]), b(q[(k + 1) & 3]);
+              if (!(cube >> a & 1) || (cube >> b & 1)) continue;
+              for (int j = 1; j < 4; ++j)
+              {
+                const int c(q[(k + j) & 3]), d(q[(k + j + 1) & 3]);
+                if ((cube >> c & 1) == (cube >> d & 1)) continue;
+                next[edgeIndex[a][b]] = edgeIndex[c][d];
+                break;
+              }
+            }
+          }
+        }
+
+        // ̗ւ`ɎOp`ɕ (ւ͐̑猩ĉEȂ̂ŋtɂǂ)
+        count[cube] = 0;
+        bool visited[12] = {};
+        for (int e = 0; e < 12; ++e)
+        {
+          if (next[e] < 0 || visited[e]) continue;
+          int loop[12], n(0);
+          for (int f = e; !visited[f]; f = next[f])
+          {
+            visited[f] = true;
+            loop[n++] = f;
+          }
+          for (int i = 1; i + 1 < n; ++i)
+          {
+            signed char *const t(edge[cube][count[cube]++]);
+            t[0] = static_cast<signed char>(loop[0]);
+            t[1] = static_cast<signed char>(loop[i + 1]);
+            t[2] = static_cast<signed char>(loop[i]);
+          }
+        }
+      }
+    }
+  };
+
+  // Op`̕\
+  const CubeTable table;
+
+  // W{̊i[ꏊ߂
+  int sampleIndex(int x, int y, int z)
+  {
+    return (z * sampleSize + y) * sampleSize + x;
+  }
+
+  // W{̊i[ꏊ i ̕ťz߂ (ׂȂΕБ̍)
+  void gradient(const GLfloat *sample, int i, GLfloat *g)
+  {
+    static const int stride[3] = { 1, sampleSize, sampleSize * sampleSize };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const GLfloat a(sample[i + stride[axis]]), b(sample[i - stride[axis]]), c(sample[i]);
+      if (a != noSample && b != noSample)
+        g[axis] = (a - b) * 0.5f;
+      else if (a != noSample)
+        g[axis] = a - c;
+      else if (b != noSample)
+        g[axis] = c - b;
+      else
+        g[axis] = 0.0f;
+    }
+  }
+
+  // 蓖Ă͈͂̑傫 (傫ȂĂ悤ɂ)
+  GLuint roomFor(size_t count)
+  {
+    return GLuint(count + count / 4);
+  }
+}
+
+// RXgN^
+MarchingCubes::MarchingCubes()
+  : volume(NULL)
+  , lastVersion(0)
+  , vertexLimit(0)
+  , faceLimit(0)
+  , vertexEnd(0)
+  , faceEnd(0)
+{
+}
+
+// {[̕\ʂ𒊏oĐ}`Ɋi[, oubN̐Ԃ
+int MarchingCubes::update(const CpuTsdfBase &volume)
+{
+  const int slots(volume.getBrickSlots());
+
+  // Ⴄ{[Ȃ炷ׂĒo
+  if (&volume != this->volume || int(piece.size()) != slots)
+  {
+    this->volume = &volume;
+    piece.assign(slots, Piece());
+    dirty.assign(slots, 0);
+    lastVersion = 0;
+    vertexEnd = faceEnd = 0;
+  }
+
+  // O̒ôƂōXVubNƂ̎̃ubNɈ
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    const Piece &p(piece[slot]);
+    int x, y, z;
+    const bool used(volume.getBrickPosition(slot, &x, &y, &z));
+    const bool moved(p.used && (!used || x != p.x || y != p.y || z != p.z));
+
+    // ̂Ăg񂵂肵ubN͌̈ʒu̎o
+    if (moved)
+    {
+      markAround(p.x, p.y, p.z);
+      dirty[slot] = 1;
+    }
+
+    if (used && (moved || !p.used || volume.getBrickVersion(slot) > lastVersion)) markAround(x, y, z);
+  }
+  lastVersion = volume.getVersion();
+
+  // ubNW߂
+  pending.clear();
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    if (dirty[slot])
+    {
+      dirty[slot] = 0;
+      pending.push_back(slot);
+    }
+  }
+
+  // ubNƂɕɒo
+  Parallel::run(0, int(pending.size()), [this](int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) extractBrick(pending[i]);
+  }, brickGrain);
+
+  // obt@IuWFNgɏ
+  upload();
+
+  return int(pending.size());
+}
+
+// ubNPʂ̈ʒu (x, y, z) ̃ubNƂ̎̃ubNɒo
+//   Z̒_ + ׂ̗̃ubN, zׂ̗͗̃ubÑ{NZg
+void MarchingCubes::markAround(int x, int y, int z)
+{
+  for (int dz = -1; dz <= 1; ++dz)
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        const int slot(volume->findBrick(x + dx, y + dy, z + dz));
+        if (slot >= 0) dirty[slot] = 1;
+      }
+}
+
+// i[ꏊ̃ubN̕\ʂ𒊏o
+void MarchingCubes::extractBrick(int slot)
+{
+  Piece &p(piece[slot]);
+  p.position.clear();
+  p.normal.clear();
+  p.face.clear();
+  p.edge.clear();
+  p.used = volume->getBrickPosition(slot, &p.x, &p.y, &p.z);
+  if (!p.used) return;
+
+  // Z̍ŏ̋͂̃ubÑ{NZȂ̂, {NZȂΕ\ʂ͂Ȃ
+  const CpuTsdfBase::Voxel *const own(volume->getBrickVoxel(slot));
+  int weighted(0);
+  for (int i = 0; i < CpuTsdfBase::brickVoxels; ++i) weighted |= own[i].weight;
+  if (weighted == 0) return;
+
+  // ubÑ{NZƎ̈ (+ ͓) ̃{NZ̕tW{ɂ
+  //   ̃ubNƂɕW{ɓ͈͂o (- ͍Ō̈, + ͍ŏ̓)
+  static const int first[3] = { brickSize - 1, 0, 0 }, count[3] = { 1, brickSize, 2 }, offset[3] = { 0, 1, brickSize + 1 };
+  GLfloat sample[sampleSize * sampleSize * sampleSize];
+  for (int i = 0; i < 27; ++i)
+  {
+    const int bx(i % 3), by(i / 3 % 3), bz(i / 9);
+    const int n(i == 13 ? slot : volume->findBrick(p.x + bx - 1, p.y + by - 1, p.z + bz - 1));
+    const CpuTsdfBase::Voxel *const v(n >= 0 ? volume->getBrickVoxel(n) : NULL);
+    for (int z = 0; z < count[bz]; ++z)
+    {
+      for (int y = 0; y < count[by]; ++y)
+      {
+        GLfloat *const s(sample + sampleIndex(offset[bx], offset[by] + y, offset[bz] + z));
+        if (v == NULL)
+        {
+          std::fill(s, s + count[bx], noSample);
+          continue;
+        }
+        const CpuTsdfBase::Voxel *const w(v + ((first[bz] + z) * brickSize + first[by] + y) * brickSize + first[bx]);
+        for (int x = 0; x < count[bx]; ++x)
+          s[x] = w[x].weight > 0 ? GLfloat(w[x].distance) * distanceScale : noSample;
+      }
+    }
+  }
+
+  // Z̒_̒ɐƕ̕W{ȂΕ\ʂ͂Ȃ
+  bool negative(false), positive(false);
+  for (int z = 1; z <= edgeSize; ++z)
+    for (int y = 1; y <= edgeSize; ++y)
+      for (int x = 1; x <= edgeSize; ++x)
+      {
+        const GLfloat s(sample[sampleIndex(x, y, z)]);
+        if (s < 0.0f) negative = true;
+        else if (s != noSample) positive = true;
+      }
+  if (!negative || !positive) return;
+
+  // Z̒_̕W{̊i[ꏊ̍
+  int corner[8];
+  for (int k = 0; k < 8; ++k) corner[k] = sampleIndex(k & 1, k >> 1 & 1, k >> 2 & 1);
+
+  // ӂ̌̕W{̊i[ꏊ̍
+  static const int stride[3] = { 1, sampleSize, sampleSize * sampleSize };
+
+  // Z̕ӂ̍ŏ̋Ƃɍ_̔ԍ (܂ĂȂ -1)
+  int vertex[3][edgeSize * edgeSize * edgeSize];
+  std::fill(vertex[0], vertex[0] + 3 * edgeSize * edgeSize * edgeSize, -1);
+
+  // ubN̍ŏ̃{NZ̑Ŝł̈ʒu
+  //   _ʒu͑Ŝł̃{NZ̈ʒu狁߂, E̒_ׂ̃ubNŋ߂̂ƓlɂȂ悤ɂ
+  const GLfloat *const origin(volume->getOrigin());
+  const GLfloat voxelSize(volume->getVoxelSize());
+  const int bx(p.x * brickSize), by(p.y * brickSize), bz(p.z * brickSize);
+
+  for (int z = 0; z < brickSize; ++z)
+  {
+    for (int y = 0; y < brickSize; ++y)
+    {
+      for (int x = 0; x < brickSize; ++x)
+      {
+        // Z̒_̕tƕ̒_̑gݍ킹
+        const int base(sampleIndex(x + 1, y + 1, z + 1));
+        GLfloat c[8];
+        int cube(0);
+        bool valid(true);
+        for (int k = 0; k < 8; ++k)
+        {
+          c[k] = sample[base + corner[k]];
+          if (c[k] == noSample) valid = false;
+          if (c[k] < 0.0f) cube |= 1 << k;
+        }
+        if (!valid || cube == 0 || cube == 255) continue;
+
+        for (int t = 0; t < table.count[cube]; ++t)
+        {
+          GLuint f[3];
+          for (int j = 0; j < 3; ++j)
+          {
+            // ӂ̍ŏ̋̃ubN̒̈ʒu
+            const int e(table.edge[cube][t][j]), axis(e / 4), k0(edgeCorner[e][0]), k1(edgeCorner[e][1]);
+            const int ex(x + (k0 & 1)), ey(y + (k0 >> 1 & 1)), ez(z + (k0 >> 2 & 1));
+
+            // ӂ̏̒_܂Ȃ΍
+            int &id(vertex[axis][(ez * edgeSize + ey) * edgeSize + ex]);
+            if (id < 0)
+            {
+              id = int(p.position.size() / 3);
+
+              // t 0 ɂȂʒu
+              const int g[3] = { bx + ex, by + ey, bz + ez };
+              const GLfloat s(c[k0] / (c[k0] - c[k1]));
+              GLfloat q[3] = { GLfloat(g[0]) + 0.5f, GLfloat(g[1]) + 0.5f, GLfloat(g[2]) + 0.5f };
+              q[axis] += s;
+              for (int a = 0; a < 3; ++a) p.position.push_back(origin[a] + q[a] * voxelSize);
+
+              // ӂ̑Ŝł̈ʒuƌ
+              p.edge.push_back(((GLuint64(g[0] + edgeKeyBias) & edgeKeyMask) << (edgeKeyBits * 2 + 2))
+                | ((GLuint64(g[1] + edgeKeyBias) & edgeKeyMask) << (edgeKeyBits + 2))
+                | ((GLuint64(g[2] + edgeKeyBias) & edgeKeyMask) << 2)
+                | GLuint64(axis));
+
+              // [̌zԂĖ@xNgɂ
+              const int i0(base + corner[k0]);
+              GLfloat g0[3], g1[3];
+              gradient(sample, i0, g0);
+              gradient(sample, i0 + stride[axis], g1);
+              const GLfloat nx(g0[0] + (g1[0] - g0[0]) * s);
+              const GLfloat ny(g0[1] + (g1[1] - g0[1]) * s);
+              const GLfloat nz(g0[2] + (g1[2] - g0[2]) * s);
+              const GLfloat l(sqrt(nx * nx + ny * ny + nz * nz));
+              const GLfloat r(l > 0.0f ? 1.0f / l : 0.0f);
+              p.normal.push_back(nx * r);
+              p.normal.push_back(ny * r);
+              p.normal.push_back(nz * r);
+            }
+            f[j] = GLuint(id);
+          }
+          p.face.insert(p.face.end(), f, f + 3);
+        }
+      }
+    }
+  }
+}
+
+// oubN̕\ʂobt@IuWFNgɏ
+void MarchingCubes::upload()
+{
+  // 蓖Ă͈͂Ɏ܂ȂubNɕtƂ̏I
+  GLuint vertexNeed(vertexEnd), faceNeed(faceEnd);
+  for (size_t i = 0; i < pending.size(); ++i)
+  {
+    const Piece &p(piece[pending[i]]);
+    const size_t nv(p.position.size() / 3), nf(p.face.size() / 3);
+    if (nv > p.vertexRoom || nf > p.faceRoom)
+    {
+      vertexNeed += roomFor(nv);
+      faceNeed += roomFor(nf);
+    }
+  }
+
+  // obt@IuWFNgȂ΋l߂Ċmۂ
+  if (vertexNeed > vertexLimit || faceNeed > faceLimit || faceLimit == 0)
+  {
+    rebuild();
+    return;
+  }
+
+  for (size_t i = 0; i < pending.size(); ++i)
+  {
+    Piece &p(piece[pending[i]]);
+    const size_t nv(p.position.size() / 3), nf(p.face.size() / 3);
+
+    // 蓖Ă͈͂Ɏ܂ȂΌ͈̔͂ɂČɕt
+    if (nv > p.vertexRoom || nf > p.faceRoom)
+    {
+      p.vertexRoom = 0;
+      send(p);
+      p.vertexFirst = vertexEnd;
+      p.vertexRoom = roomFor(nv);
+      vertexEnd += p.vertexRoom;
+      p.faceFirst = faceEnd;
+      p.faceRoom = roomFor(nf);
+      faceEnd += p.faceRoom;
+    }
+
+    send(p);
+  }
+}
+
+// ׂẴubN̕\ʂl߂ăobt@IuWFNgmۂ
+void MarchingCubes::rebuild()
+{
+  // ubNɔ͈͂蓖Ē
+  vertexEnd = faceEnd = 0;
+  for (size_t slot = 0; slot < piece.size(); ++slot)
+  {
+    Piece &p(piece[slot]);
+    p.vertexFirst = vertexEnd;
+    p.vertexRoom = p.used ? roomFor(p.position.size() / 3) : 0;
+    vertexEnd += p.vertexRoom;
+    p.faceFirst = faceEnd;
+    p.faceRoom = p.used ? roomFor(p.face.size() / 3) : 0;
+    faceEnd += p.faceRoom;
+  }
+
+  // Ă̂ɔ 1.5 {mۂ
+  vertexLimit = (std::max)(vertexEnd + vertexEnd / 2, GLuint(1024));
+  faceLimit = (std::max)(faceEnd + faceEnd / 2, GLuint(1024));
+
+  // gĂȂ͈͂͌_̏kނOp`ɂ
+  std::vector<GLfloat> position(vertexLimit * 3, 0.0f), normal(vertexLimit * 3, 0.0f);
+  staging.assign(faceLimit * 3, 0);
+  for (size_t slot = 0; slot < piece.size(); ++slot)
+  {
+    const Piece &p(piece[slot]);
+    std::copy(p.position.begin(), p.position.end(), position.begin() + p.vertexFirst * 3);
+    std::copy(p.normal.begin(), p.normal.end(), normal.begin() + p.vertexFirst * 3);
+    GLuint *const f(staging.data() + p.faceFirst * 3);
+    for (size_t i = 0; i < p.face.size(); ++i) f[i] = p.face[i] + p.vertexFirst;
+    std::fill(f + p.face.size(), f + p.faceRoom * 3, p.vertexFirst);
+  }
+
+  mesh.use();
+  mesh.load(vertexLimit, reinterpret_cast<const GLfloat (*)[3]>(position.data()),
+    reinterpret_cast<const GLfloat (*)[3]>(normal.data()),
+    faceLimit, reinterpret_cast<const GLuint (*)[3]>(staging.data()), GL_DYNAMIC_DRAW);
+}
+
+// ubN̕\ʂ蓖Ă͈͂ɏ (vertexRoom  0 Ȃ͈͂kނOp`Ŗ߂)
+void MarchingCubes::send(const Piece &p)
+{
+  if (p.faceRoom == 0) return;
+  const GLuint nv(p.vertexRoom > 0 ? GLuint(p.position.size() / 3) : 0);
+  const GLuint nf(p.vertexRoom > 0 ? GLuint(p.face.size() / 3) : 0);
+
+  // _ʒuƖ@xNg
+  if (nv > 0)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.pbuf());
+    glBufferSubData(GL_ARRAY_BUFFER, p.vertexFirst * sizeof (GLfloat[3]), nv * sizeof (GLfloat[3]), p.position.data());
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.nbuf());
+    glBufferSubData(GL_ARRAY_BUFFER, p.vertexFirst * sizeof (GLfloat[3]), nv * sizeof (GLfloat[3]), p.normal.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  // Op`̒_ԍ (c͏kނOp`)
+  staging.resize(p.faceRoom * 3);
+  for (GLuint i = 0; i < nf * 3; ++i) staging[i] = p.face[i] + p.vertexFirst;
+  std::fill(staging.begin() + nf * 3, staging.begin() + p.faceRoom * 3, p.vertexFirst);
+  mesh.use();
+  mesh.send(p.faceRoom, reinterpret_cast<const GLuint (*)[3]>(staging.data()), p.faceFirst);
+}
+
+// o\ʂ̒_ƎOp`܂Ƃ߂Ďo
+void MarchingCubes::gather(std::vector<GLfloat> &position, std::vector<GLfloat> &normal, std::vector<GLuint> &face) const
+{
+  position.clear();
+  normal.clear();
+  face.clear();
+
+  // ӂ̑Ŝł̈ʒuƂɍŏɎo_̔ԍ
+  std::unordered_map<GLuint64, GLuint> shared;
+  std::vector<GLuint> index;
+
+  for (size_t slot = 0; slot < piece.size(); ++slot)
+  {
+    const Piece &p(piece[slot]);
+
+    // ق̃ubNœӂ̒_oĂ΂g
+    index.resize(p.edge.size());
+    for (size_t i = 0; i < p.edge.size(); ++i)
+    {
+      const GLuint n(GLuint(position.size() / 3));
+      const std::pair<std::unordered_map<GLuint64, GLuint>::iterator, bool> found(shared.insert(std::make_pair(p.edge[i], n)));
+      index[i] = found.first->second;
+      if (!found.second) continue;
+      position.insert(position.end(), p.position.begin() + i * 3, p.position.begin() + i * 3 + 3);
+      normal.insert(normal.end(), p.normal.begin() + i * 3, p.normal.begin() + i * 3 + 3);
+    }
+    for (size_t i = 0; i < p.face.size(); ++i) face.push_back(index[p.face[i]]);
+  }
+}
+
+// o\ʂ Wavefront OBJ `̃t@Cɕۑ
+bool MarchingCubes::save(const char *file) const
+{
+  std::ofstream out(file);
+  if (!out) return false;
+
+  std::vector<GLfloat> position, normal;
+  std::vector<GLuint> face;
+  gather(position, normal, face);
+
+  out.precision(7);
+  for (size_t i = 0; i < position.size(); i += 3)
+    out << "v " << position[i] << ' ' << position[i + 1] << ' ' << position[i + 2] << '\n';
+  for (size_t i = 0; i < normal.size(); i += 3)
+    out << "vn " << normal[i] << ' ' << normal[i + 1] << ' ' << normal[i + 2] << '\n';
+  for (size_t i = 0; i < face.size(); i += 3)
+  {
+    const GLuint a(face[i] + 1), b(face[i + 1] + 1), c(face[i + 2] + 1);
+    out << "f " << a << "//" << a << ' ' << b << "//" << b << ' ' << c << "//" << c << '\n';
+  }
+
+  return bool(out);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+//
+// }[`OL[u@ɂ TSDF ̕\ʂ̒o
+//
+//   ׂ荇 8 ̃{NZ̒S𒸓_Ƃ闧 (Z) Ƃ, t 0 ɂȂʂOp`ɂ
+//   Z͍ŏ̋̃{NZ̃ubNɑ, ubNƂɕɒo
+//   ubN̒ł̓Z̕ӂ̏̒_L, ubN̋E̒_̓ubNƂɎ
+//   E̒_ׂ͗̃ubNƓlɂȂ悤ɑŜ̃{NZ̈ʒu狁߂̂, `ƂɌԂ͂łȂ
+//   gather()  save() ͕ӂ̑Ŝł̈ʒu_ɂ܂Ƃ߂̂, o\ʂ̓ubN̋EłȂ
+//   d݂ 0 ̃{NZ܂ރZ͔΂, @xNg͕ťzԂċ߂
+//
+//   ܂Ȗ (Ίp̒_) ͐̒_؂藎Ƃ悤Ɍ߂̂, ׂ̃ZƖʂ̕낢
+//   o\ʂɂ͌Ȃ (Op`͐̑猩č)
+//
+//   O̒ôƂōXVubN (̂Ăg񂵂肵ubŇ̈ʒu܂) 
+//   ̎̃ubN𒊏o, ubNƂ GgElements ̒_ƎOp`͈̔͂蓖Ăď
+//   ͈͂Ɏ܂ȂȂubN͌ɕt, obt@IuWFNgȂȂl߂Ċmۂ
+//
+
+// TSDF ɂfvXf[^̓
+#include "Tsdf.h"
+
+class MarchingCubes
+{
+  // ubNƂɒo\
+  struct Piece
+  {
+    // oƂ̃ubNPʂ̈ʒu
+    int x, y, z;
+
+    // ubNgĂǂ
+    bool used;
+
+    // _ʒuƖ@xNg (GLfloat[3]) ƎOp`̒_ԍ (GLuint[3], ubN̒̔ԍ)
+    std::vector<GLfloat> position, normal;
+    std::vector<GLuint> face;
+
+    // _ӂ̑Ŝł̈ʒu (gather() ŗׂ̃ubN̓_܂Ƃ߂̂Ɏg)
+    std::vector<GLuint64> edge;
+
+    // obt@IuWFNgɊ蓖Ă_ƎOp`͈̔͂̐擪Ƒ傫
+    GLuint vertexFirst, vertexRoom, faceFirst, faceRoom;
+
+    // RXgN^
+    Piece()
+      : x(0), y(0), z(0), used(false), vertexFirst(0), vertexRoom(0), faceFirst(0), faceRoom(0) {}
+  };
+
+  // \ʂ𒊏o{[
+  const CpuTsdfBase *volume;
+
+  // O̒ôƂ̃{[̓
+  GLuint lastVersion;
+
+  // ubN̊i[ꏊƂ̒o\
+  std::vector<Piece> piece;
+
+  // oubN̈ƒoubN
+  std::vector<GLubyte> dirty;
+  std::vector<int> pending;
+
+  // o\ʂi[}`
+  GgElements mesh;
+
+  // obt@IuWFNgɊmۂ_ƎOp`̐
+  GLuint vertexLimit, faceLimit;
+
+  // obt@IuWFNg̊蓖Ă͈͂̏I
+  GLuint vertexEnd, faceEnd;
+
+  // obt@IuWFNgɓ]Op`̒_ԍ
+  std::vector<GLuint> staging;
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubNƂ̎̃ubNɒo
+  void markAround(int x, int y, int z);
+
+  // i[ꏊ̃ubN̕\ʂ𒊏o
+  void extractBrick(int slot);
+
+  // oubN̕\ʂobt@IuWFNgɏ
+  void upload();
+
+  // ׂẴubN̕\ʂl߂ăobt@IuWFNgmۂ
+  void rebuild();
+
+  // ubN̕\ʂ蓖Ă͈͂ɏ
+  void send(const Piece &p);
+
+  // Rs[RXgN^ (Rs[֎~)
+  MarchingCubes(const MarchingCubes &o);
+
+  //  (֎~)
+  MarchingCubes &operator=(const MarchingCubes &o);
+
+public:
+
+  // RXgN^
+  MarchingCubes();
+
+  // fXgN^
+  virtual ~MarchingCubes() {}
+
+  // {[̕\ʂ𒊏oĐ}`Ɋi[, oubN̐Ԃ
+  //   OƓ{[ȂO̒ôƂŕςƂ낾o
+  int update(const CpuTsdfBase &volume);
+
+  // o\ʂ`悷
+  void draw() const
+  {
+    if (faceEnd > 0) mesh.draw(0, faceEnd);
+  }
+
+  // o\ʂi[}`𓾂 (Op` faceEnd ܂, gĂȂ͈͂͏kނOp`)
+  const GgElements &getMesh() const
+  {
+    return mesh;
+  }
+
+  // o\ʂ̒_ƎOp`܂Ƃ߂Ďo (ubN̋E̒_͈ɂ܂Ƃ߂)
+  void gather(std::vector<GLfloat> &position, std::vector<GLfloat> &normal, std::vector<GLuint> &face) const;
+
+  // o\ʂ Wavefront OBJ `̃t@Cɕۑ
+  bool save(const char *file) const;
+};
@@ -0,0 +1,457 @@
+#include "Octree.h"
+
+//
+// _Q̔
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <algorithm>
+
+// _ϊƂɈxɏ_̐
+const int pointGrain(4096);
+
+// Ƀ\[gƂ̈̃Xbh̓_̐̉
+const int sortGrain(16384);
+
+// \[g̈ꌅ̃rbg
+const int radixBits(11);
+
+// TƂɐςސߓ_̐̏ (ȉ 21 Ɏq̐ 8 |̂傫)
+const int stackSize(256);
+
+namespace
+{
+  // 21 rbg̐̃rbgɍL
+  inline GLuint64 spread(GLuint64 x)
+  {
+    x &= 0x1fffffULL;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+  }
+
+  // ƓY̑g [begin, end) 𕄍̉ bits rbgŊ\[g (work ͓͈͂ƂɎg)
+  //   Ȃ̂, ȂY̏̂܂܎c
+  void radixSort(std::pair<GLuint64, int> *a, std::pair<GLuint64, int> *work, int count, int bits)
+  {
+    std::vector<int> bucket(1 << radixBits);
+    std::pair<GLuint64, int> *source(a), *target(work);
+    for (int shift = 0; shift < bits; shift += radixBits)
+    {
+      // ̒lƂ̐𐔂Đ擪̈ʒu߂
+      std::fill(bucket.begin(), bucket.end(), 0);
+      const GLuint64 mask((1 << radixBits) - 1);
+      for (int i = 0; i < count; ++i) ++bucket[int((source[i].first >> shift) & mask)];
+      for (int d = 0, sum = 0; d < (1 << radixBits); ++d)
+      {
+        const int n(bucket[d]);
+        bucket[d] = sum;
+        sum += n;
+      }
+
+      // ̒l̏Ɉڂ
+      for (int i = 0; i < count; ++i) target[bucket[int((source[i].first >> shift) & mask)]++] = source[i];
+      std::swap(source, target);
+    }
+
+    // Ɨp̕ɌʂΖ߂
+    if (source != a) std::copy(source, source + count, a);
+  }
+
+  // ƓY̑g𕄍̉ bits rbgŕɃ\[g
+  //   XbhƂ͈̔͂ꂼ\[gĂ, ׂ荇͈͂ɕĂ
+  void parallelSort(std::vector< std::pair<GLuint64, int> > &a, std::vector< std::pair<GLuint64, int> > &work, int bits)
+  {
+    const int n(int(a.size()));
+    const int chunks((std::max)((std::min)(Parallel::getThreads(), n / sortGrain), 1));
+    std::vector<int> bound(chunks + 1);
+    for (int k = 0; k <= chunks; ++k) bound[k] = int(GLint64(n) * k / chunks);
+
+    work.resize(n);
+    if (n == 0) return;
+    Parallel::run(0, chunks, [&](int begin, int end)
+    {
+      for (int k = begin; k < end; ++k) radixSort(&a[bound[k]], &work[bound[k]], bound[k + 1] - bound[k], bits);
+    });
+
+    // ͕Ŕׂ (ȂO͈̔͂̕ɂȂ)
+    for (int width = 1; width < chunks; width *= 2)
+    {
+      Parallel::run(0, (chunks + width * 2 - 1) / (width * 2), [&](int begin, int end)
+      {
+        for (int k = begin; k < end; ++k)
+        {
+          const int lo(k * width * 2), mid((std::min)(lo + width, chunks)), hi((std::min)(lo + width * 2, chunks));
+          std::merge(a.begin() + bound[lo], a.begin() + bound[mid], a.begin() + bound[mid], a.begin() + bound[hi],
+            work.begin() + bound[lo], [](const std::pair<GLuint64, int> &x, const std::pair<GLuint64, int> &y)
+          {
+            return x.first < y.first;
+          });
+        }
+      });
+      a.swap(work);
+    }
+  }
+
+  // ̂̒S̋̓̉Ə߂
+  inline void boxDistance(const GLfloat *lower, GLfloat width, const GLfloat *p, GLfloat &minimum, GLfloat &maximum)
+  {
+    minimum = maximum = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+      const GLfloat d0(lower[c] - p[c]), d1(p[c] - lower[c] - width);
+      const GLfloat inner((std::max)((std::max)(d0, d1), 0.0f));
+      const GLfloat outer((std::max)(std::fabs(d0), std::fabs(d1)));
+      minimum += inner * inner;
+      maximum += outer * outer;
+    }
+  }
+}
+
+// RXgN^
+Octree::Octree(const GLfloat *origin, GLfloat size, int depth, int leafCapacity)
+  : size(size)
+  , depth((std::max)((std::min)(depth, 21), 1))
+  , leafCapacity((std::max)(leafCapacity, 1))
+{
+  this->origin[0] = origin[0];
+  this->origin[1] = origin[1];
+  this->origin[2] = origin[2];
+  clear();
+}
+
+// _Ɛߓ_ɂ
+void Octree::clear()
+{
+  const Node root = { -1, -1, 0 };
+  node.assign(1, root);
+  point.clear();
+  code.clear();
+  next.clear();
+}
+
+// _{NZ̈ʒũ[gɂ
+bool Octree::encode(const GLfloat *p, GLuint64 &c) const
+{
+  const GLfloat cells(GLfloat(1 << depth)), scale(cells / size);
+  int v[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    const GLfloat f((p[i] - origin[i]) * scale);
+    if (!(f >= 0.0f && f < cells))
+    {
+      c = outside;
+      return false;
+    }
+    v[i] = int(f);
+  }
+  c = spread(v[0]) | spread(v[1]) << 1 | spread(v[2]) << 2;
+  return true;
+}
+
+// ̎qv[o
+int Octree::allocate()
+{
+  const int c(int(node.size()));
+  const Node leaf = { -1, -1, 0 };
+  node.resize(c + 8, leaf);
+  return c;
+}
+
+// _LWnɕϊ staging , ƓY̑g order ɍ
+void Octree::prepare(const GLfloat (*p)[3], int count, const GgMatrix &pose)
+{
+  const GLfloat *const m(pose.get());
+  staging.resize(size_t(count) * 3);
+  order.resize(count);
+
+  Parallel::run(0, (count + pointGrain - 1) / pointGrain, [&](int begin, int end)
+  {
+    const int last((std::min)(end * pointGrain, count));
+    for (int i = begin * pointGrain; i < last; ++i)
+    {
+      GLfloat *const q(&staging[size_t(i) * 3]);
+      q[0] = m[0] * p[i][0] + m[4] * p[i][1] + m[8] * p[i][2] + m[12];
+      q[1] = m[1] * p[i][0] + m[5] * p[i][1] + m[9] * p[i][2] + m[13];
+      q[2] = m[2] * p[i][0] + m[6] * p[i][1] + m[10] * p[i][2] + m[14];
+      order[i].second = i;
+      if (p[i][2] < depthInvalid || !encode(q, order[i].first)) order[i].first = outside;
+    }
+  });
+}
+
+// _Q甪؂蒼
+int Octree::build(const GLfloat (*p)[3], int count, const GgMatrix &pose)
+{
+  clear();
+
+  // ̏ɕ, ̂̊O̓_͖ɏW܂̂ŏ (̃rbg܂ŕׂ outside ɂȂ)
+  prepare(p, count, pose);
+  parallelSort(order, work, depth * 3 + 1);
+  int n(count);
+  while (n > 0 && order[n - 1].first == outside) --n;
+
+  // _𕄍̏ɕבւ
+  point.resize(size_t(n) * 3);
+  code.resize(n);
+  next.resize(n);
+  Parallel::run(0, (n + pointGrain - 1) / pointGrain, [&](int begin, int end)
+  {
+    const int last((std::min)(end * pointGrain, n));
+    for (int i = begin * pointGrain; i < last; ++i)
+    {
+      const GLfloat *const q(&staging[size_t(order[i].second) * 3]);
+      std::copy(q, q + 3, &point[size_t(i) * 3]);
+      code[i] = order[i].first;
+      next[i] = i + 1;
+    }
+  });
+
+  // 񂾕͈̔͂ߓ_
+  build(0, 0, 0, n);
+
+  return n;
+}
+
+// ̏ɕׂ_ [begin, end) i level ̐ߓ_ n ̕؂
+void Octree::build(int n, int level, int begin, int end)
+{
+  node[n].count = end - begin;
+
+  // _ȂłׂiȂtɂ, 񂾓_̂܂܂Ȃ
+  if (end - begin <= leafCapacity || level == depth)
+  {
+    node[n].first = begin < end ? begin : -1;
+    if (begin < end) next[end - 1] = -1;
+    return;
+  }
+
+  // q̈ʒuƂɑĂ͈͂Ŏq̕؂ (allocate() Ńv[ڂ̂œYŎQƂ)
+  const int c(allocate());
+  node[n].child = c;
+  for (int o = 0, b = begin; o < 8; ++o)
+  {
+    int e(b);
+    while (e < end && getOctant(code[e], level) == o) ++e;
+    build(c + o, level + 1, b, e);
+    b = e;
+  }
+}
+
+// _Q𔪕؂ɒǉ
+int Octree::insert(const GLfloat (*p)[3], int count, const GgMatrix &pose)
+{
+  prepare(p, count, pose);
+
+  int added(0);
+  for (int i = 0; i < count; ++i)
+  {
+    if (order[i].first == outside) continue;
+
+    // _𖖔ɉ
+    const int k(int(code.size()));
+    const GLfloat *const q(&staging[size_t(i) * 3]);
+    point.insert(point.end(), q, q + 3);
+    code.push_back(order[i].first);
+    next.push_back(-1);
+    ++added;
+
+    // t܂ō~낷
+    int n(0), level(0);
+    while (node[n].child >= 0)
+    {
+      ++node[n].count;
+      n = node[n].child + getOctant(code[k], level++);
+    }
+
+    // t̐擪ɂȂ, ꂽ番
+    next[k] = node[n].first;
+    node[n].first = k;
+    if (++node[n].count > leafCapacity && level < depth) split(n, level);
+  }
+
+  return added;
+}
+
+// i level ̗t n ̓_𔪂̎qɕ
+void Octree::split(int n, int level)
+{
+  const int c(allocate());
+  for (int i = node[n].first; i >= 0;)
+  {
+    const int following(next[i]);
+    Node &child(node[c + getOctant(code[i], level)]);
+    next[i] = child.first;
+    child.first = i;
+    ++child.count;
+    i = following;
+  }
+  node[n].child = c;
+  node[n].first = -1;
+
+  // ̎qɕ΂ĈĂ΂ɕ
+  if (level + 1 < depth)
+  {
+    for (int o = 0; o < 8; ++o)
+      if (node[c + o].count > leafCapacity) split(c + o, level + 1);
+  }
+}
+
+// ߓ_ n ̕؂ׂ̂Ă̓_ result ɉ
+void Octree::collect(int n, std::vector<int> &result) const
+{
+  int stack[stackSize], top(0);
+  stack[top++] = n;
+  while (top > 0)
+  {
+    const Node &current(node[stack[--top]]);
+    if (current.child < 0)
+    {
+      for (int i = current.first; i >= 0; i = next[i]) result.push_back(i);
+    }
+    else
+    {
+      for (int o = 0; o < 8; ++o)
+        if (node[current.child + o].count > 0) stack[top++] = current.child + o;
+    }
+  }
+}
+
+// S甼aȓ̓_T
+void Octree::radiusSearch(const GLfloat *center, GLfloat radius, std::vector<int> &result) const
+{
+  // ߓ_ƒiƍŏ̋̈ʒuςŐ[DŒT
+  struct Entry
+  {
+    int n, level;
+    GLfloat lower[3];
+  };
+  Entry stack[stackSize];
+  int top(0);
+  const Entry root = { 0, 0, { origin[0], origin[1], origin[2] } };
+  stack[top++] = root;
+
+  const GLfloat r2(radius * radius);
+  while (top > 0)
+  {
+    const Entry e(stack[--top]);
+    const Node &current(node[e.n]);
+    if (current.count == 0) continue;
+
+    // ƌȂΔ΂, Ɋ܂܂Ă΂ׂĂ̓_
+    const GLfloat width(std::ldexp(size, -e.level));
+    GLfloat minimum, maximum;
+    boxDistance(e.lower, width, center, minimum, maximum);
+    if (minimum > r2) continue;
+    if (maximum <= r2)
+    {
+      collect(e.n, result);
+      continue;
+    }
+
+    if (current.child < 0)
+    {
+      // t̓_ׂ
+      for (int i = current.first; i >= 0; i = next[i])
+      {
+        const GLfloat *const q(&point[size_t(i) * 3]);
+        const GLfloat d[] = { q[0] - center[0], q[1] - center[1], q[2] - center[2] };
+        if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] <= r2) result.push_back(i);
+      }
+    }
+    else
+    {
+      // qς
+      const GLfloat half(width * 0.5f);
+      for (int o = 0; o < 8; ++o)
+      {
+        const Entry child =
+        {
+          current.child + o, e.level + 1,
+          { e.lower[0] + ((o & 1) ? half : 0.0f), e.lower[1] + ((o & 2) ? half : 0.0f), e.lower[2] + ((o & 4) ? half : 0.0f) }
+        };
+        stack[top++] = child;
+      }
+    }
+  }
+}
+
+// ̂̒̓_T
+void Octree::boxSearch(const GLfloat *lower, const GLfloat *upper, std::vector<int> &result) const
+{
+  // ߓ_ƒiƍŏ̋̈ʒuςŐ[DŒT
+  struct Entry
+  {
+    int n, level;
+    GLfloat lower[3];
+  };
+  Entry stack[stackSize];
+  int top(0);
+  const Entry root = { 0, 0, { origin[0], origin[1], origin[2] } };
+  stack[top++] = root;
+
+  while (top > 0)
+  {
+    const Entry e(stack[--top]);
+    const Node &current(node[e.n]);
+    if (current.count == 0) continue;
+
+    // ̂ƌȂΔ΂, ̂Ɋ܂܂Ă΂ׂĂ̓_
+    const GLfloat width(std::ldexp(size, -e.level));
+    bool overlap(true), inside(true);
+    for (int c = 0; c < 3; ++c)
+    {
+      if (e.lower[c] > upper[c] || e.lower[c] + width < lower[c]) overlap = false;
+      if (e.lower[c] < lower[c] || e.lower[c] + width > upper[c]) inside = false;
+    }
+    if (!overlap) continue;
+    if (inside)
+    {
+      collect(e.n, result);
+      continue;
+    }
+
+    if (current.child < 0)
+    {
+      // t̓_ׂ
+      for (int i = current.first; i >= 0; i = next[i])
+      {
+        const GLfloat *const q(&point[size_t(i) * 3]);
+        if (q[0] >= lower[0] && q[0] <= upper[0] && q[1] >= lower[1] && q[1] <= upper[1] && q[2] >= lower[2] && q[2] <= upper[2])
+          result.push_back(i);
+      }
+    }
+    else
+    {
+      // qς
+      const GLfloat half(width * 0.5f);
+      for (int o = 0; o < 8; ++o)
+      {
+        const Entry child =
+        {
+          current.child + o, e.level + 1,
+          { e.lower[0] + ((o & 1) ? half : 0.0f), e.lower[1] + ((o & 2) ? half : 0.0f), e.lower[2] + ((o & 4) ? half : 0.0f) }
+        };
+        stack[top++] = child;
+      }
+    }
+  }
+}
+
+// mۂ̑傫𓾂 (byte)
+size_t Octree::getMemory() const
+{
+  return node.capacity() * sizeof(Node) + point.capacity() * sizeof(GLfloat) + code.capacity() * sizeof(GLuint64)
+    + next.capacity() * sizeof(int) + staging.capacity() * sizeof(GLfloat)
+    + (order.capacity() + work.capacity()) * sizeof(std::pair<GLuint64, int>);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+//
+// _Q̔
+//
+//   _ƈӂ̒߂̂ depth i܂Ŕɕ, t̓_̐ leafCapacity 𒴂番
+//   ߓ_̓v[甪̎q܂Ƃ߂Ďo, YŎQƂ (clear() Ăv[͎̃c)
+//   build() ͓_̃[gɋ߂ĕɃ\[g, 񂾕͈̔͂ォ珇ɐߓ_
+//   insert() ͓_~낵ėtɉ, ꂽt𕪂 (t[Ƃɓ_ǉĂ)
+//   radiusSearch()  boxSearch()  const Ȃ̂, ق̏ɌĂяoĂ悢
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+class Octree
+{
+  // ߓ_
+  struct Node
+  {
+    // ̎q̐擪̐ߓ_ (tȂ -1)
+    int child;
+
+    // t̍ŏ̓_ (_Ƃ next łȂ, Ȃ -1)
+    int first;
+
+    // ؂̓_̐
+    int count;
+  };
+
+  // ̂̍ŏ̋̈ʒu (m)
+  GLfloat origin[3];
+
+  // ̂̈ӂ̒ (m)
+  const GLfloat size;
+
+  // ȉ (łׂẗӂ̒ size / 2^depth)
+  const int depth;
+
+  // tɓ_̐̏ (łׂi̗t͏𒴂ĂȂ)
+  const int leafCapacity;
+
+  // ߓ_̃v[ ( 0)
+  std::vector<Node> node;
+
+  // _̈ʒuƃ[g, t̎̓_ (Ȃ -1)
+  std::vector<GLfloat> point;
+  std::vector<GLuint64> code;
+  std::vector<int> next;
+
+  // _Ƃ̋LWnɕϊ_, Ƃ̓_̓Y̑g (̂̊O̓_̕ outside)
+  std::vector<GLfloat> staging;
+  std::vector< std::pair<GLuint64, int> > order, work;
+
+  // _{NZ̈ʒũ[gɂ (̂̊OȂ false)
+  bool encode(const GLfloat *p, GLuint64 &c) const;
+
+  // i level ̐ߓ_̎q̈ʒu (x, y, z ̃rbgׂ 0 ` 7) 𓾂
+  int getOctant(GLuint64 c, int level) const
+  {
+    return int(c >> ((depth - 1 - level) * 3)) & 7;
+  }
+
+  // ̎qv[o
+  int allocate();
+
+  // _LWnɕϊ staging , ƓY̑g order ɍ
+  void prepare(const GLfloat (*p)[3], int count, const GgMatrix &pose);
+
+  // ̏ɕׂ_ [begin, end) i level ̐ߓ_ n ̕؂
+  void build(int n, int level, int begin, int end);
+
+  // i level ̗t n ̓_𔪂̎qɕ (qĂ΂ɕ)
+  void split(int n, int level);
+
+  // ߓ_ n ̕؂ׂ̂Ă̓_ result ɉ
+  void collect(int n, std::vector<int> &result) const;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Octree(const Octree &o);
+
+  //  (֎~)
+  Octree &operator=(const Octree &o);
+
+public:
+
+  // ̂̊O̓_vłȂ_̕
+  static const GLuint64 outside = ~GLuint64(0);
+
+  // RXgN^
+  //   origin: ̂̍ŏ̋̈ʒu (m)
+  //   size: ̂̈ӂ̒ (m)
+  //   depth: ȉ (1 ` 21)
+  //   leafCapacity: tɓ_̐̏
+  Octree(const GLfloat *origin, GLfloat size, int depth = 10, int leafCapacity = 32);
+
+  // _Ɛߓ_ɂ (mۂ͎c)
+  void clear();
+
+  // _Q甪؂蒼
+  //   point: _ʒu (CpuPosition Ɠ z  depthInvalid 艓_͌vs\_Ƃď)
+  //   count: _̐
+  //   pose: _ʒu狤LWnւ̕ϊs ([xZT getExtrinsic())
+  //   ߂l: ̂̒ɂĉ_̐
+  int build(const GLfloat (*point)[3], int count, const GgMatrix &pose);
+
+  // _Q𔪕؂ɒǉ (Ɩ߂l build() Ɠ)
+  int insert(const GLfloat (*point)[3], int count, const GgMatrix &pose);
+
+  // S甼aȓ̓_T
+  //   center: S̈ʒu (LWn)
+  //   radius: a (m)
+  //   result: _̓Yǉ (getPoint() ňʒu𓾂)
+  void radiusSearch(const GLfloat *center, GLfloat radius, std::vector<int> &result) const;
+
+  // ̂̒̓_T
+  //   lower, upper: ̂̍ŏƍő̋̈ʒu (LWn)
+  //   result: _̓Yǉ (getPoint() ňʒu𓾂)
+  void boxSearch(const GLfloat *lower, const GLfloat *upper, std::vector<int> &result) const;
+
+  // _̈ʒu𓾂
+  const GLfloat *getPoint(int i) const
+  {
+    return &point[size_t(i) * 3];
+  }
+
+  // _̐𓾂
+  int getPointCount() const
+  {
+    return int(code.size());
+  }
+
+  // gĂߓ_̐𓾂
+  int getNodeCount() const
+  {
+    return int(node.size());
+  }
+
+  // mۂ̑傫𓾂 (byte)
+  size_t getMemory() const;
+};
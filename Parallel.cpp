@@ -0,0 +1,169 @@
+#include "Parallel.h"
+
+//
+// 񏈗
+//
+
+// WCu
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+  // ɏd
+  struct Job
+  {
+    // ֐
+    const std::function<void(int, int)> *body;
+
+    // ͈͂̏Iƈxɏ鐔
+    int end, grain;
+
+    // ɏ͈͂̎n܂
+    std::atomic<int> next;
+
+    // ܂IĂȂ͈͂̐
+    std::atomic<int> remaining;
+
+    // ̎dĂ郏[JXbh̐
+    int users;
+  };
+
+  // [JXbhL
+  struct Pool
+  {
+    // r
+    std::mutex mutex;
+
+    // d̓̒ʒm
+    std::condition_variable wake;
+
+    // d̊̒ʒm
+    std::condition_variable done;
+
+    // ҂̎d
+    std::deque<Job *> queue;
+
+    // [JXbh̐
+    int workers;
+  };
+
+  // [JXbhL (vȌI܂Ń[JXbhQƂ̂ŉȂ)
+  Pool *pool(NULL);
+
+  // [JXbh̋N͈xs
+  std::once_flag started;
+
+  // ݒ肵ɎgXbh̐ (0 ȂRA̐)
+  int requested(0);
+
+  // d͈̔͂o邾oď
+  void work(Job *job)
+  {
+    for (;;)
+    {
+      const int b(job->next.fetch_add(job->grain));
+      if (b >= job->end) return;
+      (*job->body)(b, std::min(b + job->grain, job->end));
+      if (--job->remaining == 0)
+      {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->done.notify_all();
+      }
+    }
+  }
+
+  // [JXbh
+  void worker()
+  {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (;;)
+    {
+      // d̂҂
+      pool->wake.wait(lock, [] { return !pool->queue.empty(); });
+
+      // 擪̎d
+      Job *const job(pool->queue.front());
+      ++job->users;
+      lock.unlock();
+      work(job);
+      lock.lock();
+
+      // o͈͂cĂȂd͑҂s񂩂O
+      const std::deque<Job *>::iterator i(std::find(pool->queue.begin(), pool->queue.end(), job));
+      if (i != pool->queue.end()) pool->queue.erase(i);
+      if (--job->users == 0) pool->done.notify_all();
+    }
+  }
+
+  // [JXbhN
+  void start()
+  {
+    pool = new Pool;
+    const unsigned int n(requested > 0 ? unsigned(requested) : std::thread::hardware_concurrency());
+    pool->workers = n > 1 ? int(n) - 1 : 0;
+    for (int i = 0; i < pool->workers; ++i) std::thread(worker).detach();
+  }
+}
+
+// [begin, end)  grain ɕĕɏ
+void Parallel::run(int begin, int end, const std::function<void(int, int)> &body, int grain)
+{
+  // ͈͂ȂΖ߂
+  if (begin >= end) return;
+  if (grain < 1) grain = 1;
+
+  // [JXbhN
+  std::call_once(started, start);
+
+  // xɏ͈͂Ȃ΂̃Xbhŏ
+  const int chunks((end - begin + grain - 1) / grain);
+  if (chunks == 1 || pool->workers == 0)
+  {
+    body(begin, end);
+    return;
+  }
+
+  // d쐬
+  Job job;
+  job.body = &body;
+  job.end = end;
+  job.grain = grain;
+  job.next = begin;
+  job.remaining = chunks;
+  job.users = 0;
+
+  // d҂sɓă[JXbhɒʒm
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->queue.push_back(&job);
+  }
+  pool->wake.notify_all();
+
+  // ̃Xbhɉ
+  work(&job);
+
+  // ׂĂ͈̔͂̏I, [JXbh̎d痣̂҂
+  std::unique_lock<std::mutex> lock(pool->mutex);
+  const std::deque<Job *>::iterator i(std::find(pool->queue.begin(), pool->queue.end(), &job));
+  if (i != pool->queue.end()) pool->queue.erase(i);
+  pool->done.wait(lock, [&job] { return job.remaining == 0 && job.users == 0; });
+}
+
+// ɎgXbh̐ (ĂяoXbh܂) 𓾂
+int Parallel::getThreads()
+{
+  std::call_once(started, start);
+  return pool->workers + 1;
+}
+
+// ɎgXbh̐ (ĂяoXbh܂) ݒ肷
+void Parallel::setThreads(int threads)
+{
+  requested = threads;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+//
+// 񏈗
+//
+
+// WCu
+#include <functional>
+
+class Parallel
+{
+public:
+
+  // [begin, end)  grain ɕĕɏ
+  //   body(b, e)  [b, e) ͈̔͂֐ (ʂ̃Xbh瓯ɌĂяo)
+  //   ĂяoXbhɉ, ׂďIĂ߂
+  static void run(int begin, int end, const std::function<void(int, int)> &body, int grain = 1);
+
+  // ɎgXbh̐ (ĂяoXbh܂) 𓾂
+  static int getThreads();
+
+  // ɎgXbh̐ (ĂяoXbh܂) ݒ肷
+  //   0 ȂRA̐ɂ, [JXbh͍ŏ run()  getThreads() Ă񂾂ƂɋN̂, OɌĂяo
+  static void setThreads(int threads);
+};
@@ -0,0 +1,229 @@
+#include "PassGraph.h"
+
+//
+// 摜̃pX̘A
+//
+
+// RXgN^
+PassGraph::PassGraph(int width, int height)
+  : width(width)
+  , height(height)
+  , attached(0)
+  , executed(0)
+{
+  // vZʂi[t[obt@IuWFNg쐬
+  glGenFramebuffers(1, &fbo);
+}
+
+// fXgN^
+PassGraph::~PassGraph()
+{
+  // VF[_vO폜
+  for (std::vector<Pass>::const_iterator p = passes.begin(); p != passes.end(); ++p)
+    glDeleteProgram(p->program);
+
+  // v[̃eNX`폜
+  for (std::vector<Slot>::const_iterator s = pool.begin(); s != pool.end(); ++s)
+    glDeleteTextures(1, &s->texture);
+
+  // t[obt@IuWFNg폜
+  glDeleteFramebuffers(1, &fbo);
+}
+
+// O^eNX`̓͂ǉ
+int PassGraph::addInput()
+{
+  const Resource r = { -1, 0, false, -1, -1, 0 };
+  resources.push_back(r);
+  return int(resources.size()) - 1;
+}
+
+// pXǉ
+int PassGraph::addPass(const char *source, const std::vector<int> &inputs, int targets,
+  GLenum internal, int width, int height)
+{
+  // pX̔ԍ
+  const int pass(int(passes.size()));
+
+  // pX쐬
+  Pass p;
+  p.program = ggLoadShader("rectangle.vert", source);
+  p.inputs = inputs;
+  p.width = width > 0 ? width : this->width;
+  p.height = height > 0 ? height : this->height;
+  p.internal = internal;
+  p.live = false;
+
+  // pX̏o͂摜o^
+  for (int i = 0; i < targets; ++i)
+  {
+    const Resource r = { pass, i, false, -1, -1, 0 };
+    resources.push_back(r);
+    p.outputs.push_back(int(resources.size()) - 1);
+  }
+
+  passes.push_back(p);
+  return pass;
+}
+
+// v[ɍeNX`o
+int PassGraph::acquire(GLsizei width, GLsizei height, GLenum internal)
+{
+  // gĂȂ`̃eNX`΂g
+  for (std::vector<Slot>::iterator s = pool.begin(); s != pool.end(); ++s)
+  {
+    if (!s->busy && s->width == width && s->height == height && s->internal == internal)
+    {
+      s->busy = true;
+      return int(s - pool.begin());
+    }
+  }
+
+  // execute() oĂANeBuȃeNX`jbǧςȂ悤Ɍ̃eNX`ۑĂ
+  GLint previous;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+
+  // Ȃ΃eNX`쐬ăv[ɒǉ
+  Slot s = { 0, width, height, internal, true };
+  glGenTextures(1, &s.texture);
+  glBindTexture(GL_TEXTURE_2D, s.texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  pool.push_back(s);
+
+  // ANeBuȃeNX`jbǧɖ߂
+  glBindTexture(GL_TEXTURE_2D, GLuint(previous));
+
+  return int(pool.size()) - 1;
+}
+
+// o摜̏o͂ɕKvȃpXs
+void PassGraph::execute()
+{
+  // Õt[Ŋ蓖ĂeNX`ׂăv[ɖ߂
+  for (std::vector<Slot>::iterator s = pool.begin(); s != pool.end(); ++s) s->busy = false;
+  for (std::vector<Resource>::iterator r = resources.begin(); r != resources.end(); ++r)
+  {
+    r->lastUse = -1;
+    r->slot = -1;
+  }
+
+  // o摜kĎspX߂
+  std::vector<bool> needed(resources.size());
+  for (size_t i = 0; i < resources.size(); ++i) needed[i] = resources[i].required;
+  for (int p = int(passes.size()) - 1; p >= 0; --p)
+  {
+    Pass &pass(passes[p]);
+    pass.live = false;
+    for (size_t i = 0; i < pass.outputs.size(); ++i)
+      if (needed[pass.outputs[i]]) pass.live = true;
+    if (pass.live)
+      for (size_t i = 0; i < pass.inputs.size(); ++i) needed[pass.inputs[i]] = true;
+  }
+
+  // 摜ŌɎQƂpX߂
+  for (int p = 0; p < int(passes.size()); ++p)
+  {
+    if (!passes[p].live) continue;
+    for (size_t i = 0; i < passes[p].inputs.size(); ++i) resources[passes[p].inputs[i]].lastUse = p;
+  }
+
+  // t[obt@IuWFNgւ̃_OJn
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  // Bʏ𖳌ɂ (pX̊Ԃł͐؂ւȂ)
+  glDisable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+
+  // ݂̏ (ݒ̂ԂȂ)
+  GLsizei viewport[2] = { 0, 0 };
+  std::vector<GLuint> bound;
+
+  // spX̐
+  executed = 0;
+
+  // spXɂ
+  for (int p = 0; p < int(passes.size()); ++p)
+  {
+    const Pass &pass(passes[p]);
+    if (!pass.live) continue;
+
+    // o͂摜Ƀv[̃eNX`蓖Ăăt[obt@IuWFNgɎt
+    std::vector<GLenum> bufs;
+    for (size_t i = 0; i < pass.outputs.size(); ++i)
+    {
+      Resource &r(resources[pass.outputs[i]]);
+      r.slot = acquire(pass.width, pass.height, pass.internal);
+      glFramebufferTexture(GL_FRAMEBUFFER, GLenum(GL_COLOR_ATTACHMENT0 + i), pool[r.slot].texture, 0);
+      bufs.push_back(GLenum(GL_COLOR_ATTACHMENT0 + i));
+    }
+
+    // ÕpXŎt]ȃeNX`O
+    for (size_t i = pass.outputs.size(); i < attached; ++i)
+      glFramebufferTexture(GL_FRAMEBUFFER, GLenum(GL_COLOR_ATTACHMENT0 + i), 0, 0);
+    if (attached != pass.outputs.size())
+    {
+      glDrawBuffers(GLsizei(bufs.size()), bufs.data());
+      attached = pass.outputs.size();
+    }
+
+    // r[|[go͂摜̃TCYɐݒ肷
+    if (viewport[0] != pass.width || viewport[1] != pass.height)
+    {
+      glViewport(0, 0, pass.width, pass.height);
+      viewport[0] = pass.width;
+      viewport[1] = pass.height;
+    }
+
+    // vZp̃VF[_vO̎gpJn
+    glUseProgram(pass.program);
+
+    // ͂摜 i Ԗڂ̃eNX`jbgɌ
+    if (bound.size() < pass.inputs.size()) bound.resize(pass.inputs.size(), 0);
+    for (size_t i = 0; i < pass.inputs.size(); ++i)
+    {
+      const GLuint texture(getTexture(pass.inputs[i]));
+      if (bound[i] != texture)
+      {
+        glActiveTexture(GLenum(GL_TEXTURE0 + i));
+        glBindTexture(GL_TEXTURE_2D, texture);
+        bound[i] = texture;
+      }
+      glUniform1i(GLint(i), GLint(i));
+    }
+
+    // TvȊO uniform ϐݒ肷
+    if (pass.setup) pass.setup(pass.program);
+
+    // NbsOԂς̋`_O
+    rectangle.draw();
+    ++executed;
+
+    // ̃pXŎQƂI摜ƎgȂo͂̃eNX`v[ɖ߂
+    for (size_t i = 0; i < pass.inputs.size(); ++i)
+    {
+      const Resource &r(resources[pass.inputs[i]]);
+      if (r.pass >= 0 && r.lastUse == p && !r.required) pool[r.slot].busy = false;
+    }
+    for (size_t i = 0; i < pass.outputs.size(); ++i)
+    {
+      const Resource &r(resources[pass.outputs[i]]);
+      if (r.lastUse < 0 && !r.required) pool[r.slot].busy = false;
+    }
+  }
+
+  // ʏ̃_Oɖ߂
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDrawBuffer(GL_BACK);
+  glActiveTexture(GL_TEXTURE0);
+
+  // BʏLɂ
+  glEnable(GL_DEPTH_TEST);
+  glDepthMask(GL_TRUE);
+
+  // o摜̎w͖t[s
+  for (std::vector<Resource>::iterator r = resources.begin(); r != resources.end(); ++r) r->required = false;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+//
+// 摜̃pX̘A
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// `
+#include "Rect.h"
+
+// WCu
+#include <vector>
+#include <functional>
+
+class PassGraph
+{
+  // pXň摜 (O^eNX`pX̏o)
+  struct Resource
+  {
+    // o͂pX̔ԍ (O^eNX`Ȃ -1)
+    int pass;
+
+    // o͂pX̃_O^[Qbg̔ԍ
+    int target;
+
+    // ̃t[ŎoȂ true
+    bool required;
+
+    // ̃t[ł̉摜ŌɎQƂpX̔ԍ
+    int lastUse;
+
+    // 蓖ĂꂽeNX` (v[̔ԍ)
+    int slot;
+
+    // O^eNX`
+    GLuint texture;
+  };
+
+  // 摜̃pX
+  struct Pass
+  {
+    // vZp̃VF[_vO
+    GLuint program;
+
+    // ͂摜
+    std::vector<int> inputs;
+
+    // o͂摜
+    std::vector<int> outputs;
+
+    // o͂摜̃TCY
+    GLsizei width, height;
+
+    // o͂摜̃eNX`̓tH[}bg
+    GLenum internal;
+
+    // TvȊO uniform ϐݒ肷֐
+    std::function<void(GLuint)> setup;
+
+    // ̃t[ŎsȂ true
+    bool live;
+  };
+
+  // o͂ɎgeNX`̃v[
+  struct Slot
+  {
+    // eNX`
+    GLuint texture;
+
+    // eNX`̃TCY
+    GLsizei width, height;
+
+    // eNX`̓tH[}bg
+    GLenum internal;
+
+    // gpȂ true
+    bool busy;
+  };
+
+  // pXň摜
+  std::vector<Resource> resources;
+
+  // 摜̃pX
+  std::vector<Pass> passes;
+
+  // o͂ɎgeNX`̃v[
+  std::vector<Slot> pool;
+
+  // 摜Ɏgt[obt@IuWFNg
+  GLuint fbo;
+
+  // o͂̊̃TCY
+  const GLsizei width, height;
+
+  // vZɎg`
+  const Rect rectangle;
+
+  // t[obt@IuWFNgɎtĂeNX`̐
+  size_t attached;
+
+  // Õt[ŎspX̐
+  int executed;
+
+  // v[ɍeNX`o
+  int acquire(GLsizei width, GLsizei height, GLenum internal);
+
+  // Rs[RXgN^ (Rs[֎~)
+  PassGraph(const PassGraph &o);
+
+  //  (֎~)
+  PassGraph &operator=(const PassGraph &o);
+
+public:
+
+  // RXgN^
+  PassGraph(int width, int height);
+
+  // fXgN^
+  virtual ~PassGraph();
+
+  // O^eNX`̓͂ǉ
+  int addInput();
+
+  // O^eNX`ݒ肷
+  void setInput(int resource, GLuint texture)
+  {
+    resources[resource].texture = texture;
+  }
+
+  // pXǉ
+  //   source: vZɎgtOgVF[_̃\[Xt@C
+  //   inputs: ͂摜 (i Ԗڂ̉摜 location = i ̃TvɊ蓖Ă)
+  //   targets: _O^[Qbg̐
+  //   internal: o͂eNX`̓tH[}bg
+  //   width, height: o͂eNX`̃TCY (0 Ȃ̃TCY)
+  //   ߂l: pX̔ԍ
+  int addPass(const char *source, const std::vector<int> &inputs, int targets = 1,
+    GLenum internal = GL_RGB32F, int width = 0, int height = 0);
+
+  // pX̃TvȊO uniform ϐݒ肷֐o^
+  void setSetup(int pass, const std::function<void(GLuint)> &setup)
+  {
+    passes[pass].setup = setup;
+  }
+
+  // pX̏o͂摜𓾂
+  int getOutput(int pass, int target = 0) const
+  {
+    return passes[pass].outputs[target];
+  }
+
+  // ̃t[Ŏo摜w肷
+  void require(int resource)
+  {
+    resources[resource].required = true;
+  }
+
+  // o摜̏o͂ɕKvȃpXs
+  void execute();
+
+  // 摜̃eNX`𓾂
+  GLuint getTexture(int resource) const
+  {
+    const Resource &r(resources[resource]);
+    return r.pass < 0 ? r.texture : r.slot < 0 ? 0 : pool[r.slot].texture;
+  }
+
+  // Õt[ŎspX̐𓾂
+  int getExecuted() const
+  {
+    return executed;
+  }
+
+  // v[ɊmۂeNX`̐𓾂
+  int getPoolSize() const
+  {
+    return int(pool.size());
+  }
+};
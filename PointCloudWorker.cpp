@@ -0,0 +1,64 @@
+#include "PointCloudWorker.h"
+
+//
+// [xZT̓_Q𕡐ă[JXbhŏ
+//
+
+// WCu
+#include <algorithm>
+
+// RXgN^
+PointCloudWorker::PointCloudWorker()
+  : sources(0)
+  , busy(false)
+{
+}
+
+// fXgN^
+PointCloudWorker::~PointCloudWorker()
+{
+  // ȂÎ҂
+  if (thread.joinable()) thread.join();
+}
+
+// [xZT̓_Q𕡐ă[JXbhŏn߂
+bool PointCloudWorker::start(const std::vector<const DepthCamera *> &camera, const std::function<void()> &job)
+{
+  if (busy) return false;
+
+  // Ȍ̃[JXbhЕt
+  if (thread.joinable()) thread.join();
+
+  // Ɏ擾ił悤ɓ_QƊOp[^𕡐 (mۂ͎g)
+  sources = int(camera.size());
+  if (int(point.size()) < sources)
+  {
+    point.resize(sources);
+    count.resize(sources);
+    pose.resize(sources, ggIdentity());
+  }
+  for (int i = 0; i < sources; ++i)
+  {
+    const GLfloat (*const p)[3](camera[i]->getPointBuffer());
+    int w, h;
+    camera[i]->getDepthResolution(&w, &h);
+    count[i] = p ? w * h : 0;
+    point[i].resize(count[i] * 3);
+    if (p) std::copy(p[0], p[0] + count[i] * 3, point[i].begin());
+    pose[i] = camera[i]->getExtrinsic();
+  }
+  this->job = job;
+
+  // [JXbhN
+  busy = true;
+  thread = std::thread(&PointCloudWorker::run, this);
+
+  return true;
+}
+
+// 
+void PointCloudWorker::run()
+{
+  job();
+  busy = false;
+}
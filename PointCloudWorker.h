@@ -0,0 +1,93 @@
+#pragma once
+
+//
+// [xZT̓_Q𕡐ă[JXbhŏ
+//
+//   start() Ő[xZT̓_QƊOp[^𕡐, `̃Xbh~߂Ƀ[JXbhŏ
+//   ĂԂ start() 󂯕tȂ̂, ԂɍȂt[͔΂
+//   ̒̌vZ Parallel ̃Xbhv[`̃Xbhƕ
+//
+
+// [xZT֘ÅNX
+#include "DepthCamera.h"
+
+// WCu
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+class PointCloudWorker
+{
+  // [xZTƂ̓_Q (f̏, vłȂ_܂) Ɠ_̐
+  std::vector< std::vector<GLfloat> > point;
+  std::vector<int> count;
+
+  // [xZTƂ̊Op[^
+  std::vector<GgMatrix> pose;
+
+  // [xZT̐
+  int sources;
+
+  // [JXbhōs
+  std::function<void()> job;
+
+  // [JXbh
+  std::thread thread;
+
+  // ǂ
+  std::atomic<bool> busy;
+
+  //  ([JXbh)
+  void run();
+
+  // Rs[RXgN^ (Rs[֎~)
+  PointCloudWorker(const PointCloudWorker &o);
+
+  //  (֎~)
+  PointCloudWorker &operator=(const PointCloudWorker &o);
+
+public:
+
+  // RXgN^
+  PointCloudWorker();
+
+  // fXgN^ (ȂÎ҂)
+  virtual ~PointCloudWorker();
+
+  // [xZT̓_Q𕡐ă[JXbhŏn߂
+  //   camera: _Q𕡐[xZT (_QȂΓ_̐ 0 ɂ)
+  //   job: [JXbhōs (getPoint() Ȃǂŕ_Qg)
+  //   ߂l: Ȃn߂ false
+  bool start(const std::vector<const DepthCamera *> &camera, const std::function<void()> &job);
+
+  // ǂׂ
+  bool isBusy() const
+  {
+    return busy;
+  }
+
+  // [xZT̐𓾂
+  int getSources() const
+  {
+    return sources;
+  }
+
+  //  i Ԗڂ̐[xZT̓_Q𓾂
+  const GLfloat (*getPoint(int i) const)[3]
+  {
+    return reinterpret_cast<const GLfloat (*)[3]>(point[i].data());
+  }
+
+  //  i Ԗڂ̐[xZT̓_̐𓾂
+  int getPointCount(int i) const
+  {
+    return count[i];
+  }
+
+  //  i Ԗڂ̐[xZT̊Op[^𓾂
+  const GgMatrix &getPose(int i) const
+  {
+    return pose[i];
+  }
+};
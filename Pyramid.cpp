@@ -0,0 +1,244 @@
+#include "Pyramid.h"
+
+//
+// fvXf[^̃s~bh
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <emmintrin.h>
+
+// xɏs
+const int rowGrain(8);
+
+// vłȂfבւŌɑ邽߂̑傫Ȓl (pyramid.frag ƍ킹)
+const GLfloat invalid(1.0e30f);
+
+namespace
+{
+  // ̒lɕׂ
+  inline void order(__m128 &a, __m128 &b)
+  {
+    const __m128 t(_mm_min_ps(a, b));
+    b = _mm_max_ps(a, b);
+    a = t;
+  }
+  inline void order(GLfloat &a, GLfloat &b)
+  {
+    const GLfloat t(a < b ? a : b);
+    b = a < b ? b : a;
+    a = t;
+  }
+
+  // 2x2 f܂Ƃ߂ (vłȂf invalid ɂĂ)
+  inline GLfloat reduce4(GLfloat a, GLfloat b, GLfloat c, GLfloat e, Pyramid::Reduce reduce)
+  {
+    const int count((a != invalid) + (b != invalid) + (c != invalid) + (e != invalid));
+    if (count == 0) return 0.0f;
+
+    if (reduce == Pyramid::MINIMUM)
+    {
+      order(a, b);
+      order(c, e);
+      return a < c ? a : c;
+    }
+
+    if (reduce == Pyramid::MEDIAN)
+    {
+      order(a, b);
+      order(c, e);
+      order(a, c);
+      order(b, e);
+      order(b, c);
+      return count == 4 ? (b + c) * 0.5f : count == 3 ? b : count == 2 ? (a + b) * 0.5f : a;
+    }
+
+    return ((a != invalid ? a : 0.0f) + (b != invalid ? b : 0.0f)
+      + (c != invalid ? c : 0.0f) + (e != invalid ? e : 0.0f)) / GLfloat(count);
+  }
+}
+
+// RXgN^
+Pyramid::Pyramid(int width, int height, int levels, Reduce reduce)
+  : texture(levels, 0)
+  , width(levels)
+  , height(levels)
+  , reduce(reduce)
+{
+  this->width[0] = width;
+  this->height[0] = height;
+
+  for (int i = 1; i < levels; ++i)
+  {
+    // ̒i̔̃TCY
+    this->width[i] = this->width[i - 1] / 2;
+    this->height[i] = this->height[i - 1] / 2;
+
+    // ̒ivZ
+    const Calculate *const c(new Calculate(this->width[i], this->height[i], "pyramid.frag", 1, 1, GL_R32F));
+    pass.push_back(c);
+    reduceLoc.push_back(glGetUniformLocation(c->get(), "reduce"));
+    texture[i] = c->getTexture()[0];
+  }
+}
+
+// fXgN^
+Pyramid::~Pyramid()
+{
+  for (std::vector<const Calculate *>::const_iterator p = pass.begin(); p != pass.end(); ++p) delete *p;
+}
+
+// fvXf[^̃eNX`s~bh
+const std::vector<GLuint> &Pyramid::build(GLuint depth)
+{
+  texture[0] = depth;
+
+  for (size_t i = 0; i < pass.size(); ++i)
+  {
+    // ܂Ƃߕݒ肷
+    pass[i]->use();
+    glUniform1i(reduceLoc[i], reduce);
+
+    // ̒i͂
+    glUniform1i(0, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture[i]);
+
+    // ̒i
+    pass[i]->calculate();
+  }
+
+  return texture;
+}
+
+// CPU ɂs~bh̃RXgN^
+CpuPyramid::CpuPyramid(int width, int height, int levels, Pyramid::Reduce reduce)
+  : CpuCalculate(width, height, 1, 0)
+  , image(levels)
+  , level(levels, static_cast<const GLushort *>(NULL))
+  , levelWidth(levels)
+  , levelHeight(levels)
+  , reduce(reduce)
+  , current(0)
+{
+  levelWidth[0] = width;
+  levelHeight[0] = height;
+
+  for (int i = 1; i < levels; ++i)
+  {
+    // ̒i̔̃TCY
+    levelWidth[i] = levelWidth[i - 1] / 2;
+    levelHeight[i] = levelHeight[i - 1] / 2;
+    image[i].resize(levelWidth[i] * levelHeight[i]);
+    level[i] = image[i].data();
+  }
+}
+
+// i current ̍s [begin, end) 
+void CpuPyramid::kernel(int begin, int end)
+{
+  // ̒iƂ̒i
+  const GLushort *const src(level[current - 1]);
+  const int sw(levelWidth[current - 1]);
+  GLushort *const dst(image[current].data());
+  const int dw(levelWidth[current]);
+
+  const __m128i low(_mm_set1_epi32(0xffff));
+  const __m128i zeroi(_mm_setzero_si128());
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 half(_mm_set1_ps(0.5f));
+  const __m128 big(_mm_set1_ps(invalid));
+  const __m128i bias(_mm_set1_epi32(32768));
+  const __m128i flip(_mm_set1_epi16(-32768));
+
+  for (int v = begin; v < end; ++v)
+  {
+    // ̒i 2 s
+    const GLushort *const s0(src + v * 2 * sw);
+    const GLushort *const s1(s0 + sw);
+    GLushort *const d(dst + v * dw);
+
+    // 4 f
+    int u(0);
+    for (; u + 4 <= dw; u += 4)
+    {
+      // 2x2 f, E, , Eɕ
+      const __m128i r0(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s0 + u * 2)));
+      const __m128i r1(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s1 + u * 2)));
+      __m128 a(_mm_cvtepi32_ps(_mm_and_si128(r0, low)));
+      __m128 b(_mm_cvtepi32_ps(_mm_srli_epi32(r0, 16)));
+      __m128 c(_mm_cvtepi32_ps(_mm_and_si128(r1, low)));
+      __m128 e(_mm_cvtepi32_ps(_mm_srli_epi32(r1, 16)));
+
+      // vłf̐
+      const __m128 va(_mm_cmpneq_ps(a, zero)), vb(_mm_cmpneq_ps(b, zero));
+      const __m128 vc(_mm_cmpneq_ps(c, zero)), ve(_mm_cmpneq_ps(e, zero));
+      const __m128 count(_mm_add_ps(_mm_add_ps(_mm_and_ps(va, one), _mm_and_ps(vb, one)),
+        _mm_add_ps(_mm_and_ps(vc, one), _mm_and_ps(ve, one))));
+
+      __m128 r;
+      if (reduce == Pyramid::AVERAGE)
+      {
+        // vłf̕
+        r = _mm_div_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, e)), _mm_max_ps(count, one));
+      }
+      else
+      {
+        // vłȂf傫Ȓlɂ
+        a = _mm_or_ps(_mm_and_ps(va, a), _mm_andnot_ps(va, big));
+        b = _mm_or_ps(_mm_and_ps(vb, b), _mm_andnot_ps(vb, big));
+        c = _mm_or_ps(_mm_and_ps(vc, c), _mm_andnot_ps(vc, big));
+        e = _mm_or_ps(_mm_and_ps(ve, e), _mm_andnot_ps(ve, big));
+
+        if (reduce == Pyramid::MINIMUM)
+        {
+          // ł߂_
+          r = _mm_min_ps(_mm_min_ps(a, b), _mm_min_ps(c, e));
+        }
+        else
+        {
+          // ɕׂĒl߂
+          order(a, b);
+          order(c, e);
+          order(a, c);
+          order(b, e);
+          order(b, c);
+          const __m128 m4(_mm_mul_ps(_mm_add_ps(b, c), half));
+          const __m128 m2(_mm_mul_ps(_mm_add_ps(a, b), half));
+          const __m128 n4(_mm_cmpeq_ps(count, _mm_set1_ps(4.0f)));
+          const __m128 n3(_mm_cmpeq_ps(count, _mm_set1_ps(3.0f)));
+          const __m128 n2(_mm_cmpeq_ps(count, _mm_set1_ps(2.0f)));
+          r = _mm_or_ps(_mm_or_ps(_mm_and_ps(n4, m4), _mm_and_ps(n3, b)),
+            _mm_or_ps(_mm_and_ps(n2, m2), _mm_andnot_ps(_mm_or_ps(_mm_or_ps(n4, n3), n2), a)));
+        }
+      }
+
+      // 4 fƂvłĂȂ 0 ɂ, ۂ߂ĕȂ 16bit ɋl߂
+      r = _mm_and_ps(_mm_cmpgt_ps(count, zero), r);
+      const __m128i ri(_mm_sub_epi32(_mm_cvtps_epi32(r), bias));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(d + u), _mm_xor_si128(_mm_packs_epi32(ri, zeroi), flip));
+    }
+
+    // c̉f
+    for (; u < dw; ++u)
+    {
+      const GLushort *const p0(s0 + u * 2), *const p1(s1 + u * 2);
+      const GLfloat r(reduce4(p0[0] ? GLfloat(p0[0]) : invalid, p0[1] ? GLfloat(p0[1]) : invalid,
+        p1[0] ? GLfloat(p1[0]) : invalid, p1[1] ? GLfloat(p1[1]) : invalid, reduce));
+      d[u] = GLushort(r + 0.5f);
+    }
+  }
+}
+
+// fvXf[^s~bh
+void CpuPyramid::build(const GLushort *data)
+{
+  level[0] = data;
+
+  // iƂɍsɍ
+  for (current = 1; current < getLevels(); ++current)
+    Parallel::run(0, levelHeight[current], [this](int begin, int end) { kernel(begin, end); }, rowGrain);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+//
+// fvXf[^̃s~bh
+//
+//   2x2 f 1 fɂ܂Ƃ߂ďc̉𑜓x̉摜ɍ
+//   ܂Ƃߕ͌vłȂf (0) ŏl (ł߂_), l, ϒlI
+//   4 fƂvłĂȂ 0 ɂ
+//   ̕⍂̍Ō̗ŝ͎Ă
+//
+
+// 摜
+#include "Calculate.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂs~bh (pyramid.frag)
+//
+//   i 0 ͓͂fvX̃eNX`, i 1 ȍ~ R32F ̓͂ƓPʂ̒l
+//
+class Pyramid
+{
+public:
+
+  // 2x2 f̂܂Ƃߕ
+  enum Reduce { MINIMUM, MEDIAN, AVERAGE };
+
+private:
+
+  // iƂ̌vZ
+  std::vector<const Calculate *> pass;
+
+  // ܂Ƃߕ uniform ϐ̏ꏊ
+  std::vector<GLint> reduceLoc;
+
+  // iƂ̃eNX`
+  std::vector<GLuint> texture;
+
+  // iƂ̃TCY
+  std::vector<int> width, height;
+
+  // 2x2 f̂܂Ƃߕ
+  Reduce reduce;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Pyramid(const Pyramid &o);
+
+  //  (֎~)
+  Pyramid &operator=(const Pyramid &o);
+
+public:
+
+  // RXgN^
+  //   levels: i (͂摜܂)
+  Pyramid(int width, int height, int levels, Reduce reduce = MEDIAN);
+
+  // fXgN^
+  virtual ~Pyramid();
+
+  // 2x2 f̂܂Ƃߕݒ肷
+  void setReduce(Reduce reduce)
+  {
+    this->reduce = reduce;
+  }
+
+  // fvXf[^̃eNX`s~bh
+  const std::vector<GLuint> &build(GLuint depth);
+
+  // i𓾂
+  int getLevels() const
+  {
+    return int(texture.size());
+  }
+
+  // i level ̃eNX`𓾂
+  GLuint getTexture(int level) const
+  {
+    return texture[level];
+  }
+
+  // i level ̃TCY𓾂
+  void getSize(int level, int *width, int *height) const
+  {
+    *width = this->width[level];
+    *height = this->height[level];
+  }
+};
+
+//
+// CPU ɂs~bh (pyramid.frag ƓvZ)
+//
+//   i 0 ͓͂fvXf[^̂̂, i 1 ȍ~͂̃NXێ GLushort (mm) ̉摜
+//
+class CpuPyramid : public CpuCalculate
+{
+  // iƂ̉摜 (i 0 ͓͂f[^w)
+  std::vector<std::vector<GLushort> > image;
+
+  // iƂ̉摜̐擪
+  std::vector<const GLushort *> level;
+
+  // iƂ̃TCY
+  std::vector<int> levelWidth, levelHeight;
+
+  // 2x2 f̂܂Ƃߕ
+  Pyramid::Reduce reduce;
+
+  // 쐬̒i
+  int current;
+
+  // i current ̍s [begin, end) 
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  //   levels: i (͂摜܂)
+  CpuPyramid(int width, int height, int levels, Pyramid::Reduce reduce = Pyramid::MEDIAN);
+
+  // 2x2 f̂܂Ƃߕݒ肷
+  void setReduce(Pyramid::Reduce reduce)
+  {
+    this->reduce = reduce;
+  }
+
+  // fvXf[^s~bh
+  void build(const GLushort *data);
+
+  // i𓾂
+  int getLevels() const
+  {
+    return int(level.size());
+  }
+
+  // i level ̉摜𓾂
+  const GLushort *getLevel(int level) const
+  {
+    return this->level[level];
+  }
+
+  // i level ̃TCY𓾂
+  void getSize(int level, int *width, int *height) const
+  {
+    *width = levelWidth[level];
+    *height = levelHeight[level];
+  }
+};
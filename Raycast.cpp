@@ -0,0 +1,609 @@
+#include "Raycast.h"
+
+//
+// TSDF ̃{[̃CLXg
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+// xɏs
+const int rowGrain(4);
+
+// xɏubN
+const int brickGrain(16);
+
+// ubN̈ӂ̃{NZ
+const int brickSize(CpuTsdfBase::brickSize);
+
+// t̐K߂W
+const GLfloat distanceScale(1.0f / 32767.0f);
+
+// \ʂ truncation ȏ㗣ꂽ{NZ̐Kt
+const GLshort distanceFree(32767);
+
+// Ae̊ƊgUˌ̋ (raycast.comp ƍ킹)
+const GLfloat shadeAmbient(0.2f);
+const GLfloat shadeDiffuse(0.8f);
+
+namespace
+{
+  // ubNPʂ̈ʒu߂ (̈ʒu؂̂Ă)
+  int brickOf(int x)
+  {
+    return (x >= 0 ? x : x - (brickSize - 1)) / brickSize;
+  }
+
+  //
+  // CƂ̃ubN̒Tʂ̍T
+  //
+  class BrickCache
+  {
+    // {[
+    const CpuTsdfBase &volume;
+
+    // T̐ (2 ׂ̂)
+    static const int size = 8;
+
+    // TubNPʂ̈ʒuƃ{NZ (ubNȂ NULL)
+    int key[size][3];
+    const CpuTsdfBase::Voxel *voxel[size];
+    bool filled[size];
+
+    //  (֎~)
+    BrickCache &operator=(const BrickCache &o);
+
+  public:
+
+    // RXgN^
+    BrickCache(const CpuTsdfBase &volume)
+      : volume(volume)
+    {
+      std::fill(filled, filled + size, false);
+    }
+
+    // {NZ (x, y, z) 𓾂 (ubNȂ NULL)
+    const CpuTsdfBase::Voxel *get(int x, int y, int z)
+    {
+      const int bx(brickOf(x)), by(brickOf(y)), bz(brickOf(z));
+      const int i((bx + by * 3 + bz * 5) & (size - 1));
+      if (!filled[i] || key[i][0] != bx || key[i][1] != by || key[i][2] != bz)
+      {
+        key[i][0] = bx;
+        key[i][1] = by;
+        key[i][2] = bz;
+        const int slot(volume.findBrick(bx, by, bz));
+        voxel[i] = slot >= 0 ? volume.getBrickVoxel(slot) : NULL;
+        filled[i] = true;
+      }
+      if (voxel[i] == NULL) return NULL;
+      return voxel[i] + ((z - bz * brickSize) * brickSize + y - by * brickSize) * brickSize + x - bx * brickSize;
+    }
+  };
+
+  // {NZPʂ̈ʒu (x, y, z) ̕t 8 ̃{NZԂ (d݂ 0 ̃{NZ false)
+  bool sample(BrickCache &cache, GLfloat x, GLfloat y, GLfloat z, GLfloat &d)
+  {
+    const GLfloat fx(floor(x)), fy(floor(y)), fz(floor(z));
+    const int ix(static_cast<int>(fx)), iy(static_cast<int>(fy)), iz(static_cast<int>(fz));
+    GLfloat c[8];
+    if ((ix & (brickSize - 1)) != brickSize - 1 && (iy & (brickSize - 1)) != brickSize - 1 && (iz & (brickSize - 1)) != brickSize - 1)
+    {
+      // 8 ̃{NZubNɂΈxT
+      const CpuTsdfBase::Voxel *const v(cache.get(ix, iy, iz));
+      if (v == NULL) return false;
+      static const int offset[8] =
+      {
+        0, 1, brickSize, brickSize + 1,
+        brickSize * brickSize, brickSize * brickSize + 1, brickSize * brickSize + brickSize, brickSize * brickSize + brickSize + 1
+      };
+      for (int k = 0; k < 8; ++k)
+      {
+        if (v[offset[k]].weight == 0) return false;
+        c[k] = GLfloat(v[offset[k]].distance) * distanceScale;
+      }
+    }
+    else
+    {
+      for (int k = 0; k < 8; ++k)
+      {
+        const CpuTsdfBase::Voxel *const v(cache.get(ix + (k & 1), iy + (k >> 1 & 1), iz + (k >> 2 & 1)));
+        if (v == NULL || v->weight == 0) return false;
+        c[k] = GLfloat(v->distance) * distanceScale;
+      }
+    }
+
+    const GLfloat tx(x - fx), ty(y - fy), tz(z - fz);
+    const GLfloat c0(c[0] + (c[1] - c[0]) * tx), c1(c[2] + (c[3] - c[2]) * tx);
+    const GLfloat c2(c[4] + (c[5] - c[4]) * tx), c3(c[6] + (c[7] - c[6]) * tx);
+    const GLfloat c4(c0 + (c1 - c0) * ty), c5(c2 + (c3 - c2) * ty);
+    d = c4 + (c5 - c4) * tz;
+    return true;
+  }
+}
+
+// RXgN^
+CpuRaycast::CpuRaycast()
+  : volume(NULL)
+  , lastVersion(0)
+  , width(0)
+  , height(0)
+{
+  lower[0] = lower[1] = lower[2] = 0;
+  extent[0] = extent[1] = extent[2] = 0;
+}
+
+// {[CLXg
+void CpuRaycast::render(const CpuTsdfBase &volume, int width, int height, const GgMatrix &projection, const GgMatrix &modelview)
+{
+  // Ⴄ{[Ȃ炷ׂẴubN𒲂ג
+  if (&volume != this->volume || int(brick.size()) != volume.getBrickSlots())
+  {
+    this->volume = &volume;
+    const Brick empty = { 0, 0, 0, false, false };
+    brick.assign(volume.getBrickSlots(), empty);
+    dirty.assign(brick.size(), 0);
+    lastVersion = 0;
+  }
+
+  // ubN\ʂ܂ނג
+  updateOccupancy();
+
+  // 摜̃TCYςmۂ
+  if (width != this->width || height != this->height)
+  {
+    this->width = width;
+    this->height = height;
+    depth.resize(width * height);
+    point.resize(width * height * 3);
+    normal.resize(width * height * 3);
+    shaded.resize(width * height * 4);
+  }
+
+  // NbsOW烏[hWւ̕ϊsƃ[hW王_W z ߂s
+  const GgMatrix m((projection * modelview).invert());
+  std::copy(m.get(), m.get() + 16, unproject);
+  const GLfloat *const mw(modelview.get());
+  row[0] = mw[2];
+  row[1] = mw[6];
+  row[2] = mw[10];
+  row[3] = mw[14];
+
+  // s̃ubNƂɕɃCLXg
+  Parallel::run(0, height, [this](int begin, int end) { kernel(begin, end); }, rowGrain);
+}
+
+// ςubNƂ̎̃ubN\ʂ܂ނגĊiq蒼
+void CpuRaycast::updateOccupancy()
+{
+  const int slots(int(brick.size()));
+
+  // ÔƂōXVubNƂ̎̃ubNɈ (MarchingCubes::update() Ɠ)
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    const Brick &b(brick[slot]);
+    int x, y, z;
+    const bool used(volume->getBrickPosition(slot, &x, &y, &z));
+    const bool moved(b.used && (!used || x != b.x || y != b.y || z != b.z));
+
+    // ̂Ăg񂵂肵ubN͌̈ʒu̎ג
+    if (moved)
+    {
+      markAround(b.x, b.y, b.z);
+      dirty[slot] = 1;
+    }
+
+    if (used && (moved || !b.used || volume->getBrickVersion(slot) > lastVersion)) markAround(x, y, z);
+  }
+  lastVersion = volume->getVersion();
+
+  // ubNW߂
+  pending.clear();
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    if (dirty[slot])
+    {
+      dirty[slot] = 0;
+      pending.push_back(slot);
+    }
+  }
+  if (pending.empty()) return;
+
+  // ubNƂɕɒג
+  Parallel::run(0, int(pending.size()), [this](int begin, int end)
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      Brick &b(brick[pending[i]]);
+      b.used = volume->getBrickPosition(pending[i], &b.x, &b.y, &b.z);
+      b.occupied = b.used && isOccupied(pending[i]);
+    }
+  }, brickGrain);
+
+  // gĂubN͂ފiq蒼
+  int upper[3] = { INT_MIN, INT_MIN, INT_MIN };
+  lower[0] = lower[1] = lower[2] = INT_MAX;
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    const Brick &b(brick[slot]);
+    if (!b.used) continue;
+    lower[0] = (std::min)(lower[0], b.x);
+    lower[1] = (std::min)(lower[1], b.y);
+    lower[2] = (std::min)(lower[2], b.z);
+    upper[0] = (std::max)(upper[0], b.x);
+    upper[1] = (std::max)(upper[1], b.y);
+    upper[2] = (std::max)(upper[2], b.z);
+  }
+  if (upper[0] < lower[0])
+  {
+    lower[0] = lower[1] = lower[2] = 0;
+    extent[0] = extent[1] = extent[2] = 0;
+    grid.clear();
+    return;
+  }
+  for (int axis = 0; axis < 3; ++axis) extent[axis] = upper[axis] - lower[axis] + 1;
+  grid.assign(size_t(extent[0]) * extent[1] * extent[2], 0);
+  for (int slot = 0; slot < slots; ++slot)
+  {
+    const Brick &b(brick[slot]);
+    if (b.used && b.occupied)
+      grid[(size_t(b.z - lower[2]) * extent[1] + b.y - lower[1]) * extent[0] + b.x - lower[0]] = 1;
+  }
+}
+
+// ubNPʂ̈ʒu (x, y, z) ̃ubNƂ̎̃ubNɒג
+void CpuRaycast::markAround(int x, int y, int z)
+{
+  for (int dz = -1; dz <= 1; ++dz)
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        const int slot(volume->findBrick(x + dx, y + dy, z + dz));
+        if (slot >= 0) dirty[slot] = 1;
+      }
+}
+
+// i[ꏊ̃ubNƂ̎̃{NZɕ\ʂ̋߂̃{NZ邩ׂ
+//   ubN͈̔͂̕W{͈͂̔͂̃{NZԂ̂, ȂΕ\ʂȂ
+bool CpuRaycast::isOccupied(int slot) const
+{
+  const Brick &b(brick[slot]);
+
+  // ̃ubNƂɒׂ͈ (- ͍Ō̈, + ͍ŏ̈)
+  static const int first[3] = { brickSize - 1, 0, 0 }, count[3] = { 1, brickSize, 1 };
+  for (int i = 0; i < 27; ++i)
+  {
+    const int bx(i % 3), by(i / 3 % 3), bz(i / 9);
+    const int n(i == 13 ? slot : volume->findBrick(b.x + bx - 1, b.y + by - 1, b.z + bz - 1));
+    if (n < 0) continue;
+    const CpuTsdfBase::Voxel *const v(volume->getBrickVoxel(n));
+    for (int z = 0; z < count[bz]; ++z)
+    {
+      for (int y = 0; y < count[by]; ++y)
+      {
+        const CpuTsdfBase::Voxel *const w(v + ((first[bz] + z) * brickSize + first[by] + y) * brickSize + first[bx]);
+        for (int x = 0; x < count[bx]; ++x)
+          if (w[x].weight > 0 && w[x].distance < distanceFree) return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// 摜̍s [begin, end) CLXg
+void CpuRaycast::kernel(int begin, int end)
+{
+  const GLfloat *const m(unproject);
+
+  for (int v = begin; v < end; ++v)
+  {
+    for (int u = 0; u < width; ++u)
+    {
+      // f̒S̑Oʂƌʂ̓_̃[hW
+      const GLfloat x(GLfloat(u * 2 + 1) / GLfloat(width) - 1.0f), y(GLfloat(v * 2 + 1) / GLfloat(height) - 1.0f);
+      GLfloat p[2][3];
+      for (int k = 0; k < 2; ++k)
+      {
+        const GLfloat z(k == 0 ? -1.0f : 1.0f);
+        const GLfloat w(1.0f / (m[3] * x + m[7] * y + m[11] * z + m[15]));
+        p[k][0] = (m[0] * x + m[4] * y + m[8] * z + m[12]) * w;
+        p[k][1] = (m[1] * x + m[5] * y + m[9] * z + m[13]) * w;
+        p[k][2] = (m[2] * x + m[6] * y + m[10] * z + m[14]) * w;
+      }
+
+      // Č
+      GLfloat d[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+      const GLfloat length(sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+      d[0] /= length;
+      d[1] /= length;
+      d[2] /= length;
+
+      // \ʂT
+      const int i(v * width + u);
+      GLfloat t, n[3];
+      if (trace(p[0], d, length, t, n))
+      {
+        const GLfloat hx(p[0][0] + d[0] * t), hy(p[0][1] + d[1] * t), hz(p[0][2] + d[2] * t);
+        depth[i] = -(row[0] * hx + row[1] * hy + row[2] * hz + row[3]);
+        point[i * 3 + 0] = hx;
+        point[i * 3 + 1] = hy;
+        point[i * 3 + 2] = hz;
+        normal[i * 3 + 0] = n[0];
+        normal[i * 3 + 1] = n[1];
+        normal[i * 3 + 2] = n[2];
+        const GLfloat l(shadeAmbient + shadeDiffuse * (std::max)(-(n[0] * d[0] + n[1] * d[1] + n[2] * d[2]), 0.0f));
+        const GLubyte c(GLubyte((std::min)(l, 1.0f) * 255.0f + 0.5f));
+        shaded[i * 4 + 0] = shaded[i * 4 + 1] = shaded[i * 4 + 2] = c;
+        shaded[i * 4 + 3] = 255;
+      }
+      else
+      {
+        depth[i] = 0.0f;
+        point[i * 3 + 0] = point[i * 3 + 1] = point[i * 3 + 2] = 0.0f;
+        normal[i * 3 + 0] = normal[i * 3 + 1] = normal[i * 3 + 2] = 0.0f;
+        shaded[i * 4 + 0] = shaded[i * 4 + 1] = shaded[i * 4 + 2] = shaded[i * 4 + 3] = 0;
+      }
+    }
+  }
+}
+
+// [hW o PʃxNg d ̌ɒ length ܂ŕ\ʂT
+bool CpuRaycast::trace(const GLfloat *o, const GLfloat *d, GLfloat length, GLfloat &t, GLfloat *n) const
+{
+  if (grid.empty()) return false;
+
+  const GLfloat *const origin(volume->getOrigin());
+  const GLfloat voxelSize(volume->getVoxelSize()), truncation(volume->getTruncation());
+  const GLfloat brickLength(voxelSize * GLfloat(brickSize));
+
+  // iq̍ŏ̋_ɂubNPʂ̃C̎n_
+  GLfloat b[3];
+  for (int axis = 0; axis < 3; ++axis) b[axis] = (o[axis] - origin[axis]) / brickLength - GLfloat(lower[axis]);
+
+  // Ciq͈̔͂ɐ؂l߂ (ubNPʂ̒)
+  GLfloat s0(0.0f), s1(length / brickLength);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (d[axis] == 0.0f)
+    {
+      if (b[axis] < 0.0f || b[axis] >= GLfloat(extent[axis])) return false;
+      continue;
+    }
+    GLfloat a0(-b[axis] / d[axis]), a1((GLfloat(extent[axis]) - b[axis]) / d[axis]);
+    if (a0 > a1) std::swap(a0, a1);
+    s0 = (std::max)(s0, a0);
+    s1 = (std::min)(s1, a1);
+  }
+  if (s0 >= s1) return false;
+
+  // iqǂ鏀 (3D DDA)
+  int c[3], step[3];
+  GLfloat next[3], delta[3];
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const GLfloat p(b[axis] + d[axis] * s0);
+    c[axis] = (std::min)((std::max)(int(floor(p)), 0), extent[axis] - 1);
+    step[axis] = d[axis] > 0.0f ? 1 : -1;
+    delta[axis] = d[axis] != 0.0f ? fabs(1.0f / d[axis]) : 1.0e30f;
+    next[axis] = d[axis] > 0.0f ? s0 + (GLfloat(c[axis] + 1) - p) * delta[axis]
+      : d[axis] < 0.0f ? s0 + (p - GLfloat(c[axis])) * delta[axis] : 1.0e30f;
+  }
+
+  // {NZPʂ̈ʒu߂W
+  const GLfloat scale(1.0f / voxelSize);
+  const GLfloat vx((o[0] - origin[0]) * scale - 0.5f), vy((o[1] - origin[1]) * scale - 0.5f), vz((o[2] - origin[2]) * scale - 0.5f);
+
+  // O̕W{̈ʒuƋ (prev  false Ȃ璼O̕W{͂Ȃ)
+  BrickCache cache(*volume);
+  GLfloat march(0.0f), lastT(0.0f), lastD(0.0f);
+  bool prev(false);
+
+  for (GLfloat s(s0); s < s1;)
+  {
+    // ̃ubNoʒu
+    const int axis(next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2));
+    const GLfloat exit((std::min)(next[axis], s1));
+
+    if (grid[(size_t(c[2]) * extent[1] + c[1]) * extent[0] + c[0]])
+    {
+      // \ʂ܂ރubN̒ɉŐi
+      GLfloat tm((std::max)(s * brickLength, march));
+      for (const GLfloat te(exit * brickLength); tm < te;)
+      {
+        GLfloat dm;
+        if (sample(cache, vx + d[0] * tm * scale, vy + d[1] * tm * scale, vz + d[2] * tm * scale, dm))
+        {
+          // 畉ɕςԂ`Ԃĕ\ʂ̈ʒuɂ
+          if (prev && lastD > 0.0f && dm <= 0.0f)
+          {
+            t = lastT + (tm - lastT) * lastD / (lastD - dm);
+
+            // \ʂ̈ʒű̌z@xNgɂ (d݂ 0 ̃{NZɂ鑤͕\ʂ̋ 0 g)
+            const GLfloat hx(vx + d[0] * t * scale), hy(vy + d[1] * t * scale), hz(vz + d[2] * t * scale);
+            GLfloat g[6];
+            for (int k = 0; k < 6; ++k)
+            {
+              const GLfloat e(k & 1 ? -1.0f : 1.0f);
+              if (!sample(cache, hx + (k >> 1 == 0 ? e : 0.0f), hy + (k >> 1 == 1 ? e : 0.0f), hz + (k >> 1 == 2 ? e : 0.0f), g[k]))
+                g[k] = 0.0f;
+            }
+            n[0] = g[0] - g[1];
+            n[1] = g[2] - g[3];
+            n[2] = g[4] - g[5];
+            const GLfloat l(sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]));
+            if (l > 0.0f)
+            {
+              n[0] /= l;
+              n[1] /= l;
+              n[2] /= l;
+            }
+            else
+            {
+              n[0] = -d[0];
+              n[1] = -d[1];
+              n[2] = -d[2];
+            }
+            return true;
+          }
+
+          prev = true;
+          lastT = tm;
+          lastD = dm;
+          tm += dm > 0.0f ? (std::max)(dm * truncation, voxelSize * 0.5f) : voxelSize * 0.5f;
+        }
+        else
+        {
+          prev = false;
+          tm += voxelSize;
+        }
+      }
+      march = tm;
+    }
+    else
+    {
+      // \ʂ܂܂ȂubN͔΂
+      prev = false;
+    }
+
+    // ̃ubNɐi
+    s = exit;
+    c[axis] += step[axis];
+    if (c[axis] < 0 || c[axis] >= extent[axis]) break;
+    next[axis] += delta[axis];
+  }
+
+  return false;
+}
+
+// RXgN^
+Raycast::Raycast()
+  : occupancyProgram(ggLoadComputeShader("occupancy.comp"))
+  , raycastProgram(ggLoadComputeShader("raycast.comp"))
+  , occupancy(0)
+  , bricks(0)
+  , width(0)
+  , height(0)
+{
+  // 摜̃eNX`͑傫܂Ămۂ
+  texture[0] = texture[1] = texture[2] = 0;
+
+  // AẽeNX`ʂɓ]t[obt@IuWFNg
+  glGenFramebuffers(1, &fbo);
+
+  // uniform ϐ̏ꏊ𒲂ׂ
+  unprojectLoc = glGetUniformLocation(raycastProgram, "unproject");
+  rowLoc = glGetUniformLocation(raycastProgram, "row");
+  originLoc = glGetUniformLocation(raycastProgram, "origin");
+  voxelSizeLoc = glGetUniformLocation(raycastProgram, "voxelSize");
+  truncationLoc = glGetUniformLocation(raycastProgram, "truncation");
+}
+
+// fXgN^
+Raycast::~Raycast()
+{
+  // VF[_vO폜
+  glDeleteProgram(occupancyProgram);
+  glDeleteProgram(raycastProgram);
+
+  // eNX`ƃt[obt@IuWFNg폜
+  glDeleteTextures(1, &occupancy);
+  glDeleteTextures(3, texture);
+  glDeleteFramebuffers(1, &fbo);
+}
+
+// {[CLXg, fvX, @xNg, AẽeNX`Ԃ
+const GLuint *Raycast::render(const Tsdf &volume, int width, int height, const GgMatrix &projection, const GgMatrix &modelview)
+{
+  // ubNPʂ̈ӂ̐ςubNƂɕ\ʂ܂ނǂ̃eNX`蒼
+  const int n((volume.getResolution() + brickSize - 1) / brickSize);
+  if (n != bricks)
+  {
+    bricks = n;
+    glDeleteTextures(1, &occupancy);
+    glGenTextures(1, &occupancy);
+    glBindTexture(GL_TEXTURE_3D, occupancy);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R8, n, n, n);
+    glBindTexture(GL_TEXTURE_3D, 0);
+  }
+
+  // 摜̃TCYςeNX`蒼
+  if (width != this->width || height != this->height)
+  {
+    this->width = width;
+    this->height = height;
+    static const GLenum format[3] = { GL_R32F, GL_RGBA16F, GL_RGBA8 };
+    glDeleteTextures(3, texture);
+    glGenTextures(3, texture);
+    for (int i = 0; i < 3; ++i)
+    {
+      glBindTexture(GL_TEXTURE_2D, texture[i]);
+      glTexStorage2D(GL_TEXTURE_2D, 1, format[i], width, height);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // AẽeNX`t[obt@IuWFNgɌ
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture[2], 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  }
+
+  // {[̃eNX`
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_3D, volume.get());
+
+  // ubNƂɕ\ʂ܂ނǂ߂
+  glUseProgram(occupancyProgram);
+  glUniform1i(0, 0);
+  glBindImageTexture(0, occupancy, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+  const GLuint groups((n + brickLocalSize - 1) / brickLocalSize);
+  glDispatchCompute(groups, groups, groups);
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+  // CLXg̃VF[_vO̎gpJn
+  glUseProgram(raycastProgram);
+
+  // uniform ϐݒ肷
+  const GLfloat *const mw(modelview.get());
+  const GLfloat row[4] = { mw[2], mw[6], mw[10], mw[14] };
+  glUniformMatrix4fv(unprojectLoc, 1, GL_FALSE, (projection * modelview).invert().get());
+  glUniform4fv(rowLoc, 1, row);
+  glUniform3fv(originLoc, 1, volume.getOrigin());
+  glUniform1f(voxelSizeLoc, volume.getVoxelSize());
+  glUniform1f(truncationLoc, volume.getTruncation());
+
+  // {[ƃubNƂɕ\ʂ܂ނǂ̃eNX`
+  glUniform1i(0, 0);
+  glUniform1i(1, 1);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_3D, occupancy);
+
+  // fvX, @xNg, AẽeNX` binding = 0`2 ̃C[WɌ
+  glBindImageTexture(0, texture[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+  glBindImageTexture(1, texture[1], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+  glBindImageTexture(2, texture[2], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+  // 摜Ŝ𕢂[NO[vN
+  glDispatchCompute((width + pixelLocalSize - 1) / pixelLocalSize, (height + pixelLocalSize - 1) / pixelLocalSize, 1);
+
+  // 摜eNX`ƂĎQƂ]肷Oɏ݂̊҂
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+  glActiveTexture(GL_TEXTURE0);
+
+  return texture;
+}
+
+// Aẻ摜ʂɓ]
+void Raycast::draw() const
+{
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
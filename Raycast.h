@@ -0,0 +1,197 @@
+#pragma once
+
+//
+// TSDF ̃{[̃CLXg
+//
+//   ʂ̉fƂɎ_烌C΂, t畉ɕςʒu\ʂƂ
+//   fvX (_Wn̉s, m), @xNg ([hW) ƉAe (̕s) ̉摜߂
+//   {[ubN̊iqƂĂǂ, \ʂ܂܂ȂubN͕W{炸ɔ΂
+//   ubN̒͋ɉ (ŏŃ{NZ̔) Ői, d݂ 0 ̃{NZɂW{͎gȂ
+//   摜̍s͉ɕׂ (OpenGL ̃eNX`Ɠ)
+//
+
+// TSDF ɂfvXf[^̓
+#include "Tsdf.h"
+
+//
+// CPU ɂ郌CLXg
+//
+//   CpuTsdf  CpuHashedTsdf ̂ǂɂg, 摜̍s̃ubNƂɕɏ
+//   ubN\ʂ܂ނǂ͕ςubNƂ̎肾ג
+//
+class CpuRaycast
+{
+  // ubN̊i[ꏊƂ̏
+  struct Brick
+  {
+    // ׂƂ̃ubNPʂ̈ʒu
+    int x, y, z;
+
+    // ubNgĂǂ
+    bool used;
+
+    // ubNƂ̎̃{NZɕ\ʂ̋߂̃{NZ邩ǂ
+    bool occupied;
+  };
+
+  // CLXg{[
+  const CpuTsdfBase *volume;
+
+  // ÕCLXĝƂ̃{[̓
+  GLuint lastVersion;
+
+  // ubN̊i[ꏊƂ̏
+  std::vector<Brick> brick;
+
+  // גubN̈ƒגubN
+  std::vector<GLubyte> dirty;
+  std::vector<int> pending;
+
+  // \ʂ܂ރubN̊iq (ubNPʂ̈ʒu lower  extent )
+  int lower[3], extent[3];
+  std::vector<GLubyte> grid;
+
+  // 摜̃TCY
+  int width, height;
+
+  // fƂ̃fvX (m, \ʂȂ 0), _ʒuƖ@xNg (GLfloat[3]), Ae (GLubyte[4])
+  std::vector<GLfloat> depth, point, normal;
+  std::vector<GLubyte> shaded;
+
+  // NbsOW烏[hWւ̕ϊs
+  GLfloat unproject[16];
+
+  // [hW王_W z ߂s
+  GLfloat row[4];
+
+  // ςubNƂ̎̃ubN\ʂ܂ނגĊiq蒼
+  void updateOccupancy();
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubNƂ̎̃ubNɒג
+  void markAround(int x, int y, int z);
+
+  // i[ꏊ̃ubNƂ̎̃{NZɕ\ʂ̋߂̃{NZ邩ׂ
+  bool isOccupied(int slot) const;
+
+  // 摜̍s [begin, end) CLXg
+  void kernel(int begin, int end);
+
+  // [hW o PʃxNg d ̌ɒ length ܂ŕ\ʂT,
+  // ΂̋ t Ɩ@xNg n ߂
+  bool trace(const GLfloat *o, const GLfloat *d, GLfloat length, GLfloat &t, GLfloat *n) const;
+
+  // Rs[RXgN^ (Rs[֎~)
+  CpuRaycast(const CpuRaycast &o);
+
+  //  (֎~)
+  CpuRaycast &operator=(const CpuRaycast &o);
+
+public:
+
+  // RXgN^
+  CpuRaycast();
+
+  // fXgN^
+  virtual ~CpuRaycast() {}
+
+  // {[CLXg
+  //   width, height: 摜̃TCY (Window::getSize())
+  //   projection: eϊs (Window::getMp())
+  //   modelview: [hW王_Wւ̕ϊs (Window::getMw())
+  void render(const CpuTsdfBase &volume, int width, int height, const GgMatrix &projection, const GgMatrix &modelview);
+
+  // 摜̕𓾂
+  int getWidth() const
+  {
+    return width;
+  }
+
+  // 摜̍𓾂
+  int getHeight() const
+  {
+    return height;
+  }
+
+  // fƂ̃fvX (_Wn̉s, m, \ʂȂ 0) 𓾂
+  const GLfloat *getDepth() const
+  {
+    return depth.data();
+  }
+
+  // fƂ̒_ʒu ([hW, \ʂȂ 0) 𓾂
+  const GLfloat (*getPoint() const)[3]
+  {
+    return reinterpret_cast<const GLfloat (*)[3]>(point.data());
+  }
+
+  // fƂ̖@xNg ([hW, \ʂȂ 0) 𓾂
+  const GLfloat (*getNormal() const)[3]
+  {
+    return reinterpret_cast<const GLfloat (*)[3]>(normal.data());
+  }
+
+  // fƂ̉Ae (RGBA, \ʂȂ 0) 𓾂
+  const GLubyte (*getShaded() const)[4]
+  {
+    return reinterpret_cast<const GLubyte (*)[4]>(shaded.data());
+  }
+};
+
+//
+// Rs[gVF[_ɂ郌CLXg (occupancy.comp, raycast.comp, OpenGL 4.3 ȍ~)
+//
+//   Tsdf ̃{[̃eNX`g, ubNƂɕ\ʂ܂ނǂ 3D eNX` (R8) ɋ߂Ă
+//   fƂɃCLXg
+//
+class Raycast
+{
+  // ubN\ʂ܂ނׂVF[_vOƃCLXg̃VF[_vO
+  const GLuint occupancyProgram, raycastProgram;
+
+  // ubNƂɕ\ʂ܂ނǂ̃eNX`
+  GLuint occupancy;
+
+  // occupancy ̃ubNPʂ̈ӂ̐
+  int bricks;
+
+  // fvX (R32F), @xNg (RGBA16F), Ae (RGBA8) ̃eNX`
+  GLuint texture[3];
+
+  // AẽeNX`ʂɓ]t[obt@IuWFNg
+  GLuint fbo;
+
+  // 摜̃TCY
+  GLsizei width, height;
+
+  // uniform ϐ̏ꏊ
+  GLint unprojectLoc, rowLoc, originLoc, voxelSizeLoc, truncationLoc;
+
+  // [NO[v̈ӂ̃Xbh (occupancy.comp  raycast.comp  LOCAL_SIZE ƍ킹)
+  static const GLsizei brickLocalSize = 4, pixelLocalSize = 16;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Raycast(const Raycast &o);
+
+  //  (֎~)
+  Raycast &operator=(const Raycast &o);
+
+public:
+
+  // RXgN^
+  Raycast();
+
+  // fXgN^
+  virtual ~Raycast();
+
+  // {[CLXg, fvX, @xNg, AẽeNX`Ԃ ( CpuRaycast::render() Ɠ)
+  const GLuint *render(const Tsdf &volume, int width, int height, const GgMatrix &projection, const GgMatrix &modelview);
+
+  // fvX, @xNg, AẽeNX`𓾂
+  const GLuint *getTexture() const
+  {
+    return texture;
+  }
+
+  // Aẻ摜ʂɓ]
+  void draw() const;
+};
@@ -0,0 +1,413 @@
+#include "Registration.h"
+
+//
+// fvXf[^̃J[̉𑜓xւ̋ẗʒu킹
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <emmintrin.h>
+
+// Op`U蕪fvX̍s̃ubN̍s
+const int rowGrain(8);
+
+// `ĂȂf̃fvXl
+const GLfloat farthest(FLT_MAX);
+
+namespace
+{
+  // l [lower, upper] Ɏ߂
+  inline GLfloat clamp(GLfloat x, GLfloat lower, GLfloat upper)
+  {
+    return x < lower ? lower : x > upper ? upper : x;
+  }
+}
+
+// RXgN^
+Registration::Registration(int depthWidth, int depthHeight, int colorWidth, int colorHeight, GLuint coordBuffer)
+  : program(ggLoadShader("register.vert", "register.frag", "register.geom"))
+  , colorWidth(colorWidth)
+  , colorHeight(colorHeight)
+  , indexes((depthWidth - 1) * (depthHeight - 1) * 3 * 2)
+  , ratio(0.05f)
+{
+  // J[̉𑜓x̃t[obt@IuWFNg쐬
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  // efvXl [0] ƃJW [1] i[eNX`쐬
+  static const GLenum internal[] = { GL_R32F, GL_RGB32F };
+  glGenTextures(2, texture);
+  for (int i = 0; i < 2; ++i)
+  {
+    glBindTexture(GL_TEXTURE_2D, texture[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal[i], colorWidth, colorHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, texture[i], 0);
+  }
+
+  // dȂOp`̒ł߂̂IԃfvXobt@쐬
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, colorWidth, colorHeight);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // fvX̉fƂ̃J[̃eNX`W𒸓_ɂ
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  glEnableVertexAttribArray(0);
+
+  // Op`̒_̃CfbNX Mesh Ɠтŋ߂ăobt@IuWFNgɓ]
+  glGenBuffers(1, &indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes * sizeof (GLuint), NULL, GL_STATIC_DRAW);
+  GLuint *index(static_cast<GLuint *>(glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY)));
+  for (int j = 0; j < depthHeight - 1; ++j)
+  {
+    for (int i = 0; i < depthWidth - 1; ++i)
+    {
+      index[0] = depthWidth * j + i;
+      index[1] = index[5] = index[0] + 1;
+      index[2] = index[4] = index[0] + depthWidth;
+      index[3] = index[2] + 1;
+      index += 6;
+    }
+  }
+  glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+  glBindVertexArray(0);
+
+  // J[̃TCY͕ςȂ̂Őɐݒ肵Ă
+  glUseProgram(program);
+  glUniform2i(glGetUniformLocation(program, "size"), colorWidth, colorHeight);
+
+  // uniform ϐ̏ꏊ
+  ratioLoc = glGetUniformLocation(program, "ratio");
+}
+
+// fXgN^
+Registration::~Registration()
+{
+  glDeleteProgram(program);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteBuffers(1, &indexBuffer);
+  glDeleteFramebuffers(1, &fbo);
+  glDeleteRenderbuffers(1, &depthBuffer);
+  glDeleteTextures(2, texture);
+}
+
+// fvXf[^̃eNX`ƃJW̃eNX`J[̉𑜓x̃fvXlƃJW, ʂ̃eNX`Ԃ
+const GLuint *Registration::filter(GLuint depth, GLuint point) const
+{
+  // vłȂf (0) ɂ
+  static const GLenum bufs[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  static const GLfloat zero[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glDrawBuffers(2, bufs);
+  glViewport(0, 0, colorWidth, colorHeight);
+  glClearBufferfv(GL_COLOR, 0, zero);
+  glClearBufferfv(GL_COLOR, 1, zero);
+  glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+
+  // eƎOp`̌͌܂Ȃ̂Ŕwʂ`
+  const GLboolean cull(glIsEnabled(GL_CULL_FACE));
+  glDisable(GL_CULL_FACE);
+
+  // fvX̉f̃bVJ[̉摜ɓe, Bʏœf̎Op`͍ł߂̂c
+  glUseProgram(program);
+  glUniform1f(ratioLoc, ratio);
+  glUniform1i(0, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, depth);
+  glUniform1i(1, 1);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, point);
+  glActiveTexture(GL_TEXTURE0);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  glDepthMask(GL_TRUE);
+  glBindVertexArray(vao);
+  glDrawElements(GL_TRIANGLES, indexes, GL_UNSIGNED_INT, 0);
+  glBindVertexArray(0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDrawBuffer(GL_BACK);
+
+  if (cull) glEnable(GL_CULL_FACE);
+
+  return texture;
+}
+
+// CPU ɂʒu킹̃RXgN^
+CpuRegistration::CpuRegistration(int depthWidth, int depthHeight, int colorWidth, int colorHeight)
+  : CpuCalculate(colorWidth, colorHeight, 3, 1)
+  , depthWidth(depthWidth)
+  , depthHeight(depthHeight)
+  , tileCols((colorWidth + tileSize - 1) / tileSize)
+  , tileRows((colorHeight + tileSize - 1) / tileSize)
+  , tileCount(tileCols * tileRows)
+  , blocks((depthHeight - 1 + rowGrain - 1) / rowGrain)
+  , zstride(tileSize + 4)
+  , zbuffer(tileCount * tileSize * zstride)
+  , depth(colorWidth * colorHeight)
+  , quadMask(depthWidth * depthHeight, 0)
+  , quadTile(depthWidth * depthHeight, 0)
+  , binOffset(blocks * tileCount)
+  , binStart(tileCount + 1)
+  , ratio(0.05f)
+{
+}
+
+// _ a, b, c ̎Op``ǂ
+bool CpuRegistration::isValid(int a, int b, int c) const
+{
+  const GLushort *const data(static_cast<const GLushort *>(input[0]));
+  const GLfloat (*const coord)[2](static_cast<const GLfloat (*)[2]>(input[1]));
+
+  // vłȂ_܂ގOp`͕`Ȃ
+  if (data[a] == 0 || data[b] == 0 || data[c] == 0) return false;
+
+  // ߂ȂeNX`W (-) ̒_܂ގOp`͕`Ȃ
+  const int v[] = { a, b, c };
+  for (int k = 0; k < 3; ++k)
+  {
+    if (!(fabs(coord[v[k]][0]) < 1.0e30f && fabs(coord[v[k]][1]) < 1.0e30f)) return false;
+  }
+
+  // ̗̂֊s܂Op`͕`Ȃ
+  const GLfloat zmin(GLfloat((std::min)((std::min)(data[a], data[b]), data[c])));
+  const GLfloat zmax(GLfloat((std::max)((std::max)(data[a], data[b]), data[c])));
+  return zmax - zmin <= ratio * zmin;
+}
+
+// ubN [begin, end) ̎lp`̕^C߂Đ
+void CpuRegistration::countBlock(int begin, int end)
+{
+  const GLfloat (*const coord)[2](static_cast<const GLfloat (*)[2]>(input[1]));
+
+  for (int block = begin; block < end; ++block)
+  {
+    int *const count(binOffset.data() + block * tileCount);
+    std::fill(count, count + tileCount, 0);
+
+    const int v1((std::min)((block + 1) * rowGrain, depthHeight - 1));
+    for (int v = block * rowGrain; v < v1; ++v)
+    {
+      for (int u = 0; u < depthWidth - 1; ++u)
+      {
+        // lp`̍̉f Mesh Ɠ̓̎Op`
+        const int a(v * depthWidth + u);
+        const bool upper(isValid(a, a + 1, a + depthWidth));
+        const bool lower(isValid(a + depthWidth + 1, a + depthWidth, a + 1));
+        quadMask[a] = 0;
+        if (!upper && !lower) continue;
+
+        // `Op`̒_͂ދ`
+        const int corner[] = { a + 1, a + depthWidth, upper ? a : a + depthWidth + 1, lower ? a + depthWidth + 1 : a };
+        GLfloat xmin(coord[corner[0]][0]), xmax(xmin), ymin(coord[corner[0]][1]), ymax(ymin);
+        for (int k = 1; k < 4; ++k)
+        {
+          xmin = (std::min)(xmin, coord[corner[k]][0]);
+          xmax = (std::max)(xmax, coord[corner[k]][0]);
+          ymin = (std::min)(ymin, coord[corner[k]][1]);
+          ymax = (std::max)(ymax, coord[corner[k]][1]);
+        }
+
+        // S`Ɋ܂܂f͈̔ (摜̊O͏)
+        const int x0(int(ceil(clamp(xmin - 0.5f, 0.0f, GLfloat(width)))));
+        const int x1(int(floor(clamp(xmax - 0.5f, -1.0f, GLfloat(width - 1)))));
+        const int y0(int(ceil(clamp(ymin - 0.5f, 0.0f, GLfloat(height)))));
+        const int y1(int(floor(clamp(ymax - 0.5f, -1.0f, GLfloat(height - 1)))));
+        if (x0 > x1 || y0 > y1) continue;
+
+        // `Op`ƕ^C͈̔͂L^Đ
+        const int tx0(x0 / tileSize), tx1(x1 / tileSize), ty0(y0 / tileSize), ty1(y1 / tileSize);
+        quadMask[a] = GLubyte(upper | lower << 1);
+        quadTile[a] = GLuint(tx0 | ty0 << 8 | tx1 << 16 | ty1 << 24);
+        for (int ty = ty0; ty <= ty1; ++ty)
+          for (int tx = tx0; tx <= tx1; ++tx) ++count[ty * tileCols + tx];
+      }
+    }
+  }
+}
+
+// ubN [begin, end) ̎lp`^CƂɕׂ
+void CpuRegistration::scatterBlock(int begin, int end)
+{
+  for (int block = begin; block < end; ++block)
+  {
+    int *const offset(binOffset.data() + block * tileCount);
+
+    const int v1((std::min)((block + 1) * rowGrain, depthHeight - 1));
+    for (int v = block * rowGrain; v < v1; ++v)
+    {
+      for (int u = 0; u < depthWidth - 1; ++u)
+      {
+        const int a(v * depthWidth + u);
+        if (quadMask[a] == 0) continue;
+        const GLuint t(quadTile[a]);
+
+        const int tx0(t & 0xff), ty0(t >> 8 & 0xff), tx1(t >> 16 & 0xff), ty1(t >> 24);
+        for (int ty = ty0; ty <= ty1; ++ty)
+          for (int tx = tx0; tx <= tx1; ++tx) binQuad[offset[ty * tileCols + tx]++] = GLuint(a);
+      }
+    }
+  }
+}
+
+// _ a, b, c ̎Op`^C͈̔ [x0, x1) x [y0, y1) ŃX^CY
+void CpuRegistration::rasterize(int a, int b, int c, int x0, int y0, int x1, int y1, GLfloat *z)
+{
+  const GLushort *const data(static_cast<const GLushort *>(input[0]));
+  const GLfloat (*const coord)[2](static_cast<const GLfloat (*)[2]>(input[1]));
+  const GLfloat (*const point)[3](static_cast<const GLfloat (*)[3]>(input[2]));
+
+  // _̈ʒu
+  const GLfloat ax(coord[a][0]), ay(coord[a][1]);
+  const GLfloat bx(coord[b][0]), by(coord[b][1]);
+  const GLfloat cx(coord[c][0]), cy(coord[c][1]);
+
+  // ʐς 0 ̎Op`͕`Ȃ
+  const GLfloat area((bx - ax) * (cy - ay) - (by - ay) * (cx - ax));
+  if (area == 0.0f) return;
+  const GLfloat r(1.0f / area);
+
+  // SOp`͂ދ`Ɋ܂܂^C̉f͈̔
+  const int u0(int(ceil(clamp((std::min)((std::min)(ax, bx), cx) - 0.5f, GLfloat(x0), GLfloat(x1)))));
+  const int u1(int(floor(clamp((std::max)((std::max)(ax, bx), cx) - 0.5f, GLfloat(x0 - 1), GLfloat(x1 - 1)))) + 1);
+  const int v0(int(ceil(clamp((std::min)((std::min)(ay, by), cy) - 0.5f, GLfloat(y0), GLfloat(y1)))));
+  const int v1(int(floor(clamp((std::max)((std::max)(ay, by), cy) - 0.5f, GLfloat(y0 - 1), GLfloat(y1 - 1)))) + 1);
+
+  // 4 f̏dSW̉̑
+  const GLfloat da(-(cy - by) * r), db(-(ay - cy) * r), dc(-(by - ay) * r);
+  const __m128 step(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+  const __m128 da4(_mm_set1_ps(da * 4.0f)), db4(_mm_set1_ps(db * 4.0f)), dc4(_mm_set1_ps(dc * 4.0f));
+
+  // _̃fvXl
+  const __m128 za(_mm_set1_ps(data[a])), zb(_mm_set1_ps(data[b])), zc(_mm_set1_ps(data[c]));
+
+  // ӏ̉f̎肱ڂhel
+  const __m128 eps(_mm_set1_ps(-1.0e-5f));
+
+  for (int v = v0; v < v1; ++v)
+  {
+    // ̍s̍[ 4 f̒S̏dSW
+    const GLfloat px(GLfloat(u0) + 0.5f), py(GLfloat(v) + 0.5f);
+    __m128 la(_mm_add_ps(_mm_set1_ps(((cx - bx) * (py - by) - (cy - by) * (px - bx)) * r), _mm_mul_ps(step, _mm_set1_ps(da))));
+    __m128 lb(_mm_add_ps(_mm_set1_ps(((ax - cx) * (py - cy) - (ay - cy) * (px - cx)) * r), _mm_mul_ps(step, _mm_set1_ps(db))));
+    __m128 lc(_mm_add_ps(_mm_set1_ps(((bx - ax) * (py - ay) - (by - ay) * (px - ax)) * r), _mm_mul_ps(step, _mm_set1_ps(dc))));
+
+    // ̍s̃^C z obt@ (^C̉Eɂ͂ݏo 4 f̗])
+    GLfloat *const row(z + (v - y0) * zstride - x0);
+
+    for (int u = u0; u < u1; u += 4, la = _mm_add_ps(la, da4), lb = _mm_add_ps(lb, db4), lc = _mm_add_ps(lc, dc4))
+    {
+      // Op`̒Ŕ͈͂̒̉f
+      const __m128 inside(_mm_and_ps(_mm_and_ps(_mm_cmpge_ps(la, eps), _mm_cmpge_ps(lb, eps)),
+        _mm_and_ps(_mm_cmpge_ps(lc, eps), _mm_cmplt_ps(step, _mm_set1_ps(GLfloat(u1 - u))))));
+
+      // Bʏ
+      const __m128 d(_mm_add_ps(_mm_add_ps(_mm_mul_ps(la, za), _mm_mul_ps(lb, zb)), _mm_mul_ps(lc, zc)));
+      const __m128 old(_mm_loadu_ps(row + u));
+      const __m128 pass(_mm_and_ps(inside, _mm_cmplt_ps(d, old)));
+      const int mask(_mm_movemask_ps(pass));
+      if (mask == 0) continue;
+      _mm_storeu_ps(row + u, _mm_or_ps(_mm_and_ps(pass, d), _mm_andnot_ps(pass, old)));
+
+      // f̃JWԂ
+      if (point)
+      {
+        GLfloat wa[4], wb[4], wc[4];
+        _mm_storeu_ps(wa, la);
+        _mm_storeu_ps(wb, lb);
+        _mm_storeu_ps(wc, lc);
+        for (int j = 0; j < 4; ++j)
+        {
+          if (!(mask >> j & 1)) continue;
+          GLfloat *const p(buffer[0].data() + (v * width + u + j) * 3);
+          for (int k = 0; k < 3; ++k) p[k] = wa[j] * point[a][k] + wb[j] * point[b][k] + wc[j] * point[c][k];
+        }
+      }
+    }
+  }
+}
+
+// ^C [begin, end) X^CY
+void CpuRegistration::kernel(int begin, int end)
+{
+  for (int tile = begin; tile < end; ++tile)
+  {
+    // ̃^Cf͈̔
+    const int x0((tile % tileCols) * tileSize), y0((tile / tileCols) * tileSize);
+    const int x1((std::min)(x0 + tileSize, width)), y1((std::min)(y0 + tileSize, height));
+
+    // ̃^C z obt@`ĂȂԂɂ
+    GLfloat *const z(zbuffer.data() + tile * tileSize * zstride);
+    std::fill(z, z + tileSize * zstride, farthest);
+    if (input[2])
+    {
+      for (int y = y0; y < y1; ++y)
+        std::fill(buffer[0].begin() + (y * width + x0) * 3, buffer[0].begin() + (y * width + x1) * 3, 0.0f);
+    }
+
+    // ̃^CɐU蕪lp`̓̎Op``
+    for (int k = binStart[tile]; k < binStart[tile + 1]; ++k)
+    {
+      const int a(binQuad[k]);
+      if (quadMask[a] & 1) rasterize(a, a + 1, a + depthWidth, x0, y0, x1, y1, z);
+      if (quadMask[a] & 2) rasterize(a + depthWidth + 1, a + depthWidth, a + 1, x0, y0, x1, y1, z);
+    }
+
+    // ۂ߂ĕȂ 16bit ɂ (`ĂȂf 0)
+    for (int y = y0; y < y1; ++y)
+    {
+      const GLfloat *const row(z + (y - y0) * zstride - x0);
+      for (int x = x0; x < x1; ++x)
+        depth[y * width + x] = row[x] < farthest ? GLushort(row[x] + 0.5f) : 0;
+    }
+  }
+}
+
+// fvXf[^ƃeNX`WƃJWJ[̉𑜓x̃fvX, ̃fvXlԂ
+const GLushort *CpuRegistration::filter(const GLushort *data, const GLfloat (*coord)[2], const GLfloat (*point)[3])
+{
+  setInput(0, data);
+  setInput(1, coord);
+  setInput(2, point);
+
+  // ubNƂɕɎlp`̕^C߂Đ
+  Parallel::run(0, blocks, [this](int begin, int end) { countBlock(begin, end); });
+
+  // ^CƂɃubN̏ɕԂ悤Ɋi[̈ʒu߂
+  int total(0);
+  for (int tile = 0; tile < tileCount; ++tile)
+  {
+    binStart[tile] = total;
+    for (int block = 0; block < blocks; ++block)
+    {
+      int &offset(binOffset[block * tileCount + tile]);
+      const int count(offset);
+      offset = total;
+      total += count;
+    }
+  }
+  binStart[tileCount] = total;
+  binQuad.resize(total);
+
+  // ubNƂɕɎlp`^CƂɕׂ
+  Parallel::run(0, blocks, [this](int begin, int end) { scatterBlock(begin, end); });
+
+  // ^CƂɕɃX^CY
+  Parallel::run(0, tileCount, [this](int begin, int end) { kernel(begin, end); });
+
+  return depth.data();
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+//
+// fvXf[^̃J[̉𑜓xւ̋ẗʒu킹
+//
+//   fvX̉f𒸓_Ƃ郁bV (Mesh ƓOp`) J[̃eNX`Ẅʒuɓe
+//   J[̉𑜓xŃX^CY, J[̉fƂɃfvXlƃJWOp`̒Ő`Ԃ
+//   BʏœfɏdȂOp`͍ł߂̂ĉ, OiɉBꂽwỉf͌vłȂƂɂȂ
+//   Op`̒_̂ǂꂩvłĂȂ, _̃fvXl̍ł߂_̃fvXl ratio {𒴂
+//   (̗̂֊s܂) Op`͕`Ȃ
+//   J[̉fŌvłȂ̂ 0 ɂ
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂʒu킹 (register.vert / register.geom / register.frag)
+//
+//   vZʂ̃eNX`̓J[ƓTCY,
+//   [0] ͓͂fvX̃eNX` R ƓPʂ̒l (R32F), [1] ̓JW (RGB32F)
+//
+class Registration
+{
+  // fvX̉f̃bVJ[̉摜ɓeVF[_vO
+  const GLuint program;
+
+  // J[̉𑜓x̃t[obt@IuWFNg
+  GLuint fbo;
+
+  // efvXl [0] ƃJW [1] ̃eNX`
+  GLuint texture[2];
+
+  // dȂOp`̒ł߂̂IԃfvXobt@
+  GLuint depthBuffer;
+
+  // fvX̉fƂ̃J[̃eNX`W𒸓_ɂ钸_zIuWFNg
+  GLuint vao;
+
+  // Op`̒_̃CfbNXi[obt@IuWFNg
+  GLuint indexBuffer;
+
+  // J[̃TCY
+  const int colorWidth, colorHeight;
+
+  // `悷钸_
+  const GLsizei indexes;
+
+  // ֊sƂ݂ȂfvXl̍̔䗦 uniform ϐ̏ꏊ
+  GLint ratioLoc;
+
+  // ֊sƂ݂ȂfvXl̍̍ł߂_̃fvXlɑ΂䗦
+  GLfloat ratio;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Registration(const Registration &o);
+
+  //  (֎~)
+  Registration &operator=(const Registration &o);
+
+public:
+
+  // RXgN^
+  //   coordBuffer: fvX̉fƂ̃J[̃eNX`W (f) i[obt@IuWFNg
+  Registration(int depthWidth, int depthHeight, int colorWidth, int colorHeight, GLuint coordBuffer);
+
+  // fXgN^
+  virtual ~Registration();
+
+  // ֊sƂ݂ȂfvXl̍̔䗦ݒ肷
+  void setRatio(GLfloat ratio)
+  {
+    this->ratio = ratio;
+  }
+
+  // fvXf[^̃eNX`ƃJW̃eNX`J[̉𑜓x̃fvXl [0] ƃJW [1] ,
+  // ʂ̃eNX`Ԃ
+  const GLuint *filter(GLuint depth, GLuint point) const;
+};
+
+//
+// CPU ɂʒu킹 (register.vert / register.geom / register.frag ƓvZ)
+//
+//   J[̉摜 tileSize fl̃^Cɕ, Op`ꂪ^CɐU蕪Ă
+//   ^CƂɕɃX^CY (z obt@̓^CƂɕĂ, ^C̉f͈̃Xbh
+//   Ȃ̂Ŕr͂Ȃ)
+//   U蕪̓fvX rowGrain sƂ̃ubNŕɐ, ^CƂɘA悤ɕׂ
+//
+//    0: fvXf[^ (GLushort, mm)
+//    1: fvX̉fƂ̃J[̃eNX`W (GLfloat[2], f)
+//    2: fvX̉fƂ̃JW (GLfloat[3], NULL ȂJW͋߂Ȃ)
+//   o 0: J[̉fƂ̃JW (x, y, z)
+//
+class CpuRegistration : public CpuCalculate
+{
+  // fvX̃TCY
+  const int depthWidth, depthHeight;
+
+  // ^C̉Əc̐ƃ^C̐
+  const int tileCols, tileRows, tileCount;
+
+  // Op`U蕪fvX̍s̃ubN̐
+  const int blocks;
+
+  // ^CƂ z obt@̈s̗vf (E 4 f̗]u)
+  const int zstride;
+
+  // ^CƂɕׂJ[̉f̃fvXl (mm, `ĂȂf͍ől)
+  std::vector<GLfloat> zbuffer;
+
+  // J[̉𑜓x̃fvXl (mm)
+  std::vector<GLushort> depth;
+
+  // fvX 2x2 f̎lp`Ƃ̕`Op` (1: , 2: E, 0 Ȃ`Ȃ)
+  std::vector<GLubyte> quadMask;
+
+  // fvX 2x2 f̎lp`Ƃ̕^C͈̔
+  std::vector<GLuint> quadTile;
+
+  // ubNƂ̃^CƂ̎lp`̐ ([block * tileCount + tile]), ׂƂ͊i[̈ʒu
+  std::vector<int> binOffset;
+
+  // ^CƂ̎lp`̕т̐擪̈ʒu
+  std::vector<int> binStart;
+
+  // ^CƂɕׂlp` (̉f̔ԍ)
+  std::vector<GLuint> binQuad;
+
+  // ֊sƂ݂ȂfvXl̍̔䗦
+  GLfloat ratio;
+
+  // _ a, b, c ̎Op``ǂ
+  bool isValid(int a, int b, int c) const;
+
+  // ubN [begin, end) ̎lp`̕^C߂Đ
+  void countBlock(int begin, int end);
+
+  // ubN [begin, end) ̎lp`^CƂɕׂ
+  void scatterBlock(int begin, int end);
+
+  // _ a, b, c ̎Op`^C͈̔ [x0, x1) x [y0, y1) Ń^C z obt@ z  4 fX^CY
+  void rasterize(int a, int b, int c, int x0, int y0, int x1, int y1, GLfloat *z);
+
+  // ^C [begin, end) X^CY
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuRegistration(int depthWidth, int depthHeight, int colorWidth, int colorHeight);
+
+  // ^C̈ӂ̉f
+  static const int tileSize = 64;
+
+  // ֊sƂ݂ȂfvXl̍̔䗦ݒ肷
+  void setRatio(GLfloat ratio)
+  {
+    this->ratio = ratio;
+  }
+
+  // fvXf[^ƃeNX`WƃJWJ[̉𑜓x̃fvX, ̃fvXlԂ
+  //   JW getBuffer()[0] ɋ߂
+  const GLushort *filter(const GLushort *data, const GLfloat (*coord)[2], const GLfloat (*point)[3] = NULL);
+};
@@ -0,0 +1,42 @@
+#include "ReplayCamera.h"
+
+//
+// L^fvXf[^Đ[xZT
+//
+
+// WCu
+#include <thread>
+
+// t[̊Ԋu
+const std::chrono::microseconds replayInterval(33333);
+
+// RXgN^
+ReplayCamera::ReplayCamera(const char *name, GLenum pointFormat)
+  : reader(name)
+  , next(std::chrono::steady_clock::now())
+{
+  // fvXf[^ǂݍ߂Ύ擾XbhJn
+  if (reader.isOpen()) start(reader.getDepthWidth(), reader.getDepthHeight(), pointFormat);
+}
+
+// fXgN^
+ReplayCamera::~ReplayCamera()
+{
+  // 擾XbhI
+  stop();
+}
+
+// ̃t[̃fvXf[^ǂݍ
+bool ReplayCamera::capture(GLushort *depth)
+{
+  // ̃t[̎܂ő҂
+  std::this_thread::sleep_until(next);
+  next += replayInterval;
+
+  // xĂԊul߂ɍ̎琔
+  const std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+  if (next < now) next = now;
+
+  // t[ǂݍ (I܂ŗ擪ɖ߂)
+  return reader.read(depth, NULL, true);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+//
+// L^fvXf[^Đ[xZT
+//
+//   DepthRecorder ŋL^t@C̃t[ 30 fps ŏɏo͂, I܂ŗ擪ɖ߂
+//
+
+// p̃XbhŃfvXf[^擾[xZT̊NX
+#include "CaptureCamera.h"
+
+// L^fvXf[^̓ǂݍ
+#include "DepthReader.h"
+
+// WCu
+#include <chrono>
+
+class ReplayCamera : public CaptureCamera
+{
+  // Đt@C
+  DepthReader reader;
+
+  // ̃t[o͂鎞
+  std::chrono::steady_clock::time_point next;
+
+  // ̃t[̃fvXf[^ǂݍ
+  virtual bool capture(GLushort *depth);
+
+public:
+
+  // RXgN^
+  //   name: Đt@C (ǂݍ߂Ȃ getActivated()  0 Ԃ)
+  //   pointFormat: JWi[eNX`̓tH[}bg
+  ReplayCamera(const char *name, GLenum pointFormat = GL_RGB32F);
+
+  // fXgN^
+  virtual ~ReplayCamera();
+};
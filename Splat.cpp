@@ -0,0 +1,60 @@
+#include "Splat.h"
+
+//
+// _Q (Xvbg)
+//
+
+// WCu
+#include <vector>
+
+// Xvbg̕`ɗpVF[_̃RXgN^
+SplatShader::SplatShader(const char *vert, const char *frag)
+  : GgSimpleShader(vert, frag)
+{
+  // Xvbg̑傫 uniform ϐ̏ꏊ
+  radiusLoc = glGetUniformLocation(get(), "radius");
+  scaleLoc = glGetUniformLocation(get(), "scale");
+  minSizeLoc = glGetUniformLocation(get(), "minSize");
+}
+
+// RXgN^
+Splat::Splat(int slices, int stacks, GLuint coordBuffer)
+  : GgPoints(GL_POINTS)
+{
+  // _̐
+  const GLuint vertices(slices * stacks);
+
+  // fvXf[^̃TvOɎgeNX`W_̈ʒuƂċ߂
+  std::vector<GLfloat> coord(vertices * 3);
+  for (GLuint i = 0; i < vertices; ++i)
+  {
+    coord[i * 3 + 0] = (GLfloat(i % slices) + 0.5f) / GLfloat(slices);
+    coord[i * 3 + 1] = (GLfloat(i / slices) + 0.5f) / GLfloat(stacks);
+    coord[i * 3 + 2] = 0.0f;
+  }
+
+  // eNX`W index == 0  in ϐɊ蓖Ă
+  load(vertices, reinterpret_cast<const GLfloat (*)[3]>(coord.data()));
+
+  // J[f[^̃eNX`Wi[obt@IuWFNgw肳Ă
+  if (coordBuffer > 0)
+  {
+    // J[f[^̃eNX`W Mesh ƋL index == 1  in ϐɊ蓖Ă
+    glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(1);
+  }
+}
+
+// `
+void Splat::draw(GLint first, GLsizei count) const
+{
+  // _VF[_œ_̑傫߂
+  glEnable(GL_PROGRAM_POINT_SIZE);
+
+  // _Q`悷
+  GgPoints::draw(first, count);
+
+  // _̑傫̐ݒɖ߂
+  glDisable(GL_PROGRAM_POINT_SIZE);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+//
+// _Q (Xvbg)
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+//
+// Xvbg̕`ɗpVF[_
+//
+class SplatShader : public GgSimpleShader
+{
+  // Xvbg̑傫 uniform ϐ̏ꏊ
+  GLint radiusLoc;
+
+  // e̊g嗦 uniform ϐ̏ꏊ
+  GLint scaleLoc;
+
+  // Xvbg̍ŏ̉f uniform ϐ̏ꏊ
+  GLint minSizeLoc;
+
+public:
+
+  // RXgN^
+  SplatShader(const char *vert, const char *frag);
+
+  // fXgN^
+  virtual ~SplatShader() {}
+
+  // Xvbg̑傫ݒ肷
+  //   radius: ZT狗 1 ̈ʒuɂ_̃Xvbg̔a (ZT̋ɔႵđ傫)
+  //   scale: _̋ 1 ̈ʒuɂ钷 1 ̐̉ʏ̉f
+  //   minSize: Xvbg̍ŏ̉f
+  void setSplat(GLfloat radius, GLfloat scale, GLfloat minSize = 1.0f) const
+  {
+    glUniform1f(radiusLoc, radius);
+    glUniform1f(scaleLoc, scale);
+    glUniform1f(minSizeLoc, minSize);
+  }
+};
+
+//
+// fvXf[^̉fƂɓ_`_Q
+//
+class Splat : public GgPoints
+{
+  // Rs[RXgN^ (Rs[֎~)
+  Splat(const Splat &o);
+
+  //  (֎~)
+  Splat &operator=(const Splat &o);
+
+public:
+
+  // RXgN^
+  Splat(int slices, int stacks, GLuint coordBuffer = 0);
+
+  // fXgN^
+  virtual ~Splat() {}
+
+  // `
+  virtual void draw(GLint first = 0, GLsizei count = 0) const;
+};
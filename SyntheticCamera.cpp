@@ -0,0 +1,163 @@
+#include "SyntheticCamera.h"
+
+//
+// fvXf[^o͂[xZT
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+// vł鋗͈̔ (m)
+const GLfloat syntheticNear(0.5f), syntheticFar(8.0f);
+
+// t[̊Ԋu
+const std::chrono::microseconds syntheticInterval(33333);
+
+// xɏs
+const int rowGrain(8);
+
+namespace
+{
+  // ̃nbVl߂
+  inline unsigned int hash(unsigned int x)
+  {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+  }
+
+  // nbVl畽 0 W΍ 1 ̋ߎIȐK߂ (ll̘a)
+  inline GLfloat gaussian(unsigned int x)
+  {
+    const GLfloat scale(1.0f / 255.0f);
+    const GLfloat sum(GLfloat(x & 255u) + GLfloat((x >> 8) & 255u) + GLfloat((x >> 16) & 255u) + GLfloat(x >> 24));
+    return (sum * scale - 2.0f) * 1.7320508f;
+  }
+
+  // ʂ̍Wn o  d ̌̃Cŏɓʒu܂ł d ̒PʂƂ鋗߂ (ȂΕ)
+  GLfloat hitScene(const GLfloat *o, const GLfloat *d, GLfloat time)
+  {
+    GLfloat nearest(-1.0f);
+
+    // ɐȕ (̕ x = -2,  y = -1 Ɖ̕ z = -4)
+    const int axis[] = { 0, 1, 2 };
+    const GLfloat plane[] = { -2.0f, -1.0f, -4.0f };
+    for (int i = 0; i < 3; ++i)
+    {
+      const int a(axis[i]);
+      if (d[a] == 0.0f) continue;
+      const GLfloat t((plane[i] - o[a]) / d[a]);
+      if (t > 0.0f && (nearest < 0.0f || t < nearest)) nearest = t;
+    }
+
+    //  (͍Eɉ)
+    const GLfloat sphere[][4] =
+    {
+      { -0.3f, -0.5f, -2.6f, 0.5f },
+      { 0.8f * std::sin(time), -0.1f, -2.0f, 0.25f }
+    };
+    const GLfloat dd(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    for (int i = 0; i < 2; ++i)
+    {
+      const GLfloat oc[] = { o[0] - sphere[i][0], o[1] - sphere[i][1], o[2] - sphere[i][2] };
+      const GLfloat b(oc[0] * d[0] + oc[1] * d[1] + oc[2] * d[2]);
+      const GLfloat c(oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - sphere[i][3] * sphere[i][3]);
+      const GLfloat disc(b * b - dd * c);
+      if (disc < 0.0f) continue;
+      const GLfloat t((-b - std::sqrt(disc)) / dd);
+      if (t > 0.0f && (nearest < 0.0f || t < nearest)) nearest = t;
+    }
+
+    return nearest;
+  }
+}
+
+// RXgN^
+SyntheticCamera::SyntheticCamera(int width, int height, const GgMatrix &pose, GLfloat noise, GLenum pointFormat)
+  : noise(noise)
+  , seed(0)
+  , begin(std::chrono::steady_clock::now())
+  , next(begin)
+  , xScale(width)
+  , yScale(height)
+{
+  // ʂ̍Wnł̈ʒuƌOp[^ɂ
+  std::copy(pose.get(), pose.get() + 16, this->pose);
+  setExtrinsic(pose);
+
+  // fƂ̃Č (CpuPosition ƓW)
+  for (int u = 0; u < width; ++u)
+    xScale[u] = ((GLfloat(u) + 0.5f) / GLfloat(width) - 0.5f) * positionScale[0];
+  for (int v = 0; v < height; ++v)
+    yScale[v] = ((GLfloat(v) + 0.5f) / GLfloat(height) - 0.5f) * positionScale[1];
+
+  // 擾XbhJn
+  start(width, height, pointFormat);
+}
+
+// fXgN^
+SyntheticCamera::~SyntheticCamera()
+{
+  // 擾XbhI
+  stop();
+}
+
+// ̃t[̃fvXf[^
+bool SyntheticCamera::capture(GLushort *depth)
+{
+  // ̃t[̎܂ő҂
+  std::this_thread::sleep_until(next);
+  const GLfloat time(std::chrono::duration<GLfloat>(next - begin).count());
+  next += syntheticInterval;
+  ++seed;
+
+  Parallel::run(0, depthHeight, [&](int b, int e)
+  {
+    for (int v = b; v < e; ++v)
+    {
+      for (int u = 0; u < depthWidth; ++u)
+      {
+        // JW̉s 1 m ̈ʒuɌC (CpuPosition  x = xScale * z ɂȂ)
+        const GLfloat dc[] = { -xScale[u], -yScale[v], -1.0f };
+        const GLfloat d[] =
+        {
+          pose[0] * dc[0] + pose[4] * dc[1] + pose[8] * dc[2],
+          pose[1] * dc[0] + pose[5] * dc[1] + pose[9] * dc[2],
+          pose[2] * dc[0] + pose[6] * dc[1] + pose[10] * dc[2]
+        };
+
+        // C܂ł̋̂܂܉sɂȂ
+        const GLfloat t(hitScene(pose + 12, d, time));
+
+        // vł͈͂ȂG mm ɊZ
+        const int i(v * depthWidth + u);
+        if (t < syntheticNear || t > syntheticFar)
+        {
+          depth[i] = 0;
+        }
+        else
+        {
+          const GLfloat z(t * 1000.0f + gaussian(hash(i * 2654435761u ^ hash(seed))) * noise * t * t);
+          depth[i] = static_cast<GLushort>(z + 0.5f);
+        }
+      }
+    }
+  }, rowGrain);
+
+  // xĂԊul߂ɍ̎琔
+  const std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+  if (next < now) next = now;
+
+  return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+//
+// fvXf[^o͂[xZT
+//
+//   Ɠ̕ǂƓ̋ (͍Eɉ) ̏ʂLWnɒu, ZT̈ʒuƌ烌C΂
+//   Kinect v2 Ɠp̃fvXf[^ 30 fps ō
+//   ̓ɔႷG, ZTƂ̈ʒuƌō̂, Op[^Γ_QdȂ
+//   ZTȂẴZTg
+//
+
+// p̃XbhŃfvXf[^擾[xZT̊NX
+#include "CaptureCamera.h"
+
+// WCu
+#include <chrono>
+
+class SyntheticCamera : public CaptureCamera
+{
+  // JWʂ̍Wnւ̕ϊs
+  GLfloat pose[16];
+
+  // fvXl̎G 1 m ̂Ƃ̕W΍ (mm)
+  GLfloat noise;
+
+  // G̗̏
+  unsigned int seed;
+
+  // JnƎ̃t[鎞
+  std::chrono::steady_clock::time_point begin, next;
+
+  // fƂ̃Č (JW)
+  std::vector<GLfloat> xScale, yScale;
+
+  // ̃t[̃fvXf[^
+  virtual bool capture(GLushort *depth);
+
+public:
+
+  // RXgN^
+  //   width, height: fvXf[^̃TCY
+  //   pose: JWʂ̍Wnւ̕ϊs (Op[^ɂݒ肷)
+  //   noise: fvXl̎G 1 m ̂Ƃ̕W΍ (mm)
+  //   pointFormat: JWi[eNX`̓tH[}bg
+  SyntheticCamera(int width, int height, const GgMatrix &pose, GLfloat noise = 1.5f, GLenum pointFormat = GL_RGB32F);
+
+  // fXgN^
+  virtual ~SyntheticCamera();
+};
@@ -0,0 +1,166 @@
+#include "Temporal.h"
+
+//
+// fvXf[^̎ԕ̕
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <emmintrin.h>
+
+// fvX̃eNX`̒l~[gɊZW (GL_R16)
+const GLfloat depthRange(65535.0f);
+
+// RXgN^
+Temporal::Temporal(int width, int height)
+  : current(0)
+  , reset(true)
+  , alpha(1.0f)
+  , threshold(1.0f)
+  , hold(0)
+{
+  // ݂ɎgvZ
+  for (int i = 0; i < 2; ++i) pass[i] = new Calculate(width, height, "temporal.frag", 2, 1, GL_RG32F);
+
+  // ̌W臒lƕێt[ uniform ϐ̏ꏊ
+  alphaLoc = glGetUniformLocation(pass[0]->get(), "alpha");
+  thresholdLoc = glGetUniformLocation(pass[0]->get(), "threshold");
+  holdLoc = glGetUniformLocation(pass[0]->get(), "hold");
+  resetLoc = glGetUniformLocation(pass[0]->get(), "reset");
+}
+
+// fXgN^
+Temporal::~Temporal()
+{
+  for (int i = 0; i < 2; ++i) delete pass[i];
+}
+
+// fvXf[^̃eNX`𕽊, ʂ̃eNX`Ԃ
+GLuint Temporal::filter(GLuint depth)
+{
+  // gvZƑÕt[̌vZ
+  const Calculate &next(*pass[current]);
+  const Calculate &last(*pass[1 - current]);
+
+  // p[^ݒ肷 (̌vZ͓VF[_Ȃ̂ uniform ϐ̏ꏊ)
+  next.use();
+  glUniform1f(alphaLoc, alpha);
+  glUniform1f(thresholdLoc, threshold / depthRange);
+  glUniform1f(holdLoc, GLfloat(hold));
+  glUniform1i(resetLoc, reset);
+
+  // fvXf[^ƑÕt[̌vZʂ͂
+  glUniform1i(0, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, depth);
+  glUniform1i(1, 1);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, last.getTexture()[0]);
+  glActiveTexture(GL_TEXTURE0);
+
+  // 
+  const GLuint texture(next.calculate()[0]);
+
+  // ̃t[ł͍̌vZʂ͂
+  current = 1 - current;
+  reset = false;
+
+  return texture;
+}
+
+// CPU ɂ镽̃RXgN^
+CpuTemporal::CpuTemporal(int width, int height)
+  : CpuCalculate(width, height, 1, 1, 2)
+  , depth(width * height)
+  , reset(true)
+  , alpha(1.0f)
+  , threshold(1.0f)
+  , hold(0)
+{
+}
+
+// fvXf[^𕽊
+void CpuTemporal::kernel(int begin, int end)
+{
+  const GLushort *const data(static_cast<const GLushort *>(input[0]));
+  const GLfloat a0(alpha);
+  const GLfloat h(static_cast<GLfloat>(hold));
+
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 va(_mm_set1_ps(a0));
+  const __m128 vb(_mm_set1_ps(1.0f - a0));
+  const __m128 vr(_mm_set1_ps(1.0f / threshold));
+  const __m128 vh(_mm_set1_ps(h));
+  const __m128 sign(_mm_set1_ps(-0.0f));
+  const __m128i bias(_mm_set1_epi32(32768));
+  const __m128i flip(_mm_set1_epi16(-32768));
+  const __m128i zeroi(_mm_setzero_si128());
+
+  for (int v = begin; v < end; ++v)
+  {
+    const int row(v * width);
+    const GLushort *const d(data + row);
+    GLfloat *const s(buffer[0].data() + row * 2);
+    GLushort *const o(depth.data() + row);
+
+    // 4 f߂
+    int u(0);
+    for (; u + 4 <= width; u += 4)
+    {
+      // VfvXlƑÕt[܂ł̒l (fvXlƌvłȂt[𕪂)
+      const __m128 df(_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(d + u)), zeroi)));
+      const __m128 s0(_mm_loadu_ps(s + u * 2)), s1(_mm_loadu_ps(s + u * 2 + 4));
+      const __m128 prev(reset ? zero : _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0)));
+      const __m128 age(reset ? zero : _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+      // 臒lɋ߂قǐVl̏d݂傫
+      const __m128 diff(_mm_sub_ps(df, prev));
+      const __m128 e(_mm_min_ps(_mm_mul_ps(_mm_andnot_ps(sign, diff), vr), one));
+      const __m128 empty(_mm_cmpeq_ps(prev, zero));
+      const __m128 w(_mm_or_ps(_mm_and_ps(empty, one), _mm_andnot_ps(empty, _mm_add_ps(va, _mm_mul_ps(vb, _mm_mul_ps(e, e))))));
+      const __m128 smooth(_mm_add_ps(prev, _mm_mul_ps(w, diff)));
+
+      // vłȂf͂΂炭O̒lێ
+      const __m128 keep(_mm_cmplt_ps(age, vh));
+      const __m128 heldDepth(_mm_and_ps(keep, prev));
+      const __m128 heldAge(_mm_or_ps(_mm_and_ps(keep, _mm_add_ps(age, one)), _mm_andnot_ps(keep, vh)));
+
+      // vłǂőI
+      const __m128 invalid(_mm_cmpeq_ps(df, zero));
+      const __m128 z(_mm_or_ps(_mm_and_ps(invalid, heldDepth), _mm_andnot_ps(invalid, smooth)));
+      const __m128 n(_mm_and_ps(invalid, heldAge));
+      _mm_storeu_ps(s + u * 2, _mm_unpacklo_ps(z, n));
+      _mm_storeu_ps(s + u * 2 + 4, _mm_unpackhi_ps(z, n));
+
+      // ۂ߂ĕȂ 16bit ɋl߂ (SSE2 ɂ͕Ȃ̖OapbNȂ̂ 32768 炵ĕtŋl߂)
+      const __m128i zi(_mm_sub_epi32(_mm_cvtps_epi32(z), bias));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(o + u), _mm_xor_si128(_mm_packs_epi32(zi, zi), flip));
+    }
+
+    // c̉f
+    for (; u < width; ++u)
+    {
+      const GLfloat prev(reset ? 0.0f : s[u * 2 + 0]);
+      const GLfloat age(reset ? 0.0f : s[u * 2 + 1]);
+      if (d[u] == 0)
+      {
+        s[u * 2 + 0] = age < h ? prev : 0.0f;
+        s[u * 2 + 1] = age < h ? age + 1.0f : h;
+      }
+      else
+      {
+        const GLfloat diff(GLfloat(d[u]) - prev);
+        GLfloat e(fabs(diff) / threshold);
+        if (e > 1.0f) e = 1.0f;
+        const GLfloat w(prev == 0.0f ? 1.0f : a0 + (1.0f - a0) * e * e);
+        s[u * 2 + 0] = prev + w * diff;
+        s[u * 2 + 1] = 0.0f;
+      }
+      o[u] = GLushort(s[u * 2 + 0] + 0.5f);
+    }
+  }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+//
+// fvXf[^̎ԕ̕
+//
+//   fƂɑÕt[܂ł̕fvXlێ, wړςƂ
+//   fvXl臒lȏωf͓̂Ƃĕ蒼
+//
+
+// 摜
+#include "Calculate.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂ镽 (temporal.frag)
+//
+//    Calculate ݂Ɏg, ̌vZʂ̃t[̓͂ɂ
+//   vZʂ̃eNX` RG32F , R fvXl (GL_R16 ̃fvX̃eNX`Ɠ [0, 1] ̒l), G vłȂt[
+//   R QƂ position.frag ɂ̂܂ܓ͂ł
+//
+class Temporal
+{
+  // ݂ɎgvZ
+  const Calculate *pass[2];
+
+  // ɎgvZ
+  int current;
+
+  // ̌W臒lƕێt[Ƃ蒼 uniform ϐ̏ꏊ
+  GLint alphaLoc, thresholdLoc, holdLoc, resetLoc;
+
+  // Õt[̌vZʂgȂ
+  bool reset;
+
+  // ̌W
+  GLfloat alpha;
+
+  // Ƃ݂ȂfvXl̍ (mm)
+  GLfloat threshold;
+
+  // vłȂf̒lێt[
+  int hold;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Temporal(const Temporal &o);
+
+  //  (֎~)
+  Temporal &operator=(const Temporal &o);
+
+public:
+
+  // RXgN^
+  Temporal(int width, int height);
+
+  // fXgN^
+  virtual ~Temporal();
+
+  // ̃p[^ݒ肷
+  //   alpha: VfvXl̏d (1 Ȃ畽Ȃ, 0 Ȃ瓮ĂȂf͑O̒l̂܂)
+  //   threshold: Ƃ݂ȂfvXl̍ (mm)
+  //   hold: vłȂfɑO̒lێt[
+  void setParameter(GLfloat alpha, GLfloat threshold, int hold)
+  {
+    this->alpha = alpha;
+    this->threshold = threshold;
+    this->hold = hold;
+  }
+
+  // ێĂl̂ĂĎ̃t[蒼
+  void restart()
+  {
+    reset = true;
+  }
+
+  // fvXf[^̃eNX`𕽊, ʂ̃eNX`Ԃ
+  GLuint filter(GLuint depth);
+};
+
+//
+// CPU ɂ镽 (temporal.frag ƓvZ)
+//
+//    0: fvXf[^ (GLushort, mm)
+//   o 0: fvXl (mm) ƌvłȂt[
+//
+class CpuTemporal : public CpuCalculate
+{
+  // fvXlۂ߂
+  std::vector<GLushort> depth;
+
+  // Õt[̒lgȂ
+  bool reset;
+
+  // ̌W
+  GLfloat alpha;
+
+  // Ƃ݂ȂfvXl̍ (mm)
+  GLfloat threshold;
+
+  // vłȂf̒lێt[
+  int hold;
+
+  // s [begin, end) ̌vZs
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  CpuTemporal(int width, int height);
+
+  // ̃p[^ݒ肷 (Temporal::setParameter() Ɠ)
+  void setParameter(GLfloat alpha, GLfloat threshold, int hold)
+  {
+    this->alpha = alpha;
+    this->threshold = threshold;
+    this->hold = hold;
+  }
+
+  // ێĂl̂ĂĎ̃t[蒼
+  void restart()
+  {
+    reset = true;
+  }
+
+  // fvXf[^𕽊, ۂ߂fvXlԂ
+  const GLushort *filter(const GLushort *data)
+  {
+    setInput(0, data);
+    calculate();
+    reset = false;
+    return depth.data();
+  }
+};
@@ -0,0 +1,393 @@
+#include "Tsdf.h"
+
+//
+// ؂̂ĕt (TSDF) ɂfvXf[^̓
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+
+// ł_߂fvX̉摜̃^C̈ӂ̉f
+const int tileSize(16);
+
+// xɏubN
+const int brickGrain(16);
+
+// Kt GLshort ɊZW
+const GLfloat distanceScale(32767.0f);
+
+namespace
+{
+  // tߎlj[g@ň␳ċ߂ (Z葬)
+  inline __m128 reciprocal(__m128 a)
+  {
+    const __m128 r(_mm_rcp_ps(a));
+    return _mm_sub_ps(_mm_add_ps(r, r), _mm_mul_ps(a, _mm_mul_ps(r, r)));
+  }
+}
+
+// RXgN^
+CpuTsdfBase::CpuTsdfBase(int depthWidth, int depthHeight, GLfloat voxelSize)
+  : depthWidth(depthWidth)
+  , depthHeight(depthHeight)
+  , voxelSize(voxelSize)
+  , truncation(voxelSize * 4.0f)
+  , maxWeight(64)
+  , tileCols((depthWidth + tileSize - 1) / tileSize)
+  , tileRows((depthHeight + tileSize - 1) / tileSize)
+  , tileFar(tileCols * tileRows)
+  , point(NULL)
+  , version(0)
+{
+  origin[0] = origin[1] = origin[2] = 0.0f;
+}
+
+// ̃p[^ݒ肷
+void CpuTsdfBase::setParameter(GLfloat truncation, int maxWeight)
+{
+  this->truncation = truncation;
+  this->maxWeight = (std::max)(1, (std::min)(maxWeight, 65535));
+}
+
+// ubNɂ
+void CpuTsdfBase::clear(Voxel *v)
+{
+  // d݂ 0 ̃{NZ͈xϑĂȂ
+  const Voxel empty = { GLshort(distanceScale), 0 };
+  std::fill(v, v + brickVoxels, empty);
+}
+
+// JWƕϊsݒ肵ă^CƂ̍ł_߂
+void CpuTsdfBase::prepare(const GLfloat (*point)[3], const GgMatrix &view)
+{
+  this->point = point;
+  std::copy(view.get(), view.get() + 16, this->view);
+
+  // {NZ x ̕т̓JWł͕ϊs̑ 1 ̕ɕ
+  step[0] = this->view[0] * voxelSize;
+  step[1] = this->view[1] * voxelSize;
+  step[2] = this->view[2] * voxelSize;
+
+  // ^CƂ̍ł_߂Ă
+  Parallel::run(0, tileRows, [this](int begin, int end) { measureTile(begin, end); });
+}
+
+// ^C̍s [begin, end) ̍ł_̃fvXl߂
+void CpuTsdfBase::measureTile(int begin, int end)
+{
+  for (int row = begin; row < end; ++row)
+  {
+    const int y0(row * tileSize), y1((std::min)(y0 + tileSize, depthHeight));
+
+    for (int col = 0; col < tileCols; ++col)
+    {
+      const int x0(col * tileSize), x1((std::min)(x0 + tileSize, depthWidth));
+
+      // JW z ͕Ȃ̂ōł_ z ŏ̌vł_
+      GLfloat deepest(0.0f);
+      for (int v = y0; v < y1; ++v)
+      {
+        for (int u = x0; u < x1; ++u)
+        {
+          const GLfloat z(point[v * depthWidth + u][2]);
+          if (z >= depthInvalid && z < deepest) deepest = z;
+        }
+      }
+
+      tileFar[row * tileCols + col] = deepest < 0.0f ? -deepest : -1.0f;
+    }
+  }
+}
+
+// ŏ̃{NZ̒S̃[hW (x, y, z) ̃ubNɍXV{NZ邩ǂׂ
+bool CpuTsdfBase::isVisible(GLfloat x, GLfloat y, GLfloat z) const
+{
+  // ubN̒̍ŏƍŌ̃{NZ̒S̋
+  const GLfloat span(GLfloat(brickSize - 1) * voxelSize);
+
+  // ubN 8 ̋fvX̉摜ɓe͈͂ƃfvXl͈̔͂߂
+  GLfloat zmin(1.0e30f), zmax(-1.0e30f);
+  GLfloat umin(1.0e30f), umax(-1.0e30f), vmin(1.0e30f), vmax(-1.0e30f);
+  bool behind(false);
+  for (int k = 0; k < 8; ++k)
+  {
+    const GLfloat wx(x + (k & 1 ? span : 0.0f)), wy(y + (k & 2 ? span : 0.0f)), wz(z + (k & 4 ? span : 0.0f));
+    const GLfloat cx(view[0] * wx + view[4] * wy + view[8] * wz + view[12]);
+    const GLfloat cy(view[1] * wx + view[5] * wy + view[9] * wz + view[13]);
+    const GLfloat cz(view[2] * wx + view[6] * wy + view[10] * wz + view[14]);
+    zmin = (std::min)(zmin, -cz);
+    zmax = (std::max)(zmax, -cz);
+
+    // J̌ɂ͓ełȂ
+    if (cz >= 0.0f)
+    {
+      behind = true;
+      continue;
+    }
+
+    const GLfloat u((cx / (positionScale[0] * cz) + 0.5f) * GLfloat(depthWidth));
+    const GLfloat v((cy / (positionScale[1] * cz) + 0.5f) * GLfloat(depthHeight));
+    umin = (std::min)(umin, u);
+    umax = (std::max)(umax, u);
+    vmin = (std::min)(vmin, v);
+    vmax = (std::max)(vmax, v);
+  }
+
+  // ubNŜJ̌ɂ
+  if (zmax <= 0.0f) return false;
+
+  // ubN^C͈̔ (J̌ɂΉ摜S)
+  int col0(0), col1(tileCols - 1), row0(0), row1(tileRows - 1);
+  if (!behind)
+  {
+    // ubNŜ摜̊Oɓe
+    if (umax < 0.0f || umin >= GLfloat(depthWidth) || vmax < 0.0f || vmin >= GLfloat(depthHeight)) return false;
+
+    col0 = umin > 0.0f ? int(umin) / tileSize : 0;
+    col1 = umax < GLfloat(depthWidth - 1) ? int(umax) / tileSize : tileCols - 1;
+    row0 = vmin > 0.0f ? int(vmin) / tileSize : 0;
+    row1 = vmax < GLfloat(depthHeight - 1) ? int(vmax) / tileSize : tileRows - 1;
+  }
+
+  // ubNŜ͈̔͂̂ǂ̓_ truncation ȏ㉜ɂ΍XV{NZ͂Ȃ
+  GLfloat deepest(-1.0f);
+  for (int row = row0; row <= row1; ++row)
+    for (int col = col0; col <= col1; ++col)
+      deepest = (std::max)(deepest, tileFar[row * tileCols + col]);
+  return deepest >= 0.0f && zmin <= deepest + truncation;
+}
+
+// ŏ̃{NZ̒S̃[hW (x, y, z) ̃ubN v ɃJW𓝍
+bool CpuTsdfBase::integrateBrick(Voxel *v, GLfloat x, GLfloat y, GLfloat z) const
+{
+  bool changed(false);
+
+  // ubÑ{NZ x ̕тƂɓ
+  for (int lz = 0; lz < brickSize; ++lz)
+  {
+    for (int ly = 0; ly < brickSize; ++ly)
+    {
+      // т̐擪̃{NZ̒S̃JW
+      const GLfloat wy(y + GLfloat(ly) * voxelSize), wz(z + GLfloat(lz) * voxelSize);
+      const GLfloat cx(view[0] * x + view[4] * wy + view[8] * wz + view[12]);
+      const GLfloat cy(view[1] * x + view[5] * wy + view[9] * wz + view[13]);
+      const GLfloat cz(view[2] * x + view[6] * wy + view[10] * wz + view[14]);
+
+      for (int lx = 0; lx < brickSize; lx += 4, v += 4)
+        if (integrate4(v, cx + step[0] * GLfloat(lx), cy + step[1] * GLfloat(lx), cz + step[2] * GLfloat(lx)))
+          changed = true;
+    }
+  }
+
+  return changed;
+}
+
+// ubÑ{NZ 4 ̕тɃJW𓝍 (SSE2)
+bool CpuTsdfBase::integrate4(Voxel *v, GLfloat x, GLfloat y, GLfloat z) const
+{
+  const __m128 zero(_mm_setzero_ps());
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 lane(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+
+  // 4 ̃{NZ̒S̃JW
+  const __m128 cx(_mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(lane, _mm_set1_ps(step[0]))));
+  const __m128 cy(_mm_add_ps(_mm_set1_ps(y), _mm_mul_ps(lane, _mm_set1_ps(step[1]))));
+  const __m128 cz(_mm_add_ps(_mm_set1_ps(z), _mm_mul_ps(lane, _mm_set1_ps(step[2]))));
+
+  // fvX̉摜ɓe (J̌Ɖ摜̊Õ{NZ͏)
+  const __m128 w(_mm_set1_ps(GLfloat(depthWidth))), h(_mm_set1_ps(GLfloat(depthHeight)));
+  const __m128 r(reciprocal(cz));
+  const __m128 u(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(cx, r), _mm_set1_ps(1.0f / positionScale[0])),
+    _mm_set1_ps(0.5f)), w));
+  const __m128 t(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(cy, r), _mm_set1_ps(1.0f / positionScale[1])),
+    _mm_set1_ps(0.5f)), h));
+  __m128 mask(_mm_and_ps(_mm_cmplt_ps(cz, zero), _mm_and_ps(
+    _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmplt_ps(u, w)), _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, h)))));
+  if (_mm_movemask_ps(mask) == 0) return false;
+
+  // ef̓_ z W߂ (͈͊Ỏf͒[Ɋ񂹂ēǂނgȂ)
+  GLint iu[4], iv[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(iu),
+    _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(u, zero), _mm_set1_ps(GLfloat(depthWidth - 1)))));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(iv),
+    _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(t, zero), _mm_set1_ps(GLfloat(depthHeight - 1)))));
+  const __m128 pz(_mm_setr_ps(point[iv[0] * depthWidth + iu[0]][2], point[iv[1] * depthWidth + iu[1]][2],
+    point[iv[2] * depthWidth + iu[2]][2], point[iv[3] * depthWidth + iu[3]][2]));
+
+  // _ZT̋ (vłȂ_ truncation ȏ㉜̃{NZ͏)
+  const __m128 sdf(_mm_sub_ps(cz, pz));
+  mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(pz, _mm_set1_ps(depthInvalid)),
+    _mm_cmpge_ps(sdf, _mm_set1_ps(-truncation))));
+  if (_mm_movemask_ps(mask) == 0) return false;
+  const __m128 d(_mm_min_ps(_mm_mul_ps(sdf, _mm_set1_ps(1.0f / truncation)), one));
+
+  // {NZ̋ ( 16bit) Əd ( 16bit) ǂݏo
+  __m128i *const p(reinterpret_cast<__m128i *>(v));
+  const __m128i raw(_mm_loadu_si128(p));
+  const __m128 distance(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(raw, 16), 16)),
+    _mm_set1_ps(1.0f / distanceScale)));
+  const __m128 weight(_mm_cvtepi32_ps(_mm_srli_epi32(raw, 16)));
+
+  // dݕtς߂ďd݂𑝂₷
+  const __m128 next(_mm_add_ps(weight, one));
+  const __m128 average(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(distance, weight), d), reciprocal(next)));
+  const __m128i a(_mm_cvtps_epi32(_mm_mul_ps(average, _mm_set1_ps(distanceScale))));
+  const __m128i b(_mm_cvttps_epi32(_mm_min_ps(next, _mm_set1_ps(GLfloat(maxWeight)))));
+  const __m128i updated(_mm_or_si128(_mm_and_si128(a, _mm_set1_epi32(0xffff)), _mm_slli_epi32(b, 16)));
+
+  // {NZ߂
+  const __m128i m(_mm_castps_si128(mask));
+  _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(m, updated), _mm_andnot_si128(m, raw)));
+
+  // ς{NZd݂ 0 {NZ邩ׂ
+  const __m128i low(_mm_set1_epi32(0xffff));
+  const __m128i same(_mm_cmpeq_epi32(_mm_and_si128(raw, low), _mm_and_si128(a, low)));
+  const __m128i empty(_mm_cmpeq_epi32(_mm_srli_epi32(raw, 16), _mm_setzero_si128()));
+  return _mm_movemask_epi8(_mm_andnot_si128(_mm_andnot_si128(empty, same), m)) != 0;
+}
+
+// RXgN^
+CpuTsdf::CpuTsdf(int depthWidth, int depthHeight, int resolution, GLfloat voxelSize, const GLfloat *origin)
+  : CpuTsdfBase(depthWidth, depthHeight, voxelSize)
+  , resolution((resolution + brickSize - 1) / brickSize * brickSize)
+  , bricks((resolution + brickSize - 1) / brickSize)
+  , voxel(size_t(bricks) * bricks * bricks * brickVoxels)
+{
+  this->origin[0] = origin[0];
+  this->origin[1] = origin[1];
+  this->origin[2] = origin[2];
+  brickVersion.resize(bricks * bricks * bricks);
+  reset();
+}
+
+// {[ɂ
+void CpuTsdf::reset()
+{
+  for (size_t i = 0; i < voxel.size(); i += brickVoxels) clear(&voxel[i]);
+
+  // ׂẴubNXVƂɂ
+  std::fill(brickVersion.begin(), brickVersion.end(), ++version);
+}
+
+// JW{[ɓ
+void CpuTsdf::integrate(const GLfloat (*point)[3], const GgMatrix &view)
+{
+  // JWƕϊsݒ肷
+  prepare(point, view);
+  ++version;
+
+  // ubNƂɕɓ
+  Parallel::run(0, bricks * bricks * bricks, [this](int begin, int end) { kernel(begin, end); }, brickGrain);
+}
+
+// ubN [begin, end) ɃJW𓝍
+void CpuTsdf::kernel(int begin, int end)
+{
+  for (int brick = begin; brick < end; ++brick)
+  {
+    // ubN̍ŏ̃{NZ̒S̃[hW
+    int bx, by, bz;
+    getBrickPosition(brick, &bx, &by, &bz);
+    GLfloat c[3];
+    getBrickCenter(bx, by, bz, c);
+
+    // XV{NZubN, \ʂς肤ȂXVƂɂ
+    if (isVisible(c[0], c[1], c[2]) && integrateBrick(voxel.data() + size_t(brick) * brickVoxels, c[0], c[1], c[2]))
+      brickVersion[brick] = version;
+  }
+}
+
+// RXgN^
+Tsdf::Tsdf(int resolution, GLfloat voxelSize, const GLfloat *origin)
+  : program(ggLoadComputeShader("tsdf.comp"))
+  , resolution(resolution)
+  , voxelSize(voxelSize)
+  , truncation(voxelSize * 4.0f)
+  , maxWeight(64.0f)
+{
+  this->origin[0] = origin[0];
+  this->origin[1] = origin[1];
+  this->origin[2] = origin[2];
+
+  // {[̃eNX`쐬
+  glGenTextures(1, &volume);
+  glBindTexture(GL_TEXTURE_3D, volume);
+  glTexStorage3D(GL_TEXTURE_3D, 1, GL_RG16F, resolution, resolution, resolution);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glBindTexture(GL_TEXTURE_3D, 0);
+
+  // uniform ϐ̏ꏊ𒲂ׂ
+  viewLoc = glGetUniformLocation(program, "view");
+  originLoc = glGetUniformLocation(program, "origin");
+  voxelSizeLoc = glGetUniformLocation(program, "voxelSize");
+  truncationLoc = glGetUniformLocation(program, "truncation");
+  maxWeightLoc = glGetUniformLocation(program, "maxWeight");
+
+  // {[ɂ
+  reset();
+}
+
+// fXgN^
+Tsdf::~Tsdf()
+{
+  // VF[_vO폜
+  glDeleteProgram(program);
+
+  // {[̃eNX`폜
+  glDeleteTextures(1, &volume);
+}
+
+// {[ɂ
+void Tsdf::reset() const
+{
+  //  1, d 0 ̈ꖇ̃f[^őŜ𖄂߂
+  std::vector<GLfloat> empty(resolution * resolution * 2, 0.0f);
+  for (size_t i = 0; i < empty.size(); i += 2) empty[i] = 1.0f;
+  glBindTexture(GL_TEXTURE_3D, volume);
+  for (int z = 0; z < resolution; ++z)
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, z, resolution, resolution, 1, GL_RG, GL_FLOAT, empty.data());
+  glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+// JW̃eNX`{[ɓ, {[̃eNX`Ԃ
+GLuint Tsdf::integrate(GLuint point, const GgMatrix &view) const
+{
+  // VF[_vO̎gpJn
+  glUseProgram(program);
+
+  // uniform ϐݒ肷
+  glUniformMatrix4fv(viewLoc, 1, GL_FALSE, view.get());
+  glUniform3fv(originLoc, 1, origin);
+  glUniform1f(voxelSizeLoc, voxelSize);
+  glUniform1f(truncationLoc, truncation);
+  glUniform1f(maxWeightLoc, maxWeight);
+
+  // JW̃eNX`
+  glUniform1i(0, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, point);
+
+  // {[ binding = 0 ̃C[WɌ
+  glBindImageTexture(0, volume, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RG16F);
+
+  // {[Ŝ𕢂[NO[vN
+  const GLuint groups((resolution + localSize - 1) / localSize);
+  glDispatchCompute(groups, groups, groups);
+
+  // {[eNX`ƂĎQƂOɏ݂̊҂
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+  return volume;
+}
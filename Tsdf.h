@@ -0,0 +1,346 @@
+#pragma once
+
+//
+// ؂̂ĕt (TSDF) ɂfvXf[^̓
+//
+//    resolution ̃{NẐ̗̒Ƀ{NZƂɍł߂\ʂ܂ł̕tƏd݂ۑ,
+//   Vt[̃JWdݕtςœĂ
+//   {NZ̒SfvX̉摜ɓe (position.frag  scale g), ̉f̓_Ƃ̃fvXl̍ɂ
+//   ͕\ʂO (ZT) , truncation Ŋ [-1, 1] ɐK
+//   \ʂ truncation ȏ㉜̃{NZ, 摜̊OvłȂfɓe{NZ͍XVȂ
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+//
+// CPU ɂubNւ TSDF ̓ (CpuTsdf  CpuHashedTsdf ̋ʕ)
+//
+//   {NZ brickSize^3 ̃ubNɂ܂Ƃ߂, ubN̒̃{NZɘAĕׂ
+//   ̓ubNƂɍs, ubNƂɕɌĂяo
+//
+class CpuTsdfBase
+{
+public:
+
+  // {NZ
+  struct Voxel
+  {
+    // Kt (-32767`32767  -1`1)
+    GLshort distance;
+
+    // d (t[, maxWeight őł؂)
+    GLushort weight;
+  };
+
+  // ubN̈ӂ̃{NZ
+  static const int brickSize = 8;
+
+  // ubÑ{NZ
+  static const int brickVoxels = brickSize * brickSize * brickSize;
+
+protected:
+
+  // fvX̃TCY
+  const int depthWidth, depthHeight;
+
+  // {NZ̈ӂ̒ (m)
+  const GLfloat voxelSize;
+
+  // ubNPʂ̈ʒu (0, 0, 0) ̃ubN̍ŏ̋̃[hW (m)
+  GLfloat origin[3];
+
+  // ł؂钷 (m)
+  GLfloat truncation;
+
+  // d݂̏
+  int maxWeight;
+
+  // fvX̉摜̃^C̉Əc̐
+  const int tileCols, tileRows;
+
+  // fvX̉摜̃^CƂ̍ł_̃fvXl (m, vł_ȂΕ)
+  std::vector<GLfloat> tileFar;
+
+  // JW
+  const GLfloat (*point)[3];
+
+  // [hWJWւ̕ϊs
+  GLfloat view[16];
+
+  // {NZ x ̈ړɑ΂JW̕ω
+  GLfloat step[3];
+
+  //  (reset() ł₷)
+  GLuint version;
+
+  // ubN̊i[ꏊƂ̍Ōɕ\ʂς{NZXVƂ version
+  std::vector<GLuint> brickVersion;
+
+  // JWƕϊsݒ肵ă^CƂ̍ł_߂
+  void prepare(const GLfloat (*point)[3], const GgMatrix &view);
+
+  // ^C̍s [begin, end) ̍ł_̃fvXl߂
+  void measureTile(int begin, int end);
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubN̍ŏ̃{NZ̒S̃[hW߂
+  void getBrickCenter(int x, int y, int z, GLfloat *center) const
+  {
+    center[0] = origin[0] + (GLfloat(x * brickSize) + 0.5f) * voxelSize;
+    center[1] = origin[1] + (GLfloat(y * brickSize) + 0.5f) * voxelSize;
+    center[2] = origin[2] + (GLfloat(z * brickSize) + 0.5f) * voxelSize;
+  }
+
+  // ŏ̃{NZ̒S̃[hW (x, y, z) ̃ubNɍXV{NZ邩ǂׂ
+  //   ̊ÕubNƕ\ʂ truncation ȏ㉜ɂubN false
+  bool isVisible(GLfloat x, GLfloat y, GLfloat z) const;
+
+  // ŏ̃{NZ̒S̃[hW (x, y, z) ̃ubN v ɃJW𓝍
+  //   ς{NZ߂ē{NZ (\ʂς肤Ȃ) true Ԃ
+  bool integrateBrick(Voxel *v, GLfloat x, GLfloat y, GLfloat z) const;
+
+  // ubÑ{NZ 4 ̕тɃJW𓝍 (SSE2, ߂l integrateBrick() Ɠ)
+  //   x, y, z: т̐擪̃{NZ̒S̃JW
+  bool integrate4(Voxel *v, GLfloat x, GLfloat y, GLfloat z) const;
+
+  // ubNɂ
+  static void clear(Voxel *v);
+
+public:
+
+  // RXgN^
+  //   depthWidth, depthHeight: fvX̃TCY
+  //   voxelSize: {NZ̈ӂ̒ (m)
+  CpuTsdfBase(int depthWidth, int depthHeight, GLfloat voxelSize);
+
+  // fXgN^
+  virtual ~CpuTsdfBase() {}
+
+  // ̃p[^ݒ肷
+  //   truncation: ł؂钷 (m)
+  //   maxWeight: d݂̏ (傫قǌÂt[c)
+  void setParameter(GLfloat truncation, int maxWeight);
+
+  // {NZ̈ӂ̒𓾂
+  GLfloat getVoxelSize() const
+  {
+    return voxelSize;
+  }
+
+  // ubNPʂ̈ʒu (0, 0, 0) ̃ubN̍ŏ̋̃[hW𓾂
+  const GLfloat *getOrigin() const
+  {
+    return origin;
+  }
+
+  // ł؂钷𓾂
+  GLfloat getTruncation() const
+  {
+    return truncation;
+  }
+
+  // 񐔂𓾂
+  GLuint getVersion() const
+  {
+    return version;
+  }
+
+  // ubN̊i[ꏊ̐𓾂
+  int getBrickSlots() const
+  {
+    return int(brickVersion.size());
+  }
+
+  // i[ꏊ̃ubN̕\ʂŌɕςƂ̓񐔂𓾂
+  GLuint getBrickVersion(int slot) const
+  {
+    return brickVersion[slot];
+  }
+
+  // i[ꏊ̃ubÑubNPʂ̈ʒu𓾂 (gĂȂi[ꏊȂ false)
+  virtual bool getBrickPosition(int slot, int *x, int *y, int *z) const = 0;
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubN̊i[ꏊT (Ȃ -1)
+  virtual int findBrick(int x, int y, int z) const = 0;
+
+  // i[ꏊ̃ubÑ{NZ𓾂
+  virtual const Voxel *getBrickVoxel(int slot) const = 0;
+};
+
+//
+// CPU ɂ TSDF ̓
+//
+//    resolution ̃{NẐׂ̗ăubNɕĊmۂ
+//   ubNƂɕɓ, ̊ÕubNƕ\ʂ truncation ȏ㉜ɂubN
+//   {NZɐG炸ɔ΂
+//
+class CpuTsdf : public CpuTsdfBase
+{
+  // {[̈ӂ̃{NZƃubN
+  const int resolution, bricks;
+
+  // ubNƂɕׂ{NZ
+  std::vector<Voxel> voxel;
+
+  // ubN [begin, end) ɃJW𓝍
+  void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  //   depthWidth, depthHeight: fvX̃TCY
+  //   resolution: {[̈ӂ̃{NZ (brickSize ̔{ɐ؂グ)
+  //   voxelSize: {NZ̈ӂ̒ (m)
+  //   origin: {[̍ŏ̋̃[hW (m)
+  CpuTsdf(int depthWidth, int depthHeight, int resolution, GLfloat voxelSize, const GLfloat *origin);
+
+  // {[ɂ
+  void reset();
+
+  // JW{[ɓ
+  //   point: fvX̉fƂ̃JW (GLfloat[3], m, vłȂ_ z  depthInvalid 菬)
+  //   view: [hWJWւ̕ϊs
+  void integrate(const GLfloat (*point)[3], const GgMatrix &view);
+
+  // {[̈ӂ̃{NZ𓾂
+  int getResolution() const
+  {
+    return resolution;
+  }
+
+  // {NZ (x, y, z) ̊i[ꏊ߂
+  int index(int x, int y, int z) const
+  {
+    const int brick(((z / brickSize) * bricks + y / brickSize) * bricks + x / brickSize);
+    return ((brick * brickSize + z % brickSize) * brickSize + y % brickSize) * brickSize + x % brickSize;
+  }
+
+  // {NZ (x, y, z) 𓾂
+  const Voxel &get(int x, int y, int z) const
+  {
+    return voxel[index(x, y, z)];
+  }
+
+  // ubNƂɕׂ{NZ𓾂
+  const std::vector<Voxel> &getVoxel() const
+  {
+    return voxel;
+  }
+
+  // i[ꏊ̃ubÑubNPʂ̈ʒu𓾂
+  virtual bool getBrickPosition(int slot, int *x, int *y, int *z) const
+  {
+    *x = slot % bricks;
+    *y = (slot / bricks) % bricks;
+    *z = slot / (bricks * bricks);
+    return true;
+  }
+
+  // ubNPʂ̈ʒu (x, y, z) ̃ubN̊i[ꏊT
+  virtual int findBrick(int x, int y, int z) const
+  {
+    if (x < 0 || x >= bricks || y < 0 || y >= bricks || z < 0 || z >= bricks) return -1;
+    return (z * bricks + y) * bricks + x;
+  }
+
+  // i[ꏊ̃ubÑ{NZ𓾂
+  virtual const Voxel *getBrickVoxel(int slot) const
+  {
+    return voxel.data() + size_t(slot) * brickVoxels;
+  }
+};
+
+//
+// Rs[gVF[_ɂ TSDF ̓ (tsdf.comp, OpenGL 4.3 ȍ~)
+//
+//   {[ 3D eNX` (RG16F) , R Kt, G d
+//
+class Tsdf
+{
+  // p̃VF[_vO
+  const GLuint program;
+
+  // {[̃eNX`
+  GLuint volume;
+
+  // {[̈ӂ̃{NZ
+  const int resolution;
+
+  // {NZ̈ӂ̒ (m)
+  const GLfloat voxelSize;
+
+  // {[̍ŏ̋̃[hW (m)
+  GLfloat origin[3];
+
+  // ł؂钷 (m)
+  GLfloat truncation;
+
+  // d݂̏
+  GLfloat maxWeight;
+
+  // uniform ϐ̏ꏊ
+  GLint viewLoc, originLoc, voxelSizeLoc, truncationLoc, maxWeightLoc;
+
+  // [NO[v̈ӂ̃Xbh (tsdf.comp  LOCAL_SIZE ƍ킹)
+  static const GLsizei localSize = 8;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Tsdf(const Tsdf &o);
+
+  //  (֎~)
+  Tsdf &operator=(const Tsdf &o);
+
+public:
+
+  // RXgN^ ( CpuTsdf Ɠ)
+  Tsdf(int resolution, GLfloat voxelSize, const GLfloat *origin);
+
+  // fXgN^
+  virtual ~Tsdf();
+
+  // ̃p[^ݒ肷 (CpuTsdf::setParameter() Ɠ)
+  void setParameter(GLfloat truncation, int maxWeight)
+  {
+    this->truncation = truncation;
+    this->maxWeight = GLfloat(maxWeight);
+  }
+
+  // {[ɂ
+  void reset() const;
+
+  // {[̈ӂ̃{NZ𓾂
+  int getResolution() const
+  {
+    return resolution;
+  }
+
+  // {NZ̈ӂ̒𓾂
+  GLfloat getVoxelSize() const
+  {
+    return voxelSize;
+  }
+
+  // {[̍ŏ̋̃[hW𓾂
+  const GLfloat *getOrigin() const
+  {
+    return origin;
+  }
+
+  // ł؂钷𓾂
+  GLfloat getTruncation() const
+  {
+    return truncation;
+  }
+
+  // JW̃eNX`{[ɓ, {[̃eNX`Ԃ
+  GLuint integrate(GLuint point, const GgMatrix &view) const;
+
+  // {[̃eNX`𓾂
+  GLuint get() const
+  {
+    return volume;
+  }
+};
@@ -0,0 +1,347 @@
+#include "Upsample.h"
+
+//
+// J[̉𑜓xւ̃fvXf[^̃AbvTvO
+//
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <immintrin.h>
+
+// RXgN^
+Upsample::Upsample(int depthWidth, int depthHeight, int colorWidth, int colorHeight, GLuint coordBuffer, int scale)
+  : program(ggLoadShader("project.vert", "project.frag"))
+  , pass(colorWidth, colorHeight, "upsample.frag", 3, 1, GL_R32F)
+  , colorWidth(colorWidth)
+  , colorHeight(colorHeight)
+  , gridWidth(colorWidth / scale)
+  , gridHeight(colorHeight / scale)
+  , depthCount(depthWidth * depthHeight)
+  , scale(scale)
+  , radius(0)
+  , sigmaSpace(1.0f)
+  , sigmaColor(1.0f)
+{
+  // eiq̃t[obt@IuWFNg쐬
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  // efvXl [0] ƓeʒũJ[ [1] i[eNX`쐬
+  static const GLenum internal[] = { GL_R32F, GL_RGBA8 };
+  glGenTextures(2, grid);
+  for (int i = 0; i < 2; ++i)
+  {
+    glBindTexture(GL_TEXTURE_2D, grid[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal[i], gridWidth, gridHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, grid[i], 0);
+  }
+
+  // Zɓe_̒ł߂̂IԃfvXobt@쐬
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, gridWidth, gridHeight);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // fvX̉fƂ̃J[̃eNX`W𒸓_ɂ
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, coordBuffer);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  glEnableVertexAttribArray(0);
+  glBindVertexArray(0);
+
+  // Z̑傫Ƒeiq̃TCY͕ςȂ̂Őɐݒ肵Ă
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "scale"), scale);
+  glUniform2i(glGetUniformLocation(program, "size"), gridWidth, gridHeight);
+  pass.use();
+  glUniform1i(glGetUniformLocation(pass.get(), "scale"), scale);
+
+  // uniform ϐ̏ꏊ
+  radiusLoc = glGetUniformLocation(pass.get(), "radius");
+  sigmaSpaceLoc = glGetUniformLocation(pass.get(), "sigmaSpace");
+  sigmaColorLoc = glGetUniformLocation(pass.get(), "sigmaColor");
+}
+
+// fXgN^
+Upsample::~Upsample()
+{
+  glDeleteProgram(program);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteFramebuffers(1, &fbo);
+  glDeleteRenderbuffers(1, &depthBuffer);
+  glDeleteTextures(2, grid);
+}
+
+// fvXf[^̃eNX`ƃJ[̃eNX`J[̉𑜓x̃fvX, ʂ̃eNX`Ԃ
+GLuint Upsample::filter(GLuint depth, GLuint color) const
+{
+  // eiqvłȂZ (0) ɂ
+  static const GLenum bufs[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  static const GLfloat zero[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glDrawBuffers(2, bufs);
+  glViewport(0, 0, gridWidth, gridHeight);
+  glClearBufferfv(GL_COLOR, 0, zero);
+  glClearBufferfv(GL_COLOR, 1, zero);
+  glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+
+  // fvX̉f_ƂăZɓe, BʏœZ̓_͍ł߂̂c
+  glUseProgram(program);
+  glUniform1i(0, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, depth);
+  glUniform1i(1, 1);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, color);
+  glActiveTexture(GL_TEXTURE0);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  glDepthMask(GL_TRUE);
+  glBindVertexArray(vao);
+  glDrawArrays(GL_POINTS, 0, depthCount);
+  glBindVertexArray(0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDrawBuffer(GL_BACK);
+
+  // p[^ݒ肷
+  pass.use();
+  glUniform1i(radiusLoc, radius);
+  glUniform1f(sigmaSpaceLoc, sigmaSpace);
+  glUniform1f(sigmaColorLoc, sigmaColor);
+
+  // eiqƃJ[͂
+  for (int i = 0; i < 3; ++i)
+  {
+    glUniform1i(i, i);
+    glActiveTexture(GL_TEXTURE0 + i);
+    glBindTexture(GL_TEXTURE_2D, i < 2 ? grid[i] : color);
+  }
+  glActiveTexture(GL_TEXTURE0);
+
+  // Ԃ
+  return pass.calculate()[0];
+}
+
+// CPU ɂAbvTvÕRXgN^
+CpuUpsample::CpuUpsample(int depthWidth, int depthHeight, int colorWidth, int colorHeight, int scale)
+  : CpuCalculate(colorWidth, colorHeight, 3, 0)
+  , depthWidth(depthWidth)
+  , depthHeight(depthHeight)
+  , scale(scale)
+  , gridWidth(colorWidth / scale)
+  , gridHeight(colorHeight / scale)
+  , tileCols((colorWidth + tileSize - 1) / tileSize)
+  , tileRows((colorHeight + tileSize - 1) / tileSize)
+  , stride(0)
+  , depth(colorWidth * colorHeight)
+  , cellX(colorWidth)
+  , radius(-1)
+  , avx2(hasAvx2())
+{
+  // J[̉f̗񂲂Ƃ̃Z̗
+  for (int x = 0; x < width; ++x) cellX[x] = x / scale;
+
+  setParameter(0, 1.0f, 1.0f);
+}
+
+// tB^̃p[^ݒ肷
+void CpuUpsample::setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaColor)
+{
+  // aς͂𖄂߂eiq蒼 (摜̉E[Ɖ[̔[ȉf̂߂Ɉ߂)
+  if (radius != this->radius)
+  {
+    this->radius = radius;
+    stride = gridWidth + radius * 2 + 1;
+    grid.assign(stride * (gridHeight + radius * 2 + 1), 0.0f);
+    guide.assign(grid.size(), 0);
+  }
+
+  // J[̉f̗񂲂ƂƍsƂ̋ߖT̃Z̋̏d
+  const GLfloat ks(-0.5f / (sigmaSpace * sigmaSpace));
+  const int taps(radius * 2 + 1);
+  spaceX.resize(taps * width);
+  spaceY.resize(taps * height);
+  for (int i = -radius; i <= radius; ++i)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      const GLfloat o(GLfloat(x / scale + i) + 0.5f - (GLfloat(x) + 0.5f) / GLfloat(scale));
+      spaceX[(i + radius) * width + x] = GLfloat(exp(o * o * ks));
+    }
+    for (int y = 0; y < height; ++y)
+    {
+      const GLfloat o(GLfloat(y / scale + i) + 0.5f - (GLfloat(y) + 0.5f) / GLfloat(scale));
+      spaceY[(i + radius) * height + y] = GLfloat(exp(o * o * ks));
+    }
+  }
+
+  // J[̍̏d݂̕\ (W΍ 3 {ȏ̍ 0 ɂ)
+  const GLfloat kc(-0.5f / (sigmaColor * sigmaColor));
+  const int entries((std::min)(int(ceil(sigmaColor * 3.0f)), 766));
+  colorWeight.resize(entries + 1);
+  for (int k = 0; k < entries; ++k) colorWeight[k] = GLfloat(exp(GLfloat(k * k) * kc));
+  colorWeight[entries] = 0.0f;
+}
+
+// s v ̉f [u0, u1) Ԃ
+void CpuUpsample::filterRow(int v, int u0, int u1)
+{
+  const GLubyte *const color(static_cast<const GLubyte *>(input[2]));
+  const int last(int(colorWeight.size()) - 1);
+
+  // ̍s̃Z̍s
+  const int gy(v / scale);
+
+  for (int u = u0; u < u1; ++u)
+  {
+    const GLubyte *const c(color + (v * width + u) * 4);
+    GLfloat sw(0.0f), sd(0.0f);
+
+    for (int j = -radius; j <= radius; ++j)
+    {
+      const GLfloat wy(spaceY[(j + radius) * height + v]);
+      const int row((gy + j + radius) * stride + cellX[u] + radius);
+
+      for (int i = -radius; i <= radius; ++i)
+      {
+        // vłȂZ͊܂߂Ȃ
+        const GLfloat d(grid[row + i]);
+        if (d == 0.0f) continue;
+
+        // J[̍̏d݂\
+        const GLubyte *const g(reinterpret_cast<const GLubyte *>(&guide[row + i]));
+        const int e(abs(c[0] - g[0]) + abs(c[1] - g[1]) + abs(c[2] - g[2]));
+        const GLfloat w(spaceX[(i + radius) * width + u] * wy * colorWeight[e < last ? e : last]);
+        sw += w;
+        sd += w * d;
+      }
+    }
+
+    // ߖTɌvłZȂ 0 ɂ
+    depth[v * width + u] = sw > 0.0f ? GLushort(sd / sw + 0.5f) : 0;
+  }
+}
+
+// s v ̉f [u0, u1)  8 fԂ, fԂ
+AVX2_FUNCTION int CpuUpsample::filterRowAvx2(int v, int u0, int u1)
+{
+  const GLubyte *const color(static_cast<const GLubyte *>(input[2]));
+  const __m256 zero(_mm256_setzero_ps());
+  const __m256i byte(_mm256_set1_epi32(0xff));
+  const __m256i last(_mm256_set1_epi32(int(colorWeight.size()) - 1));
+
+  // ̍s̃Z̍s
+  const int gy(v / scale);
+
+  int u(u0);
+  for (; u + 8 <= u1; u += 8)
+  {
+    // 8 f̃J[ B, G, R ɕ
+    const __m256i c(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(color + (v * width + u) * 4)));
+    const __m256i cb(_mm256_and_si256(c, byte));
+    const __m256i cg(_mm256_and_si256(_mm256_srli_epi32(c, 8), byte));
+    const __m256i cr(_mm256_and_si256(_mm256_srli_epi32(c, 16), byte));
+
+    // 8 f̃Z̗
+    const __m256i cx(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cellX.data() + u)));
+    __m256 sw(zero), sd(zero);
+
+    for (int j = -radius; j <= radius; ++j)
+    {
+      const __m256 wy(_mm256_set1_ps(spaceY[(j + radius) * height + v]));
+      const __m256i row(_mm256_add_epi32(cx, _mm256_set1_epi32((gy + j + radius) * stride + radius)));
+
+      for (int i = -radius; i <= radius; ++i)
+      {
+        // ߖT̃Z̃fvXlƒS̃J[
+        const __m256i cell(_mm256_add_epi32(row, _mm256_set1_epi32(i)));
+        const __m256 d(_mm256_i32gather_ps(grid.data(), cell, 4));
+        const __m256i g(_mm256_i32gather_epi32(reinterpret_cast<const int *>(guide.data()), cell, 4));
+
+        // J[̍̏d݂\
+        const __m256i e(_mm256_min_epi32(_mm256_add_epi32(_mm256_add_epi32(
+          _mm256_abs_epi32(_mm256_sub_epi32(cb, _mm256_and_si256(g, byte))),
+          _mm256_abs_epi32(_mm256_sub_epi32(cg, _mm256_and_si256(_mm256_srli_epi32(g, 8), byte)))),
+          _mm256_abs_epi32(_mm256_sub_epi32(cr, _mm256_and_si256(_mm256_srli_epi32(g, 16), byte)))), last));
+        const __m256 r(_mm256_i32gather_ps(colorWeight.data(), e, 4));
+
+        // vłȂZ̏d݂ 0 ɂ
+        const __m256 wx(_mm256_loadu_ps(spaceX.data() + (i + radius) * width + u));
+        const __m256 w(_mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_NEQ_OQ), _mm256_mul_ps(_mm256_mul_ps(wx, wy), r)));
+        sw = _mm256_add_ps(sw, w);
+        sd = _mm256_fmadd_ps(w, d, sd);
+      }
+    }
+
+    // ߖTɌvłZȂ 0 ɂ, ۂ߂ĕȂ 16bit ɋl߂
+    const __m256 valid(_mm256_cmp_ps(sw, zero, _CMP_GT_OQ));
+    const __m256 z(_mm256_and_ps(valid, _mm256_div_ps(sd, _mm256_or_ps(sw, _mm256_andnot_ps(valid, _mm256_set1_ps(1.0f))))));
+    const __m256i zi(_mm256_cvtps_epi32(z));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(depth.data() + v * width + u),
+      _mm_packus_epi32(_mm256_castsi256_si128(zi), _mm256_extracti128_si256(zi, 1)));
+  }
+
+  return u - u0;
+}
+
+// ^C [begin, end) Ԃ
+void CpuUpsample::kernel(int begin, int end)
+{
+  for (int tile = begin; tile < end; ++tile)
+  {
+    // ̃^Cf͈̔
+    const int u0((tile % tileCols) * tileSize), v0((tile / tileCols) * tileSize);
+    const int u1((std::min)(u0 + tileSize, width)), v1((std::min)(v0 + tileSize, height));
+
+    for (int v = v0; v < v1; ++v)
+    {
+      const int done(avx2 ? filterRowAvx2(v, u0, u1) : 0);
+      filterRow(v, u0 + done, u1);
+    }
+  }
+}
+
+// fvXf[^ƃeNX`WƃJ[f[^J[̉𑜓x̃fvX, ̃fvXlԂ
+const GLushort *CpuUpsample::filter(const GLushort *data, const GLfloat (*coord)[2], const GLubyte *color)
+{
+  setInput(0, data);
+  setInput(1, coord);
+  setInput(2, color);
+
+  // fvX̉feiq̃Zɓe, Z̓_͍ł߂̂Ƃ̈ʒũJ[c
+  std::fill(grid.begin(), grid.end(), 0.0f);
+  const GLuint *const pixel(reinterpret_cast<const GLuint *>(color));
+  const GLfloat s(1.0f / GLfloat(scale));
+  for (int i = 0; i < depthWidth * depthHeight; ++i)
+  {
+    const GLfloat d(data[i]);
+    if (d == 0.0f) continue;
+
+    // 摜̊O⋁߂ȂeNX`W (-) ̓_͎̂Ă
+    const GLfloat x(coord[i][0] * s), y(coord[i][1] * s);
+    if (!(x >= 0.0f && x < GLfloat(gridWidth) && y >= 0.0f && y < GLfloat(gridHeight))) continue;
+
+    const int cell((int(y) + radius) * stride + int(x) + radius);
+    if (grid[cell] == 0.0f || d < grid[cell])
+    {
+      grid[cell] = d;
+      guide[cell] = pixel[int(coord[i][1]) * width + int(coord[i][0])];
+    }
+  }
+
+  // ^CƂɕɕԂ
+  Parallel::run(0, tileCols * tileRows, [this](int begin, int end) { kernel(begin, end); });
+
+  return depth.data();
+}
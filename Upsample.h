@@ -0,0 +1,172 @@
+#pragma once
+
+//
+// J[̉𑜓xւ̃fvXf[^̃AbvTvO
+//
+//   fvXf[^̉fJ[̃eNX`Ẅʒuɓe, J[̉摜 scale fl
+//   ZɕeiqɊi[ (Zɕ̉f΍ł߂̂Ƃ̈ʒũJ[c)
+//   ̊iqJ[̉摜肪ɃWCgoCetB^ŕԂăJ[Ɠ𑜓x̃fvX߂
+//   d݂̓Z̒S܂ł̋̏d݂, J[̉fƃZɎc_̈ʒũJ[̍
+//   (RGB ̍̐Βl̘a) ̏d݂̐ςɂ
+//   ߖTɌvłZȂ 0 ɂ
+//
+
+// 摜
+#include "Calculate.h"
+
+// 摜 (CPU)
+#include "CpuCalculate.h"
+
+//
+// VF[_ɂAbvTvO (project.vert / project.frag, upsample.frag)
+//
+//   vZʂ̃eNX`̓J[ƓTCY R32F , ͂fvX̃eNX` R ƓPʂ̒l
+//
+class Upsample
+{
+  // fvX̉feiqɓeVF[_vO
+  const GLuint program;
+
+  // eiq̃t[obt@IuWFNg
+  GLuint fbo;
+
+  // eiqɓefvXl [0] ƓeʒũJ[ [1] ̃eNX`
+  GLuint grid[2];
+
+  // Zɓe_̒ł߂̂IԃfvXobt@
+  GLuint depthBuffer;
+
+  // fvX̉fƂ̃J[̃eNX`W𒸓_ɂ钸_zIuWFNg
+  GLuint vao;
+
+  // iqԂvZ
+  const Calculate pass;
+
+  // J[̃TCYƑeiq̃TCY
+  const int colorWidth, colorHeight, gridWidth, gridHeight;
+
+  // fvX̉f
+  const GLsizei depthCount;
+
+  // aƋ̕W΍ƃJ[̍̕W΍ uniform ϐ̏ꏊ
+  GLint radiusLoc, sigmaSpaceLoc, sigmaColorLoc;
+
+  // Z̈ӂ̉f
+  const int scale;
+
+  // tB^̔a (Z)
+  int radius;
+
+  // ̏d݂̕W΍ (Z)
+  GLfloat sigmaSpace;
+
+  // J[̍̏d݂̕W΍ (RGB ̍̐Βl̘a, 0`765)
+  GLfloat sigmaColor;
+
+  // Rs[RXgN^ (Rs[֎~)
+  Upsample(const Upsample &o);
+
+  //  (֎~)
+  Upsample &operator=(const Upsample &o);
+
+public:
+
+  // RXgN^
+  //   coordBuffer: fvX̉fƂ̃J[̃eNX`W (f) i[obt@IuWFNg
+  //   scale: eiq̃Z̈ӂ̉f
+  Upsample(int depthWidth, int depthHeight, int colorWidth, int colorHeight, GLuint coordBuffer, int scale = 4);
+
+  // fXgN^
+  virtual ~Upsample();
+
+  // tB^̃p[^ݒ肷
+  //   radius: tB^̔a (Z)
+  //   sigmaSpace: ̏d݂̕W΍ (Z)
+  //   sigmaColor: J[̍̏d݂̕W΍ (RGB ̍̐Βl̘a,  3 {ȏ̍̃Z͕ԂɊ܂߂Ȃ)
+  void setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaColor)
+  {
+    this->radius = radius;
+    this->sigmaSpace = sigmaSpace;
+    this->sigmaColor = sigmaColor;
+  }
+
+  // fvXf[^̃eNX`ƃJ[̃eNX`J[̉𑜓x̃fvX, ʂ̃eNX`Ԃ
+  GLuint filter(GLuint depth, GLuint color) const;
+};
+
+//
+// CPU ɂAbvTvO (upsample.frag ƓvZ)
+//
+//   J[̉摜 tileSize fl̃^Cɕ, ^CƂɕɕԂ
+//   ̏d݂͉Əcɕė񂲂ƂƍsƂ, J[̍̏d݂͍Ƃɕ\ɂĂ
+//   AVX2 g 8 fԂ
+//
+//    0: fvXf[^ (GLushort, mm)
+//    1: fvX̉fƂ̃J[̃eNX`W (GLfloat[2], f)
+//    2: J[f[^ (GLubyte[4], BGRA)
+//
+class CpuUpsample : public CpuCalculate
+{
+  // fvX̃TCY
+  const int depthWidth, depthHeight;
+
+  // Z̈ӂ̉f
+  const int scale;
+
+  // eiq̃TCY
+  const int gridWidth, gridHeight;
+
+  // ^C̉Əc̐
+  int tileCols, tileRows;
+
+  // ͂𔼌ãZŖ߂eiq̈s̃Z
+  int stride;
+
+  // eiqɓefvXl (mm, vłȂZ 0)
+  std::vector<GLfloat> grid;
+
+  // eiq̃Zɓe_̈ʒũJ[ (BGRA)
+  std::vector<GLuint> guide;
+
+  // J[̉𑜓x̃fvXl (mm)
+  std::vector<GLushort> depth;
+
+  // J[̉f̗񂲂Ƃ̃Z̗
+  std::vector<int> cellX;
+
+  // J[̉f̗񂲂ƂƍsƂ̋ߖT̃Z̋̏d ([(i + radius) * width + x]  [(j + radius) * height + y])
+  std::vector<GLfloat> spaceX, spaceY;
+
+  // J[̍Ƃ̏d (Ō̗vf 0)
+  std::vector<GLfloat> colorWeight;
+
+  // tB^̔a (Z)
+  int radius;
+
+  // AVX2 g
+  const bool avx2;
+
+  // s v ̉f [u0, u1) Ԃ
+  void filterRow(int v, int u0, int u1);
+
+  // s v ̉f [u0, u1)  8 fԂ, fԂ (AVX2)
+  int filterRowAvx2(int v, int u0, int u1);
+
+  // ^C [begin, end) Ԃ
+  virtual void kernel(int begin, int end);
+
+public:
+
+  // RXgN^
+  //   scale: eiq̃Z̈ӂ̉f
+  CpuUpsample(int depthWidth, int depthHeight, int colorWidth, int colorHeight, int scale = 4);
+
+  // ^C̈ӂ̉f
+  static const int tileSize = 64;
+
+  // tB^̃p[^ݒ肷 (Upsample::setParameter() Ɠ)
+  void setParameter(int radius, GLfloat sigmaSpace, GLfloat sigmaColor);
+
+  // fvXf[^ƃeNX`WƃJ[f[^J[̉𑜓x̃fvX, ̃fvXlԂ
+  const GLushort *filter(const GLushort *data, const GLfloat (*coord)[2], const GLubyte *color);
+};
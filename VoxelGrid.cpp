@@ -0,0 +1,305 @@
+#include "VoxelGrid.h"
+
+//
+// {NZObhɂ_Q̊Ԉ
+//
+
+// _ʒǔvZɗp萔
+#include "CpuCalculate.h"
+
+// 񏈗
+#include "Parallel.h"
+
+// WCu
+#include <cmath>
+#include <algorithm>
+
+// _𗭂߂ƂɈxɏ_̐
+const int pointGrain(4096);
+
+// L[ɋlߍރ{NZ̈ʒü̎̃rbgƕ̈ʒu𐳂ɂ邽߂̉
+const int keyBits(21);
+const int keyBias(1 << (keyBits - 1));
+const GLuint64 keyMask((GLuint64(1) << keyBits) - 1);
+
+// ̐ 2 ̎w
+const int partitionBits(6);
+const int partitions(1 << partitionBits);
+
+// nbV\̑傫 2 ̎w̉
+const int tableMinimum(10);
+
+namespace
+{
+  // L[̃nbVl (tB{ib`nbV,  2^64 {|)
+  inline GLuint64 mix(GLuint64 key)
+  {
+    return key * 0x9e3779b97f4a7c15ULL;
+  }
+
+  // L[̋ (nbV\̒TʒuɎgʂ̃rbgƂ͕ʂ̃rbgg)
+  inline int getPartition(GLuint64 key)
+  {
+    return int(mix(key) >> 32) & (partitions - 1);
+  }
+
+  // vf 2 {ȏɂȂ 2 ׂ̂̎w߂
+  int getTableBits(int count)
+  {
+    int bits(tableMinimum);
+    while ((size_t(1) << bits) < size_t(count) * 2) ++bits;
+    return bits;
+  }
+}
+
+// RXgN^
+VoxelGrid::VoxelGrid(GLfloat leafSize, Policy policy)
+  : leafSize(leafSize)
+  , policy(policy)
+  , block(Parallel::getThreads())
+  , partition(partitions)
+  , offset(partitions + 1)
+{
+  for (size_t b = 0; b < block.size(); ++b) clearTable(block[b], tableMinimum);
+  for (int p = 0; p < partitions; ++p) clearTable(partition[p], tableMinimum);
+}
+
+// {NZ̈ʒulߍ񂾃L[
+GLuint64 VoxelGrid::makeKey(int x, int y, int z)
+{
+  return ((GLuint64(x + keyBias) & keyMask) << (keyBits * 2))
+    | ((GLuint64(y + keyBias) & keyMask) << keyBits)
+    | (GLuint64(z + keyBias) & keyMask);
+}
+
+// nbV\ɂ
+void VoxelGrid::clearTable(Table &table, int bits)
+{
+  table.bits = bits;
+  table.count = 0;
+  Cell empty = { emptyKey, { 0.0f, 0.0f, 0.0f }, 0 };
+  table.cell.assign(size_t(1) << bits, empty);
+}
+
+// L[̃{NZ̏WvnbV\T, ȂΉ
+VoxelGrid::Cell &VoxelGrid::insert(Table &table, GLuint64 key)
+{
+  // gĂvf𒴂傫{ɂē꒼
+  if ((table.count + 1) * 2 > int(table.cell.size()))
+  {
+    std::vector<Cell> old;
+    old.swap(table.cell);
+    const int count(table.count);
+    clearTable(table, table.bits + 1);
+    for (size_t i = 0; i < old.size(); ++i)
+    {
+      if (old[i].key == emptyKey) continue;
+      insert(table, old[i].key) = old[i];
+    }
+    table.count = count;
+  }
+
+  const size_t mask(table.cell.size() - 1);
+  size_t i(size_t(mix(key) >> (64 - table.bits)));
+  while (table.cell[i].key != key)
+  {
+    if (table.cell[i].key == emptyKey)
+    {
+      table.cell[i].key = key;
+      ++table.count;
+      break;
+    }
+    i = (i + 1) & mask;
+  }
+  return table.cell[i];
+}
+
+// nbV\̃{NZ̏Wv悲Ƃɕׂ
+void VoxelGrid::sortTable(Table &table)
+{
+  // 悲Ƃ̐𐔂Đ擪̈ʒu߂
+  table.start.assign(partitions + 1, 0);
+  for (size_t i = 0; i < table.cell.size(); ++i)
+  {
+    if (table.cell[i].key != emptyKey) ++table.start[getPartition(table.cell[i].key) + 1];
+  }
+  for (int p = 0; p < partitions; ++p) table.start[p + 1] += table.start[p];
+
+  // 悲Ƃɕׂ
+  std::vector<int> next(table.start.begin(), table.start.end() - 1);
+  table.sorted.resize(table.count);
+  for (size_t i = 0; i < table.cell.size(); ++i)
+  {
+    if (table.cell[i].key != emptyKey) table.sorted[next[getPartition(table.cell[i].key)]++] = table.cell[i];
+  }
+}
+
+// _Q𗭂߂
+void VoxelGrid::add(const GLfloat (*p)[3], int count, const GgMatrix &pose)
+{
+  const GLfloat *const m(pose.get());
+  const int chunks((count + pointGrain - 1) / pointGrain);
+  chunkCount.assign(chunks + 1, 0);
+
+  // ubNƂɗLȓ_̐𐔂
+  Parallel::run(0, chunks, [&](int begin, int end)
+  {
+    for (int c = begin; c < end; ++c)
+    {
+      const int e((std::min)((c + 1) * pointGrain, count));
+      int n(0);
+      for (int i = c * pointGrain; i < e; ++i) if (p[i][2] >= depthInvalid) ++n;
+      chunkCount[c + 1] = n;
+    }
+  });
+  for (int c = 0; c < chunks; ++c) chunkCount[c + 1] += chunkCount[c];
+
+  // Lȓ_LWnɕϊċl߂ė߂
+  const size_t base(point.size());
+  point.resize(base + size_t(chunkCount[chunks]) * 3);
+  Parallel::run(0, chunks, [&](int begin, int end)
+  {
+    for (int c = begin; c < end; ++c)
+    {
+      const int e((std::min)((c + 1) * pointGrain, count));
+      GLfloat *q(&point[0] + base + size_t(chunkCount[c]) * 3);
+      for (int i = c * pointGrain; i < e; ++i)
+      {
+        if (p[i][2] < depthInvalid) continue;
+        q[0] = m[0] * p[i][0] + m[4] * p[i][1] + m[8] * p[i][2] + m[12];
+        q[1] = m[1] * p[i][0] + m[5] * p[i][1] + m[9] * p[i][2] + m[13];
+        q[2] = m[2] * p[i][0] + m[6] * p[i][1] + m[10] * p[i][2] + m[14];
+        q += 3;
+      }
+    }
+  });
+}
+
+// ߂_ [begin, end) ubN b ̃nbV\ɏWv
+void VoxelGrid::accumulate(int b, int begin, int end)
+{
+  Table &table(block[b]);
+
+  // Õ{NZ̐nbV\̑傫ς
+  clearTable(table, (std::max)(getTableBits(table.count), tableMinimum));
+
+  // f̏ɕ񂾓_͑ē{NZɓ₷̂, Õ{NZȂnbV\Ȃ
+  GLuint64 lastKey(emptyKey);
+  size_t last(0);
+
+  const GLfloat scale(1.0f / leafSize);
+  for (int i = begin; i < end; ++i)
+  {
+    const GLfloat *const q(&point[size_t(i) * 3]);
+    const int x(int(std::floor(q[0] * scale))), y(int(std::floor(q[1] * scale))), z(int(std::floor(q[2] * scale)));
+    const GLuint64 key(makeKey(x, y, z));
+    if (key != lastKey || table.cell[last].key != key)
+    {
+      last = &insert(table, key) - &table.cell[0];
+      lastKey = key;
+    }
+    Cell &cell(table.cell[last]);
+
+    if (cell.count == 0 || policy == CENTROID)
+    {
+      // dS̓{NZ̋̈ʒu̘aŋ߂Č
+      const GLfloat corner[] =
+      {
+        policy == CENTROID ? GLfloat(x) * leafSize : 0.0f,
+        policy == CENTROID ? GLfloat(y) * leafSize : 0.0f,
+        policy == CENTROID ? GLfloat(z) * leafSize : 0.0f
+      };
+      for (int c = 0; c < 3; ++c) cell.sum[c] += q[c] - corner[c];
+    }
+    ++cell.count;
+  }
+
+  // 悲Ƃɕׂ
+  sortTable(table);
+}
+
+//  p ̏WvׂẴubN畹
+void VoxelGrid::merge(int p)
+{
+  // ̃{NZ̐̏nbV\̑傫߂
+  int count(0);
+  for (size_t b = 0; b < block.size(); ++b) count += block[b].start[p + 1] - block[b].start[p];
+  Table &table(partition[p]);
+  clearTable(table, getTableBits(count));
+
+  // ubN̏ɕ̂, FIRST ̂Ƃ͗߂ōŏ̓_c
+  for (size_t b = 0; b < block.size(); ++b)
+  {
+    for (int i = block[b].start[p]; i < block[b].start[p + 1]; ++i)
+    {
+      const Cell &source(block[b].sorted[i]);
+      Cell &cell(insert(table, source.key));
+      if (cell.count == 0 || policy == CENTROID)
+      {
+        for (int c = 0; c < 3; ++c) cell.sum[c] += source.sum[c];
+      }
+      cell.count += source.count;
+    }
+  }
+
+  // ̃{NZ̐o͂̈ʒu߂̂Ɏg
+  offset[p + 1] = table.count;
+}
+
+//  p ̏WvԈ_߂
+void VoxelGrid::emit(int p)
+{
+  const Table &table(partition[p]);
+  GLfloat *q(output.empty() ? NULL : &output[0] + size_t(offset[p]) * 3);
+  for (size_t i = 0; i < table.cell.size(); ++i)
+  {
+    const Cell &cell(table.cell[i]);
+    if (cell.key == emptyKey) continue;
+
+    if (policy == CENTROID)
+    {
+      // {NZ̋ɋ̈ʒu̕ς𑫂
+      const int x(int((cell.key >> (keyBits * 2)) & keyMask) - keyBias);
+      const int y(int((cell.key >> keyBits) & keyMask) - keyBias);
+      const int z(int(cell.key & keyMask) - keyBias);
+      const GLfloat s(1.0f / GLfloat(cell.count));
+      q[0] = GLfloat(x) * leafSize + cell.sum[0] * s;
+      q[1] = GLfloat(y) * leafSize + cell.sum[1] * s;
+      q[2] = GLfloat(z) * leafSize + cell.sum[2] * s;
+    }
+    else
+    {
+      std::copy(cell.sum, cell.sum + 3, q);
+    }
+    q += 3;
+  }
+}
+
+// ߂_Ԉ
+const std::vector<GLfloat> &VoxelGrid::filter()
+{
+  // ߂_Xbh̐̃ubNɕăubNƂ̃nbV\ɏWv
+  const int count(getInputCount()), blocks(int(block.size()));
+  Parallel::run(0, blocks, [&](int begin, int end)
+  {
+    for (int b = begin; b < end; ++b)
+      accumulate(b, int(GLint64(count) * b / blocks), int(GLint64(count) * (b + 1) / blocks));
+  });
+
+  // 悲ƂɂׂẴubN̏Wv𕹍
+  offset[0] = 0;
+  Parallel::run(0, partitions, [&](int begin, int end)
+  {
+    for (int p = begin; p < end; ++p) merge(p);
+  });
+  for (int p = 0; p < partitions; ++p) offset[p + 1] += offset[p];
+
+  // 悲ƂɊԈ_o͂
+  output.resize(size_t(offset[partitions]) * 3);
+  Parallel::run(0, partitions, [&](int begin, int end)
+  {
+    for (int p = begin; p < end; ++p) emit(p);
+  });
+
+  return output;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+//
+// {NZObhɂ_Q̊Ԉ
+//
+//   _ leafSize ̊iq̃{NZɕ, {NZƂɈ̓_ (dSŏɓ_) ɂ
+//   ̃ZT̓_QOp[^ŋLWnɕϊȂ痭߂, ܂Ƃ߂ĊԈ
+//   ߂_Xbh̐̃ubNɕăubNƂ̃nbV\ɕɏWv,
+//   L[̃nbVlŕ悲ƂɃubÑnbV\ɕ
+//
+
+// EBhE֘Ȁ
+#include "Window.h"
+
+// WCu
+#include <vector>
+
+class VoxelGrid
+{
+public:
+
+  // {NZ̑\_̑Iѕ
+  enum Policy
+  {
+    CENTROID,                                           // {NZɓ_̏dS
+    FIRST                                               // {NZɍŏɓ_ (߂)
+  };
+
+private:
+
+  // {NZ̏Wv
+  struct Cell
+  {
+    // {NZ̈ʒulߍ񂾃L[ (gĂȂ emptyKey)
+    GLuint64 key;
+
+    // {NZ̋̈ʒu̘a (CENTROID) ŏɓ_̈ʒu (FIRST)
+    GLfloat sum[3];
+
+    // {NZɓ_̐
+    int count;
+  };
+
+  // nbV\ (JԒn@, 傫 2 ׂ̂) Ƌ悲ƂɕבւWv
+  struct Table
+  {
+    // nbV\Ƒ傫 2 ̎w, gĂvf̐
+    std::vector<Cell> cell;
+    int bits, count;
+
+    // 悲Ƃɕׂ{NZ̏WvƋ̐擪̈ʒu
+    std::vector<Cell> sorted;
+    std::vector<int> start;
+  };
+
+  // {NZ̈ӂ̒ (m)
+  GLfloat leafSize;
+
+  // {NZ̑\_̑Iѕ
+  Policy policy;
+
+  // ߂_̈ʒu
+  std::vector<GLfloat> point;
+
+  // _𗭂߂Ƃ̃ubNƂ̗Lȓ_̐
+  std::vector<int> chunkCount;
+
+  // ubNƂ̃nbV\
+  std::vector<Table> block;
+
+  // 悲ƂɕnbV\
+  std::vector<Table> partition;
+
+  // 悲Ƃ̏o͂̐擪̈ʒu
+  std::vector<int> offset;
+
+  // Ԉ_̈ʒu
+  std::vector<GLfloat> output;
+
+  // {NZ̈ʒulߍ񂾃L[
+  static GLuint64 makeKey(int x, int y, int z);
+
+  // nbV\ɂ (bits ͑傫 2 ̎w̉)
+  static void clearTable(Table &table, int bits);
+
+  // L[̃{NZ̏WvnbV\T, ȂΉ (̂ count  0)
+  static Cell &insert(Table &table, GLuint64 key);
+
+  // nbV\̃{NZ̏Wv悲Ƃɕׂ
+  static void sortTable(Table &table);
+
+  // ߂_ [begin, end) ubN b ̃nbV\ɏWv
+  void accumulate(int b, int begin, int end);
+
+  //  p ̏WvׂẴubN畹
+  void merge(int p);
+
+  //  p ̏WvԈ_߂
+  void emit(int p);
+
+public:
+
+  // gĂȂ{NZ̃L[
+  static const GLuint64 emptyKey = ~GLuint64(0);
+
+  // RXgN^
+  //   leafSize: {NZ̈ӂ̒ (m)
+  //   policy: {NZ̑\_̑Iѕ
+  VoxelGrid(GLfloat leafSize, Policy policy = CENTROID);
+
+  // {NZ̈ӂ̒ݒ肷
+  void setLeafSize(GLfloat size)
+  {
+    leafSize = size;
+  }
+
+  // {NZ̈ӂ̒𓾂
+  GLfloat getLeafSize() const
+  {
+    return leafSize;
+  }
+
+  // {NZ̑\_̑Iѕݒ肷
+  void setPolicy(Policy p)
+  {
+    policy = p;
+  }
+
+  // {NZ̑\_̑Iѕ𓾂
+  Policy getPolicy() const
+  {
+    return policy;
+  }
+
+  // ߂_ɂ
+  void clear()
+  {
+    point.clear();
+  }
+
+  // _Q𗭂߂
+  //   point: _ʒu (CpuPosition Ɠ z  depthInvalid 艓_͌vs\_Ƃď)
+  //   count: _̐
+  //   pose: _ʒu狤LWnւ̕ϊs ([xZT getExtrinsic())
+  void add(const GLfloat (*point)[3], int count, const GgMatrix &pose);
+
+  // ߂_̐𓾂
+  int getInputCount() const
+  {
+    return int(point.size() / 3);
+  }
+
+  // ߂_Ԉ (߂_͂̂܂܎c)
+  //   ߂l: Ԉ_̈ʒu (x, y, z ̏ɕׂ)
+  const std::vector<GLfloat> &filter();
+
+  // Ō filter() ŊԈ_̈ʒu𓾂
+  const std::vector<GLfloat> &getOutput() const
+  {
+    return output;
+  }
+
+  // Ō filter() ŊԈ_̐𓾂
+  int getOutputCount() const
+  {
+    return int(output.size() / 3);
+  }
+};
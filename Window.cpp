@@ -12,6 +12,7 @@
 //
 Window::Window(int width, int height, const char *title, GLFWmonitor *monitor, GLFWwindow *share)
   : window(glfwCreateWindow(width, height, title, monitor, share))
+  , pointMode(false)
 {
   // EBhEJĂȂ߂
   if (!window) return;
@@ -241,6 +242,8 @@ void Window::keyboard(GLFWwindow *window, int key, int scancode, int action, int
         instance->eye[2] = objectCenter[2];
         break;
       case GLFW_KEY_SPACE:
+        // bVƓ_Q̕`؂ւ
+        instance->pointMode = !instance->pointMode;
         break;
       case GLFW_KEY_BACKSPACE:
       case GLFW_KEY_DELETE:
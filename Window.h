@@ -30,6 +30,9 @@ class Window
   // vWFNVϊs
   GgMatrix mp;
 
+  // _Qŕ`悷Ȃ true
+  bool pointMode;
+
   //
   // Rs[RXgN^ (Rs[֎~)
   //
@@ -141,4 +144,20 @@ public:
   {
     return mp;
   }
+
+  //
+  //  1 ɂ钷 1 ̐̉ʏ̉f𓾂
+  //
+  GLfloat getScale() const
+  {
+    return mp.get()[5] * GLfloat(size[1]) * 0.5f;
+  }
+
+  //
+  // _Qŕ`悷邩ǂ𒲂ׂ
+  //
+  bool getPointMode() const
+  {
+    return pointMode;
+  }
 };
@@ -0,0 +1,76 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D depth;
+
+// tB^̔a (f)
+uniform int radius;
+
+// ̏d݂̕W΍ (f)
+uniform float sigmaSpace;
+
+// fvXl̍̏d݂̕W΍ (fvX̃eNX`̒l̒P)
+uniform float sigmaRange;
+
+// ߖTǂ (0 Ȃ񎟌)
+uniform ivec2 direction;
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float filtered;
+
+// ߖT̉f
+//   p, d: S̉fƃfvXl
+//   o: S̈ʒu
+//   ks, kr: ƃfvXl̍̏d݂̎w̌W
+//   sw, sd: d݂̍vƏdݕt̃fvXl̍v
+void add(in ivec2 p, in float d, in ivec2 o, in float ks, in float kr, inout float sw, inout float sd)
+{
+  ivec2 q = p + o;
+  if (any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, textureSize(depth, 0)))) return;
+
+  // vłȂfƃfvXl̍W΍ 3 {ȏ̉f͉Ȃ
+  float n = texelFetch(depth, q, 0).r;
+  float e = n - d;
+  if (n == 0.0 || abs(e) >= 3.0 * sigmaRange) return;
+
+  float w = exp(float(o.x * o.x + o.y * o.y) * ks + e * e * kr);
+  sw += w;
+  sd += w * n;
+}
+
+void main(void)
+{
+  // vłȂf͂̂܂܂ɂ
+  ivec2 p = ivec2(gl_FragCoord.xy);
+  float d = texelFetch(depth, p, 0).r;
+  if (d == 0.0)
+  {
+    filtered = 0.0;
+    return;
+  }
+
+  // d݂̎w̌W
+  float ks = -0.5 / (sigmaSpace * sigmaSpace);
+  float kr = -0.5 / (sigmaRange * sigmaRange);
+
+  // d݂̍vƏdݕt̃fvXl̍v
+  float sw = 0.0, sd = 0.0;
+
+  if (direction == ivec2(0))
+  {
+    // 񎟌̋ߖT
+    for (int j = -radius; j <= radius; ++j)
+      for (int i = -radius; i <= radius; ++i)
+        add(p, d, ivec2(i, j), ks, kr, sw, sd);
+  }
+  else
+  {
+    // ̋ߖT
+    for (int i = -radius; i <= radius; ++i)
+      add(p, d, direction * i, ks, kr, sw, sd);
+  }
+
+  filtered = sd / sw;
+}
@@ -37,5 +37,99 @@ const GgSimpleShader::Material material =
   50.0f                                                 // PW
 };
 
+// fvXf[^ωƂ݂Ȃ臒l (mm, Œ肵Jł͐ mm ɂƓ]ʂ)
+const GLushort depthChangeThreshold(0);
+
+// fvXf[^̎ԕ̕
+const GLfloat temporalAlpha(0.3f);                      // VfvXl̏d
+const GLfloat temporalThreshold(30.0f);                 // Ƃ݂ȂfvXl̍ (mm)
+const int temporalHold(2);                              // vłȂfɑO̒lێt[
+
+// tCOsNZƂ݂ȂׂƂ̃fvXl̍̃fvXlɑ΂䗦
+const GLfloat flyingRatio(0.03f);
+
+// fvXf[^̌
+const int holeMaxGap(8);                                // ߂т̍ő̉f
+const int holeJump(50);                                 // `Ԃ闼[̃fvXl̍̍ől (mm)
+
+// fvXf[^̃oCetB^
+const int bilateralRadius(3);                           // a (f)
+const GLfloat bilateralSigmaSpace(2.0f);                // ̏d݂̕W΍ (f)
+const GLfloat bilateralSigmaRange(20.0f);               // fvXl̍̏d݂̕W΍ (mm)
+const bool bilateralSeparable(true);                    // Əcɕċߎ
+
+// ZT狗 1m ̓__Qŕ`Ƃ̔a (m)
+const GLfloat splatRadius(0.002f);
+
+// _ʒũeNX`̓tH[}bg (GL_RGB32F Ȃ 12 byte/f, GL_RGBA16F Ȃ 8 byte/f)
+const GLenum pointFormat(GL_RGBA16F);
+
+// @xNg𔪖ʑ̎ʑ 2 ɋlߍނȂ 1 (VF[_ɂǂݍނƂɓlŒ`)
+#define PACK_NORMAL 1
+
+// @xNg̃eNX`̓tH[}bg
+#if PACK_NORMAL
+const GLenum normalFormat(GL_RG16);
+#else
+const GLenum normalFormat(GL_RGB32F);
+#endif
+
 // wiF
 const GLfloat background[] = { 0.2f, 0.3f, 0.4f, 0.0f };
+
+// fvXf[^̉fƂ̐Mx
+const GLfloat confidenceSigma(1.5f);                    // 1 m ̂Ƃ̌v̕W΍ (mm)
+const GLfloat confidenceJump(0.03f);                    // ֊sƂ݂Ȃׂ̉fƂ̃fvXl̍̃fvXlɑ΂䗦
+const int confidenceDistance(4);                        // ł؂錊֊s̋ (f)
+const int confidenceFrames(8);                          // ł؂肵t[
+
+// fvXf[^𓝍 TSDF ̃{[ (ZT̈ʒu_)
+const int tsdfResolution(256);                          // ӂ̃{NZ
+const GLfloat tsdfVoxelSize(0.01f);                     // {NZ̈ӂ̒ (m)
+const GLfloat tsdfOrigin[] = { -1.28f, -1.28f, -3.2f }; // ŏ̋̈ʒu (m)
+const GLfloat tsdfTruncation(0.04f);                    // ł؂钷 (m)
+const int tsdfMaxWeight(64);                            // d݂̏
+const size_t tsdfMemoryBudget(size_t(256) << 20);       // {NZnbṼ{[Ɏg̏ (byte)
+
+// ICP ɂZT̈ʒuƌ̐
+const int icpLevels(3);                                 // i
+const GLfloat icpDistance(0.1f);                        // Ή_Ƃ݂Ȃ (m)
+const GLfloat icpAngle(0.35f);                          // Ή_Ƃ݂Ȃ@xNĝȂp̏ (rad)
+const GLfloat icpNear(0.1f);                            // fCLXgOʂ܂ł̋ (m)
+const GLfloat icpFar(10.0f);                            // fCLXgʂ܂ł̋ (m)
+
+// CPU ̕񏈗ɎgXbh̐ (ĂяoXbh܂, 0 ȂRA̐)
+const int parallelThreads(0);
+
+// ꏏɕ`[xZT (main  sensor ̃JWLWnɂ)
+const int rigSynthetic(2);                              // fvXf[^̃ZT̐
+const GLfloat rigCenter[] = { 0.0f, 0.0f, -2.5f };      // fvXf[^̃ZT͂ޒS (m)
+const GLfloat rigAngle(0.6f);                           // fvXf[^̃ZT𒆐S̎ɉ񂷊Ԋu (rad)
+const GLfloat rigNoise(1.5f);                           // fvXf[^ 1 m ̂Ƃ̎G̕W΍ (mm)
+const char *const rigReplayFile(NULL);                  // ĐfvXf[^̃t@C (NULL ȂĐȂ)
+const char *const rigRecordFile(NULL);                  // sensor ̃fvXf[^L^t@C (NULL ȂL^Ȃ)
+const char *const rigRecordTexcoordFile(NULL);          // ꏏ SDK ̃eNX`WL^t@C (NULL ȂL^Ȃ)
+const int rigCalibrationInterval(30);                   // Op[^̐n߂t[̊Ԋu
+
+// {NZObhɂ_Q̊Ԉ
+const GLfloat downsampleLeafSize(0.02f);                // {NZ̈ӂ̒ (m)
+const bool downsampleFirst(false);                      // {NZ̑\_dSłȂŏɓ_ɂȂ true
+
+// _Q̔
+const GLfloat octreeOrigin[] = { -10.24f, -10.24f, -20.48f }; // ̂̍ŏ̋̈ʒu (m)
+const GLfloat octreeSize(20.48f);                       // ̂̈ӂ̒ (m)
+const int octreeDepth(10);                              // ȉ (łׂt 2 cm)
+const int octreeLeafCapacity(32);                       // tɓ_̐̏
+const int octreeInterval(30);                           // _Qǉt[̊Ԋu
+const int octreeMaximum(4000000);                       // ߂_̐̏ (蒼)
+
+// t[̓_Q k-d 
+const int kdTreeLeafSize(16);                           // tɂ͈͂̓_̐̏
+const int kdTreeNeighbours(8);                          // fƂɒTߖT̓_̐
+
+// fvX̉fJ[̉fɓeLu[Ṽt@C
+const char calibrationFile[] = "calibration.txt";
+
+// Lu[V؂L^fvXf[^ SDK ̃eNX`W̃t@C (rigRecordFile, rigRecordTexcoordFile ŋL^)
+const char colorVerifyFile[] = "depth.rec";
+const char colorVerifyTexcoordFile[] = "texcoord.rec";
@@ -0,0 +1,38 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D depth;
+
+// 臒l̃fvXlɑ΂䗦
+uniform float ratio;
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float filtered;
+
+// p  o Ƃ̔Α̉f̃fvXlƂ t ȏ㗣, d ̊Ԃɂ邩ׂ
+bool between(in ivec2 p, in float d, in ivec2 o, in float t)
+{
+  float n1 = texelFetch(depth, p + o, 0).r;
+  float n2 = texelFetch(depth, p - o, 0).r;
+  float a = n1 - d;
+  float b = n2 - d;
+  return n1 > 0.0 && n2 > 0.0 && a * b < 0.0 && min(abs(a), abs(b)) > t;
+}
+
+void main(void)
+{
+  // ̉f̃fvXl
+  ivec2 p = ivec2(gl_FragCoord.xy);
+  float d = texelFetch(depth, p, 0).r;
+  filtered = d;
+
+  // vłȂfƉ摜̒[̉f͂̂܂܂ɂ
+  if (d == 0.0 || any(equal(p, ivec2(0))) || any(equal(p, textureSize(depth, 0) - 1))) return;
+
+  // , c, ̎΂߂̂ꂩŗׂ̊Ԃɂ΃tCOsNZƂ݂Ȃ
+  float t = ratio * d;
+  if (between(p, d, ivec2(1, 0), t) || between(p, d, ivec2(0, 1), t)
+    || between(p, d, ivec2(1, 1), t) || between(p, d, ivec2(1, -1), t)) filtered = 0.0;
+}
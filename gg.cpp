@@ -6494,6 +6494,24 @@ GLuint gg::ggCreateShader(const char *vsrc, const char *fsrc, const char *gsrc,
   return program;
 }
 
+/*
+** VF[_̃\[Xt@Cɑ}}N`
+*/
+static std::string shaderDefines;
+
+/*!
+** \brief VF[_̃\[Xt@CǂݍނƂɑ}}N`.
+**
+**   \param name }N.
+**   \param value }N̒l.
+*/
+void gg::ggShaderDefine(const char *name, int value)
+{
+  std::ostringstream line;
+  line << "#define " << name << " " << value << "\n";
+  shaderDefines += line.str();
+}
+
 /*
 ** VF[_̃\[Xt@Cǂݍ񂾃Ԃ
 */
@@ -6543,6 +6561,19 @@ static GLchar *readShaderSource(const char *name)
   // t@C
   file.close();
 
+  // }N` #version ̍šɑ}, s̍sԍɖ߂
+  if (buffer != NULL && !shaderDefines.empty())
+  {
+    std::string source(buffer);
+    delete[] buffer;
+    const std::string::size_type eol(source.find('\n'));
+    const std::string::size_type pos(source.compare(0, 8, "#version") == 0 && eol != std::string::npos ? eol + 1 : 0);
+    source.insert(pos, shaderDefines + (pos > 0 ? "#line 2\n" : "#line 1\n"));
+    buffer = new GLchar[source.length() + 1];
+    source.copy(buffer, source.length());
+    buffer[source.length()] = '\0';
+  }
+
   // \[XvOǂݍ񂾃Ԃ
   return buffer;
 }
@@ -6577,6 +6608,69 @@ GLuint gg::ggLoadShader(const char *vert, const char *frag, const char *geom,
   return program;
 }
 
+/*!
+** \brief Rs[gVF[_̃\[XvO̕ǂݍŃvOIuWFNg쐬.
+**
+**   \param csrc Rs[gVF[_̃\[XvO̕.
+**   \param ctext Rs[gVF[_̃RpC̃bZ[Wɒǉ镶.
+**   \return VF[_vÕvO (쐬łȂ 0).
+*/
+GLuint gg::ggCreateComputeShader(const char *csrc, const char *ctext)
+{
+  // VF[_vO̍쐬
+  const GLuint program(glCreateProgram());
+
+  if (program > 0)
+  {
+    if (csrc)
+    {
+      // Rs[gVF[_̃VF[_IuWFNg쐬
+      const GLuint compShader(glCreateShader(GL_COMPUTE_SHADER));
+      glShaderSource(compShader, 1, &csrc, NULL);
+      glCompileShader(compShader);
+
+      // Rs[gVF[_̃VF[_IuWFNgvOIuWFNgɑgݍ
+      if (printShaderInfoLog(compShader, ctext))
+        glAttachShader(program, compShader);
+      glDeleteShader(compShader);
+    }
+
+    // VF[_vON
+    glLinkProgram(program);
+
+    // vOIuWFNg쐬łȂ 0 Ԃ
+    if (printProgramInfoLog(program) == GL_FALSE)
+    {
+      glDeleteProgram(program);
+      return 0;
+    }
+  }
+
+  // vOIuWFNgԂ
+  return program;
+}
+
+/*!
+** \brief Rs[gVF[_̃\[Xt@CǂݍŃvOIuWFNg쐬.
+**
+**   \param comp Rs[gVF[_̃\[Xt@C.
+**   \return VF[_vÕvO (쐬łȂ 0).
+*/
+GLuint gg::ggLoadComputeShader(const char *comp)
+{
+  // VF[_̃\[Xt@Cǂݍ
+  const GLchar *const csrc(readShaderSource(comp));
+
+  // vOIuWFNg쐬
+  const GLuint program(ggCreateComputeShader(csrc, comp));
+
+  // \[Xt@C̓ǂݍ݂Ɏg
+  delete[] csrc;
+
+  // 쐬vOIuWFNgԂ
+  return program;
+}
+
 /*
 ** ϊsFsƃxNg̐ c  a ~ b
 */
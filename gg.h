@@ -2674,6 +2674,17 @@ namespace gg
     const char *ftext = "fragment shader",
     const char *gtext = "geometry shader");
 
+  /*!
+  ** \brief VF[_̃\[Xt@CǂݍނƂɑ}}N`.
+  **
+  **   ggLoadShader()  ggLoadComputeShader() œǂݍނׂẴVF[_ #version ̍š
+  **   "#define name value" }. VF[_ǂݍޑOɌĂяo.
+  **
+  **   \param name }N.
+  **   \param value }N̒l.
+  */
+  extern void ggShaderDefine(const char *name, int value);
+
   /*!
   ** \brief VF[_̃\[Xt@CǂݍŃvOIuWFNg쐬.
   **
@@ -2687,6 +2698,23 @@ namespace gg
   extern GLuint ggLoadShader(const char *vert, const char *frag = NULL, const char *geom = NULL,
     int nvarying = 0, const char *varyings[] = NULL);
 
+  /*!
+  ** \brief Rs[gVF[_̃\[XvO̕ǂݍŃvOIuWFNg쐬.
+  **
+  **   \param csrc Rs[gVF[_̃\[XvO̕.
+  **   \param ctext Rs[gVF[_̃RpC̃bZ[Wɒǉ镶.
+  **   \return VF[_vÕvO (쐬łȂ 0).
+  */
+  extern GLuint ggCreateComputeShader(const char *csrc, const char *ctext = "compute shader");
+
+  /*!
+  ** \brief Rs[gVF[_̃\[Xt@CǂݍŃvOIuWFNg쐬.
+  **
+  **   \param comp Rs[gVF[_̃\[Xt@C.
+  **   \return VF[_vÕvO (쐬łȂ 0).
+  */
+  extern GLuint ggLoadComputeShader(const char *comp);
+
   /*!
   ** \brief 3 vf̓
   **
@@ -11,20 +11,202 @@
 // ZT֘Ȁ
 #include "KinectV2.h"
 
+// fvXf[^o͂[xZT
+#include "SyntheticCamera.h"
+
+// L^fvXf[^Đ[xZT
+#include "ReplayCamera.h"
+
 // `ɗp郁bV
 #include "Mesh.h"
 
-// vZɗpVF[_
-#include "Calculate.h"
+// `ɗp_Q
+#include "Splat.h"
+
+// vZɗpVF[_̘A
+#include "PassGraph.h"
+
+// vZɗpRs[gVF[_
+#include "Compute.h"
+
+// CPU ɂ摜
+#include "CpuCalculate.h"
+
+// fvXf[^̎ԕ̕
+#include "Temporal.h"
+
+// fvXf[^̃tCOsNZ̏
+#include "FlyingPixel.h"
+
+// fvXf[^̃oCetB^
+#include "Bilateral.h"
+
+// TSDF ɂfvXf[^̓
+#include "Tsdf.h"
+#include "HashedTsdf.h"
+
+// }[`OL[u@ɂ TSDF ̕\ʂ̒o
+#include "MarchingCubes.h"
+
+// TSDF ̃{[̃CLXg
+#include "Raycast.h"
+
+// ICP ɂfvXZT̈ʒuƌ̐
+#include "Icp.h"
+
+// dȂ_QɂZTԂ̊Op[^̐
+#include "ExtrinsicCalibration.h"
+
+// {NZObhɂ_Q̊Ԉ
+#include "VoxelGrid.h"
+
+// _Q̔
+#include "Octree.h"
+
+// t[̓_Q k-d 
+#include "KdTree.h"
+
+// [xZT̓_Q𕡐ă[JXbhŏ
+#include "PointCloudWorker.h"
+
+// 񏈗
+#include "Parallel.h"
 
 // _ʒu̐VF[_ (position.frag) ōsȂ 1
 #define GENERATE_POSITION 0
 
+// fvXf[^ԕɕȂ 1 (CPU)  2 (temporal.frag, GENERATE_POSITION  1 ̂Ƃ)
+#define TEMPORAL_FILTER 0
+
+// fvXf[^tCOsNZȂ 1 (CPU)  2 (flying.frag, GENERATE_POSITION  1 ̂Ƃ)
+#define FLYING_PIXEL_FILTER 0
+
+// fvXf[^̌vłȂf͂̒lŖ߂Ȃ 1 (CPU)
+#define HOLE_FILL 0
+
+// fvXf[^ɃoCetB^Ȃ 1 (CPU)  2 (bilateral.frag, GENERATE_POSITION  1 ̂Ƃ)
+#define BILATERAL_FILTER 0
+
+// @xNǧvZRs[gVF[_ (normal.comp) ōsȂ 1 (OpenGL 4.3 ȍ~)
+#define USE_COMPUTE 0
+
+// @xNǧvZԂƐ}`̕`掞ԂvȂ 1
+#define MEASURE_TIME 0
+
+// VF[_ɂ钸_ʒuƖ@xNg CPU ̌vZʂƔrȂ 1 (GENERATE_POSITION  1 ̂Ƃ)
+#define VERIFY_CPU 0
+
+// fvXf[^̉fƂ̐Mx (getConfidence() / getConfidenceBuffer()) ߂Ȃ 1 (CPU)
+#define CONFIDENCE 0
+
+// fvXf[^ TSDF ̃{[ɓȂ 1 (CPU, GENERATE_POSITION  0 ̂Ƃ) 
+// 2 (tsdf.comp, USE_COMPUTE  1 ̂Ƃ), {NZnbV̑aȃ{[ɓȂ 3 (CPU, GENERATE_POSITION  0 ̂Ƃ)
+#define TSDF 0
+
+// TSDF  1  3 ̂Ƃ, {[璊o\ʂbV̑ɕ`悷Ȃ 1
+#define EXTRACT_SURFACE 0
+
+// TSDF  2 ̂Ƃ, {[CLXgAebV̑ɕ\Ȃ 1
+#define RAYCAST 0
+
+// TSDF  1  3 ̂Ƃ, {[CLXgf ICP Ńt[킹ăZT̓ǂȂ 1
+#define TRACK_CAMERA 0
+
+// fvXf[^L^fvXf[^ (rigReplayFile) ̃ZTOp[^ sensor ̍Wnɒu
+// ꏏɕ`Ȃ 1 (TSDF  0 ̂Ƃ)
+#define RIG 0
+
+// RIG  1  GENERATE_POSITION  0 ̂Ƃ, dȂ_Qꏏɕ`[xZT sensor ɑ΂Op[^
+// ɐ肵Ȃ 1 (MEASURE_TIME  1 Ȃ琄肷邲ƂɐɂԂƍ킹񂾌덷\)
+#define CALIBRATE_RIG 0
+
+// sensor ̓_Q (RIG  1 Ȃꏏɕ`[xZT̓_Qƍ킹) {NZObhŊԈȂ 1
+// (CPU ̃[JXbhőO̊ԈI邲Ƃɍs, GENERATE_POSITION  0 ̂Ƃ,
+// MEASURE_TIME  1 ȂԈԂƓ_̐\)
+#define DOWNSAMPLE 0
+
+// sensor ̓_Q (RIG  1 Ȃꏏɕ`[xZT̓_Q) octreeInterval t[Ƃɔ؂ɒǉ,
+// _̐ octreeMaximum 𒴂炻̃t[̓_Qō蒼Ȃ 1
+// (CPU ̃[JXbhōs, GENERATE_POSITION  0 ̂Ƃ, MEASURE_TIME  1 Ȃǉ鎞ԂƓ_Ɛߓ_̐\)
+#define OCTREE 0
+
+// sensor ̃t[̓_Q k-d ؂蒼, ׂẲf kdTreeNeighbours ̋ߖT̓_TȂ 1
+// (CPU ̃[JXbhőO̒TI邲Ƃɍs, GENERATE_POSITION  0 ̂Ƃ,
+// MEASURE_TIME  1 Ȃ鎞ԂƒTԂ\)
+#define KD_TREE 0
+
+// J[̃eNX`WۑLu[V (calibrationFile) ŋ߂Ȃ 1,
+// SDK ̃eNX`Wɍ킹ăLu[V߂ĕۑĂgȂ 2,
+// EBhEJɋL^t[ (colorVerifyFile) ŃLu[V SDK ̃eNX`WƔׂȂ 3
+#define COLOR_MAPPING 0
+
+// WCu
+#if MEASURE_TIME || VERIFY_CPU || COLOR_MAPPING >= 2
+#  include <iostream>
+#endif
+#if MEASURE_TIME && (DOWNSAMPLE || OCTREE || KD_TREE || TRACK_CAMERA)
+#  include <chrono>
+#endif
+
+#if COLOR_MAPPING == 3
+// fvX̉f̃J[̃eNX`Wւ̕ϊ
+#  include "ColorMapper.h"
+
+//
+// L^t[ۑLu[Vŕϊ, ꏏɋL^ SDK ̃eNX`WƔׂ
+//
+static int verifyColorMapping()
+{
+  // L^fvXf[^ SDK ̃eNX`WJ
+  DepthReader reader(colorVerifyFile, colorVerifyTexcoordFile);
+  if (!reader.hasTexcoord())
+  {
+    std::cerr << "Can't open " << colorVerifyFile << " or " << colorVerifyTexcoordFile << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // ۑLu[Vǂݍ
+  ColorMapper mapper(reader.getDepthWidth(), reader.getDepthHeight(), reader.getColorWidth(), reader.getColorHeight());
+  if (!mapper.load(calibrationFile))
+  {
+    std::cerr << "Can't load " << calibrationFile << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // t[Ƃ̍ƑŜ̍\
+  const std::vector<ColorMapper::Error> error(mapper.verify(reader));
+  double sum(0.0);
+  GLfloat worst(0.0f);
+  long long count(0), mismatch(0);
+  for (size_t i = 0; i < error.size(); ++i)
+  {
+    std::cerr << "frame " << i << ": mean " << error[i].mean << " px, max " << error[i].max << " px, "
+      << error[i].count << " pixels, " << error[i].mismatch << " mismatched\n";
+    sum += double(error[i].mean) * error[i].count;
+    if (error[i].max > worst) worst = error[i].max;
+    count += error[i].count;
+    mismatch += error[i].mismatch;
+  }
+  std::cerr << error.size() << " frames: mean " << (count > 0 ? sum / count : 0.0) << " px, max " << worst << " px, "
+    << mismatch << " mismatched pixels\n";
+
+  return error.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif
+
 //
 // CvO
 //
 int main()
 {
+  // 񏈗ɎgXbh̐ݒ肷
+  Parallel::setThreads(parallelThreads);
+
+#if COLOR_MAPPING == 3
+  // L^t[ŃLu[V؂ďI
+  return verifyColorMapping();
+#endif
+
   // GLFW 
   if (glfwInit() == GL_FALSE)
   {
@@ -36,12 +218,21 @@ int main()
   // vOIɂ GLFW I
   atexit(glfwTerminate);
 
+#if USE_COMPUTE
+  // OpenGL Version 4.3 Core Profile I
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+#else
   // OpenGL Version 3.2 Core Profile I
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+#endif
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+  // VF[_ƋLݒVF[_̃}NƂĒ`
+  ggShaderDefine("PACK_NORMAL", PACK_NORMAL);
+
   // EBhEJ
   Window window(640, 480, "Depth Map Viewer");
   if (!window.get())
@@ -52,7 +243,7 @@ int main()
   }
 
   // [xZTLɂ
-  KinectV2 sensor;
+  KinectV2 sensor(pointFormat);
   if (sensor.getActivated() == 0)
   {
     // ZTgȂ
@@ -60,6 +251,43 @@ int main()
     return EXIT_FAILURE;
   }
 
+  // fvXf[^ωƂ݂Ȃ臒lݒ肷
+  sensor.setChangeThreshold(depthChangeThreshold);
+
+#if TEMPORAL_FILTER == 1
+  // ωoOɃfvXf[^ CPU ŕ
+  sensor.setTemporalFilter(temporalAlpha, temporalThreshold, temporalHold);
+#endif
+
+#if FLYING_PIXEL_FILTER == 1
+  // ωoOɃfvXf[^tCOsNZ
+  sensor.setFlyingPixelFilter(flyingRatio);
+#endif
+
+#if HOLE_FILL
+  // ωoOɃfvXf[^̌𖄂߂
+  sensor.setHoleFill(holeMaxGap, holeJump);
+#endif
+
+#if BILATERAL_FILTER == 1
+  // ωoOɃfvXf[^ CPU ŃoCetB^
+  sensor.setBilateralFilter(bilateralRadius, bilateralSigmaSpace, bilateralSigmaRange, bilateralSeparable);
+#endif
+
+#if CONFIDENCE
+  // eNX`ɓ]fvXf[^̉fƂ̐Mx߂
+  sensor.setConfidence(confidenceSigma, confidenceJump, confidenceDistance, confidenceFrames);
+#endif
+
+#if COLOR_MAPPING == 1
+  // J[̃eNX`WۑLu[Vŋ߂ (ǂݍ߂Ȃ SDK g)
+  if (!sensor.setColorMapping(calibrationFile))
+    MessageBox(NULL, TEXT("Lu[Vǂݍ߂܂łB"), TEXT("܂̂"), MB_OK);
+#elif COLOR_MAPPING == 2
+  // Lu[V߂܂ł̃t[
+  int calibrationFrames(60);
+#endif
+
   // [xZT̉𑜓x
   int width, height;
   sensor.getDepthResolution(&width, &height);
@@ -70,71 +298,647 @@ int main()
   // `p̃VF[_
   GgSimpleShader simple("simple.vert", "simple.frag");
 
-  // fvXf[^璸_ʒuvZVF[_
-  const Calculate position(width, height, "position.frag");
+  // `Ɏg_Q
+  const Splat splat(width, height, sensor.getCoordBuffer());
+
+  // _Q̕`p̃VF[_
+  SplatShader splatShader("splat.vert", "splat.frag");
+
+  // 摜̃pX̘A
+  PassGraph graph(width, height);
+
+#if GENERATE_POSITION
+  // fvXf[^̓
+  const int depthInput(graph.addInput());
+
+  // fvXf[^璸_ʒuvZpX
+  const int positionPass(graph.addPass("position.frag", std::vector<int>(1, depthInput), 1, pointFormat));
+  const int positionOutput(graph.getOutput(positionPass));
+
+#  if TEMPORAL_FILTER == 2
+  // fvXf[^𕽊VF[_
+  Temporal temporal(width, height);
+  temporal.setParameter(temporalAlpha, temporalThreshold, temporalHold);
+#  endif
+
+#  if FLYING_PIXEL_FILTER == 2
+  // fvXf[^tCOsNZVF[_
+  FlyingPixel flyingPixel(width, height);
+  flyingPixel.setParameter(flyingRatio);
+#  endif
+
+#  if BILATERAL_FILTER == 2
+  // fvXf[^ɃoCetB^VF[_
+  Bilateral bilateral(width, height);
+  bilateral.setParameter(bilateralRadius, bilateralSigmaSpace, bilateralSigmaRange, bilateralSeparable);
+#  endif
+#else
+  // _ʒu̓
+  const int positionOutput(graph.addInput());
+#endif
+
+#if USE_COMPUTE
+  // _ʒu@xNgvZRs[gVF[_
+  const Compute normal(width, height, "normal.comp", 1, PACK_NORMAL ? normalFormat : GL_RGBA32F);
+#else
+  // _ʒu@xNgvZpX
+  const int normalPass(graph.addPass("normal.frag", std::vector<int>(1, positionOutput), 1, normalFormat));
+  const int normalOutput(graph.getOutput(normalPass));
+#endif
+
+#if TSDF == 1
+  // fvXf[^𓝍{[ (CPU)
+  CpuTsdf tsdf(width, height, tsdfResolution, tsdfVoxelSize, tsdfOrigin);
+  tsdf.setParameter(tsdfTruncation, tsdfMaxWeight);
+#elif TSDF == 2
+  // fvXf[^𓝍{[ (Rs[gVF[_)
+  Tsdf tsdf(tsdfResolution, tsdfVoxelSize, tsdfOrigin);
+  tsdf.setParameter(tsdfTruncation, tsdfMaxWeight);
+#elif TSDF == 3
+  // fvXf[^𓝍{NZnbṼ{[ (CPU)
+  CpuHashedTsdf tsdf(width, height, tsdfVoxelSize, tsdfMemoryBudget);
+  tsdf.setParameter(tsdfTruncation, tsdfMaxWeight);
+#endif
+
+#if TSDF
+  // ŌɃ{[ɓZT̃t[̔ԍ
+  unsigned int tsdfFrame(sensor.getFrame());
+#endif
+
+#if (TSDF == 1 || TSDF == 3) && EXTRACT_SURFACE
+  // {[璊o\
+  MarchingCubes surface;
+
+  // o\ʂ̕`p̃VF[_
+  GgSimpleShader surfaceShader("surface.vert", "surface.frag");
+#endif
+
+#if TSDF == 2 && RAYCAST
+  // {[̃CLXg (Rs[gVF[_)
+  Raycast raycast;
+#endif
+
+#if (TSDF == 1 || TSDF == 3) && TRACK_CAMERA
+  // t[̖@xNg
+  CpuNormal trackNormal(width, height);
 
-  // _ʒu@xNgvZVF[_
-  const Calculate normal(width, height, "normal.frag");
+  // {[CLXgf
+  CpuRaycast model;
+  const GgMatrix modelProjection(CpuIcp::getProjection(icpNear, icpFar));
+
+  // t[fɍ킹 ICP
+  CpuIcp icp(width, height, icpLevels);
+  icp.setParameter(icpDistance, icpAngle);
+
+  // 肵[hW (ŏ̃t[̃JW) JWւ̕ϊs
+  GgMatrix sensorView(ggIdentity());
+#  if MEASURE_TIME
+
+  // @xNg [0], ICP [1],  [2], CLXg [3] ̎Ԃ ICP ̒iƂ̎Ԃ̍vƃt[
+  double trackTime[4] = { 0.0, 0.0, 0.0, 0.0 };
+  std::vector<double> icpLevelTime(icpLevels, 0.0);
+  int trackFrames(0);
+#  endif
+#endif
+
+#if VERIFY_CPU
+  // _ʒuƖ@xNg CPU ŋ߂
+  CpuPosition cpuPosition(width, height);
+  CpuNormal cpuNormal(width, height);
+  cpuNormal.setInput(0, cpuPosition.getBuffer()[0].data());
+
+  // _ʒuƖ@xNǧ덷̍őlƔrt[
+  GLfloat positionError(0.0f), normalError(0.0f);
+  int verifyFrames(0);
+#endif
 
   // wiFݒ肷
   glClearColor(background[0], background[1], background[2], background[3]);
 
   // BʏLɂ
   glEnable(GL_DEPTH_TEST);
+#if RIG
+  // ꏏɕ`[xZT
+  std::vector<DepthCamera *> rig;
+
+  // fvXf[^̃ZT rigCenter ̎ɍE݂ rigAngle 񂵂ʒuɒu
+  for (int i = 0; i < rigSynthetic; ++i)
+  {
+    const GLfloat angle(GLfloat(i / 2 + 1) * (i % 2 == 0 ? rigAngle : -rigAngle));
+    const GgMatrix pose(ggTranslate(rigCenter[0], rigCenter[1], rigCenter[2]) * ggRotateY(angle)
+      * ggTranslate(-rigCenter[0], -rigCenter[1], -rigCenter[2]));
+    rig.push_back(new SyntheticCamera(width, height, pose, rigNoise, pointFormat));
+  }
+
+  // L^fvXf[^ sensor ƓʒuōĐ
+  if (rigReplayFile)
+  {
+    ReplayCamera *const replay(new ReplayCamera(rigReplayFile, pointFormat));
+    if (replay->getActivated())
+      rig.push_back(replay);
+    else
+      delete replay;
+  }
+
+  // ZTƂ̕`ɎgbVƓ_Q, @xNg߂pX̘AƂ̓o
+  std::vector<Mesh *> rigMesh;
+  std::vector<Splat *> rigSplat;
+  std::vector<PassGraph *> rigGraph;
+  std::vector<int> rigInput, rigNormal;
+  for (size_t i = 0; i < rig.size(); ++i)
+  {
+    int w, h;
+    rig[i]->getDepthResolution(&w, &h);
+    rigMesh.push_back(new Mesh(w, h, rig[i]->getCoordBuffer()));
+    rigSplat.push_back(new Splat(w, h, rig[i]->getCoordBuffer()));
+    rigGraph.push_back(new PassGraph(w, h));
+    rigInput.push_back(rigGraph[i]->addInput());
+    rigNormal.push_back(rigGraph[i]->getOutput(rigGraph[i]->addPass("normal.frag", std::vector<int>(1, rigInput[i]), 1, normalFormat)));
+  }
+
+  // sensor ̃fvXf[^ SDK ̃eNX`W̋L^
+  int colorWidth, colorHeight;
+  sensor.getColorResolution(&colorWidth, &colorHeight);
+  DepthRecorder *const recorder(rigRecordFile
+    ? new DepthRecorder(rigRecordFile, width, height, rigRecordTexcoordFile, colorWidth, colorHeight) : NULL);
+  std::vector<GLfloat> recordTexcoord(rigRecordTexcoordFile ? width * height * 2 : 0);
+#  if CALIBRATE_RIG
+
+  // Op[^̐Ɛ肵Ă[xZT, ɐ肷[xZT, ̐n߂܂ł̃t[
+  ExtrinsicCalibration calibration(width, height);
+  size_t calibrationTarget(0), calibrationNext(0);
+  int calibrationWait(rigCalibrationInterval);
+#  endif
+#endif
+
   glEnable(GL_CULL_FACE);
 
+#if MEASURE_TIME
+  // @xNǧvZ [0] ƕ`掞 [1] ̌vɎgNGIuWFNg
+  GLuint query[2];
+  glGenQueries(2, query);
+
+  // @xNǧvZԂ̍v
+  double normalTime(0.0);
+
+  // bV [0] Ɠ_Q [1] ̕`掞Ԃ̍vƃt[
+  double drawTime[2] = { 0.0, 0.0 };
+  int drawFrames[2] = { 0, 0 };
+#endif
+
+#if DOWNSAMPLE
+  // _Q̊Ԉ
+  VoxelGrid downsample(downsampleLeafSize, downsampleFirst ? VoxelGrid::FIRST : VoxelGrid::CENTROID);
+#  if MEASURE_TIME
+
+  // ԈԂ̍vƉ
+  double downsampleTime(0.0);
+  int downsampleFrames(0);
+#  endif
+#endif
+
+#if OCTREE
+  // t[܂œ_Q𗭂߂锪؂Ǝɒǉ܂ł̃t[
+  Octree octree(octreeOrigin, octreeSize, octreeDepth, octreeLeafCapacity);
+  int octreeWait(0);
+#endif
+
+#if KD_TREE
+  // t[̓_Q k-d ؂ƉfƂ̋ߖT̓_
+  KdTree kdTree(kdTreeLeafSize);
+  std::vector<int> neighbour(width * height * kdTreeNeighbours);
+#  if MEASURE_TIME
+
+  // 鎞ԂƒTԂ̍vƉ
+  double kdTreeTime[2] = { 0.0, 0.0 };
+  int kdTreeFrames(0);
+#  endif
+#endif
+
+#if DOWNSAMPLE || OCTREE || KD_TREE
+  // [JXbhœ_Q[xZT (sensor ƈꏏɕ`[xZT)
+  std::vector<const DepthCamera *> pointSource(1, &sensor);
+#  if RIG
+  pointSource.insert(pointSource.end(), rig.begin(), rig.end());
+#  endif
+
+  // _Q̊Ԉ, ؂ւ̒ǉ, k-d ؂̒Ts[JXbh (gϐɐ錾ĐɏÎ҂)
+#  if DOWNSAMPLE
+  PointCloudWorker downsampleWorker;
+#  endif
+#  if OCTREE
+  PointCloudWorker octreeWorker;
+#  endif
+#  if KD_TREE
+  PointCloudWorker kdTreeWorker;
+#  endif
+#endif
+
   // EBhEJĂԂԂ`悷
   while (!window.shouldClose())
   {
+    // ZT擾f[^͂
 #if GENERATE_POSITION
-    // _ʒǔvZ
-    position.use();
-    glUniform1i(0, 0);
-    glActiveTexture(GL_TEXTURE0);
-    sensor.getDepth();
-    const std::vector<GLuint> &positionTexture(position.calculate());
+    GLuint depthTexture(sensor.getDepth());
+#  if TEMPORAL_FILTER == 2
+    depthTexture = temporal.filter(depthTexture);
+#  endif
+#  if FLYING_PIXEL_FILTER == 2
+    depthTexture = flyingPixel.filter(depthTexture);
+#  endif
+#  if BILATERAL_FILTER == 2
+    depthTexture = bilateral.filter(depthTexture);
+#  endif
+    graph.setInput(depthInput, depthTexture);
+#else
+    graph.setInput(positionOutput, sensor.getPoint());
+#endif
+
+#if MEASURE_TIME
+    // @xNǧvZԂ̌vJn
+    glBeginQuery(GL_TIME_ELAPSED, query[0]);
+#endif
 
-    // @xNǧvZ
+#if USE_COMPUTE
+    // _ʒu߂
+    graph.require(positionOutput);
+    graph.execute();
+
+    // @xNg߂
     normal.use();
     glUniform1i(0, 0);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, positionTexture[0]);
-    const std::vector<GLuint> &normalTexture(normal.calculate());
+    glBindTexture(GL_TEXTURE_2D, graph.getTexture(positionOutput));
+    const GLuint normalTexture(normal.calculate()[0]);
 #else
-    // @xNǧvZ
-    normal.use();
-    glUniform1i(0, 0);
-    glActiveTexture(GL_TEXTURE0);
-    sensor.getPoint();
-    const std::vector<GLuint> &normalTexture(normal.calculate());
+    // _ʒuƖ@xNg߂
+    graph.require(positionOutput);
+    graph.require(normalOutput);
+    graph.execute();
+    const GLuint normalTexture(graph.getTexture(normalOutput));
+#endif
+
+#if MEASURE_TIME
+    // @xNǧvZԂ̌vI
+    glEndQuery(GL_TIME_ELAPSED);
+#endif
+
+#if RIG
+    // ꏏɕ`[xZT̍ŐṼt[̒_ʒuƖ@xNg߂
+    for (size_t i = 0; i < rig.size(); ++i)
+    {
+      rigGraph[i]->setInput(rigInput[i], rig[i]->getPoint());
+      rigGraph[i]->require(rigNormal[i]);
+      rigGraph[i]->execute();
+    }
+
+    // sensor ̃fvXf[^L^ (SDK ̃eNX`WL^Ȃ狁߂ĈꏏɋL^)
+    if (recorder)
+    {
+      GLfloat (*const texcoord)[2](reinterpret_cast<GLfloat (*)[2]>(recordTexcoord.data()));
+      recorder->write(sensor.getDepthBuffer(), !recordTexcoord.empty() && sensor.getSdkTexcoord(texcoord) ? texcoord : NULL);
+    }
+#  if CALIBRATE_RIG
+
+    // 肪IĂΐ肵Op[^ݒ肷
+    GgMatrix relative;
+    if (calibration.getResult(relative))
+    {
+      rig[calibrationTarget]->setExtrinsic(sensor.getExtrinsic() * relative);
+#    if MEASURE_TIME
+      const ExtrinsicCalibration::Result &result(calibration.getLastResult());
+      std::cerr << "ExtrinsicCalibration rig " << calibrationTarget << ": " << result.time << " ms, "
+        << result.matchedPlanes << " planes matched, ICP error " << result.icp.error << " m\n";
+#    endif
+    }
+
+    // 蒆łȂ rigCalibrationInterval t[ƂɎ̐[xZT̐n߂ (_Q̑傫ႦΔ΂)
+    if (!rig.empty() && sensor.getPointBuffer() && !calibration.isBusy() && --calibrationWait <= 0)
+    {
+      calibrationTarget = calibrationNext;
+      calibrationNext = (calibrationNext + 1) % rig.size();
+      calibrationWait = rigCalibrationInterval;
+
+      int w, h;
+      rig[calibrationTarget]->getDepthResolution(&w, &h);
+      if (w == width && h == height)
+        calibration.start(sensor.getPointBuffer(), rig[calibrationTarget]->getPointBuffer(),
+          sensor.getExtrinsic().invert() * rig[calibrationTarget]->getExtrinsic());
+    }
+#  endif
+#endif
+
+#if DOWNSAMPLE
+    // O̊ԈIĂΓ_Q𕡐, [JXbhŋLWnɕϊȂ痭߂ĊԈ
+    downsampleWorker.start(pointSource, [&]()
+    {
+#  if MEASURE_TIME
+      // ԈԂ̌vJn
+      const std::chrono::steady_clock::time_point downsampleStart(std::chrono::steady_clock::now());
+#  endif
+
+      downsample.clear();
+      for (int i = 0; i < downsampleWorker.getSources(); ++i)
+      {
+        if (downsampleWorker.getPointCount(i) > 0)
+          downsample.add(downsampleWorker.getPoint(i), downsampleWorker.getPointCount(i), downsampleWorker.getPose(i));
+      }
+      downsample.filter();
+
+#  if MEASURE_TIME
+      // 100 񂲂Ƃɕς̊ԈԂƊԈO̓_̐\
+      downsampleTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - downsampleStart).count();
+      if (++downsampleFrames == 100)
+      {
+        std::cerr << "VoxelGrid::filter " << downsampleTime / 100.0 << " ms, "
+          << downsample.getInputCount() << " -> " << downsample.getOutputCount() << " points\n";
+        downsampleTime = 0.0;
+        downsampleFrames = 0;
+      }
+#  endif
+    });
+#endif
+
+#if OCTREE
+    // octreeInterval t[Ƃ, O̒ǉIĂΓ_Q𕡐ă[JXbhŔ؂ɒǉ
+    if (--octreeWait <= 0 && sensor.getPointBuffer() && !octreeWorker.isBusy())
+    {
+      octreeWait = octreeInterval;
+      octreeWorker.start(pointSource, [&]()
+      {
+#  if MEASURE_TIME
+        const std::chrono::steady_clock::time_point octreeStart(std::chrono::steady_clock::now());
+#  endif
+
+        // ꂻȂ sensor ̓_Qō蒼, łȂΒǉ
+        const bool rebuild(octree.getPointCount() + octreeWorker.getPointCount(0) > octreeMaximum);
+        if (rebuild)
+          octree.build(octreeWorker.getPoint(0), octreeWorker.getPointCount(0), octreeWorker.getPose(0));
+        else
+          octree.insert(octreeWorker.getPoint(0), octreeWorker.getPointCount(0), octreeWorker.getPose(0));
+        for (int i = 1; i < octreeWorker.getSources(); ++i)
+        {
+          if (octreeWorker.getPointCount(i) > 0)
+            octree.insert(octreeWorker.getPoint(i), octreeWorker.getPointCount(i), octreeWorker.getPose(i));
+        }
+#  if MEASURE_TIME
+
+        // 蒼ǉԂƓ_Ɛߓ_̐\
+        std::cerr << (rebuild ? "Octree::build " : "Octree::insert ")
+          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - octreeStart).count() << " ms, "
+          << octree.getPointCount() << " points, " << octree.getNodeCount() << " nodes\n";
+#  endif
+      });
+    }
+#endif
+
+#if KD_TREE
+    // O̒TIĂ sensor ̓_Q𕡐, [JXbhŖ؂蒼ċߖT̓_T
+    if (sensor.getPointBuffer())
+    {
+      kdTreeWorker.start(std::vector<const DepthCamera *>(1, &sensor), [&]()
+      {
+        const GLfloat (*const point)[3](kdTreeWorker.getPoint(0));
+        const int count(kdTreeWorker.getPointCount(0));
+#  if MEASURE_TIME
+        const std::chrono::steady_clock::time_point kdTreeStart(std::chrono::steady_clock::now());
+#  endif
+
+        // vł_؂蒼
+        kdTree.build(point, count);
+#  if MEASURE_TIME
+        const std::chrono::steady_clock::time_point kdTreeBuilt(std::chrono::steady_clock::now());
+#  endif
+
+        // ׂẲf̋ߖT̓_܂Ƃ߂ĒT
+        kdTree.findNearest(point, count, kdTreeNeighbours, neighbour.data());
+#  if MEASURE_TIME
+
+        // 100 񂲂Ƃɕς̍鎞ԂƒTԂ\
+        kdTreeTime[0] += std::chrono::duration<double, std::milli>(kdTreeBuilt - kdTreeStart).count();
+        kdTreeTime[1] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kdTreeBuilt).count();
+        if (++kdTreeFrames == 100)
+        {
+          std::cerr << "KdTree::build " << kdTreeTime[0] / 100.0 << " ms, KdTree::findNearest "
+            << kdTreeTime[1] / 100.0 << " ms (" << kdTree.getPointCount() << " points)\n";
+          kdTreeTime[0] = kdTreeTime[1] = 0.0;
+          kdTreeFrames = 0;
+        }
+#  endif
+      });
+    }
+#endif
+
+#if (TSDF == 1 || TSDF == 3) && TRACK_CAMERA
+    // Vt[擾ƂZTǐՂă{[ɓ
+    if (sensor.getFrame() != tsdfFrame)
+    {
+      tsdfFrame = sensor.getFrame();
+
+#  if MEASURE_TIME
+      // ǐՂ̎Ԃ̌vJn
+      std::chrono::steady_clock::time_point trackLap[5];
+      trackLap[0] = std::chrono::steady_clock::now();
+#  endif
+
+      // t[fɍ킹ăZT̈ʒuƌ߂ (킹ȂΑÕt[̈ʒuƌ̂܂)
+      trackNormal.setInput(0, sensor.getPointBuffer());
+      trackNormal.calculate();
+#  if MEASURE_TIME
+      trackLap[1] = std::chrono::steady_clock::now();
+#  endif
+      icp.track(sensor.getPointBuffer(), reinterpret_cast<const GLfloat (*)[3]>(trackNormal.getBuffer()[0].data()), sensorView);
+#  if MEASURE_TIME
+      trackLap[2] = std::chrono::steady_clock::now();
+#  endif
+
+      // 肵ʒuƌŃ{[ɓ, 猩\ʂ̃t[̃fɂ
+      tsdf.integrate(sensor.getPointBuffer(), sensorView);
+#  if MEASURE_TIME
+      trackLap[3] = std::chrono::steady_clock::now();
+#  endif
+      model.render(tsdf, width, height, modelProjection, sensorView);
+      icp.setModel(model.getPoint(), model.getNormal(), sensorView);
+#  if MEASURE_TIME
+      trackLap[4] = std::chrono::steady_clock::now();
+
+      // 100 t[Ƃɕς̎Ԃ 30 fps  1 t[̎ (33 ms) Ɣׂĕ\
+      for (int i = 0; i < 4; ++i) trackTime[i] += std::chrono::duration<double, std::milli>(trackLap[i + 1] - trackLap[i]).count();
+      for (int i = 0; i < icpLevels; ++i) icpLevelTime[i] += icp.getResult(i).time;
+      if (++trackFrames == 100)
+      {
+        std::cerr << "CpuNormal " << trackTime[0] / 100.0 << " ms, CpuIcp::track " << trackTime[1] / 100.0 << " ms (level";
+        for (int i = icpLevels - 1; i >= 0; --i) std::cerr << ' ' << i << ": " << icpLevelTime[i] / 100.0;
+        std::cerr << "), integrate " << trackTime[2] / 100.0 << " ms, CpuRaycast::render " << trackTime[3] / 100.0 << " ms, total "
+          << (trackTime[0] + trackTime[1] + trackTime[2] + trackTime[3]) / 100.0 << " ms / 33 ms\n";
+        std::fill(trackTime, trackTime + 4, 0.0);
+        std::fill(icpLevelTime.begin(), icpLevelTime.end(), 0.0);
+        trackFrames = 0;
+      }
+#  endif
+#  if EXTRACT_SURFACE
+      // ςƂ̕\ʂ𒊏o
+      surface.update(tsdf);
+#  endif
+    }
+#elif TSDF == 1 || TSDF == 3
+    // Vt[擾Ƃ{[ɓ
+    if (sensor.getFrame() != tsdfFrame)
+    {
+      tsdfFrame = sensor.getFrame();
+
+      // Œ肵ZT̃JŴ܂܃[hWƂă{[ɓ
+      tsdf.integrate(sensor.getPointBuffer(), ggIdentity());
+#  if EXTRACT_SURFACE
+      // ςƂ̕\ʂ𒊏o
+      surface.update(tsdf);
+#  endif
+    }
+#elif TSDF == 2
+    // Vt[擾Ƃ{[ɓ
+    if (sensor.getFrame() != tsdfFrame)
+    {
+      tsdfFrame = sensor.getFrame();
+
+      // Œ肵ZT̃JŴ܂܃[hWƂă{[ɓ
+      tsdf.integrate(graph.getTexture(positionOutput), ggIdentity());
+    }
+#endif
+
+#if VERIFY_CPU
+    // CPU œvZăVF[_̌vZʂƔr
+    cpuPosition.setInput(0, sensor.getDepthBuffer());
+    cpuPosition.calculate();
+    cpuNormal.calculate();
+    const GLfloat pe(cpuPosition.compare(graph.getTexture(positionOutput)));
+    const GLfloat ne(cpuNormal.compare(normalTexture, 0, PACK_NORMAL != 0));
+    if (pe > positionError) positionError = pe;
+    if (ne > normalError) normalError = ne;
+
+    // 100 t[ƂɌ덷̍ől\
+    if (++verifyFrames == 100)
+    {
+      std::cerr << "position error " << positionError << ", normal error " << normalError << "\n";
+      positionError = normalError = 0.0f;
+      verifyFrames = 0;
+    }
 #endif
 
     // ʏ
     window.clear();
 
+    // _Qŕ`悷邩ǂ
+    const bool pointMode(window.getPointMode());
+
     // `p̃VF[_vO̎gpJn
-    simple.use();
-    simple.loadMatrix(window.getMp(), window.getMw());
-    simple.setLight(light);
-    simple.setMaterial(material);
+#if (TSDF == 1 || TSDF == 3) && EXTRACT_SURFACE
+    GgSimpleShader &shader(pointMode ? splatShader : surfaceShader);
+#else
+    GgSimpleShader &shader(pointMode ? splatShader : simple);
+#endif
+    shader.use();
+    shader.loadMatrix(window.getMp(), window.getMw());
+    shader.setLight(light);
+    shader.setMaterial(material);
+
+    // _Q̑傫
+    if (pointMode) splatShader.setSplat(splatRadius, window.getScale());
 
     // eNX`
-#if GENERATE_POSITION
     glUniform1i(0, 0);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, positionTexture[0]);
-#endif
+    glBindTexture(GL_TEXTURE_2D, graph.getTexture(positionOutput));
     glUniform1i(1, 1);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalTexture[0]);
+    glBindTexture(GL_TEXTURE_2D, normalTexture);
     glUniform1i(2, 2);
     glActiveTexture(GL_TEXTURE2);
     sensor.getColor();
 
+#if COLOR_MAPPING == 2
+    // ZT肵 SDK ̃eNX`Wɍ킹ăLu[V, g悤ɂ
+    if (calibrationFrames > 0 && --calibrationFrames == 0)
+    {
+      const GLfloat error(sensor.fitColorMapping(calibrationFile));
+      std::cerr << "ColorMapper::fit " << error << " px\n";
+      if (error >= 0.0f) sensor.setColorMapping(calibrationFile);
+    }
+#endif
+
+#if MEASURE_TIME
+    // `掞Ԃ̌vJn
+    glBeginQuery(GL_TIME_ELAPSED, query[1]);
+#endif
+
     // }``
-    mesh.draw();
+    if (pointMode)
+      splat.draw();
+    else
+#if (TSDF == 1 || TSDF == 3) && EXTRACT_SURFACE
+      surface.draw();
+#elif TSDF == 2 && RAYCAST
+    {
+      // EBhEƓ傫ŃCLXgĉAe\
+      raycast.render(tsdf, window.getSize()[0], window.getSize()[1], window.getMp(), window.getMw());
+      raycast.draw();
+    }
+#else
+      mesh.draw();
+#endif
+
+#if RIG
+    // ꏏɕ`[xZT̐}`Op[^ sensor ̍Wnɒuĕ`
+    for (size_t i = 0; i < rig.size(); ++i)
+    {
+      shader.loadMatrix(window.getMp(), window.getMw() * rig[i]->getExtrinsic());
+      glActiveTexture(GL_TEXTURE0);
+      glBindTexture(GL_TEXTURE_2D, rigGraph[i]->getTexture(rigInput[i]));
+      glActiveTexture(GL_TEXTURE1);
+      glBindTexture(GL_TEXTURE_2D, rigGraph[i]->getTexture(rigNormal[i]));
+      glActiveTexture(GL_TEXTURE2);
+      rig[i]->getColor();
+      if (pointMode)
+        rigSplat[i]->draw();
+      else
+        rigMesh[i]->draw();
+    }
+#endif
+
+#if MEASURE_TIME
+    // `掞Ԃ̌vI
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // vZԂƕ`掞ԂWv
+    GLuint64 elapsed;
+    glGetQueryObjectui64v(query[0], GL_QUERY_RESULT, &elapsed);
+    normalTime += double(elapsed) * 1.0e-6;
+    glGetQueryObjectui64v(query[1], GL_QUERY_RESULT, &elapsed);
+    drawTime[pointMode] += double(elapsed) * 1.0e-6;
+
+    // 100 t[Ƃɕς̌vZԂƕ`掞Ԃ\
+    if (++drawFrames[pointMode] == 100)
+    {
+      std::cerr << (USE_COMPUTE ? "normal.comp " : "normal.frag ") << normalTime / 100.0 << " ms, "
+        << (pointMode ? "Splat::draw " : "Mesh::draw ") << drawTime[pointMode] / 100.0 << " ms\n";
+      normalTime = 0.0;
+      drawTime[pointMode] = 0.0;
+      drawFrames[pointMode] = 0;
+    }
+#endif
 
     // obt@ւ
     window.swapBuffers();
   }
+
+#if RIG
+  // 擾XbhIĈꏏɕ`[xZT폜
+  delete recorder;
+  for (size_t i = 0; i < rig.size(); ++i)
+  {
+    delete rigGraph[i];
+    delete rigSplat[i];
+    delete rigMesh[i];
+    delete rig[i];
+  }
+#endif
 }
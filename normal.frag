@@ -2,6 +2,11 @@
 #extension GL_ARB_explicit_attrib_location : enable
 #extension GL_ARB_explicit_uniform_location : enable
 
+// @xNg𔪖ʑ̎ʑ 2 ɋlߍނȂ PACK_NORMAL  1 (ǂݍނƂ config.h ̒lŒ`)
+
+// 艓_͌vłȂ_ (position.frag  DEPTH_MAXIMUM) Ƃ݂Ȃ
+#define DEPTH_INVALID (-9.0)
+
 // eNX`
 layout (location = 0) uniform sampler2D position;
 
@@ -9,14 +14,41 @@ layout (location = 0) uniform sampler2D position;
 in vec2 texcoord;
 
 // t[obt@ɏo͂f[^
+#if PACK_NORMAL
+layout (location = 0) out vec2 normal;
+#else
 layout (location = 0) out vec3 normal;
+#endif
+
+// PʃxNg𔪖ʑ̎ʑ [0, 1]  2 ɕϊ
+vec2 encode(in vec3 n)
+{
+  vec2 p = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+  if (n.z < 0.0) p = (1.0 - abs(p.yx)) * vec2(p.x >= 0.0 ? 1.0 : -1.0, p.y >= 0.0 ? 1.0 : -1.0);
+  return p * 0.5 + 0.5;
+}
 
 void main(void)
 {
+  // ߖT̒_ʒu (vłȂ_͒S̓_ɒuĕБ̍ɂ)
+  vec3 c = texture(position, texcoord).xyz;
+  vec3 l = textureOffset(position, texcoord, ivec2(-1, 0)).xyz;
+  vec3 r = textureOffset(position, texcoord, ivec2(1, 0)).xyz;
+  vec3 b = textureOffset(position, texcoord, ivec2(0, -1)).xyz;
+  vec3 t = textureOffset(position, texcoord, ivec2(0, 1)).xyz;
+  if (l.z < DEPTH_INVALID) l = c;
+  if (r.z < DEPTH_INVALID) r = c;
+  if (b.z < DEPTH_INVALID) b = c;
+  if (t.z < DEPTH_INVALID) t = c;
+
   // ߖŤz߂
-  vec3 vx = vec3(textureOffset(position, texcoord, ivec2(1, 0)) - textureOffset(position, texcoord, ivec2(-1, 0)));
-  vec3 vy = vec3(textureOffset(position, texcoord, ivec2(0, 1)) - textureOffset(position, texcoord, ivec2(0, -1)));
+  vec3 vx = r - l;
+  vec3 vy = t - b;
 
   // z炩@xNg߂
+#if PACK_NORMAL
+  normal = encode(normalize(cross(vx, vy)));
+#else
   normal = normalize(cross(vx, vy));
+#endif
 }
@@ -18,8 +18,8 @@ layout (location = 0) uniform sampler2D depth;
 // eNX`W
 in vec2 texcoord;
 
-// t[obt@ɏo͂f[^
-layout (location = 0) out vec3 position;
+// t[obt@ɏo͂f[^ (GL_RGBA16F ɏo͂Ă w  1 ɂȂ悤 4 ŏo͂)
+layout (location = 0) out vec4 position;
 
 // fvXlXP[O
 float s(in float z)
@@ -33,5 +33,5 @@ void main(void)
   float z = s(texture(depth, texcoord).r);
 
   // fvXlJWl߂
-  position = vec3((texcoord - 0.5) * scale * z, z);
+  position = vec4((texcoord - 0.5) * scale * z, z, 1.0);
 }
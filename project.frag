@@ -0,0 +1,20 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 1) uniform sampler2D color;      // J[̃eNX`
+
+// X^CU󂯎钸_̕Ԓl
+in float z;                                         // fvXl
+flat in ivec2 pixel;                                // J[̉f
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float projected;          // fvXl
+layout (location = 1) out vec4 guide;               // eʒũJ[
+
+void main(void)
+{
+  projected = z;
+  guide = texelFetch(color, pixel, 0);
+}
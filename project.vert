@@ -0,0 +1,40 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D depth;      // fvX̃eNX`
+
+// eiq̃Z̈ӂ̉f
+uniform int scale;
+
+// eiq̃TCY
+uniform ivec2 size;
+
+// _
+layout (location = 0) in vec2 cc;                   // J[̃eNX`W (f)
+
+// X^CUɑ钸_
+out float z;                                        // fvXl
+flat out ivec2 pixel;                               // J[̉f
+
+void main(void)
+{
+  // ̒_ɑΉfvX̉f
+  int width = textureSize(depth, 0).x;
+  z = texelFetch(depth, ivec2(gl_VertexID % width, gl_VertexID / width), 0).r;
+
+  // J[̃eNX`W̃Z
+  vec2 cell = floor(cc / float(scale));
+
+  // vłȂ_Ɗiq̊O̓_ (߂ȂeNX`W܂) ̓NbsOԂ̊Oɏo
+  if (z == 0.0 || !all(greaterThanEqual(cell, vec2(0.0))) || !all(lessThan(cell, vec2(size))))
+  {
+    gl_Position = vec4(2.0, 2.0, 0.0, 1.0);
+    return;
+  }
+
+  // Z̒SɃfvXlsɂē_u
+  pixel = ivec2(cc);
+  gl_Position = vec4((cell + 0.5) * 2.0 / vec2(size) - 1.0, z * 2.0 - 1.0, 1.0);
+}
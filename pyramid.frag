@@ -0,0 +1,72 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// 2x2 f̂܂Ƃߕ (Pyramid::Reduce ƍ킹)
+#define MINIMUM 0
+#define MEDIAN 1
+#define AVERAGE 2
+
+// eNX` (̒i)
+layout (location = 0) uniform sampler2D depth;
+
+// 2x2 f̂܂Ƃߕ
+uniform int reduce;
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float filtered;
+
+// vłȂfבւŌɑ邽߂̑傫Ȓl
+const float invalid = 1.0e30;
+
+// ̒lɕׂ
+void order(inout float a, inout float b)
+{
+  float t = min(a, b);
+  b = max(a, b);
+  a = t;
+}
+
+void main(void)
+{
+  // ̒i 2x2 f (vłȂf͑傫Ȓlɂ)
+  ivec2 p = ivec2(gl_FragCoord.xy) * 2;
+  vec4 d = vec4(
+    texelFetch(depth, p, 0).r,
+    texelFetch(depth, p + ivec2(1, 0), 0).r,
+    texelFetch(depth, p + ivec2(0, 1), 0).r,
+    texelFetch(depth, p + ivec2(1, 1), 0).r
+  );
+  vec4 valid = vec4(notEqual(d, vec4(0.0)));
+  float count = dot(valid, vec4(1.0));
+  d = mix(vec4(invalid), d, valid);
+
+  // 4 fƂvłĂȂ 0 ɂ
+  if (count == 0.0)
+  {
+    filtered = 0.0;
+    return;
+  }
+
+  if (reduce == MINIMUM)
+  {
+    // ł߂_
+    filtered = min(min(d.x, d.y), min(d.z, d.w));
+  }
+  else if (reduce == MEDIAN)
+  {
+    // ɕׂĒl߂
+    float a = d.x, b = d.y, c = d.z, e = d.w;
+    order(a, b);
+    order(c, e);
+    order(a, c);
+    order(b, e);
+    order(b, c);
+    filtered = count == 4.0 ? (b + c) * 0.5 : count == 3.0 ? b : count == 2.0 ? (a + b) * 0.5 : a;
+  }
+  else
+  {
+    // vłf̕
+    filtered = dot(d * valid, vec4(1.0)) / count;
+  }
+}
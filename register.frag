@@ -0,0 +1,17 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// X^CU󂯎钸_̕Ԓl
+in float z;                                         // fvXl
+in vec3 p;                                          // JW
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float projected;          // fvXl
+layout (location = 1) out vec3 position;            // JW
+
+void main(void)
+{
+  projected = z;
+  position = p;
+}
@@ -0,0 +1,37 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D depth;      // fvX̃eNX`
+layout (location = 1) uniform sampler2D point;      // JW̃eNX`
+
+// J[̃TCY
+uniform ivec2 size;
+
+// _
+layout (location = 0) in vec2 cc;                   // J[̃eNX`W (f)
+
+// WIgVF[_ɑ钸_
+out float vz;                                       // fvXl
+out vec3 vp;                                        // JW
+
+void main(void)
+{
+  // ̒_ɑΉfvX̉f
+  int width = textureSize(depth, 0).x;
+  ivec2 p = ivec2(gl_VertexID % width, gl_VertexID / width);
+  vz = texelFetch(depth, p, 0).r;
+  vp = texelFetch(point, p, 0).xyz;
+
+  // ߂ȂeNX`W (-) ̒_͌vłȂƂɂ
+  if (!all(lessThan(abs(cc), vec2(1.0e30))))
+  {
+    vz = 0.0;
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  // J[̉f̈ʒuɃfvXlsɂĒ_u
+  gl_Position = vec4(cc * 2.0 / vec2(size) - 1.0, vz * 2.0 - 1.0, 1.0);
+}
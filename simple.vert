@@ -2,6 +2,8 @@
 #extension GL_ARB_explicit_attrib_location : enable
 #extension GL_ARB_explicit_uniform_location : enable
 
+// @xNg𔪖ʑ̎ʑ 2 ɋlߍނȂ PACK_NORMAL  1 (ǂݍނƂ config.h ̒lŒ`)
+
 // 
 uniform vec4 lamb;                                  // 
 uniform vec4 ldiff;                                 // gUˌ
@@ -33,13 +35,27 @@ out vec4 idiff;                                     // 
 out vec4 ispec;                                     // ʔˌx
 out vec2 texcoord;                                  // eNX`W
 
+// ʑ̎ʑ [0, 1]  2 ɕϊꂽPʃxNg𕜌
+vec3 decode(in vec2 e)
+{
+  vec2 f = e * 2.0 - 1.0;
+  vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+  float t = max(-n.z, 0.0);
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
 void main(void)
 {
   // _ʒu
   vec4 pv = texture(position, pc);
 
   // @xNg
+#if PACK_NORMAL
+  vec4 nv = vec4(decode(texture(normal, pc).xy), 0.0);
+#else
   vec4 nv = texture(normal, pc);
+#endif
 
   // WvZ
   vec4 p = mw * pv;                                 // _Wn̒_̈ʒu
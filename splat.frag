@@ -0,0 +1,24 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 2) uniform sampler2D color;      // J[̃eNX`
+
+// X^CU󂯎钸_̕Ԓl
+in vec4 idiff;                                      // gUˌx
+in vec4 ispec;                                      // ʔˌx
+in vec2 texcoord;                                   // eNX`W
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out vec4 fc;                  // tOg̐F
+
+void main(void)
+{
+  // Xvbg~`ɂ
+  vec2 d = gl_PointCoord * 2.0 - 1.0;
+  if (dot(d, d) > 1.0) discard;
+
+  // eNX`}bsOsĉAe߂
+  fc = texture(color, texcoord) * idiff + ispec;
+}
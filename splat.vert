@@ -0,0 +1,96 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// @xNg𔪖ʑ̎ʑ 2 ɋlߍނȂ PACK_NORMAL  1 (ǂݍނƂ config.h ̒lŒ`)
+
+// 艓_͌vłȂ_ (position.frag  DEPTH_MAXIMUM) Ƃ݂Ȃ
+#define DEPTH_INVALID (-9.0)
+
+// 
+uniform vec4 lamb;                                  // 
+uniform vec4 ldiff;                                 // gUˌ
+uniform vec4 lspec;                                 // ʌ
+uniform vec4 pl;                                    // ʒu
+
+// ގ
+uniform vec4 kamb;                                  // ̔ˌW
+uniform vec4 kdiff;                                 // gUˌW
+uniform vec4 kspec;                                 // ʔˌW
+uniform float kshi;                                 // PW
+
+// ϊs
+uniform mat4 mw;                                    // _Wnւ̕ϊs
+uniform mat4 mc;                                    // NbsOWnւ̕ϊs
+uniform mat4 mg;                                    // @xNg̕ϊs
+
+// Xvbg̑傫
+uniform float radius;                               // ZT狗 1 ̓_̔a
+uniform float scale;                                //  1 ɂ钷 1 ̉f
+uniform float minSize;                              // ŏ̉f
+
+// eNX`
+layout (location = 0) uniform sampler2D position;   // _ʒũeNX`
+layout (location = 1) uniform sampler2D normal;     // @xNg̃eNX`
+layout (location = 2) uniform sampler2D color;      // J[̃eNX`
+
+// _
+layout (location = 0) in vec4 pc;                   // _̃eNX`W
+layout (location = 1) in vec2 cc;                   // J[̃eNX`W
+
+// X^CUɑ钸_
+out vec4 idiff;                                     // gUˌx
+out vec4 ispec;                                     // ʔˌx
+out vec2 texcoord;                                  // eNX`W
+
+// ʑ̎ʑ [0, 1]  2 ɕϊꂽPʃxNg𕜌
+vec3 decode(in vec2 e)
+{
+  vec2 f = e * 2.0 - 1.0;
+  vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+  float t = max(-n.z, 0.0);
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
+void main(void)
+{
+  // _ʒu
+  vec4 pv = texture(position, pc.xy);
+
+  // vłȂ_̓NbsOԂ̊Oɒuđ傫 0 ɂĎ̂Ă
+  if (pv.z < DEPTH_INVALID)
+  {
+    gl_PointSize = 0.0;
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+
+  // @xNg
+#if PACK_NORMAL
+  vec4 nv = vec4(decode(texture(normal, pc.xy).xy), 0.0);
+#else
+  vec4 nv = texture(normal, pc.xy);
+#endif
+
+  // WvZ
+  vec4 p = mw * pv;                                 // _Wn̒_̈ʒu
+  vec4 q = pl;                                      // _Wň̈ʒu
+  vec3 v = normalize(p.xyz / p.w);                  // xNg
+  vec3 l = normalize((q * p.w - p * q.w).xyz);      // xNg
+  vec3 n = normalize((mg * nv).xyz);                // @xNg
+  vec3 h = normalize(l - v);                        // ԃxNg
+
+  // AevZ
+  idiff = max(dot(n, l), 0.0) * kdiff * ldiff + kamb * lamb;
+  ispec = pow(max(dot(n, h), 0.0), kshi) * kspec * lspec;
+
+  // eNX`W
+  texcoord = cc / vec2(textureSize(color, 0));
+
+  // ZT̋ɔႵ傫̃Xvbg_̋ɉĉʂɓe
+  gl_PointSize = max(2.0 * radius * abs(pv.z) * scale / max(-p.z / p.w, 1.0e-3), minSize);
+
+  // NbsOWnɂWl
+  gl_Position = mc * pv;
+}
@@ -0,0 +1,15 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+
+// X^CU󂯎钸_̕Ԓl
+in vec4 idiff;                                      // gUˌx
+in vec4 ispec;                                      // ʔˌx
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out vec4 fc;                  // tOg̐F
+
+void main(void)
+{
+  // Ae߂
+  fc = idiff + ispec;
+}
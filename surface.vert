@@ -0,0 +1,45 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+
+// 
+uniform vec4 lamb;                                  // 
+uniform vec4 ldiff;                                 // gUˌ
+uniform vec4 lspec;                                 // ʔˌ
+uniform vec4 pl;                                    // ʒu
+
+// ގ
+uniform vec4 kamb;                                  // ̔ˌW
+uniform vec4 kdiff;                                 // gUˌW
+uniform vec4 kspec;                                 // ʔˌW
+uniform float kshi;                                 // PW
+
+// ϊs
+uniform mat4 mw;                                    // _Wnւ̕ϊs
+uniform mat4 mc;                                    // NbsOWnւ̕ϊs
+uniform mat4 mg;                                    // @xNg̕ϊs
+
+// _
+layout (location = 0) in vec4 pv;                   // _ʒu ([hW)
+layout (location = 1) in vec4 nv;                   // @xNg
+
+// X^CUɑ钸_
+out vec4 idiff;                                     // gUˌx
+out vec4 ispec;                                     // ʔˌx
+
+void main(void)
+{
+  // WvZ
+  vec4 p = mw * pv;                                 // _Wn̒_̈ʒu
+  vec4 q = pl;                                      // _Wň̈ʒu
+  vec3 v = normalize(p.xyz / p.w);                  // xNg
+  vec3 l = normalize((q * p.w - p * q.w).xyz);      // xNg
+  vec3 n = normalize((mg * vec4(nv.xyz, 0.0)).xyz); // @xNg
+  vec3 h = normalize(l - v);                        // ԃxNg
+
+  // AevZ
+  idiff = max(dot(n, l), 0.0) * kdiff * ldiff + kamb * lamb;
+  ispec = pow(max(dot(n, h), 0.0), kshi) * kspec * lspec;
+
+  // NbsOWnɂWl
+  gl_Position = mc * pv;
+}
@@ -0,0 +1,42 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D depth;
+layout (location = 1) uniform sampler2D state;
+
+// VfvXl̏d (0 Ȃ瓮ĂȂf͑O̒l̂܂)
+uniform float alpha;
+
+// Õt[̒lg킸ɂ蒼Ȃ true
+uniform bool reset;
+
+// Ƃ݂ȂfvXl̍ (fvX̃eNX`̒l̒P)
+uniform float threshold;
+
+// vłȂfɑO̒lێt[
+uniform float hold;
+
+// t[obt@ɏo͂f[^ (fvXl, vłȂt[)
+layout (location = 0) out vec2 filtered;
+
+void main(void)
+{
+  // VfvXlƑÕt[܂ł̒l (vłȂfɗׂ̒lȂ悤ɕԂɎo)
+  ivec2 p = ivec2(gl_FragCoord.xy);
+  float d = texelFetch(depth, p, 0).r;
+  vec2 s = reset ? vec2(0.0) : texelFetch(state, p, 0).rg;
+
+  // vłȂf͂΂炭O̒lێ
+  if (d == 0.0)
+  {
+    filtered = s.g < hold ? vec2(s.r, s.g + 1.0) : vec2(0.0, hold);
+    return;
+  }
+
+  // 臒lɋ߂قǐVl̏d݂傫, 臒l𒴂Vlɒu
+  float e = min(abs(d - s.r) / threshold, 1.0);
+  float a = s.r == 0.0 ? 1.0 : mix(alpha, 1.0, e * e);
+  filtered = vec2(mix(s.r, d, a), 0.0);
+}
@@ -0,0 +1,68 @@
+#version 150 core
+#extension GL_ARB_explicit_attrib_location : enable
+#extension GL_ARB_explicit_uniform_location : enable
+
+// eNX`
+layout (location = 0) uniform sampler2D grid;       // eiqɓefvXl (vłȂZ 0)
+layout (location = 1) uniform sampler2D guide;      // eiqɓeʒũJ[
+layout (location = 2) uniform sampler2D color;      // J[̃eNX`
+
+// eiq̃Z̈ӂ̉f
+uniform int scale;
+
+// tB^̔a (Z)
+uniform int radius;
+
+// ̏d݂̕W΍ (Z)
+uniform float sigmaSpace;
+
+// J[̍̏d݂̕W΍ (RGB ̍̐Βl̘a, 0`765)
+uniform float sigmaColor;
+
+// t[obt@ɏo͂f[^
+layout (location = 0) out float upsampled;
+
+void main(void)
+{
+  // ̉fƂ̃J[ƃZ
+  ivec2 p = ivec2(gl_FragCoord.xy);
+  vec3 c = floor(texelFetch(color, p, 0).rgb * 255.0 + 0.5);
+  ivec2 cell = p / scale;
+
+  // ̉f̒S̃ZPʂ̈ʒu
+  vec2 center = (vec2(p) + 0.5) / float(scale);
+
+  // d݂̎w̌WƃJ[̍̏
+  float ks = -0.5 / (sigmaSpace * sigmaSpace);
+  float kc = -0.5 / (sigmaColor * sigmaColor);
+  float limit = sigmaColor * 3.0;
+
+  // ߖT̃Z̃fvXldݕtĕς
+  ivec2 size = textureSize(grid, 0);
+  float sw = 0.0, sd = 0.0;
+  for (int j = -radius; j <= radius; ++j)
+  {
+    for (int i = -radius; i <= radius; ++i)
+    {
+      ivec2 q = cell + ivec2(i, j);
+      if (any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size))) continue;
+
+      // vłȂZ͊܂߂Ȃ
+      float d = texelFetch(grid, q, 0).r;
+      if (d == 0.0) continue;
+
+      // eʒũJ[Ƃ̍
+      vec3 g = floor(texelFetch(guide, q, 0).rgb * 255.0 + 0.5);
+      float e = dot(abs(c - g), vec3(1.0));
+      if (e >= limit) continue;
+
+      vec2 o = vec2(q) + 0.5 - center;
+      float w = exp(dot(o, o) * ks + e * e * kc);
+      sw += w;
+      sd += w * d;
+    }
+  }
+
+  // ߖTɌvłZȂ 0 ɂ
+  upsampled = sw > 0.0 ? sd / sw : 0.0;
+}